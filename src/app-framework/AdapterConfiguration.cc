@@ -47,11 +47,9 @@
 #include "Update.hh"
 #include "UtilityAdapter.h"
 
-#ifdef PLEXIL_WITH_THREADS
+#include "LockFreeInputQueue.hh"
 #include "SerializedInputQueue.hh"
-#else
 #include "SimpleInputQueue.hh"
-#endif
 
 //
 // The reason for all this #ifdef'ery is that when this library is built
@@ -80,12 +78,121 @@
 #endif
 #endif // not defined(PIC)
 
-#include <map>
+#include <atomic>
+#include <functional> // std::hash
 
 #include <cstring>
 
 namespace PLEXIL {
 
+  //! \brief Source of handler generation numbers.  Shared by all
+  //!        instances, so that a DispatchCache filled by one
+  //!        AdapterConfiguration never appears valid to another.
+  static std::atomic<uint32_t> s_nextHandlerGeneration(1);
+
+  //*
+  // @class HandlerTable
+  // @brief Open-addressing (linear probing) hash table mapping a
+  //        command or state name to its handler.
+  // @note Handlers may be added or replaced, but not removed.
+  //
+  template <class HandlerPtr>
+  class HandlerTable final
+  {
+  public:
+    using Handler = typename HandlerPtr::element_type;
+
+    HandlerTable()
+      : m_slots(MIN_SIZE),
+        m_count(0)
+    {
+    }
+
+    ~HandlerTable() = default;
+
+    //* Return the handler registered for the name, or null if none.
+    Handler *find(std::string const &name) const
+    {
+      size_t hash = std::hash<std::string>()(name);
+      size_t mask = m_slots.size() - 1;
+      for (size_t i = hash & mask; m_slots[i].used; i = (i + 1) & mask) {
+        Slot const &slot = m_slots[i];
+        if (slot.hash == hash && slot.name == name)
+          return slot.handler.get();
+      }
+      return nullptr;
+    }
+
+    //* Register the handler for the name, replacing any previous one.
+    void insert(std::string const &name, HandlerPtr handler)
+    {
+      size_t hash = std::hash<std::string>()(name);
+      Slot &slot = findSlot(name, hash);
+      if (slot.used) {
+        slot.handler = handler;
+        return;
+      }
+      // Keep the load factor under 3/4
+      if ((m_count + 1) * 4 > m_slots.size() * 3) {
+        grow();
+        insert(name, handler);
+        return;
+      }
+      slot.hash = hash;
+      slot.name = name;
+      slot.handler = handler;
+      slot.used = true;
+      ++m_count;
+    }
+
+    void clear()
+    {
+      std::vector<Slot>(MIN_SIZE).swap(m_slots);
+      m_count = 0;
+    }
+
+  private:
+
+    struct Slot
+    {
+      size_t hash = 0;
+      std::string name;
+      HandlerPtr handler;
+      bool used = false;
+    };
+
+    static constexpr size_t MIN_SIZE = 64; // must be a power of 2
+
+    //* Return the slot holding the name, or the empty slot where it belongs.
+    Slot &findSlot(std::string const &name, size_t hash)
+    {
+      size_t mask = m_slots.size() - 1;
+      size_t i = hash & mask;
+      while (m_slots[i].used
+             && (m_slots[i].hash != hash || m_slots[i].name != name))
+        i = (i + 1) & mask;
+      return m_slots[i];
+    }
+
+    void grow()
+    {
+      std::vector<Slot> oldSlots(m_slots.size() * 2);
+      oldSlots.swap(m_slots);
+      size_t mask = m_slots.size() - 1;
+      for (Slot &old : oldSlots) {
+        if (!old.used)
+          continue;
+        size_t i = old.hash & mask;
+        while (m_slots[i].used)
+          i = (i + 1) & mask;
+        m_slots[i] = std::move(old);
+      }
+    }
+
+    std::vector<Slot> m_slots; // size is always a power of 2
+    size_t m_count;
+  };
+
   //*
   // @class AdapterConfigurationImpl
   // @brief Implementation class for AdapterConfiguration
@@ -99,16 +206,27 @@ namespace PLEXIL {
     // punt for now
     using InterfaceAdapterSet = std::vector<InterfaceAdapterPtr>;
 
-    using CommandHandlerMap = std::map<std::string, CommandHandlerPtr>;
-    using LookupHandlerMap = std::map<std::string, LookupHandlerPtr>;
+    using CommandHandlerMap = HandlerTable<CommandHandlerPtr>;
+    using LookupHandlerMap = HandlerTable<LookupHandlerPtr>;
 
+    //* Kinds of InputQueue which may be requested in the configuration
+    enum InputQueueType {
+      INPUT_QUEUE_DEFAULT = 0, // Serialized if threads enabled, else simple
+      INPUT_QUEUE_SIMPLE,
+      INPUT_QUEUE_SERIALIZED,
+      INPUT_QUEUE_LOCK_FREE
+    };
 
   public:
 
     AdapterConfigurationImpl()
-      : m_defaultCommandHandler(std::make_shared<CommandHandler>()),
+      : m_inputQueueType(INPUT_QUEUE_DEFAULT),
+        m_inputQueuePoolSize(LockFreeInputQueue::DEFAULT_POOL_SIZE),
+        m_defaultCommandHandler(std::make_shared<CommandHandler>()),
         m_defaultLookupHandler(std::make_shared<LookupHandler>()),
-        m_plannerUpdateHandler()
+        m_plannerUpdateHandler(),
+        m_commandGeneration(s_nextHandlerGeneration++),
+        m_lookupGeneration(s_nextHandlerGeneration++)
     {
       // Every application has access to the time adapter
       initTimeAdapter();
@@ -261,6 +379,14 @@ namespace PLEXIL {
           if (!listenerHub.constructListener(element))
             return false;
         }
+        else if (strcmp(elementType, InterfaceSchema::LISTENER_QUEUE_TAG) == 0) {
+          if (!listenerHub.configureQueue(element))
+            return false;
+        }
+        else if (strcmp(elementType, InterfaceSchema::INPUT_QUEUE_TAG) == 0) {
+          if (!configureInputQueue(element))
+            return false;
+        }
         else if (strcmp(elementType, InterfaceSchema::LIBRARY_NODE_PATH_TAG) == 0) {
           // Add to library path
           const char* pathstring = element.child_value();
@@ -354,8 +480,9 @@ namespace PLEXIL {
       for (std::string const &name : names) {
         debugMsg("AdapterConfiguration:registerCommandHandler",
                  " (vector) " << name << " -> " << handler);
-        m_commandMap[name] = handler;
+        m_commandMap.insert(name, handler);
       }
+      m_commandGeneration = s_nextHandlerGeneration++;
     }
 
     virtual void registerCommandHandler(CommandHandlerPtr handler,
@@ -363,7 +490,8 @@ namespace PLEXIL {
     {
       debugMsg("AdapterConfiguration:registerCommandHandler",
                " (string) " << cmdName << " -> " << handler);
-      m_commandMap[cmdName] = handler;
+      m_commandMap.insert(cmdName, handler);
+      m_commandGeneration = s_nextHandlerGeneration++;
     }
 
     virtual void registerCommandHandlerFunction(std::string const &stateName,
@@ -379,6 +507,7 @@ namespace PLEXIL {
     {
       debugMsg("AdapterConfiguration:setDefaultCommandHandler", ' ' << handler);
       m_defaultCommandHandler = CommandHandlerPtr(handler);
+      m_commandGeneration = s_nextHandlerGeneration++;
     }
 
     virtual void setDefaultCommandHandlerFunction(ExecuteCommandHandler execCmd,
@@ -399,8 +528,9 @@ namespace PLEXIL {
       for (std::string const &name : names) {
         debugMsg("AdapterConfiguration:registerLookupHandler",
                  " (vector) " << name << " -> " << handler);
-        m_lookupMap[name] = handler;
+        m_lookupMap.insert(name, handler);
       }
+      m_lookupGeneration = s_nextHandlerGeneration++;
     }
 
     virtual void registerLookupHandler(LookupHandlerPtr handler,
@@ -408,7 +538,8 @@ namespace PLEXIL {
     {
       debugMsg("AdapterConfiguration:registerLookupHandler",
                " (string) for " << stateName << " -> " << handler);
-      m_lookupMap[stateName] = handler;
+      m_lookupMap.insert(stateName, handler);
+      m_lookupGeneration = s_nextHandlerGeneration++;
     }
 
     virtual void registerLookupHandlerFunction(std::string const &stateName,
@@ -431,6 +562,7 @@ namespace PLEXIL {
     {
       debugMsg("AdapterConfiguration:registerLookupHandler", ' ' << handler);
       m_defaultLookupHandler = handler;
+      m_lookupGeneration = s_nextHandlerGeneration++;
     }
 
     virtual void setDefaultLookupHandler(LookupNowHandler lookupNow,
@@ -484,7 +616,7 @@ namespace PLEXIL {
     {
       debugMsg("AdapterConfiguration:lookupNow", " of " << state);
       try {
-        getLookupHandler(state.name())->lookupNow(state, rcvr);
+        getCachedLookupHandler(state, rcvr)->lookupNow(state, rcvr);
       }
       catch (InterfaceError const &e) {
         warn("lookupNow: Error performing lookup of " << state << ":\n"
@@ -510,6 +642,21 @@ namespace PLEXIL {
       getLookupHandler(state.name())->setThresholds(state, hi, lo);
     }
 
+    //! Advise the interface of the upper threshold of each change
+    //! lookup on this state.
+    //! @param state The state.
+    //! @param highs The upper threshold of each lookup.
+    //! @param hi The lowest of the upper thresholds.
+    //! @param lo The highest of the lower thresholds.
+    virtual void setLookupThresholds(const State& state,
+                                     std::vector<Real> const &highs,
+                                     Real hi, Real lo)
+    {
+      debugMsg("AdapterConfiguration:setLookupThresholds",
+               " state " << state << ", " << highs.size() << " lookups");
+      getLookupHandler(state.name())->setLookupThresholds(state, highs, hi, lo);
+    }
+
     //! Tell the interface that thresholds are no longer in effect
     //! for this state.
     //! @param state The state.
@@ -524,7 +671,7 @@ namespace PLEXIL {
     virtual void executeCommand(Command *cmd)
     {
       try {
-        getCommandHandler(cmd->getName())->executeCommand(cmd, m_manager);
+        getCachedCommandHandler(cmd)->executeCommand(cmd, m_manager);
       }
       catch (InterfaceError const &e) {
         // return error status quickly
@@ -548,7 +695,7 @@ namespace PLEXIL {
     virtual void invokeAbort(Command *cmd)
     {
       try {
-        getCommandHandler(cmd->getName())->abortCommand(cmd, m_manager);
+        getCachedCommandHandler(cmd)->abortCommand(cmd, m_manager);
       }
       catch (InterfaceError const &e) {
         // return error status quickly
@@ -585,11 +732,11 @@ namespace PLEXIL {
 
     virtual CommandHandler *getCommandHandler(std::string const &cmdName) const
     {
-      CommandHandlerMap::const_iterator it = m_commandMap.find(cmdName);
-      if (it != m_commandMap.end()) {
+      CommandHandler *result = m_commandMap.find(cmdName);
+      if (result) {
         debugMsg("AdapterConfiguration:getCommandHandler",
                  " found registered handler for command '" << cmdName << "'");
-        return (*it).second.get();
+        return result;
       }
       debugMsg("AdapterConfiguration:getCommandHandler",
                " using default handler for command '" << cmdName << "'");
@@ -598,11 +745,11 @@ namespace PLEXIL {
 
     virtual LookupHandler *getLookupHandler(std::string const &stateName) const
     {
-      LookupHandlerMap::const_iterator it = m_lookupMap.find(stateName);
-      if (it != m_lookupMap.end()) {
+      LookupHandler *result = m_lookupMap.find(stateName);
+      if (result) {
         debugMsg("AdapterConfiguration:getLookupHandler",
                  " found registered handler for lookup '" << stateName << "'");
-        return (*it).second.get();
+        return result;
       }
       debugMsg("AdapterConfiguration:getLookupHandler",
                  " using default handler for lookup '" << stateName << "'");
@@ -614,6 +761,34 @@ namespace PLEXIL {
       return m_plannerUpdateHandler;
     }
 
+    //! Return the handler for the command, from its DispatchCache if
+    //! the cache is current, and update the cache.
+    CommandHandler *getCachedCommandHandler(Command *cmd)
+    {
+      DispatchCache *cache = cmd->getDispatchCache();
+      if (!cache)
+        return getCommandHandler(cmd->getName());
+      if (cache->generation != m_commandGeneration) {
+        cache->handler = getCommandHandler(cmd->getName());
+        cache->generation = m_commandGeneration;
+      }
+      return static_cast<CommandHandler *>(cache->handler);
+    }
+
+    //! Return the lookup handler for the state, from the receiver's
+    //! DispatchCache if the cache is current, and update the cache.
+    LookupHandler *getCachedLookupHandler(State const &state, LookupReceiver *rcvr)
+    {
+      DispatchCache *cache = rcvr->getDispatchCache();
+      if (!cache)
+        return getLookupHandler(state.name());
+      if (cache->generation != m_lookupGeneration) {
+        cache->handler = getLookupHandler(state.name());
+        cache->generation = m_lookupGeneration;
+      }
+      return static_cast<LookupHandler *>(cache->handler);
+    }
+
     //
     // Search path registration for plans and libraries
     //
@@ -679,15 +854,26 @@ namespace PLEXIL {
     // Input queue
     //
 
-    // TODO: actually get queue type from input data
     virtual InputQueue *makeInputQueue() const
     {
-      return 
+      switch (m_inputQueueType) {
+      case INPUT_QUEUE_SIMPLE:
+        return new SimpleInputQueue();
+
+      case INPUT_QUEUE_SERIALIZED:
+        return new SerializedInputQueue();
+
+      case INPUT_QUEUE_LOCK_FREE:
+        return new LockFreeInputQueue(m_inputQueuePoolSize);
+
+      default:
+        return 
 #ifdef PLEXIL_WITH_THREADS
-        new SerializedInputQueue();
+          new SerializedInputQueue();
 #else
-        new SimpleInputQueue();
+          new SimpleInputQueue();
 #endif
+      }
     }
 
   private:
@@ -696,6 +882,34 @@ namespace PLEXIL {
     // Private helpers
     //
 
+    //! Select the kind of InputQueue as described by the given XML.
+    //! @param element The InputQueue element.
+    //! @return True if successful, false otherwise.
+    bool configureInputQueue(pugi::xml_node const element)
+    {
+      char const *typeName =
+        element.attribute(InterfaceSchema::TYPE_ATTR).value();
+      if (!strcmp(typeName, "Simple"))
+        m_inputQueueType = INPUT_QUEUE_SIMPLE;
+      else if (!strcmp(typeName, "Serialized"))
+        m_inputQueueType = INPUT_QUEUE_SERIALIZED;
+      else if (!strcmp(typeName, "LockFree"))
+        m_inputQueueType = INPUT_QUEUE_LOCK_FREE;
+      else {
+        warn("constructInterfaces: " << InterfaceSchema::INPUT_QUEUE_TAG
+             << " element has invalid " << InterfaceSchema::TYPE_ATTR
+             << " \"" << typeName
+             << "\"; expected Simple, Serialized, or LockFree");
+        return false;
+      }
+      m_inputQueuePoolSize =
+        element.attribute(InterfaceSchema::POOL_SIZE_ATTR)
+        .as_uint(LockFreeInputQueue::DEFAULT_POOL_SIZE);
+      debugMsg("AdapterConfiguration:constructInterfaces",
+               " input queue type " << typeName);
+      return true;
+    }
+
     //! Construct the adapter described by the given XML.
     //! @param element The XML element specifying the adapter to be constructed.
     //! @param intf The AdapterExecInterface the new adapter will report to.
@@ -888,6 +1102,12 @@ namespace PLEXIL {
     //* List of directory names for plan file search paths
     std::vector<std::string> m_planPath;
 
+    //* The kind of InputQueue to construct
+    InputQueueType m_inputQueueType;
+
+    //* Free pool size for the lock-free InputQueue
+    size_t m_inputQueuePoolSize;
+
     //* Default handlers
     CommandHandlerPtr m_defaultCommandHandler;
     LookupHandlerPtr m_defaultLookupHandler;
@@ -895,6 +1115,12 @@ namespace PLEXIL {
     //* Handler to use for Update nodes
     PlannerUpdateHandler m_plannerUpdateHandler;
 
+    //* Generation numbers of the current command and lookup handler
+    //  registrations.  Changed whenever a handler is registered, so
+    //  that every DispatchCache must be refreshed.
+    uint32_t m_commandGeneration;
+    uint32_t m_lookupGeneration;
+
     //! Pointer to the InterfaceManager instance.
     //! @note InterfaceManager is owned by ExecApplication.
     InterfaceManager *m_manager;
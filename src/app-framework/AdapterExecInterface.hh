@@ -27,7 +27,7 @@
 #ifndef PLEXIL_ADAPTER_EXEC_INTERFACE_HH
 #define PLEXIL_ADAPTER_EXEC_INTERFACE_HH
 
-#include "ValueType.hh"
+#include "State.hh" // StateId
 
 #include <memory>
 
@@ -43,7 +43,6 @@ namespace PLEXIL
   // forward references
   class Command;
   struct Message;
-  class State;
   class Update;
   class Value;
 
@@ -73,6 +72,41 @@ namespace PLEXIL
     virtual void handleValueChange(State &&state, const Value &value) = 0;
     virtual void handleValueChange(State &&state, Value &&value) = 0;
 
+    //!
+    // @brief Get the stable integer ID for a state, for use with the
+    //        StateId variants of handleValueChange().
+    // @param state The state.
+    // @return The ID.
+    // @note Adapters publishing the same state repeatedly should
+    //       obtain its ID once and reuse it.
+    //
+    virtual StateId getStateId(State const &state) = 0;
+
+    //!
+    // @brief Notify of the availability of a new value for a lookup.
+    // @param id The StateId, as returned by getStateId(), of the state.
+    // @param value The new value.
+    //
+    virtual void handleValueChange(StateId id, const Value &value) = 0;
+    virtual void handleValueChange(StateId id, Value &&value) = 0;
+
+    //!
+    // @brief Notify of the availability of new values for a batch of
+    //        lookups.  The values are applied in order, in one pass.
+    // @param values Pointer to the first element of a contiguous array.
+    // @param n The number of elements.
+    // @note Much cheaper per value than handleValueChange() for large
+    //       bursts of updates.
+    //
+    virtual void handleValueChanges(LookupValue const *values, size_t n) = 0;
+
+    //!
+    // @brief Notify of the availability of new values for a batch of
+    //        lookups.  The values are applied in order, in one pass.
+    // @param values The batch.  Its contents are moved, not copied.
+    //
+    virtual void handleValueChanges(LookupBatch &&values) = 0;
+
     //
     // Command API
     //
@@ -29,6 +29,7 @@
 #include "AdapterConfiguration.hh"
 #include "Debug.hh"
 #include "ExecListenerHub.hh"
+#include "ExecMetrics.hh"
 #include "InterfaceAdapter.hh"
 #include "InterfaceManager.hh"
 #include "InputQueue.hh"
@@ -64,6 +65,7 @@ using ThreadMutexGuard = std::lock_guard<std::mutex>;
 
 #include <csignal>
 #include <cstring>
+#include <ostream>
 
 namespace PLEXIL
 {
@@ -623,6 +625,9 @@ namespace PLEXIL
       }
 #endif // PLEXIL_WITH_THREADS
 
+      // Worker thread is stopped, no need to acquire m_execMutex
+      debugMsg("ExecApplication:metrics", '\n' << m_exec->getMetrics());
+
       // Stop interfaces
       m_configuration->stop();
       m_listener->stop();
@@ -824,6 +829,16 @@ namespace PLEXIL
 #endif
     }
 
+    //! Print the Exec's step timing, queue high-water marks, and
+    //! dispatch counts.
+    virtual void printMetrics(std::ostream &stream) override
+    {
+#ifdef PLEXIL_WITH_THREADS
+      ThreadMutexGuard guard(m_execMutex);
+#endif
+      stream << m_exec->getMetrics();
+    }
+
   private:
 
     //
@@ -29,6 +29,7 @@
 
 #include "plexil-config.h"
 
+#include <iosfwd>
 #include <string>
 #include <vector>
 
@@ -195,6 +196,16 @@ namespace PLEXIL
     //! @note Used to implement notifyAndWaitForCompletion().
     virtual void markProcessed(unsigned int sequence) = 0;
 
+    //
+    // Instrumentation
+    //
+
+    //! Print the Exec's step timing, queue high-water marks, and
+    //! dispatch counts.
+    //! @param stream The stream to print to.
+    //! @see ExecMetrics
+    virtual void printMetrics(std::ostream &stream) = 0;
+
     //
     // Accessors to application objects
     //
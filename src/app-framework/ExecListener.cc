@@ -178,6 +178,16 @@ namespace PLEXIL
   {
   }
 
+  /**
+   * @brief Query whether this listener may be called from another thread.
+   * @return true if so, false otherwise.
+   * @note Default method is conservative.
+   */
+  bool ExecListener::supportsAsynchronousPublication() const
+  {
+    return false;
+  }
+
   /**
    * @brief Set the filter of this instance.
    * @param fltr Pointer to the filter.
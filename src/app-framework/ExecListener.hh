@@ -111,6 +111,15 @@ namespace PLEXIL
     //! @note Default method does nothing.
     virtual void stop();
 
+    //! Query whether this listener may be called from a thread other
+    //! than the Exec's.
+    //! @return true if so, false otherwise.
+    //! @note A listener which returns true, and its filter, must use
+    //!       only the NodeTransition records and their snapshots, and
+    //!       never read the state of the node itself.
+    //! @note Default method returns false.
+    virtual bool supportsAsynchronousPublication() const;
+
     //
     // Public configuration API
     //
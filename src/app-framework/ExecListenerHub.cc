@@ -31,17 +31,85 @@
 #include "ExecListener.hh"
 #include "ExecListenerFactory.hh"
 #include "InterfaceSchema.hh"
+#include "NodeImpl.hh"
 #include "NodeTransition.hh"
 
+#include "plexil-config.h"
+
+#ifdef PLEXIL_WITH_THREADS
+#include "SpscRingBuffer.hh"
+#include "ThreadSemaphore.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#endif
+
 #include "pugixml.hpp"
 
+#include <algorithm> // std::reverse
+#include <cstring>
+
 namespace PLEXIL
 {
+
+#ifdef PLEXIL_WITH_THREADS
+
+  //! The state shared between the Exec and the listener thread.
+  //! Only the Exec thread writes to the queue; only the listener
+  //! thread reads from it.
+  struct ExecListenerHub::AsyncPublisher
+  {
+    AsyncPublisher(size_t capacity)
+      : queue(capacity),
+        workSem(),
+        waitMutex(),
+        spaceCv(),
+        deliveryMutex(),
+        thread(),
+        heldSteps(),
+        stopRequested(false),
+        dropped(0),
+        coalesced(0)
+    {
+    }
+
+    SpscRingBuffer<StepRecord> queue;
+    ThreadSemaphore workSem;          //!< Posted when a step is queued, and at stop.
+    std::mutex waitMutex;             //!< Guards waits on spaceCv.
+    std::condition_variable spaceCv;  //!< Notified when a slot is freed.
+    std::mutex deliveryMutex;         //!< Serializes delivery to the listeners.
+    std::thread thread;
+    std::deque<StepRecord> heldSteps; //!< Steps waiting for a slot, oldest first.  Exec thread only.
+    std::atomic<bool> stopRequested;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> coalesced;
+  };
+
+#else
+
+  struct ExecListenerHub::AsyncPublisher
+  {
+  };
+
+#endif
+
   ExecListenerHub::ExecListenerHub()
     : m_listeners(),
       m_transitions(),
-      m_assignments()
+      m_snapshots(),
+      m_assignments(),
+      m_async(),
+      m_queueCapacity(0),
+      m_overflowPolicy(OVERFLOW_BLOCK)
+  {
+  }
+
+  ExecListenerHub::~ExecListenerHub()
   {
+    stopPublisher();
   }
 
   //
@@ -57,6 +125,13 @@ namespace PLEXIL
   {
     m_transitions.insert(m_transitions.end(),
                          transitions.begin(), transitions.end());
+#ifdef PLEXIL_WITH_THREADS
+    // The listener thread must not read the nodes; copy what the
+    // listeners need while the Exec is between steps.
+    if (m_async)
+      for (NodeTransition const &trans : transitions)
+        captureSnapshot(trans.node);
+#endif
   }
 
   /**
@@ -84,6 +159,16 @@ namespace PLEXIL
    */
   void ExecListenerHub::notifyOfAddPlan(pugi::xml_node const plan)
   {
+#ifdef PLEXIL_WITH_THREADS
+    // Preserve ordering with the events already queued
+    if (m_async) {
+      waitForQueue();
+      std::lock_guard<std::mutex> guard(m_async->deliveryMutex);
+      for (ExecListenerPtr const &listener : m_listeners)
+        listener->notifyOfAddPlan(plan);
+      return;
+    }
+#endif
     for (ExecListenerPtr const &listener : m_listeners)
       listener->notifyOfAddPlan(plan);
   }
@@ -94,6 +179,15 @@ namespace PLEXIL
    */
   void ExecListenerHub::notifyOfAddLibrary(pugi::xml_node const libNode)
   {
+#ifdef PLEXIL_WITH_THREADS
+    if (m_async) {
+      waitForQueue();
+      std::lock_guard<std::mutex> guard(m_async->deliveryMutex);
+      for (ExecListenerPtr const &listener : m_listeners)
+        listener->notifyOfAddLibrary(libNode);
+      return;
+    }
+#endif
     for (ExecListenerPtr const &listener : m_listeners)
       listener->notifyOfAddLibrary(libNode);
   }
@@ -102,17 +196,173 @@ namespace PLEXIL
    * @brief Notify that a step is complete and the listener
    *        may publish transitions and assignments.
    */
-  void ExecListenerHub::stepComplete(unsigned int cycleNum)
+  void ExecListenerHub::stepComplete(unsigned int /* cycleNum */)
   {
-    for (ExecListenerPtr const &listener : m_listeners) {
-      listener->notifyOfTransitions(m_transitions);
-      for (AssignmentRecord const &assign : m_assignments)
-        listener->notifyOfAssignment(assign.dest, assign.destName, assign.value);
+#ifdef PLEXIL_WITH_THREADS
+    if (m_async) {
+      enqueue(m_overflowPolicy == OVERFLOW_BLOCK);
+      return;
     }
+#endif
+    publish(m_transitions, m_assignments);
     m_transitions.clear();
     m_assignments.clear();
   }
 
+  /**
+   * @brief Wait until every event reported so far has been published.
+   * @note Must be called from the Exec thread, or after the Exec has stopped.
+   */
+  void ExecListenerHub::flush()
+  {
+#ifdef PLEXIL_WITH_THREADS
+    if (!m_async)
+      return;
+    // Publish any events held back by the coalesce policy
+    releaseHeldSteps(true);
+    if (!m_transitions.empty() || !m_assignments.empty())
+      enqueue(true);
+    waitForQueue();
+#endif
+  }
+
+  void ExecListenerHub::publish(std::vector<NodeTransition> const &transitions,
+                                std::vector<AssignmentRecord> const &assignments)
+  {
+    for (ExecListenerPtr const &listener : m_listeners) {
+      listener->notifyOfTransitions(transitions);
+      for (AssignmentRecord const &assign : assignments)
+        listener->notifyOfAssignment(assign.dest, assign.destName, assign.value);
+    }
+  }
+
+#ifdef PLEXIL_WITH_THREADS
+
+  void ExecListenerHub::captureSnapshot(Node const *node)
+  {
+    m_snapshots.emplace_back();
+    NodeTransitionSnapshot &snap = m_snapshots.back();
+    for (Node const *n = node; n; n = n->getParent())
+      snap.nodePath.push_back(n->getNodeId());
+    std::reverse(snap.nodePath.begin(), snap.nodePath.end());
+
+    NodeImpl const *impl = dynamic_cast<NodeImpl const *>(node);
+    assertTrueMsg(impl,
+                  "ExecListenerHub::captureSnapshot: not a node");
+    for (size_t i = 0; i < NodeImpl::conditionIndexMax; ++i) {
+      Expression const *cond = impl->getCondition(i);
+      if (cond)
+        snap.conditions.emplace_back(i, cond->toValue());
+    }
+  }
+
+  ExecListenerHub::StepRecord *ExecListenerHub::nextSlot(bool mustBlock)
+  {
+    StepRecord *slot = m_async->queue.writeSlot();
+    if (!slot && mustBlock) {
+      std::unique_lock<std::mutex> lock(m_async->waitMutex);
+      m_async->spaceCv.wait(lock,
+                            [this, &slot]() -> bool
+                            { return (slot = m_async->queue.writeSlot()) != nullptr; });
+    }
+    return slot;
+  }
+
+  bool ExecListenerHub::releaseHeldSteps(bool mustBlock)
+  {
+    std::deque<StepRecord> &held = m_async->heldSteps;
+    StepRecord *slot;
+    while (!held.empty() && (slot = nextSlot(mustBlock))) {
+      StepRecord &oldest = held.front();
+      slot->transitions.swap(oldest.transitions);
+      slot->snapshots.swap(oldest.snapshots);
+      slot->assignments.swap(oldest.assignments);
+      m_async->queue.commitWrite();
+      m_async->workSem.post();
+      held.pop_front();
+    }
+    return held.empty();
+  }
+
+  void ExecListenerHub::enqueue(bool mustBlock)
+  {
+    // Steps held back earlier must be queued before this one
+    StepRecord *slot =
+      releaseHeldSteps(mustBlock) ? nextSlot(mustBlock) : nullptr;
+    if (!slot) {
+      if (m_overflowPolicy == OVERFLOW_DROP) {
+        debugMsg("ExecListenerHub:overflow",
+                 " queue full, dropping " << m_transitions.size()
+                 << " transitions and " << m_assignments.size() << " assignments");
+        ++m_async->dropped;
+        m_transitions.clear();
+        m_snapshots.clear();
+        m_assignments.clear();
+      }
+      else {
+        // Close the step as its own record; queue it when a slot frees up
+        debugMsg("ExecListenerHub:overflow",
+                 " queue full, holding " << m_transitions.size()
+                 << " transitions and " << m_assignments.size() << " assignments");
+        m_async->heldSteps.emplace_back();
+        StepRecord &newest = m_async->heldSteps.back();
+        newest.transitions.swap(m_transitions);
+        newest.snapshots.swap(m_snapshots);
+        newest.assignments.swap(m_assignments);
+        ++m_async->coalesced;
+      }
+      return;
+    }
+
+    // Swap rather than copy; the slot's emptied vectors keep their
+    // capacity for the next step.
+    slot->transitions.swap(m_transitions);
+    slot->snapshots.swap(m_snapshots);
+    slot->assignments.swap(m_assignments);
+    m_async->queue.commitWrite();
+    m_async->workSem.post();
+  }
+
+  void ExecListenerHub::waitForQueue()
+  {
+    std::unique_lock<std::mutex> lock(m_async->waitMutex);
+    m_async->spaceCv.wait(lock,
+                          [this]() -> bool
+                          { return m_async->queue.empty(); });
+  }
+
+  void ExecListenerHub::publisherLoop()
+  {
+    debugMsg("ExecListenerHub:publisherLoop", " started");
+    while (true) {
+      m_async->workSem.wait();
+      StepRecord *record;
+      while ((record = m_async->queue.readSlot())) {
+        // The snapshots vector no longer grows, so the pointers stay valid
+        for (size_t i = 0; i < record->transitions.size(); ++i)
+          record->transitions[i].snapshot = &record->snapshots[i];
+        {
+          std::lock_guard<std::mutex> guard(m_async->deliveryMutex);
+          publish(record->transitions, record->assignments);
+        }
+        record->transitions.clear();
+        record->snapshots.clear();
+        record->assignments.clear();
+        m_async->queue.commitRead();
+        {
+          // Ensure a waiter is either notified or sees the free slot
+          std::lock_guard<std::mutex> guard(m_async->waitMutex);
+        }
+        m_async->spaceCv.notify_all();
+      }
+      if (m_async->stopRequested.load())
+        break;
+    }
+    debugMsg("ExecListenerHub:publisherLoop", " exiting");
+  }
+
+#endif // PLEXIL_WITH_THREADS
+
   //
   // API to AdapterConfiguration
   //
@@ -135,6 +385,73 @@ namespace PLEXIL
     return true;
   }
 
+  bool ExecListenerHub::configureQueue(pugi::xml_node const configXml)
+  {
+    size_t capacity =
+      configXml.attribute(InterfaceSchema::CAPACITY_ATTR).as_uint(DEFAULT_QUEUE_CAPACITY);
+    if (!capacity) {
+      warn("constructInterfaces: " << InterfaceSchema::LISTENER_QUEUE_TAG
+           << " element has invalid " << InterfaceSchema::CAPACITY_ATTR);
+      return false;
+    }
+    char const *policyName =
+      configXml.attribute(InterfaceSchema::OVERFLOW_ATTR).as_string("Block");
+    OverflowPolicy policy;
+    if (!strcmp(policyName, "Block"))
+      policy = OVERFLOW_BLOCK;
+    else if (!strcmp(policyName, "Drop"))
+      policy = OVERFLOW_DROP;
+    else if (!strcmp(policyName, "Coalesce"))
+      policy = OVERFLOW_COALESCE;
+    else {
+      warn("constructInterfaces: " << InterfaceSchema::LISTENER_QUEUE_TAG
+           << " element has invalid " << InterfaceSchema::OVERFLOW_ATTR
+           << " \"" << policyName << "\"; expected Block, Drop, or Coalesce");
+      return false;
+    }
+    return setQueue(capacity, policy);
+  }
+
+  bool ExecListenerHub::setQueue(size_t capacity, OverflowPolicy policy)
+  {
+#ifdef PLEXIL_WITH_THREADS
+    if (m_async) {
+      warn("ExecListenerHub: cannot configure queue after start");
+      return false;
+    }
+    m_queueCapacity = capacity;
+    m_overflowPolicy = policy;
+    debugMsg("ExecListenerHub:setQueue",
+             " capacity " << capacity << ", policy " << (int) policy);
+#else
+    warn("ExecListenerHub: threads not available, listeners will be called synchronously");
+#endif
+    return true;
+  }
+
+  bool ExecListenerHub::isAsynchronous() const
+  {
+    return (bool) m_async;
+  }
+
+  uint64_t ExecListenerHub::getDroppedSteps() const
+  {
+#ifdef PLEXIL_WITH_THREADS
+    if (m_async)
+      return m_async->dropped.load();
+#endif
+    return 0;
+  }
+
+  uint64_t ExecListenerHub::getCoalescedSteps() const
+  {
+#ifdef PLEXIL_WITH_THREADS
+    if (m_async)
+      return m_async->coalesced.load();
+#endif
+    return 0;
+  }
+
   /**
    * @brief Adds an Exec listener for publication of plan events.
    */
@@ -176,15 +493,49 @@ namespace PLEXIL
         return false; // stop at first failure
       }
     }
+#ifdef PLEXIL_WITH_THREADS
+    if (m_queueCapacity && !m_async) {
+      for (ExecListenerPtr const &listener : m_listeners) {
+        if (!listener->supportsAsynchronousPublication()) {
+          warn("ExecListenerHub: a listener reads node state directly, "
+               "listeners will be called synchronously");
+          m_queueCapacity = 0;
+          break;
+        }
+      }
+    }
+    if (m_queueCapacity && !m_async) {
+      m_async.reset(new AsyncPublisher(m_queueCapacity));
+      m_async->thread = std::thread(&ExecListenerHub::publisherLoop, this);
+    }
+#endif
     debugMsg("ExecListenerHub:start", " returns true");
     return true;
   }
 
+  void ExecListenerHub::stopPublisher()
+  {
+#ifdef PLEXIL_WITH_THREADS
+    if (!m_async)
+      return;
+    flush();
+    m_async->stopRequested = true;
+    m_async->workSem.post();
+    m_async->thread.join();
+    debugMsg("ExecListenerHub:stop",
+             " listener thread stopped; "
+             << m_async->dropped.load() << " steps dropped, "
+             << m_async->coalesced.load() << " steps held");
+    m_async.reset();
+#endif
+  }
+
   /**
    * @brief Perform listener-specific actions to stop.
    */
   void ExecListenerHub::stop()
   {
+    stopPublisher();
     for (ExecListenerPtr const &listener : m_listeners)
       listener->stop();
   }
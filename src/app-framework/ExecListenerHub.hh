@@ -31,17 +31,35 @@
 #include "ExecListenerBase.hh"
 #include "Value.hh"
 
+#include <cstdint>
 #include <memory>
 
 namespace PLEXIL
 {
   //! @class ExecListenerHub
   //! A central dispatcher for multiple exec listeners.
+  //!
+  //! By default the hub publishes each step's events to the listeners
+  //! synchronously, from stepComplete().  When configured with a
+  //! queue, the events of each step are handed to a bounded ring
+  //! buffer and published by a dedicated listener thread, in the same
+  //! order as in the synchronous case.  The node data the listeners
+  //! report is copied into a NodeTransitionSnapshot at the end of the
+  //! step; the queue is used only if every listener declares that it
+  //! reads nothing else.
   class ExecListenerHub : public ExecListenerBase
   {
   public:
+
+    //! What to do with a step's events when the queue is full.
+    enum OverflowPolicy : uint8_t {
+      OVERFLOW_BLOCK = 0, //!< Wait for the listener thread to free a slot.
+      OVERFLOW_DROP,      //!< Discard the step's events and count them.
+      OVERFLOW_COALESCE   //!< Hold the step's events until a slot is free.
+    };
+
     ExecListenerHub();
-    virtual ~ExecListenerHub() = default;
+    virtual ~ExecListenerHub();
 
     //
     // ExecListenerBase API to PlexilExec
@@ -64,6 +82,9 @@ namespace PLEXIL
     //! transitions and assignments.
     virtual void stepComplete(unsigned int cycleNum) override;
 
+    //! Wait until every event reported so far has been published.
+    virtual void flush() override;
+
     //
     // API to ExecApplication
     //
@@ -85,6 +106,36 @@ namespace PLEXIL
     //! @return true if successful, false otherwise.
     bool constructListener(pugi::xml_node const configXml);
 
+    //! Configure the publication queue as described by the XML.
+    //! @param configXml A ListenerQueue element.
+    //! @return true if successful, false otherwise.
+    bool configureQueue(pugi::xml_node const configXml);
+
+    //! Publish events from a dedicated thread through a queue.
+    //! @param capacity Number of steps the queue can hold.
+    //! @param policy What to do when the queue is full.
+    //! @return true if successful, false otherwise.
+    //! @note Must be called before start().  If PLEXIL was built
+    //!       without threads, warns and leaves the hub synchronous.
+    //! @note start() also leaves the hub synchronous if a listener
+    //!       does not support asynchronous publication.
+    //! @see ExecListener::supportsAsynchronousPublication
+    bool setQueue(size_t capacity, OverflowPolicy policy);
+
+    //! Query whether events are published from a dedicated thread.
+    //! @return true if asynchronous, false otherwise.
+    bool isAsynchronous() const;
+
+    //! Get the number of steps whose events were discarded because
+    //! the queue was full.
+    //! @return The count.
+    uint64_t getDroppedSteps() const;
+
+    //! Get the number of steps whose events were held back because
+    //! the queue was full.  Held steps are published later, in order.
+    //! @return The count.
+    uint64_t getCoalescedSteps() const;
+
     //! Adds an Exec listener for publication of plan events.
     //! @param Pointer to an ExecListener instance.
     //! @note The ExecListenerHub takes ownership of the listener
@@ -104,7 +155,7 @@ namespace PLEXIL
 
   private:
 
-    // Internal data type
+    // Internal data types
     struct AssignmentRecord {
       Value value;
       std::string destName;
@@ -121,9 +172,48 @@ namespace PLEXIL
       // use default destructor, copy constructor, assignment
     };
 
+    //! The events of one step, as held in the publication queue.
+    struct StepRecord {
+      std::vector<NodeTransition> transitions;
+      std::vector<NodeTransitionSnapshot> snapshots; // parallel to transitions
+      std::vector<AssignmentRecord> assignments;
+    };
+
+    //! State of the asynchronous publication pipeline.
+    struct AsyncPublisher;
+
+    // Queue capacity used when the configuration doesn't specify one
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 64;
+
     // Local typedefs
     using ExecListenerPtr = std::unique_ptr<ExecListener>;
 
+    // Deliver one step's events to every listener.
+    void publish(std::vector<NodeTransition> const &transitions,
+                 std::vector<AssignmentRecord> const &assignments);
+
+    // Copy the node data the listeners report.
+    void captureSnapshot(Node const *node);
+
+    // Get a free slot in the queue, waiting for one if mustBlock.
+    StepRecord *nextSlot(bool mustBlock);
+
+    // Queue the steps held back by the coalesce policy, oldest first.
+    // Returns true if none remain held.
+    bool releaseHeldSteps(bool mustBlock);
+
+    // Hand the accumulated events to the listener thread.
+    void enqueue(bool mustBlock);
+
+    // Wait until the listener thread has emptied the queue.
+    void waitForQueue();
+
+    // Publish what remains and stop the listener thread.
+    void stopPublisher();
+
+    // Body of the listener thread.
+    void publisherLoop();
+
     // Deliberately unimplemented
     ExecListenerHub(ExecListenerHub const &) = delete;
     ExecListenerHub(ExecListenerHub &&) = delete;
@@ -135,7 +225,13 @@ namespace PLEXIL
 
     // Queues
     std::vector<NodeTransition> m_transitions;
+    std::vector<NodeTransitionSnapshot> m_snapshots;
     std::vector<AssignmentRecord> m_assignments;
+
+    // Asynchronous publication; null when synchronous
+    std::unique_ptr<AsyncPublisher> m_async;
+    size_t m_queueCapacity;
+    OverflowPolicy m_overflowPolicy;
   };
 
 }
@@ -54,6 +54,7 @@
 #include <iomanip>
 #include <limits>
 #include <sstream>
+#include <utility> // std::move()
 
 #include <cstring>
 
@@ -118,7 +119,7 @@ namespace PLEXIL
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
 
-    entry->initForLookup(state, value);
+    entry->initForLookup(state, std::move(value));
     m_inputQueue->put(entry);
   }
 
@@ -132,7 +133,7 @@ namespace PLEXIL
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
 
-    entry->initForLookup(state, value);
+    entry->initForLookup(std::move(state), value);
     m_inputQueue->put(entry);
   }
 
@@ -146,7 +147,71 @@ namespace PLEXIL
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
 
-    entry->initForLookup(state, value);
+    entry->initForLookup(std::move(state), std::move(value));
+    m_inputQueue->put(entry);
+  }
+
+  StateId
+  InterfaceManager::getStateId(State const &state)
+  {
+    return StateCache::instance().getStateId(state);
+  }
+
+  void
+  InterfaceManager::handleValueChange(StateId id, const Value &value)
+  {
+    debugMsg("InterfaceManager:handleValueChange",
+             " for state ID " << id << ", new value = " << value);
+
+    assertTrue_1(m_inputQueue);
+    QueueEntry *entry = m_inputQueue->allocate();
+    assertTrue_1(entry);
+
+    entry->initForLookup(id, value);
+    m_inputQueue->put(entry);
+  }
+
+  void
+  InterfaceManager::handleValueChange(StateId id, Value &&value)
+  {
+    debugMsg("InterfaceManager:handleValueChange",
+             " for state ID " << id << ", new value = " << value);
+
+    assertTrue_1(m_inputQueue);
+    QueueEntry *entry = m_inputQueue->allocate();
+    assertTrue_1(entry);
+
+    entry->initForLookup(id, std::move(value));
+    m_inputQueue->put(entry);
+  }
+
+  void
+  InterfaceManager::handleValueChanges(LookupValue const *values, size_t n)
+  {
+    debugMsg("InterfaceManager:handleValueChanges", ' ' << n << " values");
+    if (!n)
+      return;
+
+    assertTrue_1(m_inputQueue);
+    QueueEntry *entry = m_inputQueue->allocate();
+    assertTrue_1(entry);
+
+    entry->initForLookupBatch(values, n);
+    m_inputQueue->put(entry);
+  }
+
+  void
+  InterfaceManager::handleValueChanges(LookupBatch &&values)
+  {
+    debugMsg("InterfaceManager:handleValueChanges", ' ' << values.size() << " values");
+    if (values.empty())
+      return;
+
+    assertTrue_1(m_inputQueue);
+    QueueEntry *entry = m_inputQueue->allocate();
+    assertTrue_1(entry);
+
+    entry->initForLookupBatch(std::move(values));
     m_inputQueue->put(entry);
   }
 
@@ -478,6 +543,23 @@ namespace PLEXIL
         needsStep = true;
         break;
 
+      case Q_LOOKUP_ID:
+        debugMsg("InterfaceManager:processQueue",
+                 " Received new value " << entry->value << " for state ID "
+                 << entry->stateId);
+
+        StateCache::instance().lookupReturn(entry->stateId, entry->value);
+        needsStep = true;
+        break;
+
+      case Q_LOOKUP_BATCH:
+        debugMsg("InterfaceManager:processQueue",
+                 " Received batch of " << entry->batch.size() << " values");
+
+        StateCache::instance().lookupReturn(entry->batch);
+        needsStep = true;
+        break;
+
       case Q_COMMAND_ACK:
         assertTrue_1(entry->command);
 
@@ -104,6 +104,26 @@ namespace PLEXIL
     virtual void handleValueChange(State &&state, const Value &value);
     virtual void handleValueChange(State &&state, Value &&value);
 
+    //! Get the stable integer ID for a state.
+    //! @param state The state.
+    //! @return The ID.
+    virtual StateId getStateId(State const &state);
+
+    //! Notify of the availability of a new value for a lookup.
+    //! @param id The StateId of the state for the new value.
+    //! @param value The new value.
+    virtual void handleValueChange(StateId id, const Value &value);
+    virtual void handleValueChange(StateId id, Value &&value);
+
+    //! Notify of the availability of new values for a batch of lookups.
+    //! @param values Pointer to the first element of a contiguous array.
+    //! @param n The number of elements.
+    virtual void handleValueChanges(LookupValue const *values, size_t n);
+
+    //! Notify of the availability of new values for a batch of lookups.
+    //! @param values The batch.
+    virtual void handleValueChanges(LookupBatch &&values);
+
     //
     // Command API
     //
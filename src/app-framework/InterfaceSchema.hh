@@ -46,10 +46,12 @@ namespace PLEXIL
     static constexpr char const *DEFAULT_COMMAND_ADAPTER_TAG = "DefaultCommandAdapter";
     static constexpr char const *DEFAULT_LOOKUP_ADAPTER_TAG = "DefaultLookupAdapter";
     static constexpr char const *FILTER_TAG = "Filter";
+    static constexpr char const *INPUT_QUEUE_TAG = "InputQueue";
     static constexpr char const *INTERFACES_TAG = "Interfaces";
     static constexpr char const *INTERFACE_LIBRARY_TAG = "InterfaceLibrary";
     static constexpr char const *LIBRARY_NODE_PATH_TAG = "LibraryNodePath";
     static constexpr char const *LISTENER_TAG = "Listener";
+    static constexpr char const *LISTENER_QUEUE_TAG = "ListenerQueue";
     static constexpr char const *LOOKUP_HANDLER_TAG = "LookupHandler";
     static constexpr char const *LOOKUP_NAMES_TAG = "LookupNames";
     static constexpr char const *PLAN_PATH_TAG = "PlanPath";
@@ -64,13 +66,18 @@ namespace PLEXIL
     //
 
     static constexpr char const *ADAPTER_TYPE_ATTR = "AdapterType";
+    static constexpr char const *CAPACITY_ATTR = "Capacity";
+    static constexpr char const *COALESCING_SLACK_ATTR = "CoalescingSlack";
     static constexpr char const *DEFAULT_HANDLER_ATTR = "DefaultHandler";
     static constexpr char const *FILTER_TYPE_ATTR = "FilterType";
     static constexpr char const *HANDLER_TYPE_ATTR = "HandlerType";
     static constexpr char const *LIB_PATH_ATTR = "LibPath";
     static constexpr char const *LISTENER_TYPE_ATTR = "ListenerType";
     static constexpr char const *NAME_ATTR = "Name";
+    static constexpr char const *OVERFLOW_ATTR = "Overflow";
+    static constexpr char const *POOL_SIZE_ATTR = "PoolSize";
     static constexpr char const *TICK_INTERVAL_ATTR = "TickInterval";
+    static constexpr char const *TIME_SOURCE_ATTR = "TimeSource";
     static constexpr char const *TYPE_ATTR = "Type";
     
     /**
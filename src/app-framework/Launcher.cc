@@ -73,6 +73,13 @@ namespace PLEXIL
 
     virtual ~LauncherListener() = default;
 
+    //! Uses only the transition records, and the node's ID and parent,
+    //! which never change.
+    virtual bool supportsAsynchronousPublication() const override
+    {
+      return true;
+    }
+
     //! Wrapper method to ensure we don't notify the Exec too often.
     virtual void
     implementNotifyNodeTransitions(std::vector<NodeTransition> const &transitions) const override
@@ -94,14 +101,14 @@ namespace PLEXIL
         m_interface->handleValueChange(State(PLAN_STATE_STATE, nodeIdValue),
                                        Value(nodeStateName(newState)));
 
-        NodeOutcome o = node->getOutcome();
+        NodeOutcome o = t.outcome;
         if (o != NO_OUTCOME) {
           // Report the outcome
           debugMsg("LauncherListener:notify",
                    ' ' << node->getNodeId() << " outcome " << outcomeName(o));
           m_interface->handleValueChange(State(PLAN_OUTCOME_STATE, nodeIdValue),
                                          Value(outcomeName(o)));
-          FailureType f = node->getFailureType();
+          FailureType f = t.failureType;
           if (f != NO_FAILURE) {
             // Report the failure type
             debugMsg("LauncherListener:notify",
@@ -0,0 +1,193 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "LockFreeInputQueue.hh"
+
+#include "Error.hh"
+
+#include <cstdint> // intptr_t
+
+namespace PLEXIL
+{
+  // Round up to a power of 2, minimum 2.
+  static size_t poolCapacity(size_t n)
+  {
+    size_t result = 2;
+    while (result < n)
+      result *= 2;
+    return result;
+  }
+
+  LockFreeInputQueue::LockFreeInputQueue(size_t poolSize)
+    : InputQueue(),
+      m_stub(),
+      m_pool(new PoolCell[poolCapacity(poolSize)]),
+      m_poolMask(poolCapacity(poolSize) - 1),
+      m_head(&m_stub),
+      m_tail(&m_stub),
+      m_poolPut(0),
+      m_poolTake(0)
+  {
+    for (size_t i = 0; i <= m_poolMask; ++i) {
+      m_pool[i].sequence.store(i, std::memory_order_relaxed);
+      m_pool[i].entry = nullptr;
+    }
+  }
+
+  LockFreeInputQueue::~LockFreeInputQueue()
+  {
+    QueueEntry *entry;
+    while ((entry = get()))
+      delete entry;
+    while ((entry = takeFree()))
+      delete entry;
+  }
+
+  bool LockFreeInputQueue::isEmpty() const
+  {
+    return m_tail == &m_stub
+      && !m_stub.next.load(std::memory_order_acquire);
+  }
+
+  QueueEntry *LockFreeInputQueue::allocate()
+  {
+    QueueEntry *result = takeFree();
+    if (!result)
+      result = new QueueEntry;
+    return result;
+  }
+
+  void LockFreeInputQueue::release(QueueEntry *entry)
+  {
+    assertTrue_1(entry);
+    entry->reset();
+    if (!giveFree(entry))
+      delete entry; // pool is full
+  }
+
+  void LockFreeInputQueue::put(QueueEntry *entry)
+  {
+    assertTrue_1(entry);
+    push(entry);
+  }
+
+  void LockFreeInputQueue::push(QueueEntry *entry)
+  {
+    entry->next.store(nullptr, std::memory_order_relaxed);
+    QueueEntry *prev = m_head.exchange(entry, std::memory_order_acq_rel);
+    // Between the exchange and this store, the reader sees the list
+    // as ending at prev.
+    prev->next.store(entry, std::memory_order_release);
+  }
+
+  QueueEntry *LockFreeInputQueue::get()
+  {
+    QueueEntry *tail = m_tail;
+    QueueEntry *next = tail->next.load(std::memory_order_acquire);
+    if (tail == &m_stub) {
+      if (!next)
+        return nullptr; // empty
+      // Skip over the stub
+      m_tail = tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+      m_tail = next;
+      return tail;
+    }
+    if (tail != m_head.load(std::memory_order_acquire))
+      return nullptr; // a writer is partway through put(); try again later
+
+    // tail is the last entry; put the stub behind it so it can be removed
+    push(&m_stub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+      m_tail = next;
+      return tail;
+    }
+    return nullptr;
+  }
+
+  void LockFreeInputQueue::flush()
+  {
+    QueueEntry *entry;
+    while ((entry = get()))
+      release(entry);
+  }
+
+  //
+  // Free pool
+  // A bounded multi-producer/multi-consumer ring (after D. Vyukov).
+  // Each cell's sequence number says whether it is ready to be
+  // filled or emptied for a given lap of the ring.
+  //
+
+  QueueEntry *LockFreeInputQueue::takeFree()
+  {
+    size_t pos = m_poolTake.load(std::memory_order_relaxed);
+    PoolCell *cell;
+    while (true) {
+      cell = &m_pool[pos & m_poolMask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+      if (diff == 0) {
+        if (m_poolTake.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return nullptr; // pool is empty
+      else
+        pos = m_poolTake.load(std::memory_order_relaxed);
+    }
+    QueueEntry *result = cell->entry;
+    cell->sequence.store(pos + m_poolMask + 1, std::memory_order_release);
+    return result;
+  }
+
+  bool LockFreeInputQueue::giveFree(QueueEntry *entry)
+  {
+    size_t pos = m_poolPut.load(std::memory_order_relaxed);
+    PoolCell *cell;
+    while (true) {
+      cell = &m_pool[pos & m_poolMask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+      if (diff == 0) {
+        if (m_poolPut.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return false; // pool is full
+      else
+        pos = m_poolPut.load(std::memory_order_relaxed);
+    }
+    cell->entry = entry;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+} // namespace PLEXIL
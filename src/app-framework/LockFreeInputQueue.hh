@@ -0,0 +1,137 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PLEXIL_LOCK_FREE_INPUT_QUEUE_HH
+#define PLEXIL_LOCK_FREE_INPUT_QUEUE_HH
+
+#include "InputQueue.hh"
+#include "QueueEntry.hh"
+
+#include <atomic>
+#include <memory>
+
+namespace PLEXIL
+{
+
+  //! @class LockFreeInputQueue
+  //! @brief A lock-free implementation of the InputQueue API, for any
+  //!        number of writer threads and a single reader thread.
+  //!
+  //! The queue is an intrusive multi-producer/single-consumer linked
+  //! list (after D. Vyukov): put() is a single atomic exchange, and
+  //! get() never blocks.  Released entries are kept for reuse in a
+  //! bounded multi-producer/multi-consumer ring of pointers, which
+  //! is immune to the ABA problem of a linked free list.  Entries
+  //! which don't fit in the ring are deleted.
+  //!
+  //! @note get(), release(), flush(), and isEmpty() may only be called
+  //!       from the reader thread.
+  class LockFreeInputQueue : public InputQueue
+  {
+  public:
+
+    //! @brief Constructor.
+    //! @param poolSize The maximum number of free entries kept for reuse.
+    //!                 Rounded up to a power of 2.
+    LockFreeInputQueue(size_t poolSize = DEFAULT_POOL_SIZE);
+
+    //! @brief Virtual destructor.
+    virtual ~LockFreeInputQueue();
+
+    // Reader-side query
+    virtual bool isEmpty() const;
+
+    //
+    // Reader side
+    //
+
+    // Get the head of the queue. If empty, returns nullptr.
+    virtual QueueEntry *get();
+
+    // Flush the queue without examining it.
+    virtual void flush();
+
+    // Return an entry to the free list after use.
+    virtual void release(QueueEntry *entry);
+
+    //
+    // Writer side
+    //
+
+    // Get an entry for insertion. Will allocate if none are free.
+    virtual QueueEntry *allocate();
+
+    // Insert an entry on the queue.
+    virtual void put(QueueEntry *entry);
+
+    //! @brief Default maximum number of free entries kept for reuse.
+    static constexpr size_t DEFAULT_POOL_SIZE = 1024;
+
+  private:
+
+    // Disallow copy, assign
+    LockFreeInputQueue(LockFreeInputQueue const &) = delete;
+    LockFreeInputQueue(LockFreeInputQueue &&) = delete;
+    LockFreeInputQueue &operator=(LockFreeInputQueue const &) = delete;
+    LockFreeInputQueue &operator=(LockFreeInputQueue &&) = delete;
+
+    // Link an entry at the tail of the queue.
+    void push(QueueEntry *entry);
+
+    // Free pool operations.
+    QueueEntry *takeFree();
+    bool giveFree(QueueEntry *entry);
+
+    //! @brief A cell of the free pool.
+    struct PoolCell
+    {
+      std::atomic<size_t> sequence;
+      QueueEntry *entry;
+    };
+
+    // Typical cache line size, used to keep the hot indices apart.
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    //! @brief Placeholder which keeps the list non-empty.
+    QueueEntry m_stub;
+
+    std::unique_ptr<PoolCell[]> const m_pool;
+    size_t const m_poolMask;
+
+    char m_pad0[CACHE_LINE_SIZE];
+    //! @brief Most recently added entry.  Shared by the writers.
+    std::atomic<QueueEntry *> m_head;
+    char m_pad1[CACHE_LINE_SIZE];
+    //! @brief Oldest entry.  Owned by the reader.
+    QueueEntry *m_tail;
+    char m_pad2[CACHE_LINE_SIZE];
+    std::atomic<size_t> m_poolPut;
+    char m_pad3[CACHE_LINE_SIZE];
+    std::atomic<size_t> m_poolTake;
+  };
+
+}
+
+#endif // PLEXIL_LOCK_FREE_INPUT_QUEUE_HH
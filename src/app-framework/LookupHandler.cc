@@ -60,6 +60,13 @@ namespace PLEXIL
              ' ' << state << " (Integer) " << hi << "," << lo);
   }
 
+  void LookupHandler::setLookupThresholds(const State &state,
+                                          std::vector<Real> const & /* highs */,
+                                          Real hi, Real lo)
+  {
+    setThresholds(state, hi, lo);
+  }
+
   void LookupHandler::clearThresholds(const State &state)
   {
     debugMsg("LookupHandler:defaultClearThresholds", ' ' << state);
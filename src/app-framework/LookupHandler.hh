@@ -50,6 +50,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace PLEXIL
 {
@@ -184,6 +185,24 @@ namespace PLEXIL
     virtual void setThresholds(const State & state, Real hi, Real lo);
     virtual void setThresholds(const State & state, Integer hi, Integer lo);
 
+    //!
+    // @brief setLookupThresholds() is called instead of the Real
+    //        setThresholds() method, with the upper threshold of each
+    //        active LookupOnChange for the named state.
+    //
+    // @param state The state on which the bounds are being established.
+    // @param highs The upper threshold of each lookup, in no particular order.
+    // @param hi The lowest of the upper thresholds.
+    // @param lo The highest of the lower thresholds.
+    //
+    // @note The default method calls setThresholds(state, hi, lo).
+    //       The TimeAdapter uses the full list to schedule a wakeup
+    //       for every time lookup.
+    //
+    virtual void setLookupThresholds(const State & state,
+                                     std::vector<Real> const &highs,
+                                     Real hi, Real lo);
+
     //!
     // @brief Tell the interface that thresholds are no longer in effect
     //        for this state.
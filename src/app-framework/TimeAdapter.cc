@@ -32,16 +32,19 @@
 #include "Configuration.hh"
 #include "Debug.hh"
 #include "Error.hh"
+#include "FastClock.hh"
 #include "InterfaceAdapter.hh"
 #include "InterfaceError.hh"
 #include "InterfaceSchema.hh"
 #include "LookupHandler.hh"
 #include "LookupReceiver.hh"
 #include "State.hh"
+#include "StateCache.hh"
 #include "TimebaseFactory.hh"
 
 #include <iomanip> // std::setprecision()
 #include <memory>  // std::unique_ptr<>
+#include <sstream>
 
 //
 // TODO: Document!!
@@ -93,11 +96,43 @@ namespace PLEXIL
     //!           wakeup for this time.
     //! \param lo The value at or below which updates should be sent
     //!           to the Exec.  Ignored by TimeLookupHandler.
+    //! \note Called with the earliest threshold of all the time
+    //!       lookups, so any deadline before it is no longer wanted.
+    //!       Later deadlines are kept.
+    //! \see TimeLookupHandler::setLookupThresholds
     virtual void setThresholds(const State & state, Real hi, Real lo) override
     {
       debugMsg("TimeLookupHandler:setThresholds",
                " requesting wakeup at " << std::setprecision(15) << hi);
-      m_timebase->setTimer(hi);
+      m_timebase->cancelDeadlinesBefore(hi);
+      m_timebase->addDeadline(hi);
+    }
+
+    //! \brief setLookupThresholds() is called when the PLEXIL Exec
+    //!        activates or updates a LookupOnChange of time, with the
+    //!        threshold of each active time lookup.  Every threshold
+    //!        becomes a deadline in the Timebase.
+    //! \param state The state.  Ignored by TimeLookupHandler.
+    //! \param highs The threshold of each lookup.
+    //! \param hi The earliest threshold.
+    //! \param lo Ignored by TimeLookupHandler.
+    virtual void setLookupThresholds(const State & /* state */,
+                                     std::vector<Real> const &highs,
+                                     Real hi, Real /* lo */) override
+    {
+      debugMsg("TimeLookupHandler:setLookupThresholds",
+               ' ' << highs.size() << " deadlines, earliest "
+               << std::setprecision(15) << hi);
+      m_timebase->setDeadlines(highs);
+    }
+
+    //! \brief clearThresholds() is called when the PLEXIL Exec has
+    //!        no more time lookups active.
+    //! \param state The state.  Ignored by TimeLookupHandler.
+    virtual void clearThresholds(const State & /* state */) override
+    {
+      debugMsg("TimeLookupHandler:clearThresholds", " clearing all deadlines");
+      m_timebase->clearDeadlines();
     }
 
   private:
@@ -120,7 +155,8 @@ namespace PLEXIL
     //! \param conf Pointer to this instance's configuration data.
     TimeAdapter(AdapterExecInterface &intf, AdapterConf *conf)
       : InterfaceAdapter(intf, conf),
-        m_timebase()
+        m_timebase(),
+        m_timeSource(nullptr)
     {
     }
 
@@ -136,8 +172,27 @@ namespace PLEXIL
       // Construct Timebase
       pugi::xml_node const tb_xml = getXml().child(InterfaceSchema::TIMEBASE_TAG);
       m_timebase.reset(makeTimebase(tb_xml, [this]() -> void { timeout(this); }));
+      unsigned int slackUsec =
+        tb_xml.attribute(InterfaceSchema::COALESCING_SLACK_ATTR).as_uint();
+      if (slackUsec)
+        m_timebase->setCoalescingSlack(slackUsec / 1e6);
       config->registerLookupHandler(std::make_shared<TimeLookupHandler>(m_timebase.get()),
                                     "time");
+
+      // Choose how StateCache::queryTime() reads the time
+      std::string const source =
+        tb_xml.attribute(InterfaceSchema::TIME_SOURCE_ATTR).as_string("Timebase");
+      if (source == "Timebase")
+        m_timeSource = &Timebase::queryTime;
+      else if (source == "Clock")
+        m_timeSource = &getFastClockTime;
+      else if (source == "Lookup")
+        m_timeSource = nullptr;
+      else {
+        warn("TimeAdapter: invalid " << InterfaceSchema::TIME_SOURCE_ATTR
+             << " value \"" << source << '"');
+        return false;
+      }
       return true;
     }
 
@@ -147,6 +202,8 @@ namespace PLEXIL
     {
       try {
         m_timebase->start();
+        if (m_timeSource)
+          StateCache::setTimeSource(m_timeSource);
         debugMsg("TimeAdapter:start", " complete");
         return true;
       } catch (const InterfaceError &e) {
@@ -159,8 +216,13 @@ namespace PLEXIL
     //! \brief Stop the interface.
     virtual void stop() override
     {
+      if (m_timeSource && StateCache::getTimeSource() == m_timeSource)
+        StateCache::setTimeSource(nullptr);
       try {
         m_timebase->stop(); 
+        condDebugMsg(m_timebase->getStatistics().wakeups,
+                     "TimeAdapter:statistics",
+                     ' ' << statisticsString(m_timebase->getStatistics()));
         debugMsg("TimeAdapter:stop", " complete");
       } catch (const InterfaceError &e) {
         std::cerr << "ERROR: Stopping timebase threw an exception:\n "
@@ -188,23 +250,34 @@ namespace PLEXIL
       double now = tb->getTime();
       debugMsg("TimeAdapter:timeout", " at " << std::setprecision(15) << now);
 
-      // Check if timer went off too soon.
-      double next = tb->getNextWakeup();
-      if (next && now < next) {
-        // Alarm went off too early. Hit the snooze button.
-        debugMsg("TimeAdapter:timeout", " early wakeup, resetting");
-        tb->setTimer(next); // possibility of reentrant call to this function
+      // In deadline mode, only wake the Exec if a deadline is due.
+      // expireDeadlines() re-arms the timer for the next one.
+      if (!tb->getTickInterval() && !tb->expireDeadlines(now)) {
+        debugMsg("TimeAdapter:timeout", " early wakeup, ignored");
+        return;
       }
 
-      // Notify in any case
       adpt->getInterface().notifyOfExternalEvent();
     }
 
+    //! \brief Format the timebase's wakeup statistics for a debug message.
+    static std::string statisticsString(Timebase::Statistics const &stats)
+    {
+      std::ostringstream s;
+      s << stats.wakeups << " wakeups, "
+        << stats.earlyWakeups << " early, "
+        << stats.deadlinesExpired << " deadlines expired, jitter mean "
+        << std::setprecision(6) << (stats.wakeups ? stats.totalJitter / stats.wakeups : 0)
+        << " max " << stats.maxJitter << " s";
+      return s.str();
+    }
+
     //
     // Member variables
     //
 
     std::unique_ptr<Timebase> m_timebase;
+    StateCache::TimeSourceFn m_timeSource; //!< Direct time source for the Exec, or null.
   };
 
 } // namespace PLEXIL
@@ -33,6 +33,7 @@
 #include "TimebaseFactory.hh" // REGISTER_TIMEBASE() macro
 
 #include <cerrno>
+#include <cmath>    // fabs()
 #include <cstring>  // strerror()
 #include <iomanip> // std::fixed, std::setprecision()
 
@@ -48,6 +49,10 @@
 #define NSEC_PER_SEC (1000000000ull)
 #endif
 
+#ifdef PLEXIL_WITH_THREADS
+using DeadlineGuard = std::lock_guard<std::recursive_mutex>;
+#endif
+
 namespace PLEXIL
 {
 
@@ -61,7 +66,12 @@ namespace PLEXIL
     : m_nextWakeup(0),
       m_wakeupFn(f),
       m_interval_usec(0),
-      m_started(false)
+      m_started(false),
+      m_deadlines(),
+      m_stats(),
+      m_earliestDeadline(0),
+      m_armedTime(0),
+      m_slack(0)
   {
     if (!s_instance)
       s_instance = this;
@@ -90,6 +100,120 @@ namespace PLEXIL
     tb->m_wakeupFn();
   }
 
+  void Timebase::addDeadline(double d)
+  {
+    if (m_interval_usec)
+      return; // tick mode
+#ifdef PLEXIL_WITH_THREADS
+    DeadlineGuard guard(m_deadlineMutex);
+#endif
+    if (m_deadlines.empty() || d < m_earliestDeadline)
+      m_earliestDeadline = d;
+    m_deadlines.insert(d);
+    armTimer();
+  }
+
+  void Timebase::setDeadlines(std::vector<double> const &deadlines)
+  {
+    if (m_interval_usec)
+      return; // tick mode
+#ifdef PLEXIL_WITH_THREADS
+    DeadlineGuard guard(m_deadlineMutex);
+#endif
+    m_deadlines.clear();
+    for (double d : deadlines)
+      m_deadlines.insert(d);
+    if (m_deadlines.empty())
+      m_earliestDeadline = 0;
+    else {
+      m_earliestDeadline = m_deadlines.next();
+      armTimer();
+    }
+  }
+
+  void Timebase::cancelDeadlinesBefore(double d)
+  {
+#ifdef PLEXIL_WITH_THREADS
+    DeadlineGuard guard(m_deadlineMutex);
+#endif
+    if (m_deadlines.removeBefore(d)) {
+      m_earliestDeadline = m_deadlines.next();
+      armTimer();
+    }
+  }
+
+  void Timebase::clearDeadlines()
+  {
+#ifdef PLEXIL_WITH_THREADS
+    DeadlineGuard guard(m_deadlineMutex);
+#endif
+    m_deadlines.clear();
+    m_earliestDeadline = 0;
+  }
+
+  size_t Timebase::expireDeadlines(double now)
+  {
+#ifdef PLEXIL_WITH_THREADS
+    DeadlineGuard guard(m_deadlineMutex);
+#endif
+    ++m_stats.wakeups;
+    if (m_armedTime) {
+      double const jitter = fabs(now - m_armedTime);
+      m_stats.totalJitter += jitter;
+      if (jitter > m_stats.maxJitter)
+        m_stats.maxJitter = jitter;
+    }
+
+    // Deadlines due within the slack share this wakeup
+    size_t const nDue = m_deadlines.expire(now + m_slack);
+    if (nDue)
+      m_stats.deadlinesExpired += nDue;
+    else
+      ++m_stats.earlyWakeups;
+    debugMsg("Timebase:expireDeadlines",
+             ' ' << nDue << " due at " << std::fixed << std::setprecision(6) << now
+             << ", " << m_deadlines.size() << " remaining");
+
+    // The timer has fired, so must be armed again for what remains
+    m_armedTime = 0;
+    if (!m_deadlines.empty()) {
+      m_earliestDeadline = m_deadlines.next();
+      armTimer();
+    }
+    return nDue;
+  }
+
+  void Timebase::armTimer()
+  {
+    if (m_deadlines.empty())
+      return;
+    if (m_earliestDeadline == m_armedTime)
+      return;
+    m_armedTime = m_earliestDeadline;
+    setTimer(m_earliestDeadline); // may call the wakeup function
+  }
+
+  void Timebase::setCoalescingSlack(double slack)
+  {
+#ifdef PLEXIL_WITH_THREADS
+    DeadlineGuard guard(m_deadlineMutex);
+#endif
+    m_slack = slack > 0 ? slack : 0;
+  }
+
+  double Timebase::getCoalescingSlack() const
+  {
+    return m_slack;
+  }
+
+  Timebase::Statistics Timebase::getStatistics() const
+  {
+#ifdef PLEXIL_WITH_THREADS
+    DeadlineGuard guard(m_deadlineMutex);
+#endif
+    return m_stats;
+  }
+
 } // namespace PLEXIL
 
 //
@@ -26,9 +26,18 @@
 #ifndef PLEXIL_TIMEBASE_HH
 #define PLEXIL_TIMEBASE_HH
 
+#include "plexil-config.h"
+
+#include "TimerWheel.hh"
+
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <vector>
+
+#ifdef PLEXIL_WITH_THREADS
+#include <mutex>
+#endif
 
 namespace PLEXIL
 {
@@ -51,6 +60,14 @@ namespace PLEXIL
   //! Deadline mode is the default, for compatibility with previous
   //! PLEXIL implementations.
 
+  //! In deadline mode a Timebase can hold any number of outstanding
+  //! deadlines, in a timing wheel.  The timer is armed for the
+  //! earliest of them.  At wakeup the client calls expireDeadlines()
+  //! to learn whether any deadline is actually due, and to re-arm the
+  //! timer for the next one.  With a coalescing slack, deadlines that
+  //! fall due within the slack after a wakeup are expired with it,
+  //! so that deadlines close together share one wakeup.
+
   //! In either mode, the wakeup function is generally called after
   //! the specified time plus a variable latency has elapsed.  On some
   //! platforms (notably macOS), the wakeup function may be called
@@ -73,6 +90,17 @@ namespace PLEXIL
     //! \brief Type alias for a function of no arguments, returning void.
     using WakeupFn = std::function<void()>;
 
+    //! \struct Statistics
+    //! \brief Deadline mode wakeup counts and timing.
+    struct Statistics
+    {
+      uint64_t wakeups;          //!< Wakeups passed to expireDeadlines().
+      uint64_t earlyWakeups;     //!< Wakeups at which no deadline was due.
+      uint64_t deadlinesExpired; //!< Deadlines found due at wakeups.
+      double   totalJitter;      //!< Sum of the differences between the wakeup and armed times, in seconds.
+      double   maxJitter;        //!< Largest difference between a wakeup and its armed time, in seconds.
+    };
+
     //! \brief Convenience function. Gets the time from an existing timebase.
     //! \return Time in seconds, as a double. Returns 0 if there is no
     //!         existing timebase.
@@ -123,6 +151,49 @@ namespace PLEXIL
     //!       return 0.
     double getNextWakeup() const;
 
+    //! \brief Add a deadline, and arm the timer for it if it is now
+    //!        the earliest.
+    //! \param d The deadline.
+    //! \note Ignored in tick mode.
+    void addDeadline(double d);
+
+    //! \brief Replace all deadlines with the given ones, and arm the
+    //!        timer for the earliest.
+    //! \param deadlines The new deadlines, in any order.
+    //! \note Ignored in tick mode.
+    void setDeadlines(std::vector<double> const &deadlines);
+
+    //! \brief Remove all deadlines earlier than the given time.
+    //! \param d The time.
+    void cancelDeadlinesBefore(double d);
+
+    //! \brief Remove all deadlines.
+    //! \note A wakeup already armed is reported by expireDeadlines()
+    //!       as early.
+    void clearDeadlines();
+
+    //! \brief Remove the deadlines which are due, or due within the
+    //!        coalescing slack, and arm the timer for the next one.
+    //!        Call from the wakeup function.
+    //! \param now The current time.
+    //! \return The number of deadlines which were due.  0 means the
+    //!         wakeup was early or no longer needed.
+    size_t expireDeadlines(double now);
+
+    //! \brief Set the coalescing slack, the time after a wakeup within
+    //!        which later deadlines share that wakeup.  No wakeup is
+    //!        delayed past its deadline.
+    //! \param slack The slack in seconds. The default is 0.
+    void setCoalescingSlack(double slack);
+
+    //! \brief Get the coalescing slack.
+    //! \return The slack in seconds.
+    double getCoalescingSlack() const;
+
+    //! \brief Get the deadline mode wakeup statistics.
+    //! \return Copy of the statistics.
+    Statistics getStatistics() const;
+
   protected:
 
     //! \brief Constructor.
@@ -151,6 +222,22 @@ namespace PLEXIL
 
   private:
 
+    //! \brief Arm the timer for the earliest deadline, unless it is
+    //!        already armed for that time.
+    //! \note Caller must hold m_deadlineMutex.
+    void armTimer();
+
+    TimerWheel m_deadlines;        //!< The outstanding deadlines.
+    Statistics m_stats;            //!< Wakeup statistics.
+    double     m_earliestDeadline; //!< Earliest entry in m_deadlines.
+    double     m_armedTime;        //!< Time the timer is armed for; 0 if not armed.
+    double     m_slack;            //!< Coalescing slack in seconds.
+#ifdef PLEXIL_WITH_THREADS
+    //! Serializes the deadline functions.  Recursive because
+    //! setTimer() may call the wakeup function directly.
+    mutable std::recursive_mutex m_deadlineMutex;
+#endif
+
     // Copy, move constructors, assignment operators unimplemented.
     Timebase(Timebase const &) = delete;
     Timebase(Timebase &&) = delete;
@@ -0,0 +1,222 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "TimerWheel.hh"
+
+#include <algorithm>
+
+namespace PLEXIL
+{
+
+  TimerWheel::TimerWheel(double resolution)
+    : m_counts(),
+      m_resolution(resolution),
+      m_current(0),
+      m_size(0)
+  {
+  }
+
+  bool TimerWheel::empty() const
+  {
+    return !m_size;
+  }
+
+  size_t TimerWheel::size() const
+  {
+    return m_size;
+  }
+
+  uint64_t TimerWheel::tickOf(double t) const
+  {
+    if (t <= 0)
+      return 0;
+    return (uint64_t) (t / m_resolution);
+  }
+
+  // Deadlines earlier than the current tick go into the current slot.
+  // The level is returned through the second argument; LEVELS means
+  // the overflow list.
+  TimerWheel::Slot &TimerWheel::slotFor(uint64_t tick, unsigned int &level)
+  {
+    if (tick < m_current)
+      tick = m_current;
+    uint64_t const delta = tick - m_current;
+    for (level = 0; level < LEVELS; ++level) {
+      if (delta < ((uint64_t) 1 << (SLOT_BITS * (level + 1))))
+        return m_slots[level][(tick >> (SLOT_BITS * level)) & SLOT_MASK];
+    }
+    return m_overflow;
+  }
+
+  void TimerWheel::insert(double t)
+  {
+    uint64_t const tick = tickOf(t);
+    if (!m_size)
+      m_current = tick; // any position is valid for an empty wheel
+
+    unsigned int level;
+    slotFor(tick, level).push_back(t);
+    if (level < LEVELS)
+      ++m_counts[level];
+    ++m_size;
+  }
+
+  double TimerWheel::next() const
+  {
+    if (!m_size)
+      return 0;
+
+    // Within a level, slots are in tick order starting at the current
+    // tick; at the higher levels the current slot holds the most
+    // distant deadlines, so it comes last.  A deadline in a higher
+    // level may still precede one inserted later into a lower level,
+    // so the earliest of each level must be compared.
+    double result = 0;
+    bool found = false;
+    for (unsigned int level = 0; level < LEVELS; ++level) {
+      if (!m_counts[level])
+        continue;
+      uint64_t const base = m_current >> (SLOT_BITS * level);
+      unsigned int const first = level ? 1 : 0;
+      for (unsigned int i = first; i < first + SLOTS; ++i) {
+        Slot const &slot = m_slots[level][(base + i) & SLOT_MASK];
+        if (!slot.empty()) {
+          double const levelMin = *std::min_element(slot.begin(), slot.end());
+          if (!found || levelMin < result)
+            result = levelMin;
+          found = true;
+          break;
+        }
+      }
+    }
+    if (!m_overflow.empty()) {
+      double const overflowMin = *std::min_element(m_overflow.begin(), m_overflow.end());
+      if (!found || overflowMin < result)
+        result = overflowMin;
+    }
+    return result;
+  }
+
+  // Redistribute the higher level slots which the current tick has
+  // just reached.  Called when the current tick is a multiple of the
+  // level 0 size.
+  void TimerWheel::cascade()
+  {
+    unsigned int top = 1;
+    while (top < LEVELS
+           && !(m_current & (((uint64_t) 1 << (SLOT_BITS * (top + 1))) - 1)))
+      ++top;
+
+    for (unsigned int level = top; level >= 1; --level) {
+      Slot pending;
+      if (level == LEVELS)
+        pending.swap(m_overflow);
+      else {
+        pending.swap(m_slots[level][(m_current >> (SLOT_BITS * level)) & SLOT_MASK]);
+        m_counts[level] -= pending.size();
+      }
+      for (double t : pending) {
+        unsigned int newLevel;
+        slotFor(tickOf(t), newLevel).push_back(t);
+        if (newLevel < LEVELS)
+          ++m_counts[newLevel];
+      }
+    }
+  }
+
+  size_t TimerWheel::advance(double t, bool inclusive)
+  {
+    if (!m_size)
+      return 0;
+
+    uint64_t const target = tickOf(t);
+    size_t removed = 0;
+    while (m_current < target) {
+      uint64_t next;
+      if (m_counts[0]) {
+        // Every deadline in the current slot is due
+        Slot &slot = m_slots[0][m_current & SLOT_MASK];
+        m_counts[0] -= slot.size();
+        removed += slot.size();
+        slot.clear();
+
+        // Skip empty slots, stopping at the end of the level 0 turn
+        next = m_current + 1;
+        while (next < target && (next & SLOT_MASK)
+               && m_slots[0][next & SLOT_MASK].empty())
+          ++next;
+      }
+      else {
+        // Jump to the next slot of the lowest occupied level
+        unsigned int level = 1;
+        while (level < LEVELS && !m_counts[level])
+          ++level;
+        next = ((m_current >> (SLOT_BITS * level)) + 1) << (SLOT_BITS * level);
+        if (next > target)
+          next = target;
+      }
+
+      m_current = next;
+      if (!(m_current & SLOT_MASK))
+        cascade();
+    }
+
+    // Only some of the deadlines in the target tick may be due
+    Slot &slot = m_slots[0][m_current & SLOT_MASK];
+    Slot::iterator const newEnd =
+      std::remove_if(slot.begin(), slot.end(),
+                     [t, inclusive](double d) -> bool
+                     { return inclusive ? d <= t : d < t; });
+    size_t const nDue = slot.end() - newEnd;
+    slot.erase(newEnd, slot.end());
+    m_counts[0] -= nDue;
+    removed += nDue;
+
+    m_size -= removed;
+    return removed;
+  }
+
+  size_t TimerWheel::expire(double now)
+  {
+    return advance(now, true);
+  }
+
+  size_t TimerWheel::removeBefore(double t)
+  {
+    return advance(t, false);
+  }
+
+  void TimerWheel::clear()
+  {
+    for (unsigned int level = 0; level < LEVELS; ++level) {
+      for (Slot &slot : m_slots[level])
+        slot.clear();
+      m_counts[level] = 0;
+    }
+    m_overflow.clear();
+    m_size = 0;
+  }
+
+} // namespace PLEXIL
@@ -0,0 +1,125 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PLEXIL_TIMER_WHEEL_HH
+#define PLEXIL_TIMER_WHEEL_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace PLEXIL
+{
+
+  //! \class TimerWheel
+  //! \brief A hierarchical timing wheel holding a set of deadlines.
+
+  //! Deadlines are times in seconds, as returned by
+  //! Timebase::getTime().  They are hashed into slots by their tick,
+  //! i.e. the time divided by the wheel's resolution.  Level 0 has
+  //! one slot per tick; each higher level has one slot per full turn
+  //! of the level below it.  The contents of a higher level slot are
+  //! redistributed to the lower levels as the wheel turns.  Deadlines
+  //! too far in the future for the highest level are kept in an
+  //! overflow list.
+
+  //! Insertion is constant time.  Expiring deadlines takes time
+  //! proportional to the number of deadlines expired, plus the number
+  //! of ticks elapsed divided by the level 0 size.
+
+  //! The wheel itself is not thread safe.
+
+  class TimerWheel final
+  {
+  public:
+
+    //! \brief Constructor.
+    //! \param resolution The length of a tick, in seconds.
+    TimerWheel(double resolution = 0.001);
+
+    //! \brief Destructor.
+    ~TimerWheel() = default;
+
+    //! \brief Add a deadline.
+    //! \param t The deadline.
+    //! \note Duplicates are not detected; each copy counts separately.
+    void insert(double t);
+
+    //! \brief Query whether the wheel is empty.
+    //! \return true if there are no deadlines, false otherwise.
+    bool empty() const;
+
+    //! \brief Get the number of deadlines in the wheel.
+    //! \return The count.
+    size_t size() const;
+
+    //! \brief Get the earliest deadline.
+    //! \return The earliest deadline; 0 if the wheel is empty.
+    double next() const;
+
+    //! \brief Remove all deadlines at or before the given time.
+    //! \param now The current time.
+    //! \return The number of deadlines removed.
+    size_t expire(double now);
+
+    //! \brief Remove all deadlines strictly before the given time.
+    //! \param t The time.
+    //! \return The number of deadlines removed.
+    size_t removeBefore(double t);
+
+    //! \brief Remove all deadlines.
+    void clear();
+
+  private:
+
+    // Not copyable
+    TimerWheel(TimerWheel const &) = delete;
+    TimerWheel(TimerWheel &&) = delete;
+    TimerWheel &operator=(TimerWheel const &) = delete;
+    TimerWheel &operator=(TimerWheel &&) = delete;
+
+    static constexpr unsigned int LEVELS = 4;
+    static constexpr unsigned int SLOT_BITS = 8;
+    static constexpr unsigned int SLOTS = 1 << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+
+    using Slot = std::vector<double>;
+
+    uint64_t tickOf(double t) const;
+    Slot &slotFor(uint64_t tick, unsigned int &level);
+    void cascade();
+    size_t advance(double t, bool inclusive);
+
+    Slot m_slots[LEVELS][SLOTS];   //!< The wheels.
+    Slot m_overflow;               //!< Deadlines beyond the highest level.
+    size_t m_counts[LEVELS];       //!< Number of deadlines in each level.
+    double m_resolution;           //!< Length of a tick in seconds.
+    uint64_t m_current;            //!< The tick the wheel is pointing at.
+    size_t m_size;                 //!< Number of deadlines in the wheel.
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_TIMER_WHEEL_HH
@@ -0,0 +1,299 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+//
+// Measures the cost of dispatching commands and lookups through
+// AdapterConfiguration, with and without the handler cached in the
+// Command or StateCacheEntry.
+//
+
+#include "AdapterConfiguration.hh"
+#include "CommandImpl.hh"
+#include "Constant.hh"
+#include "Error.hh"
+#include "LookupReceiver.hh"
+#include "State.hh"
+#include "StateCache.hh"
+#include "StateCacheEntry.hh"
+#include "lifecycle-utils.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace PLEXIL;
+
+using Clock = std::chrono::steady_clock;
+
+//
+// Handlers which only count their invocations
+//
+
+class CountingCommandHandler : public CommandHandler
+{
+public:
+  CountingCommandHandler(size_t &count)
+    : m_count(count)
+  {
+  }
+
+  virtual void executeCommand(Command * /* cmd */, AdapterExecInterface * /* intf */)
+  {
+    ++m_count;
+  }
+
+private:
+  size_t &m_count;
+};
+
+class CountingLookupHandler : public LookupHandler
+{
+public:
+  CountingLookupHandler(size_t &count)
+    : m_count(count)
+  {
+  }
+
+  virtual void lookupNow(const State & /* state */, LookupReceiver *rcvr)
+  {
+    ++m_count;
+    rcvr->update((Integer) m_count);
+  }
+
+private:
+  size_t &m_count;
+};
+
+//
+// Command and LookupReceiver without a DispatchCache, which force
+// a search of the handler table on every dispatch
+//
+
+class UncachedCommand : public Command
+{
+public:
+  UncachedCommand(std::string const &name)
+    : m_command(name)
+  {
+  }
+
+  virtual State const &getCommand() const { return m_command; }
+  virtual std::string const &getName() const { return m_command.name(); }
+  virtual std::vector<Value> const &getArgValues() const { return m_command.parameters(); }
+  virtual bool isReturnExpected() const { return false; }
+
+private:
+  State m_command;
+};
+
+class UncachedReceiver : public LookupReceiver
+{
+public:
+  UncachedReceiver(LookupReceiver *entry)
+    : m_entry(entry)
+  {
+  }
+
+  virtual void update(Value const &val) { m_entry->update(val); }
+  virtual void setUnknown() { m_entry->setUnknown(); }
+  virtual void update(Boolean val) { m_entry->update(val); }
+  virtual void update(Integer val) { m_entry->update(val); }
+  virtual void update(Real val) { m_entry->update(val); }
+  virtual void update(String const &val) { m_entry->update(val); }
+  virtual void update(char const *val) { m_entry->update(val); }
+  virtual void update(Boolean const ary[], size_t size) { m_entry->update(ary, size); }
+  virtual void update(Integer const ary[], size_t size) { m_entry->update(ary, size); }
+  virtual void update(Real const ary[], size_t size) { m_entry->update(ary, size); }
+  virtual void update(String const ary[], size_t size) { m_entry->update(ary, size); }
+
+private:
+  LookupReceiver *m_entry;
+};
+
+static void report(char const *what, size_t n, Clock::time_point start)
+{
+  double secs = std::chrono::duration<double>(Clock::now() - start).count();
+  std::cout << std::left << std::setw(20) << what << std::right
+            << std::fixed << std::setprecision(1)
+            << secs * 1e9 / n << " ns/dispatch, "
+            << std::setprecision(0) << n / secs << " dispatches/sec"
+            << std::endl;
+}
+
+template <class CommandType>
+static void dispatchCommands(char const *what, AdapterConfiguration *config,
+                             std::vector<CommandType *> const &commands,
+                             size_t nDispatches)
+{
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < nDispatches; ++i)
+    config->executeCommand(commands[i % commands.size()]);
+  report(what, nDispatches, start);
+}
+
+static void dispatchLookups(char const *what, AdapterConfiguration *config,
+                            std::vector<State> const &states,
+                            std::vector<LookupReceiver *> const &receivers,
+                            size_t nDispatches)
+{
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < nDispatches; ++i) {
+    size_t n = i % states.size();
+    config->lookupNow(states[n], receivers[n]);
+  }
+  report(what, nDispatches, start);
+}
+
+static void usage()
+{
+  std::cout << "Usage: dispatch-benchmark [options]\n"
+            << " Options:\n"
+            << "  -h               Display this message and exit\n"
+            << "  -n <number>      Number of dispatches per pass (default 1000000)\n"
+            << "  -s <number>      Number of distinct command and state names (default 200)\n"
+            << std::endl;
+}
+
+static bool parseCount(char const *arg, size_t &result)
+{
+  long n = atol(arg);
+  if (n <= 0)
+    return false;
+  result = (size_t) n;
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t nDispatches = 1000000;
+  size_t nNames = 200;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-h")) {
+      usage();
+      return 0;
+    }
+    else if (i + 1 < argc && !strcmp(argv[i], "-n")) {
+      if (!parseCount(argv[++i], nDispatches)) {
+        std::cerr << "-n option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+    }
+    else if (i + 1 < argc && !strcmp(argv[i], "-s")) {
+      if (!parseCount(argv[++i], nNames)) {
+        std::cerr << "-s option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+    }
+    else {
+      std::cerr << "Unrecognized argument " << argv[i] << std::endl;
+      usage();
+      return 1;
+    }
+  }
+
+  try {
+    Error::doThrowExceptions();
+
+    size_t commandCount = 0;
+    size_t lookupCount = 0;
+    std::unique_ptr<AdapterConfiguration> config(makeAdapterConfiguration());
+    CommandHandlerPtr cmdHandler = std::make_shared<CountingCommandHandler>(commandCount);
+    LookupHandlerPtr lookupHandler = std::make_shared<CountingLookupHandler>(lookupCount);
+
+    // Commands and states, with a handler registered for each name
+    std::vector<std::unique_ptr<CommandImpl>> commands;
+    std::vector<std::unique_ptr<UncachedCommand>> uncachedCommands;
+    std::vector<State> states;
+    std::vector<std::unique_ptr<UncachedReceiver>> uncachedReceivers;
+    std::vector<LookupReceiver *> entryReceivers;
+    for (size_t i = 0; i < nNames; ++i) {
+      std::string const name = "Name" + std::to_string(i);
+      config->registerCommandHandler(cmdHandler, name);
+      config->registerLookupHandler(lookupHandler, name);
+
+      commands.emplace_back(std::make_unique<CommandImpl>("node"));
+      commands.back()->setNameExpr(new Constant<String>(name), true);
+      commands.back()->activate();
+      commands.back()->fixValues();
+      uncachedCommands.emplace_back(std::make_unique<UncachedCommand>(name));
+
+      states.emplace_back(State(name));
+      LookupReceiver *rcvr =
+        StateCache::instance().ensureStateCacheEntry(states.back())->getLookupReceiver();
+      entryReceivers.push_back(rcvr);
+      uncachedReceivers.emplace_back(std::make_unique<UncachedReceiver>(rcvr));
+    }
+    std::vector<CommandImpl *> commandPtrs;
+    std::vector<UncachedCommand *> uncachedCommandPtrs;
+    std::vector<LookupReceiver *> uncachedReceiverPtrs;
+    for (size_t i = 0; i < nNames; ++i) {
+      commandPtrs.push_back(commands[i].get());
+      uncachedCommandPtrs.push_back(uncachedCommands[i].get());
+      uncachedReceiverPtrs.push_back(uncachedReceivers[i].get());
+    }
+
+    std::cout << nDispatches << " dispatches over " << nNames << " names" << std::endl;
+
+    dispatchCommands("Commands, uncached", config.get(), uncachedCommandPtrs, nDispatches);
+    dispatchCommands("Commands, cached", config.get(), commandPtrs, nDispatches);
+    dispatchLookups("Lookups, uncached", config.get(), states, uncachedReceiverPtrs, nDispatches);
+    dispatchLookups("Lookups, cached", config.get(), states, entryReceivers, nDispatches);
+
+    // Re-registering a handler must invalidate every cache
+    size_t replacementCount = 0;
+    config->registerCommandHandler(std::make_shared<CountingCommandHandler>(replacementCount),
+                                   "Name0");
+    config->executeCommand(commandPtrs[0]);
+    if (replacementCount != 1) {
+      std::cerr << "Cached command handler was not replaced" << std::endl;
+      return 1;
+    }
+    if (commandCount != 2 * nDispatches || lookupCount != 2 * nDispatches) {
+      std::cerr << "Handlers were called " << commandCount << " and " << lookupCount
+                << " times, expected " << 2 * nDispatches << std::endl;
+      return 1;
+    }
+
+    for (std::unique_ptr<CommandImpl> &cmd : commands)
+      cmd->deactivate(nullptr);
+    config.reset();
+    plexilRunFinalizers();
+  }
+  catch (Error const &e) {
+    std::cerr << "Aborting benchmark due to error:\n" << e << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,385 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//
+// Compares the cost of reporting lookup values to the Exec one at a
+// time (handleValueChange) and in batches (handleValueChanges).
+// Each pass enqueues the samples the way InterfaceManager does, then
+// drains the queue into the StateCache the way processQueue() does.
+//
+// With -p, instead measures the latency of put() under contention for
+// each InputQueue implementation, with 1, 4, and 16 writer threads
+// and a reader thread draining the queue concurrently.
+//
+
+#include "plexil-config.h"
+
+#include "Error.hh"
+#include "LockFreeInputQueue.hh"
+#include "QueueEntry.hh"
+#include "SerializedInputQueue.hh"
+#include "State.hh"
+#include "StateCache.hh"
+#include "lifecycle-utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#ifdef PLEXIL_WITH_THREADS
+#include <atomic>
+#include <thread>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace PLEXIL;
+
+using Clock = std::chrono::steady_clock;
+
+static void reportTime(char const *what, size_t nSamples,
+                       Clock::time_point start, Clock::time_point enqueued,
+                       Clock::time_point finish)
+{
+  double enqueueSecs = std::chrono::duration<double>(enqueued - start).count();
+  double totalSecs = std::chrono::duration<double>(finish - start).count();
+  std::cout << std::left << std::setw(24) << what << std::right
+            << std::fixed << std::setprecision(6)
+            << " total " << totalSecs << " s, enqueue "
+            << std::setprecision(1)
+            << enqueueSecs * 1e9 / nSamples << " ns/sample, overall "
+            << totalSecs * 1e9 / nSamples << " ns/sample"
+            << std::endl;
+}
+
+// Apply everything in the queue to the state cache.
+static void drainQueue(InputQueue &queue)
+{
+  StateCache &cache = StateCache::instance();
+  QueueEntry *entry;
+  while ((entry = queue.get())) {
+    switch (entry->type) {
+    case Q_LOOKUP:
+      cache.lookupReturn(*entry->state, entry->value);
+      break;
+
+    case Q_LOOKUP_ID:
+      cache.lookupReturn(entry->stateId, entry->value);
+      break;
+
+    case Q_LOOKUP_BATCH:
+      cache.lookupReturn(entry->batch);
+      break;
+
+    default:
+      break;
+    }
+    queue.release(entry);
+  }
+}
+
+static void perEntryByState(InputQueue &queue,
+                            std::vector<State> const &states,
+                            size_t nSamples)
+{
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < nSamples; ++i) {
+    QueueEntry *entry = queue.allocate();
+    entry->initForLookup(states[i % states.size()], Value((Real) i));
+    queue.put(entry);
+  }
+  Clock::time_point enqueued = Clock::now();
+  drainQueue(queue);
+  reportTime("per entry, by State", nSamples, start, enqueued, Clock::now());
+}
+
+static void perEntryById(InputQueue &queue,
+                         std::vector<StateId> const &ids,
+                         size_t nSamples)
+{
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < nSamples; ++i) {
+    QueueEntry *entry = queue.allocate();
+    entry->initForLookup(ids[i % ids.size()], Value((Real) i));
+    queue.put(entry);
+  }
+  Clock::time_point enqueued = Clock::now();
+  drainQueue(queue);
+  reportTime("per entry, by StateId", nSamples, start, enqueued, Clock::now());
+}
+
+static void batchedByState(InputQueue &queue,
+                           std::vector<State> const &states,
+                           size_t nSamples,
+                           size_t batchSize)
+{
+  std::vector<LookupValue> values;
+  values.reserve(batchSize);
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < nSamples; ) {
+    values.clear();
+    for (size_t j = 0; j < batchSize && i < nSamples; ++j, ++i)
+      values.emplace_back(states[i % states.size()], Value((Real) i));
+    QueueEntry *entry = queue.allocate();
+    entry->initForLookupBatch(values.data(), values.size());
+    queue.put(entry);
+  }
+  Clock::time_point enqueued = Clock::now();
+  drainQueue(queue);
+  reportTime("batched, by State", nSamples, start, enqueued, Clock::now());
+}
+
+static void batchedById(InputQueue &queue,
+                        std::vector<StateId> const &ids,
+                        size_t nSamples,
+                        size_t batchSize)
+{
+  std::vector<LookupValue> values;
+  values.reserve(batchSize);
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < nSamples; ) {
+    values.clear();
+    for (size_t j = 0; j < batchSize && i < nSamples; ++j, ++i)
+      values.emplace_back(ids[i % ids.size()], Value((Real) i));
+    QueueEntry *entry = queue.allocate();
+    entry->initForLookupBatch(values.data(), values.size());
+    queue.put(entry);
+  }
+  Clock::time_point enqueued = Clock::now();
+  drainQueue(queue);
+  reportTime("batched, by StateId", nSamples, start, enqueued, Clock::now());
+}
+
+#ifdef PLEXIL_WITH_THREADS
+
+// Each writer puts nSamples entries, timing every put.  The reader
+// checks that each writer's entries arrive complete and in order.
+static bool stressQueue(char const *name, InputQueue &queue,
+                        size_t nWriters, size_t nSamples)
+{
+  std::vector<std::vector<uint32_t>> latencies(nWriters);
+  std::atomic<size_t> writersDone(0);
+  bool ordered = true;
+  size_t received = 0;
+
+  std::thread reader([&]() {
+      std::vector<Integer> lastSeen(nWriters, -1);
+      while (true) {
+        bool done = (writersDone.load() == nWriters);
+        QueueEntry *entry;
+        while ((entry = queue.get())) {
+          Integer seq = 0;
+          entry->value.getValue(seq);
+          if (seq != lastSeen[entry->stateId] + 1)
+            ordered = false;
+          lastSeen[entry->stateId] = seq;
+          ++received;
+          queue.release(entry);
+        }
+        if (done && queue.isEmpty())
+          break;
+        std::this_thread::yield();
+      }
+    });
+
+  std::vector<std::thread> writers;
+  for (size_t w = 0; w < nWriters; ++w) {
+    latencies[w].reserve(nSamples);
+    writers.emplace_back([&queue, &latencies, &writersDone, w, nSamples]() {
+        for (size_t i = 0; i < nSamples; ++i) {
+          Clock::time_point start = Clock::now();
+          QueueEntry *entry = queue.allocate();
+          entry->initForLookup((StateId) w, Value((Integer) i));
+          queue.put(entry);
+          latencies[w].push_back((uint32_t)
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        }
+        ++writersDone;
+      });
+  }
+  for (std::thread &t : writers)
+    t.join();
+  reader.join();
+
+  std::vector<uint32_t> all;
+  all.reserve(nWriters * nSamples);
+  for (std::vector<uint32_t> const &v : latencies)
+    all.insert(all.end(), v.begin(), v.end());
+  std::sort(all.begin(), all.end());
+  double sum = 0;
+  for (uint32_t ns : all)
+    sum += ns;
+
+  std::cout << std::left << std::setw(12) << name << std::right
+            << std::setw(3) << nWriters << " writers: put mean "
+            << std::fixed << std::setprecision(1) << sum / all.size()
+            << " ns, p50 " << all[all.size() / 2]
+            << " ns, p99 " << all[all.size() * 99 / 100]
+            << " ns, p99.9 " << all[all.size() * 999 / 1000]
+            << " ns, max " << all.back() << " ns"
+            << std::endl;
+
+  if (received != nWriters * nSamples || !ordered) {
+    std::cerr << name << ": expected " << nWriters * nSamples
+              << " entries in order, received " << received
+              << (ordered ? " in order" : " out of order") << std::endl;
+    return false;
+  }
+  return true;
+}
+
+static bool stressQueues(size_t nSamples)
+{
+  static size_t const writerCounts[] = {1, 4, 16};
+  bool result = true;
+  std::cout << nSamples << " puts per writer" << std::endl;
+  for (size_t nWriters : writerCounts) {
+    {
+      SerializedInputQueue queue;
+      result = stressQueue("Serialized", queue, nWriters, nSamples) && result;
+    }
+    {
+      LockFreeInputQueue queue;
+      result = stressQueue("LockFree", queue, nWriters, nSamples) && result;
+    }
+  }
+  return result;
+}
+
+#endif // PLEXIL_WITH_THREADS
+
+static void usage()
+{
+  std::cout << "Usage: input-queue-benchmark [options]\n"
+            << " Options:\n"
+            << "  -h               Display this message and exit\n"
+            << "  -n <number>      Number of samples per pass (default 1000000)\n"
+            << "  -s <number>      Number of distinct states (default 10000)\n"
+            << "  -b <number>      Samples per batch (default 1000)\n"
+#ifdef PLEXIL_WITH_THREADS
+            << "  -p               Measure put() latency with concurrent writers;\n"
+            << "                   -n is then the number of samples per writer\n"
+#endif
+            << std::endl;
+}
+
+static bool parseCount(char const *arg, size_t &result)
+{
+  long n = atol(arg);
+  if (n <= 0)
+    return false;
+  result = (size_t) n;
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t nSamples = 1000000;
+  size_t nStates = 10000;
+  size_t batchSize = 1000;
+#ifdef PLEXIL_WITH_THREADS
+  bool stress = false;
+#endif
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-h")) {
+      usage();
+      return 0;
+    }
+#ifdef PLEXIL_WITH_THREADS
+    else if (!strcmp(argv[i], "-p"))
+      stress = true;
+#endif
+    else if (i + 1 < argc && !strcmp(argv[i], "-n")) {
+      if (!parseCount(argv[++i], nSamples)) {
+        std::cerr << "-n option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+    }
+    else if (i + 1 < argc && !strcmp(argv[i], "-s")) {
+      if (!parseCount(argv[++i], nStates)) {
+        std::cerr << "-s option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+    }
+    else if (i + 1 < argc && !strcmp(argv[i], "-b")) {
+      if (!parseCount(argv[++i], batchSize)) {
+        std::cerr << "-b option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+    }
+    else {
+      std::cerr << "Unrecognized argument " << argv[i] << std::endl;
+      usage();
+      return 1;
+    }
+  }
+
+  try {
+    Error::doThrowExceptions();
+
+#ifdef PLEXIL_WITH_THREADS
+    if (stress)
+      return stressQueues(nSamples) ? 0 : 1;
+#endif
+
+    // Telemetry-like states: one name, one integer parameter
+    std::vector<State> states;
+    std::vector<StateId> ids;
+    states.reserve(nStates);
+    ids.reserve(nStates);
+    for (size_t i = 0; i < nStates; ++i) {
+      states.emplace_back(State("Telemetry", Value((Integer) i)));
+      ids.push_back(StateCache::instance().getStateId(states.back()));
+    }
+
+    std::cout << nSamples << " samples over " << nStates << " states, "
+              << batchSize << " samples per batch" << std::endl;
+
+    SerializedInputQueue queue;
+    // Warm up the queue's free list and the cache
+    perEntryByState(queue, states, nStates);
+    std::cout << "--" << std::endl;
+
+    perEntryByState(queue, states, nSamples);
+    perEntryById(queue, ids, nSamples);
+    batchedByState(queue, states, nSamples, batchSize);
+    batchedById(queue, ids, nSamples, batchSize);
+
+    plexilRunFinalizers();
+  }
+  catch (Error const &e) {
+    std::cerr << "Aborting benchmark due to error:\n" << e << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
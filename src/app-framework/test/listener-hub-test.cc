@@ -0,0 +1,153 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "plexil-config.h"
+
+#include "Error.hh"
+#include "ExecListener.hh"
+#include "ExecListenerHub.hh"
+#include "NodeImpl.hh"
+#include "NodeTransition.hh"
+#include "ThreadSemaphore.hh"
+#include "Value.hh"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace PLEXIL;
+
+//! \brief A listener which records the events it receives, in order,
+//!        and holds up the listener thread on its first transition.
+class RecordingListener : public ExecListener
+{
+public:
+  RecordingListener(ThreadSemaphore &started,
+                    ThreadSemaphore &release,
+                    std::vector<std::string> &events)
+    : ExecListener(),
+      m_started(started),
+      m_release(release),
+      m_events(events),
+      m_held(false)
+  {
+  }
+
+  virtual ~RecordingListener() = default;
+
+  virtual bool supportsAsynchronousPublication() const override
+  {
+    return true;
+  }
+
+protected:
+
+  virtual void
+  implementNotifyNodeTransition(NodeTransition const &trans) const override
+  {
+    if (!m_held) {
+      m_held = true;
+      m_started.post();
+      m_release.wait();
+    }
+    assertTrue_1(trans.snapshot);
+    m_events.push_back("T " + trans.snapshot->nodePath.back());
+  }
+
+  virtual void implementNotifyAssignment(Expression const * /* dest */,
+                                         std::string const &destName,
+                                         Value const & /* value */) const override
+  {
+    m_events.push_back("A " + destName);
+  }
+
+private:
+  ThreadSemaphore &m_started;
+  ThreadSemaphore &m_release;
+  std::vector<std::string> &m_events; // written on the listener thread
+  mutable bool m_held;
+};
+
+//! \brief Fill the queue under the Coalesce policy, and check that
+//!        every step is still published whole and in order.
+static bool testCoalesceOrder()
+{
+  static constexpr size_t N_STEPS = 5;
+
+  ThreadSemaphore started, release;
+  std::vector<std::string> events;
+  std::vector<std::unique_ptr<NodeImpl> > nodes;
+  for (size_t i = 1; i <= N_STEPS; ++i)
+    nodes.emplace_back(new NodeImpl(("N" + std::to_string(i)).c_str()));
+
+  ExecListenerHub hub;
+  hub.addListener(new RecordingListener(started, release, events));
+  assertTrue_1(hub.setQueue(1, ExecListenerHub::OVERFLOW_COALESCE));
+  assertTrue_1(hub.initialize());
+  assertTrue_1(hub.start());
+  assertTrue_1(hub.isAsynchronous());
+
+  for (size_t i = 1; i <= N_STEPS; ++i) {
+    std::vector<NodeTransition> transitions;
+    transitions.emplace_back(nodes[i - 1].get(), INACTIVE_STATE, WAITING_STATE);
+    hub.notifyOfTransitions(transitions);
+    hub.notifyOfAssignment(nullptr, "a" + std::to_string(i), Value((Integer) i));
+    hub.stepComplete(i);
+    // The listener thread now holds the only slot until released
+    if (i == 1)
+      started.wait();
+  }
+  // Every later step found the queue full
+  assertTrue_1(hub.getCoalescedSteps() == N_STEPS - 1);
+
+  release.post();
+  hub.flush();
+
+  std::vector<std::string> expected;
+  for (size_t i = 1; i <= N_STEPS; ++i) {
+    expected.push_back("T N" + std::to_string(i));
+    expected.push_back("A a" + std::to_string(i));
+  }
+  if (events != expected) {
+    std::cout << "testCoalesceOrder: events published out of order:";
+    for (std::string const &e : events)
+      std::cout << " [" << e << ']';
+    std::cout << std::endl;
+    return false;
+  }
+  assertTrue_1(hub.getDroppedSteps() == 0);
+
+  hub.stop();
+  std::cout << "testCoalesceOrder passed" << std::endl;
+  return true;
+}
+
+int main(int /* argc */, char ** /* argv */)
+{
+  bool success = testCoalesceOrder();
+  std::cout << "Listener hub test " << (success ? "succeeded" : "failed") << std::endl;
+  return (success ? 0 : 1);
+}
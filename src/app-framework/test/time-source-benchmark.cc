@@ -0,0 +1,164 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//
+// Measures the rate at which an application can step the Exec when
+// each step reads the time, as ExecApplication::step() and runExec()
+// do, using each StateCache time source: a lookup through the
+// Dispatcher to the time handler, a direct read of the Timebase, and
+// the fast clock.
+//
+
+#include "AdapterConfiguration.hh"
+#include "Error.hh"
+#include "FastClock.hh"
+#include "LookupHandler.hh"
+#include "LookupReceiver.hh"
+#include "PlexilExec.hh"
+#include "StateCache.hh"
+#include "Timebase.hh"
+#include "TimebaseFactory.hh"
+#include "lifecycle-utils.h"
+
+#include "pugixml.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace PLEXIL;
+
+using Clock = std::chrono::steady_clock;
+
+//! Answers lookups of the time from a Timebase, as TimeAdapter does.
+class TimebaseLookupHandler : public LookupHandler
+{
+public:
+  TimebaseLookupHandler(Timebase *tb)
+    : m_timebase(tb)
+  {
+  }
+
+  virtual void lookupNow(const State & /* state */, LookupReceiver *rcvr)
+  {
+    rcvr->update(m_timebase->getTime());
+  }
+
+private:
+  Timebase *m_timebase;
+};
+
+static double runSteps(char const *what, PlexilExec *exec,
+                       StateCache::TimeSourceFn source, size_t nSteps)
+{
+  StateCache::setTimeSource(source);
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < nSteps; ++i)
+    exec->step(StateCache::queryTime());
+  double secs = std::chrono::duration<double>(Clock::now() - start).count();
+  StateCache::setTimeSource(nullptr);
+
+  std::cout << std::left << std::setw(24) << what << std::right
+            << std::fixed << std::setprecision(1)
+            << secs * 1e9 / nSteps << " ns/step, "
+            << std::setprecision(0) << nSteps / secs << " steps/sec"
+            << std::endl;
+  return secs;
+}
+
+static void usage()
+{
+  std::cout << "Usage: time-source-benchmark [options]\n"
+            << " Options:\n"
+            << "  -h               Display this message and exit\n"
+            << "  -n <number>      Number of steps per pass (default 1000000)\n"
+            << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t nSteps = 1000000;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-h")) {
+      usage();
+      return 0;
+    }
+    else if (i + 1 < argc && !strcmp(argv[i], "-n")) {
+      long n = atol(argv[++i]);
+      if (n <= 0) {
+        std::cerr << "-n option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+      nSteps = (size_t) n;
+    }
+    else {
+      std::cerr << "Unrecognized argument " << argv[i] << std::endl;
+      usage();
+      return 1;
+    }
+  }
+
+  try {
+    Error::doThrowExceptions();
+    initTimebaseFactories();
+
+    std::unique_ptr<AdapterConfiguration> config(makeAdapterConfiguration());
+    std::unique_ptr<Timebase> timebase(makeTimebase(pugi::xml_node(), []() -> void {}));
+    config->registerLookupHandler(std::make_shared<TimebaseLookupHandler>(timebase.get()),
+                                  "time");
+
+    std::unique_ptr<PlexilExec> exec(makePlexilExec());
+    g_dispatcher = static_cast<Dispatcher *>(config.get());
+    g_exec = exec.get();
+    exec->setDispatcher(config.get());
+
+    std::cout << nSteps << " steps of an idle Exec" << std::endl;
+    double lookupSecs = runSteps("Lookup", exec.get(), nullptr, nSteps);
+    double directSecs = runSteps("Timebase", exec.get(), &Timebase::queryTime, nSteps);
+    runSteps("Clock", exec.get(), &getFastClockTime, nSteps);
+    std::cout << std::setprecision(2)
+              << "Timebase source speedup over lookup: " << lookupSecs / directSecs
+              << std::endl;
+
+    g_exec = nullptr;
+    g_dispatcher = nullptr;
+    exec.reset();
+    timebase.reset();
+    config.reset();
+    plexilRunFinalizers();
+  }
+  catch (Error const &e) {
+    std::cerr << "Aborting benchmark due to error:\n" << e << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
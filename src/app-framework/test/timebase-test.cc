@@ -29,6 +29,7 @@
 #include "InterfaceError.hh"
 #include "ThreadSemaphore.hh"
 #include "TimebaseFactory.hh"
+#include "TimerWheel.hh"
 
 #include <fstream>
 #include <iomanip> // std::fixed, std::setprecision()
@@ -206,6 +207,161 @@ static bool testTimebaseTick(std::string const &name)
   return false;
 }
 
+//! \brief Test the TimerWheel class in isolation.
+static bool testTimerWheel()
+{
+  std::cout << "testTimerWheel" << std::endl;
+  try {
+    TimerWheel wheel(0.001);
+    assertTrue_1(wheel.empty());
+    assertTrue_1(wheel.next() == 0);
+
+    // Deadlines at every level, inserted out of order
+    double const base = 1.6e9;
+    double const offsets[] = {90000.0, 0.0005, 300.0, 0.2, 20.0, 0.2005, 5e6};
+    for (double off : offsets)
+      wheel.insert(base + off);
+    assertTrue_1(wheel.size() == 7);
+    assertTrue_1(wheel.next() == base + 0.0005);
+
+    // Nothing due yet
+    assertTrue_1(wheel.expire(base) == 0);
+    // Both deadlines in the same tick, only one of them due
+    assertTrue_1(wheel.expire(base + 0.2001) == 2);
+    assertTrue_1(wheel.next() == base + 0.2005);
+    assertTrue_1(wheel.expire(base + 0.2005) == 1);
+    assertTrue_1(wheel.next() == base + 20.0);
+
+    // Cancelling is strictly before
+    assertTrue_1(wheel.removeBefore(base + 300.0) == 1);
+    assertTrue_1(wheel.next() == base + 300.0);
+
+    // A deadline later inserted near the current time precedes
+    // those placed in the higher levels earlier
+    wheel.insert(base + 250.0);
+    assertTrue_1(wheel.next() == base + 250.0);
+
+    // Jump far ahead
+    assertTrue_1(wheel.expire(base + 1e6) == 3);
+    assertTrue_1(wheel.size() == 1);
+    assertTrue_1(wheel.next() == base + 5e6);
+    wheel.clear();
+    assertTrue_1(wheel.empty());
+
+    std::cout << "testTimerWheel passed\n" << std::endl;
+    return true;
+  } catch (Error const &e) {
+    std::cerr << "*** Test error: " << e.what() << std::endl;
+  }
+
+  std::cout << "\ntestTimerWheel failed\n" << std::endl;
+  return false;
+}
+
+//! \brief Test multiple outstanding deadlines and coalescing.
+//! \param name Registered name of the timebase class to test.
+static bool testTimebaseMultipleDeadlines(std::string const &name)
+{
+  std::cout << "testTimebaseMultipleDeadlines: Testing " << name << std::endl;
+  try {
+    ThreadSemaphore testSem;
+    Timebase *tbp = nullptr;
+    // As TimeAdapter does, report only the wakeups with something due
+    WakeupFn f =
+      [&testSem, &tbp]() -> void
+      {
+        if (tbp->expireDeadlines(tbp->getTime()))
+          testSem.post();
+      };
+    std::unique_ptr<Timebase> tb {TimebaseFactory::get(name)->create(f)};
+    tbp = tb.get();
+    tb->setCoalescingSlack(0.05);
+    tb->start();
+
+    // Four deadlines, two of them within the slack of each other.
+    // The wakeup is at the earlier one, and is not delayed by the slack.
+    double const startTime = tb->getTime();
+    double const deadlines[] = {startTime + 1.5, startTime + 0.5,
+                                startTime + 1.02, startTime + 1.0};
+    for (double d : deadlines)
+      tb->addDeadline(d);
+
+    double const expected[] = {startTime + 0.5, startTime + 1.0, startTime + 1.5};
+    for (double d : expected) {
+      testSem.wait();
+      double actualTime = tb->getTime();
+      std::cout << "Wakeup for " << std::fixed << std::setprecision(6) << d
+                << " received " << actualTime - d << " seconds late" << std::endl;
+      // Should be strictly >=, but macOS can wake up early
+      assertTrue_1(geq_within_epsilon(actualTime, d));
+      assertTrue_1(actualTime < d + tb->getCoalescingSlack());
+    }
+    tb->stop();
+
+    Timebase::Statistics stats = tb->getStatistics();
+    std::cout << stats.wakeups << " wakeups, " << stats.earlyWakeups << " early, max jitter "
+              << stats.maxJitter << std::endl;
+    assertTrue_1(stats.deadlinesExpired == 4);
+    assertTrue_1(stats.wakeups - stats.earlyWakeups == 3);
+
+    std::cout << "testTimebaseMultipleDeadlines: " << name << " passed\n" << std::endl;
+    return true;
+  } catch (Error const &e) {
+    std::cerr << "*** Test error: " << e.what() << std::endl;
+  }
+
+  std::cout << "\ntestTimebaseMultipleDeadlines: " << name << " failed\n" << std::endl;
+  return false;
+}
+
+//! \brief Test replacing all outstanding deadlines at once.
+//! \param name Registered name of the timebase class to test.
+static bool testTimebaseSetDeadlines(std::string const &name)
+{
+  std::cout << "testTimebaseSetDeadlines: Testing " << name << std::endl;
+  try {
+    ThreadSemaphore testSem;
+    Timebase *tbp = nullptr;
+    WakeupFn f =
+      [&testSem, &tbp]() -> void
+      {
+        if (tbp->expireDeadlines(tbp->getTime()))
+          testSem.post();
+      };
+    std::unique_ptr<Timebase> tb {TimebaseFactory::get(name)->create(f)};
+    tbp = tb.get();
+    tb->start();
+
+    // The first deadline is replaced before it is due
+    double const startTime = tb->getTime();
+    tb->addDeadline(startTime + 0.3);
+    std::vector<double> const deadlines = {startTime + 0.8, startTime + 0.5};
+    tb->setDeadlines(deadlines);
+
+    double const expected[] = {startTime + 0.5, startTime + 0.8};
+    for (double d : expected) {
+      testSem.wait();
+      double actualTime = tb->getTime();
+      std::cout << "Wakeup for " << std::fixed << std::setprecision(6) << d
+                << " received " << actualTime - d << " seconds late" << std::endl;
+      // Should be strictly >=, but macOS can wake up early
+      assertTrue_1(geq_within_epsilon(actualTime, d));
+    }
+    tb->stop();
+
+    Timebase::Statistics stats = tb->getStatistics();
+    assertTrue_1(stats.deadlinesExpired == 2);
+
+    std::cout << "testTimebaseSetDeadlines: " << name << " passed\n" << std::endl;
+    return true;
+  } catch (Error const &e) {
+    std::cerr << "*** Test error: " << e.what() << std::endl;
+  }
+
+  std::cout << "\ntestTimebaseSetDeadlines: " << name << " failed\n" << std::endl;
+  return false;
+}
+
 int main(int argc, char *argv[])
 {
   // Read Debug.cfg in current directory, if it exists
@@ -238,6 +394,18 @@ int main(int argc, char *argv[])
     success = success && testTimebaseDeadlines(name);
   }
 
+  success = success && testTimerWheel();
+
+  std::cout << "Testing multiple deadlines" << std::endl;
+  for (std::string const &name : timebaseNames) {
+    success = success && testTimebaseMultipleDeadlines(name);
+  }
+
+  std::cout << "Testing replaced deadlines" << std::endl;
+  for (std::string const &name : timebaseNames) {
+    success = success && testTimebaseSetDeadlines(name);
+  }
+
   std::cout << "Testing tick timers" << std::endl;
   for (std::string const &name : timebaseNames) {
     success = success && testTimebaseTick(name);
@@ -28,6 +28,7 @@
 #include "Debug.hh"
 #include "Error.hh"
 #include "ExecListenerHub.hh"
+#include "Function.hh"
 #include "lifecycle-utils.h"
 #include "Logging.hh"
 #include "NodeImpl.hh"
@@ -84,7 +85,9 @@ int run(int argc, char** argv)
                         [-d <debug_config_file>] (default ./Debug.cfg)\n\
                         [+d]                     (disable debug messages)\n\
                         [-r <resource_file>]     (default ./resource.data)\n\
-                        [+r]                     (don't read resource data)\n");
+                        [+r]                     (don't read resource data)\n\
+                        [-t <n>]                 (condition check threads, default 1)\n\
+                        [-e]                     (lazy expression evaluation)\n");
 
 #ifdef HAVE_LUV_LISTENER
   string luvHost = LUV_DEFAULT_HOSTNAME;
@@ -98,6 +101,8 @@ int run(int argc, char** argv)
   bool useDebugConfig = true;
   bool resourceFileSupplied = false;
   bool useResourceFile = true;
+  unsigned int conditionCheckThreads = 1;
+  bool lazyEvaluation = false;
 
   // if not enough parameters, print usage
 
@@ -194,6 +199,17 @@ int run(int argc, char** argv)
       useResourceFile = true;
       resourceFileSupplied = true;
     }
+    else if (strcmp(argv[i], "-t") == 0) {
+      if (argc == (++i)) {
+        warn("Missing argument to the " << argv[i-1] << " option.\n"
+             << usage);
+        return 2;
+      }
+      std::istringstream buffer(argv[i]);
+      buffer >> conditionCheckThreads;
+    }
+    else if (strcmp(argv[i], "-e") == 0)
+      lazyEvaluation = true;
     else if (strcmp(argv[i], "+r") == 0) {
       if (resourceFileSupplied) {
         warn("Both -r and +r options specified.\n"
@@ -295,6 +311,8 @@ int run(int argc, char** argv)
   if (useResourceFile) {
     g_exec->getArbiter()->readResourceHierarchyFile(resourceFile);
   }
+  g_exec->setConditionCheckThreads(conditionCheckThreads);
+  Function::setLazyEvaluation(lazyEvaluation);
 
 
 #ifdef HAVE_DEBUG_LISTENER
@@ -26,6 +26,7 @@
 #ifndef PLEXIL_ASSIGNMENT_HH
 #define PLEXIL_ASSIGNMENT_HH
 
+#include "PlanArena.hh"
 #include "SimpleBooleanVariable.hh"
 #include "Value.hh"
 
@@ -36,7 +37,7 @@ namespace PLEXIL
   class Assignable;
   class ExecListenerBase;
 
-  class Assignment final
+  class Assignment final : public ArenaAllocated
   {
   public:
     //! \brief Default constructor.
@@ -0,0 +1,165 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "ConditionCheckPool.hh"
+
+#ifdef PLEXIL_WITH_THREADS
+
+#include "Debug.hh"
+#include "Error.hh"
+#include "Node.hh"
+
+#include <algorithm> // std::min()
+
+namespace PLEXIL
+{
+
+  //! Number of candidates claimed by a thread at one time.
+  static constexpr size_t CHUNK_SIZE = 16;
+
+  ConditionCheckPool::ConditionCheckPool(unsigned int nThreads)
+    : m_threads(),
+      m_mutex(),
+      m_startCv(),
+      m_doneCv(),
+      m_error(),
+      m_batch(nullptr),
+      m_results(nullptr),
+      m_nextIndex(0),
+      m_errorIndex(0),
+      m_generation(0),
+      m_busy(0),
+      m_stop(false)
+  {
+    assertTrue_2(nThreads > 1,
+                 "ConditionCheckPool: thread count must be at least 2");
+    // The calling thread does its share of the work
+    m_threads.reserve(nThreads - 1);
+    for (unsigned int i = 1; i < nThreads; ++i)
+      m_threads.emplace_back([this]() -> void { this->worker(); });
+    debugMsg("ConditionCheckPool", " started " << m_threads.size() << " worker threads");
+  }
+
+  ConditionCheckPool::~ConditionCheckPool()
+  {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_stop = true;
+    }
+    m_startCv.notify_all();
+    for (std::thread &t : m_threads)
+      t.join();
+    debugMsg("ConditionCheckPool", " stopped");
+  }
+
+  unsigned int ConditionCheckPool::size() const
+  {
+    return m_threads.size() + 1;
+  }
+
+  void ConditionCheckPool::evaluate(std::vector<Node *> const &candidates,
+                                    std::vector<uint8_t> &results)
+  {
+    results.resize(candidates.size());
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_batch = &candidates;
+      m_results = &results;
+      m_nextIndex = 0;
+      m_error = nullptr;
+      m_errorIndex = candidates.size();
+      m_busy = m_threads.size();
+      ++m_generation;
+    }
+    m_startCv.notify_all();
+
+    work();
+
+    std::exception_ptr error;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_doneCv.wait(lock, [this]() -> bool { return !m_busy; });
+      m_batch = nullptr;
+      m_results = nullptr;
+      error = m_error;
+      m_error = nullptr;
+    }
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  void ConditionCheckPool::worker()
+  {
+    unsigned int generation = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_startCv.wait(lock,
+                       [this, generation]() -> bool
+                       { return m_stop || m_generation != generation; });
+        if (m_stop)
+          return;
+        generation = m_generation;
+      }
+
+      work();
+
+      {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (!--m_busy)
+          m_doneCv.notify_one();
+      }
+    }
+  }
+
+  void ConditionCheckPool::work()
+  {
+    std::vector<Node *> const &batch = *m_batch;
+    std::vector<uint8_t> &results = *m_results;
+    size_t const n = batch.size();
+    while (true) {
+      size_t i = m_nextIndex.fetch_add(CHUNK_SIZE);
+      if (i >= n)
+        return;
+      size_t const end = std::min(i + CHUNK_SIZE, n);
+      for (; i < end; ++i) {
+        try {
+          results[i] = batch[i]->getDestState();
+        }
+        catch (...) {
+          results[i] = false;
+          std::lock_guard<std::mutex> guard(m_mutex);
+          if (i < m_errorIndex) {
+            m_error = std::current_exception();
+            m_errorIndex = i;
+          }
+        }
+      }
+    }
+  }
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_WITH_THREADS
@@ -0,0 +1,120 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PLEXIL_CONDITION_CHECK_POOL_HH
+#define PLEXIL_CONDITION_CHECK_POOL_HH
+
+#include "plexil-config.h"
+
+#ifdef PLEXIL_WITH_THREADS
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace PLEXIL
+{
+
+  // Forward reference
+  class Node;
+
+  //! \class ConditionCheckPool
+  //! \brief A fixed-size pool of worker threads which evaluate
+  //!        Node::getDestState() for a batch of candidate nodes.
+  //!
+  //! The pool only computes each candidate's next state.  The caller
+  //! is responsible for acting on the results, in the order of the
+  //! batch, so that the Exec's queues are updated exactly as they
+  //! would be by serial evaluation.
+  //!
+  //! \note Node::getDestState() only writes the node's own
+  //!       next-state fields, and only reads expression values, so
+  //!       distinct nodes may be evaluated concurrently as long as no
+  //!       node is transitioning.
+  //! \ingroup Exec-Core
+  class ConditionCheckPool final
+  {
+  public:
+
+    //! \brief Constructor.
+    //! \param nThreads Total number of threads to use, including the
+    //!                 calling thread.  Must be at least 2.
+    ConditionCheckPool(unsigned int nThreads);
+
+    //! \brief Destructor.  Stops and joins the worker threads.
+    ~ConditionCheckPool();
+
+    //! \brief Get the total number of threads used, including the caller.
+    //! \return The number of threads.
+    unsigned int size() const;
+
+    //! \brief Call getDestState() on every node in the batch.
+    //! \param candidates The nodes to evaluate.
+    //! \param results Vector to receive the results, in the same
+    //!                order as candidates.
+    //! \note If any evaluation throws an exception, the exception
+    //!       thrown by the earliest node in the batch is rethrown to
+    //!       the caller after all evaluations are complete.
+    void evaluate(std::vector<Node *> const &candidates,
+                  std::vector<uint8_t> &results);
+
+  private:
+
+    // Not implemented
+    ConditionCheckPool() = delete;
+    ConditionCheckPool(ConditionCheckPool const &) = delete;
+    ConditionCheckPool(ConditionCheckPool &&) = delete;
+    ConditionCheckPool &operator=(ConditionCheckPool const &) = delete;
+    ConditionCheckPool &operator=(ConditionCheckPool &&) = delete;
+
+    //! \brief The top level of each worker thread.
+    void worker();
+
+    //! \brief Evaluate chunks of the current batch until none remain.
+    void work();
+
+    std::vector<std::thread> m_threads;    //!< The worker threads.
+    std::mutex m_mutex;                    //!< Guards the members below.
+    std::condition_variable m_startCv;     //!< Signals workers that a batch is ready.
+    std::condition_variable m_doneCv;      //!< Signals the caller that workers are done.
+    std::exception_ptr m_error;            //!< First exception caught in this batch.
+    std::vector<Node *> const *m_batch;    //!< The batch being evaluated.
+    std::vector<uint8_t> *m_results;       //!< Where the results go.
+    std::atomic<size_t> m_nextIndex;       //!< Index of next unclaimed chunk.
+    size_t m_errorIndex;                   //!< Batch index of m_error.
+    unsigned int m_generation;             //!< Incremented for every batch.
+    unsigned int m_busy;                   //!< Workers still processing this batch.
+    bool m_stop;                           //!< True when the pool is shutting down.
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_WITH_THREADS
+
+#endif // PLEXIL_CONDITION_CHECK_POOL_HH
@@ -80,6 +80,12 @@ namespace PLEXIL
     //!        may publish transitions and assignments.
     virtual void stepComplete(unsigned int cycleNum) = 0;
 
+    //! \brief Wait until every event reported so far has been
+    //!        published.
+    //! \note Called by the Exec before deleting finished plans, as
+    //!       the listener may still refer to their nodes.
+    virtual void flush() = 0;
+
   };
 
 }
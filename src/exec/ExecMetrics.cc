@@ -0,0 +1,108 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "ExecMetrics.hh"
+
+#include <ostream>
+
+namespace PLEXIL
+{
+
+  ExecMetrics::ExecMetrics()
+  {
+    reset();
+  }
+
+  void ExecMetrics::reset()
+  {
+    steps = 0;
+    lastStepTime = 0;
+    maxStepTime = 0;
+    totalStepTime = 0;
+    totalMicroSteps = 0;
+    lastMicroSteps = 0;
+    maxMicroSteps = 0;
+    totalTransitions = 0;
+    lastTransitions = 0;
+    maxTransitions = 0;
+    maxCandidateQueue = 0;
+    maxStateChangeQueue = 0;
+    maxPendingQueue = 0;
+    conditionChecks = 0;
+    pendingScans = 0;
+    resourceAttempts = 0;
+    assignments = 0;
+    retractions = 0;
+    commands = 0;
+    commandsRejected = 0;
+    aborts = 0;
+    updates = 0;
+    functionEvaluations = 0;
+    functionEvaluationsSaved = 0;
+  }
+
+  double ExecMetrics::meanStepTime() const
+  {
+    if (!steps)
+      return 0;
+    return totalStepTime / steps;
+  }
+
+  void ExecMetrics::print(std::ostream &s) const
+  {
+    s << "Exec metrics:\n"
+      << " Macro steps: " << steps
+      << ", last " << lastStepTime
+      << " s, mean " << meanStepTime()
+      << " s, max " << maxStepTime << " s\n"
+      << " Micro steps: " << totalMicroSteps
+      << ", last " << lastMicroSteps
+      << ", max " << maxMicroSteps << '\n'
+      << " Transitions: " << totalTransitions
+      << ", last " << lastTransitions
+      << ", max " << maxTransitions << '\n'
+      << " Queue high-water marks: candidate " << maxCandidateQueue
+      << ", state change " << maxStateChangeQueue
+      << ", pending " << maxPendingQueue << '\n'
+      << " Condition checks: " << conditionChecks << '\n'
+      << " Pending nodes examined: " << pendingScans
+      << ", resource acquisition attempts " << resourceAttempts << '\n'
+      << " Assignments: " << assignments
+      << ", retractions " << retractions << '\n'
+      << " Commands: " << commands
+      << ", rejected " << commandsRejected
+      << ", aborts " << aborts << '\n'
+      << " Updates: " << updates << '\n'
+      << " Function evaluations: " << functionEvaluations
+      << ", saved " << functionEvaluationsSaved << '\n';
+  }
+
+  std::ostream &operator<<(std::ostream &stream, ExecMetrics const &m)
+  {
+    m.print(stream);
+    return stream;
+  }
+
+} // namespace PLEXIL
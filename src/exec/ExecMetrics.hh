@@ -0,0 +1,125 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PLEXIL_EXEC_METRICS_HH
+#define PLEXIL_EXEC_METRICS_HH
+
+#include <cstddef> // size_t
+#include <cstdint>
+#include <iosfwd>
+
+namespace PLEXIL
+{
+
+  //! \struct ExecMetrics
+  //! \brief Counters and high-water marks describing the work done
+  //!        by the PlexilExec.
+  //!
+  //! "Last" values describe the most recent macro step.  "Max"
+  //! values are the worst case since the last reset.  Everything
+  //! else is a running total since the last reset.
+  //!
+  //! \see PlexilExec::getMetrics
+  //! \ingroup Exec-Core
+  struct ExecMetrics final
+  {
+    //
+    // Macro steps
+    //
+
+    uint64_t steps;              //!< Macro steps run.
+    double   lastStepTime;       //!< Wall time of the most recent macro step, in seconds.
+    double   maxStepTime;        //!< Longest macro step, in seconds.
+    double   totalStepTime;      //!< Sum of all macro step times, in seconds.
+
+    //
+    // Micro steps, i.e. iterations of the quiescence loop
+    //
+
+    uint64_t totalMicroSteps;    //!< Micro steps run.
+    size_t   lastMicroSteps;     //!< Micro steps in the most recent macro step.
+    size_t   maxMicroSteps;      //!< Most micro steps in any macro step.
+
+    //
+    // Node state transitions
+    //
+
+    uint64_t totalTransitions;   //!< Node state transitions performed.
+    size_t   lastTransitions;    //!< Transitions in the most recent macro step.
+    size_t   maxTransitions;     //!< Most transitions in any macro step.
+
+    //
+    // Queue high-water marks
+    //
+
+    size_t   maxCandidateQueue;   //!< Largest candidate queue at the start of a micro step.
+    size_t   maxStateChangeQueue; //!< Largest state change queue at the start of transitions.
+    size_t   maxPendingQueue;     //!< Largest pending queue after resource conflict resolution.
+
+    //
+    // Side effects dispatched
+    //
+
+    uint64_t conditionChecks;    //!< Calls to Node::getDestState() on candidate nodes.
+    uint64_t pendingScans;       //!< Pending queue nodes examined by resource conflict resolution.
+    uint64_t resourceAttempts;   //!< Calls to Node::tryResourceAcquisition().
+    uint64_t assignments;        //!< Assignments executed.
+    uint64_t retractions;        //!< Assignments retracted.
+    uint64_t commands;           //!< Commands sent to the dispatcher for execution.
+    uint64_t commandsRejected;   //!< Commands denied by the resource arbiter.
+    uint64_t aborts;             //!< Command aborts requested.
+    uint64_t updates;            //!< Planner updates sent.
+
+    //
+    // Lazy expression evaluation
+    //
+
+    uint64_t functionEvaluations;      //!< Function results computed while lazy evaluation was enabled.
+    uint64_t functionEvaluationsSaved; //!< Cached Function results reused instead of computed.
+
+    //! \brief Default constructor.  All values are zero.
+    ExecMetrics();
+
+    //! \brief Reset all values to zero.
+    void reset();
+
+    //! \brief Get the mean wall time per macro step.
+    //! \return The mean time in seconds; 0 if no steps have run.
+    double meanStepTime() const;
+
+    //! \brief Print the metrics in human-readable form.
+    //! \param stream The stream to print to.
+    void print(std::ostream &stream) const;
+  };
+
+  //! \brief Formatted output operator for ExecMetrics.
+  //! \param stream Reference to an output stream.
+  //! \param m Const reference to the metrics.
+  //! \return Reference to the stream.
+  std::ostream &operator<<(std::ostream &stream, ExecMetrics const &m);
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_EXEC_METRICS_HH
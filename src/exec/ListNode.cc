@@ -42,6 +42,7 @@ namespace PLEXIL
   //! \class AllFinished
   //! \brief A specialized NodeOperator for ListNode which returns true
   //!        when all child nodes are in FINISHED node state.
+  //! \note Reads the ListNode's child state counts, so is constant time.
   //! \see ListNode::specializedCreateConditionWrappers
   //! \ingroup Exec-Core
   class AllFinished : public NodeOperatorImpl<Boolean>
@@ -60,15 +61,8 @@ namespace PLEXIL
     //! \note The result of this operator is always known.
     bool operator()(Boolean &result, NodeImpl const *node) const override
     {
-      for (NodeImplPtr const &child : node->getChildren()) {
-        if (child->getState() != FINISHED_STATE) {
-          result = false;
-          debugMsg("AllFinished", "result = false");
-          return true;
-        }
-      }
-      debugMsg("AllFinished", "result = true");
-      result = true;
+      result = static_cast<ListNode const *>(node)->allChildrenFinished();
+      debugMsg("AllFinished", "result = " << (result ? "true" : "false"));
       return true; // always known
     }
 
@@ -101,6 +95,7 @@ namespace PLEXIL
   //! \class AllWaitingOrFinished
   //! \brief A specialized NodeOperator for ListNode which returns true
   //!        when all child nodes are in either WAITING or FINISHED node state.
+  //! \note Reads the ListNode's child state counts, so is constant time.
   //! \see ListNode::specializedCreateConditionWrappers
   //! \ingroup Exec-Core
   //! \ingroup Expression
@@ -120,20 +115,8 @@ namespace PLEXIL
     //! \note The result of this operator is always known.
     bool operator()(Boolean &result, NodeImpl const *node) const override
     {
-      for (NodeImplPtr const &child : node->getChildren()) {
-        switch (child->getState()) {
-        case WAITING_STATE:
-        case FINISHED_STATE:
-          break;
-
-        default:
-          result = false;
-          debugMsg("AllWaitingOrFinished", " result = false");
-          return true;
-        }
-      }
-      result = true;
-      debugMsg("AllWaitingOrFinished", " result = true");
+      result = static_cast<ListNode const *>(node)->allChildrenWaitingOrFinished();
+      debugMsg("AllWaitingOrFinished", " result = " << (result ? "true" : "false"));
       return true; // always known
     }
 
@@ -169,7 +152,9 @@ namespace PLEXIL
   ListNode::ListNode(char const *nodeId, NodeImpl *parent)
     : NodeImpl(nodeId, parent),
       m_actionCompleteFn(AllWaitingOrFinished::instance(), this),
-      m_allFinishedFn(AllFinished::instance(), this)
+      m_allFinishedFn(AllFinished::instance(), this),
+      m_waitingChildren(0),
+      m_finishedChildren(0)
   {
   }
 
@@ -179,7 +164,9 @@ namespace PLEXIL
                      NodeImpl *parent)
     : NodeImpl(type, name, state, parent),
       m_actionCompleteFn(AllWaitingOrFinished::instance(), this),
-      m_allFinishedFn(AllFinished::instance(), this)
+      m_allFinishedFn(AllFinished::instance(), this),
+      m_waitingChildren(0),
+      m_finishedChildren(0)
   {
     checkError(type == LIST || type == LIBRARYNODECALL,
                "Invalid node type " << type << " for a ListNode");
@@ -365,6 +352,8 @@ namespace PLEXIL
     for (NodeImplPtr &child : m_children)
       delete (Node*) child.release();
     m_children.clear();
+    m_waitingChildren = 0;
+    m_finishedChildren = 0;
     m_cleanedBody = true;
   }
 
@@ -401,6 +390,37 @@ namespace PLEXIL
   void ListNode::addChild(NodeImpl *node)
   {
     m_children.emplace_back(NodeImplPtr(node));
+    node->m_countedByParent = true;
+    childStateChanged(NO_NODE_STATE, node->getState());
+  }
+
+  void ListNode::childStateChanged(NodeState oldState, NodeState newState)
+  {
+    switch (oldState) {
+    case WAITING_STATE:
+      --m_waitingChildren;
+      break;
+
+    case FINISHED_STATE:
+      --m_finishedChildren;
+      break;
+
+    default:
+      break;
+    }
+
+    switch (newState) {
+    case WAITING_STATE:
+      ++m_waitingChildren;
+      break;
+
+    case FINISHED_STATE:
+      ++m_finishedChildren;
+      break;
+
+    default:
+      break;
+    }
   }
 
   void ListNode::setState(PlexilExec *exec, NodeState newValue, double tym)
@@ -99,6 +99,20 @@ namespace PLEXIL
     //! \note For use by parsers. An optional optimization.
     void reserveChildren(size_t n);
 
+    //! \brief Are all the children of this node in FINISHED state?
+    //! \return True if so, false otherwise.
+    bool allChildrenFinished() const
+    {
+      return m_finishedChildren == m_children.size();
+    }
+
+    //! \brief Are all the children of this node in WAITING or FINISHED state?
+    //! \return True if so, false otherwise.
+    bool allChildrenWaitingOrFinished() const
+    {
+      return m_waitingChildren + m_finishedChildren == m_children.size();
+    }
+
     //! \brief Get the name -> variable mapping that children of this node should reference.
     //! \return Const pointer to a variable map; may be null.
     virtual NodeVariableMap const *getChildVariableMap() const override;
@@ -116,6 +130,11 @@ namespace PLEXIL
     //! \brief Create any condition wrapper expressions appropriate to the node type.
     virtual void specializedCreateConditionWrappers() override;
 
+    //! \brief Update the child state counts for a change in a child's state.
+    //! \param oldState The child's previous state.
+    //! \param newState The child's new state.
+    virtual void childStateChanged(NodeState oldState, NodeState newState) override;
+
     //! \brief Perform activations appropriate to the node type.
     virtual void specializedActivate() override;
 
@@ -174,6 +193,12 @@ namespace PLEXIL
     //! \note Shared with derived class LibraryCallNode
     std::vector<NodeImplPtr> m_children;
 
+    //! \brief The number of children in WAITING state.
+    size_t m_waitingChildren;
+
+    //! \brief The number of children in FINISHED state.
+    size_t m_finishedChildren;
+
   private:
 
     //! \brief Clean up the conditions of any child nodes.
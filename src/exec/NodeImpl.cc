@@ -154,6 +154,7 @@ namespace PLEXIL
       m_nextState(NO_NODE_STATE),
       m_nextOutcome(NO_OUTCOME),
       m_nextFailureType(NO_FAILURE),
+      m_countedByParent(false),
       m_parent(parent),
       m_conditions(),
       m_localVariables(),
@@ -191,6 +192,7 @@ namespace PLEXIL
       m_nextState(NO_NODE_STATE),
       m_nextOutcome(NO_OUTCOME),
       m_nextFailureType(NO_FAILURE),
+      m_countedByParent(false),
       m_parent(parent),
       m_conditions(),
       m_localVariables(),
@@ -302,6 +304,10 @@ namespace PLEXIL
     return nullptr; // this node has no children
   }
 
+  void NodeImpl::childStateChanged(NodeState /* oldState */, NodeState /* newState */)
+  {
+  }
+
   bool NodeImpl::addLocalVariable(char const *name, Expression *var)
   {
     assertTrueMsg(m_localVariables && m_variablesByName,
@@ -583,6 +589,7 @@ namespace PLEXIL
 
     case QUEUE_PENDING:           // will be checked while on pending queue
       m_queueStatus = QUEUE_PENDING_CHECK;
+      exec->notifyPendingNode(this);
       debugMsg("Node:notifyChanged",
                " pending node " << m_nodeId << ' ' << this
                << " will be rechecked");
@@ -711,6 +718,7 @@ namespace PLEXIL
 
     case QUEUE_PENDING:
       m_queueStatus = QUEUE_PENDING_TRY;
+      g_exec->notifyPendingNode(this);
       debugMsg("Node:notifyResourceAvailable",
                ' ' << m_nodeId << ' ' << this << " will retry resource acquisition");
       return;
@@ -783,10 +791,12 @@ namespace PLEXIL
     if (m_nextState == m_state)
       return;
 
-    debugMsg("Node:transition", " Transitioning " << m_nodeId << ' ' << this
-             << " from " << nodeStateName(m_state)
-             << " to " << nodeStateName(m_nextState)
-             << " at " << std::setprecision(15) << time);
+    debugTraceMsg("Node:transition",
+                  " Transitioning " << m_nodeId << ' ' << this
+                  << " from " << nodeStateName(m_state)
+                  << " to " << nodeStateName(m_nextState)
+                  << " at " << std::setprecision(15) << time,
+                  this, m_state, m_nextState, time);
 
     // Transition out of current state
     switch (m_state) {
@@ -1481,6 +1491,8 @@ namespace PLEXIL
       return;
     assertTrue_1(exec);
     logTransition(tym, newValue);
+    if (m_countedByParent)
+      m_parent->childStateChanged((NodeState) m_state, newValue);
     m_state = newValue;
     if (m_state == FINISHED_STATE && !m_parent)
       // Mark this node as ready to be deleted -
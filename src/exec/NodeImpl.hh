@@ -156,7 +156,8 @@ namespace PLEXIL
     //
     
     //! \brief Notify this object of a change.
-    virtual void notifyChanged() override;
+    //! \note Final; node condition notifications are a hot path.
+    virtual void notifyChanged() final;
 
     //
     // Listenable API
@@ -585,6 +586,13 @@ namespace PLEXIL
     //! \note This default method always returns null.
     virtual NodeVariableMap const *getChildVariableMap() const;
 
+    //! \brief Account for a change in the state of a child node.
+    //! \param oldState The child's previous state.
+    //! \param newState The child's new state.
+    //! \note Called from setState() on the child.
+    //! \note This default method does nothing.
+    virtual void childStateChanged(NodeState oldState, NodeState newState);
+
     //! \brief Perform common initializations used by both constructors.
     void commonInit();
 
@@ -831,6 +839,7 @@ namespace PLEXIL
     NodeState    m_nextState;           //!< The state returned by getDestState() the last time checkConditions() was called.
     NodeOutcome  m_nextOutcome;         //!< The pending outcome.
     FailureType  m_nextFailureType;     //!< The pending failure.
+    bool         m_countedByParent;     //!< True if the parent's child state counts include this node.
 
     NodeImpl    *m_parent;                          //!< The parent of this node.*/
     Expression  *m_conditions[conditionIndexMax]; //!< The condition expressions.
@@ -26,36 +26,80 @@
 #ifndef PLEXIL_NODE_TRANSITION_HH
 #define PLEXIL_NODE_TRANSITION_HH
 
-#include "NodeConstants.hh" // for NodeState type
+#include "NodeConstants.hh" // for NodeState, NodeOutcome, FailureType
+#include "Value.hh"
+
+#include <string>
+#include <utility> // std::pair
+#include <vector>
 
 namespace PLEXIL
 {
   // Forward declarations
   class Node;
 
+  //! \struct NodeTransitionSnapshot
+  //! \brief Node data copied at the end of a step, for listeners which
+  //!        are called after the Exec has moved on.
+  //! \see ExecListenerHub
+  //! \ingroup Exec-Core
+  struct NodeTransitionSnapshot final
+  {
+    //! Node IDs of the node and its ancestors, root first.
+    std::vector<std::string> nodePath;
+
+    //! Index and value of each condition the node has, in index order.
+    std::vector<std::pair<size_t, Value>> conditions;
+  };
+
   //! \struct NodeTransition
   //! \brief A data structure for recording or reporting node state transitions.
   //! \see ExecListener
   //! \ingroup Exec-Core
   struct NodeTransition final
   {
-    Node *node;          //!< The Node being transitioned.
-    NodeState oldState;  //!< The previous state of the Node.
-    NodeState newState;  //!< The new state of the Node.
+    Node *node;              //!< The Node being transitioned.
+    NodeTransitionSnapshot const *snapshot; //!< Copied node data; null when the listener is called synchronously.
+    double time;             //!< The time the Node entered the new state.
+    NodeState oldState;      //!< The previous state of the Node.
+    NodeState newState;      //!< The new state of the Node.
+    NodeOutcome outcome;     //!< The outcome of the Node after the transition.
+    FailureType failureType; //!< The failure type of the Node after the transition.
 
     //! \brief Default constructor.
     NodeTransition()
       : node(),
+        snapshot(),
+        time(0),
         oldState(INACTIVE_STATE),
-        newState(INACTIVE_STATE)
+        newState(INACTIVE_STATE),
+        outcome(NO_OUTCOME),
+        failureType(NO_FAILURE)
     {
     }
 
     //! \brief Trivial constructor
     NodeTransition(Node *nod, NodeState oldStat, NodeState newStat)
       : node(nod),
+        snapshot(),
+        time(0),
+        oldState(oldStat),
+        newState(newStat),
+        outcome(NO_OUTCOME),
+        failureType(NO_FAILURE)
+    {
+    }
+
+    //! \brief Constructor recording the node's status after the transition.
+    NodeTransition(Node *nod, NodeState oldStat, NodeState newStat,
+                   NodeOutcome outc, FailureType fail, double tym)
+      : node(nod),
+        snapshot(),
+        time(tym),
         oldState(oldStat),
-        newState(newStat)
+        newState(newStat),
+        outcome(outc),
+        failureType(fail)
     {
     }
 
@@ -26,6 +26,7 @@
 #ifndef PLEXIL_NODE_VARIABLE_MAP_HH
 #define PLEXIL_NODE_VARIABLE_MAP_HH
 
+#include "PlanArena.hh"
 #include "SimpleMap.hh"
 #include "map-utils.hh"
 
@@ -40,7 +41,8 @@ namespace PLEXIL
   //!        within a node.  Has a link to the parent node for recursive lookup.
   //! \ingroup Exec-Core
   class NodeVariableMap final:
-    public SimpleMap<char const *, Expression *, CStringComparator>
+    public SimpleMap<char const *, Expression *, CStringComparator>,
+    public ArenaAllocated
   {
   public:
 
@@ -27,10 +27,13 @@
 
 #include "Assignment.hh"
 #include "CommandImpl.hh"
+#include "ConditionCheckPool.hh" // includes plexil-config.h
 #include "Debug.hh"
 #include "Dispatcher.hh"
 #include "Error.hh"
 #include "ExecListenerBase.hh"
+#include "ExecMetrics.hh"
+#include "Function.hh"
 #include "LinkedQueue.hh"
 #include "Mutex.hh"
 #include "Node.hh"
@@ -41,6 +44,14 @@
 #include "Variable.hh"
 
 #include <algorithm> // std::remove_if()
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#ifdef PLEXIL_WITH_THREADS
+#include <memory>   // std::unique_ptr
+#endif
 
 namespace PLEXIL 
 {
@@ -63,6 +74,27 @@ namespace PLEXIL
     }
   };
 
+  //! \brief A node on the pending queue which needs attention from
+  //!        resource conflict resolution.
+  struct PendingWakeup
+  {
+    Node *node;        //!< The node.
+    int32_t priority;  //!< The node's priority.
+    uint64_t sequence; //!< Order of insertion into the pending queue.
+  };
+
+  //! \brief Comparison functor for a heap of PendingWakeup, putting
+  //!        them in pending queue order.
+  struct PendingWakeupCompare
+  {
+    bool operator() (PendingWakeup const &x, PendingWakeup const &y) const
+    {
+      if (x.priority != y.priority)
+        return x.priority > y.priority;
+      return x.sequence > y.sequence;
+    }
+  };
+
   //! \class PlexilExecImpl
   //! \brief Implements the PlexilExec API.
   //! \ingroup Exec-Core
@@ -82,6 +114,11 @@ namespace PLEXIL
     LinkedQueue<Node> m_stateChangeQueue;                //!< Nodes actively transitioning.
     PriorityQueue<Node, PriorityCompare> m_pendingQueue; //!< Nodes eligible to transition, but
                                                          //!< waiting on resources in use.
+    std::vector<Node *> m_pendingWakeups;                //!< Pending nodes whose queue status
+                                                         //!< changed since they were last examined.
+    std::vector<PendingWakeup> m_pendingHeap;            //!< Working storage for resolveResourceConflicts.
+    std::unordered_map<Node const *, uint64_t> m_pendingSequence; //!< Pending queue insertion order.
+    uint64_t m_nextPendingSequence;                      //!< Next pending queue insertion number.
 
     // Output queues
     LinkedQueue<Assignment>  m_assignmentsToExecute; //!< Assignments to be executed.
@@ -98,8 +135,28 @@ namespace PLEXIL
     Dispatcher                                *m_dispatcher;  //!< The external interface.
     ExecListenerBase                          *m_listener;    //!< The Exec listener.
 
-    // Flag
+    // Instrumentation
+    ExecMetrics m_metrics; //!< Counters and high-water marks.
+
+#ifdef PLEXIL_WITH_THREADS
+    // Parallel condition evaluation
+    std::unique_ptr<ConditionCheckPool> m_conditionCheckPool; //!< Null if evaluation is serial.
+    std::vector<Node *> m_candidateBatch;  //!< Candidates drained from the queue.
+    std::vector<uint8_t> m_candidateResults; //!< Results of getDestState() on each.
+#endif
+
+    // Flags
     bool m_finishedRootNodesDeleted; //!< True if at least one finished plan has been deleted */
+#ifdef PLEXIL_WITH_THREADS
+    bool m_reportedSerialChecks; //!< True once the user has been told parallel evaluation is off.
+#endif
+
+#ifdef PLEXIL_WITH_THREADS
+    //! \brief Minimum number of candidates for which evaluation is
+    //!        handed to the condition check pool.  Smaller batches
+    //!        are evaluated serially.
+    static constexpr size_t PARALLEL_CHECK_MIN_CANDIDATES = 64;
+#endif
 
   public:
 
@@ -113,6 +170,10 @@ namespace PLEXIL
         m_candidateQueue(),
         m_stateChangeQueue(),
         m_pendingQueue(),
+        m_pendingWakeups(),
+        m_pendingHeap(),
+        m_pendingSequence(),
+        m_nextPendingSequence(0),
         m_assignmentsToExecute(),
         m_assignmentsToRetract(),
         m_commandsToExecute(),
@@ -123,7 +184,16 @@ namespace PLEXIL
         m_arbiter(makeResourceArbiter()),
         m_dispatcher(),
         m_listener(),
+        m_metrics(),
+#ifdef PLEXIL_WITH_THREADS
+        m_conditionCheckPool(),
+        m_candidateBatch(),
+        m_candidateResults(),
+#endif
         m_finishedRootNodesDeleted(false)
+#ifdef PLEXIL_WITH_THREADS
+      , m_reportedSerialChecks(false)
+#endif
     {}
 
     //! \brief Virtual destructor.
@@ -133,6 +203,8 @@ namespace PLEXIL
       m_stateChangeQueue.clear();
       m_finishedRootNodes.clear();
       m_pendingQueue.clear();
+      m_pendingWakeups.clear();
+      m_pendingSequence.clear();
       m_transitionsToPublish.clear(),
       m_assignmentsToExecute.clear();
       m_assignmentsToRetract.clear();
@@ -169,6 +241,37 @@ namespace PLEXIL
       return m_listener;
     }
 
+    //! \brief Set the number of threads used to evaluate the
+    //!        conditions of candidate nodes.
+    //! \param n The number of threads.  0 or 1 selects serial evaluation.
+    virtual void setConditionCheckThreads(unsigned int n) override
+    {
+#ifdef PLEXIL_WITH_THREADS
+      if (n == getConditionCheckThreads())
+        return;
+      m_conditionCheckPool.reset();
+      if (n > 1)
+        m_conditionCheckPool.reset(new ConditionCheckPool(n));
+      debugMsg("PlexilExec:setConditionCheckThreads",
+               " using " << getConditionCheckThreads() << " threads");
+#else
+      if (n > 1)
+        warn("PlexilExec: threads not enabled, evaluating conditions serially");
+#endif
+    }
+
+    //! \brief Get the number of threads used to evaluate the
+    //!        conditions of candidate nodes.
+    //! \return The number of threads; 1 if evaluation is serial.
+    virtual unsigned int getConditionCheckThreads() const override
+    {
+#ifdef PLEXIL_WITH_THREADS
+      if (m_conditionCheckPool)
+        return m_conditionCheckPool->size();
+#endif
+      return 1;
+    }
+
     //! \brief Get the list of active plans.
     //! \return Const reference to the list of root nodes.
     virtual std::list<NodePtr> const &getPlans() const override
@@ -176,6 +279,21 @@ namespace PLEXIL
       return m_plan;
     }
 
+    //! \brief Get the counters and high-water marks describing the
+    //!        work done by the Exec.
+    //! \return Const reference to the metrics.
+    virtual ExecMetrics const &getMetrics() const override
+    {
+      return m_metrics;
+    }
+
+    //! \brief Reset the metrics to zero.
+    virtual void resetMetrics() override
+    {
+      m_metrics.reset();
+      Function::resetEvaluationCounts();
+    }
+
     //! \brief Prepare the given plan for execution.
     //! \param root Pointer to the plan's root node.
     //! \return True if succesful, false otherwise.
@@ -223,6 +341,9 @@ namespace PLEXIL
     //! \brief Delete any plans (root nodes) which have finished.
     virtual void deleteFinishedPlans() override
     {
+      // Listener may be publishing transitions of these nodes
+      if (m_listener && !m_finishedRootNodes.empty())
+        m_listener->flush();
       while (!m_finishedRootNodes.empty()) {
         Node *node = m_finishedRootNodes.front();
         m_finishedRootNodes.pop();
@@ -255,13 +376,24 @@ namespace PLEXIL
       // Queue had better be empty when we get here!
       checkError(m_stateChangeQueue.empty(), "State change queue not empty at entry");
 
+      // Instrumentation
+      std::chrono::steady_clock::time_point const stepStart =
+        std::chrono::steady_clock::now();
+      size_t microSteps = 0;
+      size_t transitions = 0;
+
 #ifndef NO_DEBUG_MESSAGE_SUPPORT 
       // Only used in debugMsg calls
       unsigned int stepCount = 0;
       unsigned int cycleNum = StateCache::instance().getCycleCount();
 #endif
 
-      debugMsg("PlexilExec:step", " ==>Start cycle " << cycleNum);
+      debugTraceMsg("PlexilExec:step", " ==>Start cycle " << cycleNum, cycleNum);
+
+#ifdef PLEXIL_WITH_THREADS
+      // Settings which force serial evaluation only change between steps
+      bool const parallelChecks = m_conditionCheckPool && parallelChecksAllowed();
+#endif
 
       // A Node is initially inserted on the pending queue when it is eligible to
       // transition to EXECUTING, and it needs to acquire one or more resources.
@@ -269,17 +401,24 @@ namespace PLEXIL
       //  - its conditions have changed and it is no longer eligible to execute;
       //  - it has acquired the resources and is transitioning to EXECUTING.
       //
-      // At each step, each node in the pending queue is checked.
+      // At each step, nodes in the pending queue whose conditions changed,
+      // or whose resources were released, are checked.
 
       // BEGIN QUIESCENCE LOOP
       do {
-        debugStmt("PlexilExec:step",
-                  {
-                    getDebugOutputStream() << "[PlexilExec:step]["
-                                           << cycleNum << ":" << stepCount << "]";
-                    printConditionCheckQueue();
-                  });
-        condDebugStmt(!m_pendingQueue.empty(),
+        // The queue dumps are text only; trace their sizes instead
+        condTraceMsg(traceLogActive(),
+                     "PlexilExec:step:queues",
+                     cycleNum, stepCount, m_candidateQueue.size(),
+                     m_pendingQueue.size(), m_stateChangeQueue.size());
+        condDebugStmt(!traceLogActive(),
+                      "PlexilExec:step",
+                      {
+                        getDebugOutputStream() << "[PlexilExec:step]["
+                                               << cycleNum << ":" << stepCount << "]";
+                        printConditionCheckQueue();
+                      });
+        condDebugStmt(!m_pendingQueue.empty() && !traceLogActive(),
                       "PlexilExec:step",
                       {
                         getDebugOutputStream() << "[PlexilExec:step]["
@@ -288,87 +427,89 @@ namespace PLEXIL
                       });
 
         // Evaluate conditions of nodes reporting a change
-        while (!m_candidateQueue.empty()) {
-          Node *candidate = getCandidateNode();
-          bool canTransition = candidate->getDestState(); // sets node's next state
-          if (canTransition) {
-            debugMsg("PlexilExec:step",
-                     " Node " << candidate->getNodeId() << ' ' << candidate
-                     << " can transition from "
-                     << nodeStateName(candidate->getState())
-                     << " to " << nodeStateName(candidate->getNextState()));
-            if (!resourceCheckRequired(candidate)) {
-              // The node is eligible to transition now
-              addStateChangeNode(candidate);
-            }
-            else {
-              // Possibility of conflict - set it aside to evaluate as a batch
-              addPendingNode(candidate);
-            }
+        if (m_candidateQueue.size() > m_metrics.maxCandidateQueue)
+          m_metrics.maxCandidateQueue = m_candidateQueue.size();
+        m_metrics.conditionChecks += m_candidateQueue.size();
+#ifdef PLEXIL_WITH_THREADS
+        if (parallelChecks
+            && m_candidateQueue.size() >= PARALLEL_CHECK_MIN_CANDIDATES)
+          evaluateCandidatesInParallel();
+        else
+#endif
+          while (!m_candidateQueue.empty()) {
+            Node *candidate = getCandidateNode();
+            if (candidate->getDestState()) // sets node's next state
+              handleEligibleCandidate(candidate);
           }
-        }
 
         // See if any on the pending queue are eligible
         if (!m_pendingQueue.empty()) {
-          debugStmt("PlexilExec:step",
-                    {
-                      getDebugOutputStream() << "[PlexilExec:step]["
-                                             << cycleNum << ":" << stepCount << "]";
-                      printPendingQueue();
-                    });
+          condDebugStmt(!traceLogActive(),
+                        "PlexilExec:step",
+                        {
+                          getDebugOutputStream() << "[PlexilExec:step]["
+                                                 << cycleNum << ":" << stepCount << "]";
+                          printPendingQueue();
+                        });
           resolveResourceConflicts();
+          if (m_pendingQueue.size() > m_metrics.maxPendingQueue)
+            m_metrics.maxPendingQueue = m_pendingQueue.size();
         }
 
         if (m_stateChangeQueue.empty())
           break; // nothing to do, exit quiescence loop
 
-        debugStmt("PlexilExec:step",
-                  {
-                    getDebugOutputStream() << "[PlexilExec:step]["
-                                           << cycleNum << ":" << stepCount << "]";
-                    printStateChangeQueue();
-                  });
+        condDebugStmt(!traceLogActive(),
+                      "PlexilExec:step",
+                      {
+                        getDebugOutputStream() << "[PlexilExec:step]["
+                                               << cycleNum << ":" << stepCount << "]";
+                        printStateChangeQueue();
+                      });
 
 #ifndef NO_DEBUG_MESSAGE_SUPPORT 
         // Only used in debug messages
         unsigned int microStepCount = 0;
 #endif
 
+        if (m_stateChangeQueue.size() > m_metrics.maxStateChangeQueue)
+          m_metrics.maxStateChangeQueue = m_stateChangeQueue.size();
+        transitions += m_stateChangeQueue.size();
+
         // Reserve space for the transitions to be published
         if (m_listener)
-          m_transitionsToPublish.reserve(m_stateChangeQueue.size());
+          m_transitionsToPublish.reserve(m_transitionsToPublish.size()
+                                         + m_stateChangeQueue.size());
 
         // Transition the nodes
         // Transition may put node on m_candidateQueue or m_finishedRootNodes
         while (!m_stateChangeQueue.empty()) {
           Node *node = getStateChangeNode();
           NodeState oldState = node->getState(); // for listener
-          debugMsg("PlexilExec:step",
-                   "[" << cycleNum << ":" << stepCount << ":" << microStepCount <<
-                   "] Transitioning " << nodeTypeString(node->getType())
-                   << " node " << node->getNodeId() << ' ' << node
-                   << " from " << nodeStateName(node->getState())
-                   << " to " << nodeStateName(node->getNextState()));
+          debugTraceMsg("PlexilExec:step",
+                        "[" << cycleNum << ":" << stepCount << ":" << microStepCount <<
+                        "] Transitioning " << nodeTypeString(node->getType())
+                        << " node " << node->getNodeId() << ' ' << node
+                        << " from " << nodeStateName(node->getState())
+                        << " to " << nodeStateName(node->getNextState()),
+                        stepCount, microStepCount, node,
+                        node->getState(), node->getNextState());
           node->transition(this, startTime);
           if (m_listener)
             // After transition, old state is lost, so use cached state
             m_transitionsToPublish.emplace_back(NodeTransition(node,
                                                                oldState,
-                                                               node->getState()));
+                                                               node->getState(),
+                                                               node->getOutcome(),
+                                                               node->getFailureType(),
+                                                               startTime));
 #ifndef NO_DEBUG_MESSAGE_SUPPORT 
           ++microStepCount;
 #endif
         }
 
-        // TODO: instrument high-water-mark of max nodes transitioned in this step
-
-        // Publish the transitions
-        // FIXME: Move call to listener outside of quiescence loop
-        if (m_listener)
-          m_listener->notifyOfTransitions(m_transitionsToPublish);
-        m_transitionsToPublish.clear();
-
         // done with this batch
+        ++microSteps;
 #ifndef NO_DEBUG_MESSAGE_SUPPORT 
         ++stepCount;
 #endif
@@ -384,10 +525,20 @@ namespace PLEXIL
       StateCache::instance().incrementCycleCount();
       performAssignments();
       executeOutboundQueue();
-      if (m_listener)
+      if (m_listener) {
+        // Publish the transitions of the whole step at once
+        m_listener->notifyOfTransitions(m_transitionsToPublish);
         m_listener->stepComplete(cycleNum);
+      }
+      m_transitionsToPublish.clear();
+
+      recordStepMetrics(std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                                      - stepStart).count(),
+                        microSteps,
+                        transitions);
 
-      debugMsg("PlexilExec:step", " ==>End cycle " << cycleNum);
+      debugTraceMsg("PlexilExec:step", " ==>End cycle " << cycleNum,
+                    cycleNum, microSteps, transitions);
       for (NodePtr const &node: m_plan)
         debugMsg("PlexilExec:printPlan",
                  std::endl << *const_cast<Node const *>(node.get()));
@@ -405,6 +556,14 @@ namespace PLEXIL
       m_candidateQueue.push(node);
     }
 
+    //! \brief Note that a node on the pending queue must be examined
+    //!        by resource conflict resolution.
+    //! \param node Pointer to the node.
+    virtual void notifyPendingNode(Node *node) override
+    {
+      m_pendingWakeups.push_back(node);
+    }
+
     //! \brief Schedule this assignment for execution.
     //! \param assign Pointer to the Assignment.
     virtual void enqueueAssignment(Assignment *assign) override
@@ -462,7 +621,10 @@ namespace PLEXIL
     //  - its conditions have changed and it is no longer eligible to execute;
     //  - it has acquired the mutexes and is transitioning to EXECUTING.
     //
-    // At each step, each node in the pending queue is checked.
+    // A node in the pending queue is examined only when its queue
+    // status has changed since it was last examined, i.e. when its
+    // conditions changed or a resource it is waiting for was released.
+    // Such nodes are reported through notifyPendingNode().
     // 
 
     // We know that the node is eligible to transition.
@@ -500,9 +662,10 @@ namespace PLEXIL
           removePendingNode(node);
           addStateChangeNode(node);
         }
-        // else still eligible to transition to EXECUTING,
-        // but resources not available
-        node->setQueueStatus(QUEUE_PENDING);
+        else
+          // still eligible to transition to EXECUTING,
+          // but resources not available
+          node->setQueueStatus(QUEUE_PENDING);
         return false;
 
       case QUEUE_PENDING_TRY_CHECK:
@@ -541,41 +704,75 @@ namespace PLEXIL
       }
     }      
 
-    //! \brief Resolve resource conflicts among the best priority
-    //! nodes on the pending queue.
+    //! \brief Queue a node reported by notifyPendingNode for
+    //!        examination by resolveResourceConflicts.
+    //! \param node The node.
+    void pushPendingWakeup(Node *node)
+    {
+      switch (node->getQueueStatus()) {
+      case QUEUE_PENDING_TRY:
+      case QUEUE_PENDING_TRY_CHECK:
+      case QUEUE_PENDING_CHECK: {
+        std::unordered_map<Node const *, uint64_t>::const_iterator it =
+          m_pendingSequence.find(node);
+        if (it == m_pendingSequence.end())
+          return; // not on the pending queue
+        m_pendingHeap.push_back({node, node->getPriority(), it->second});
+        std::push_heap(m_pendingHeap.begin(), m_pendingHeap.end(),
+                       PendingWakeupCompare());
+        return;
+      }
+
+      default:
+        // Nothing to do
+        return;
+      }
+    }
+
+    //! \brief Resolve resource conflicts among the nodes on the
+    //!        pending queue which need attention.
+    //! \note Nodes are examined in pending queue order, in batches
+    //!       of equal priority.
     void resolveResourceConflicts()
     {
-      Node *priorityHead = m_pendingQueue.front();
+      for (Node *node : m_pendingWakeups)
+        pushPendingWakeup(node);
+      m_pendingWakeups.clear();
+
       std::vector<Node *> priorityNodes;
-      while (priorityHead) {
-        // Gather nodes at same priority 
-        int32_t thisPriority = priorityHead->getPriority();
+      while (!m_pendingHeap.empty()) {
+        // Gather nodes at same priority
+        int32_t thisPriority = m_pendingHeap.front().priority;
 
-        debugMsg("PlexilExec:step",
-                 " processing resource reservations at priority " << thisPriority);
+        debugTraceMsg("PlexilExec:step",
+                      " processing resource reservations at priority " << thisPriority,
+                      thisPriority);
 
-        Node *temp = priorityHead;
         do {
+          Node *temp = m_pendingHeap.front().node;
+          std::pop_heap(m_pendingHeap.begin(), m_pendingHeap.end(),
+                        PendingWakeupCompare());
+          m_pendingHeap.pop_back();
+          ++m_metrics.pendingScans;
           if (resourceCheckEligible(temp)) 
             // Resource(s) were released, give it a look
             priorityNodes.push_back(temp);
-          temp = temp->next();
-        } while (temp && temp->getPriority() == thisPriority);
+        } while (!m_pendingHeap.empty()
+                 && m_pendingHeap.front().priority == thisPriority);
 
-        // temp is at end of queue,
-        // or pointing to node with higher (numerical) priority
-        priorityHead = temp; // for next iteration
-
-        debugMsg("PlexilExec:step",
-                 ' ' << priorityNodes.size() << " nodes eligible to acquire resources");
+        debugTraceMsg("PlexilExec:step",
+                      ' ' << priorityNodes.size() << " nodes eligible to acquire resources",
+                      priorityNodes.size());
 
         // Let each node try to acquire its resources.
         // Transition the ones that succeed.
         for (Node *n : priorityNodes) {
+          ++m_metrics.resourceAttempts;
           if (n->tryResourceAcquisition()) {
             // Node can transition now
-            debugMsg("PlexilExec:resolveResourceConflicts",
-                     ' ' << n->getNodeId() << " succeeded");
+            debugTraceMsg("PlexilExec:resolveResourceConflicts",
+                          ' ' << n->getNodeId() << " succeeded",
+                          n);
             removePendingNode(n);
             addStateChangeNode(n);
           }
@@ -587,12 +784,121 @@ namespace PLEXIL
 
         // Done with this batch
         priorityNodes.clear();
+
+        // Failed attempts may have released resources, waking other
+        // nodes.  Those of lower priority are examined in this call;
+        // the rest wait for the next one.
+        if (!m_pendingWakeups.empty()) {
+          std::vector<Node *>::iterator it =
+            std::partition(m_pendingWakeups.begin(), m_pendingWakeups.end(),
+                           [thisPriority](Node const *n) -> bool
+                           { return n->getPriority() <= thisPriority; });
+          for (std::vector<Node *>::iterator later = it;
+               later != m_pendingWakeups.end();
+               ++later)
+            pushPendingWakeup(*later);
+          m_pendingWakeups.erase(it, m_pendingWakeups.end());
+        }
+      }
+    }
+
+    //
+    // Condition evaluation
+    //
+
+    //! \brief Place a candidate node which can transition on the
+    //!        appropriate queue.
+    //! \param candidate Pointer to the node.
+    void handleEligibleCandidate(Node *candidate)
+    {
+      debugTraceMsg("PlexilExec:step",
+                    " Node " << candidate->getNodeId() << ' ' << candidate
+                    << " can transition from "
+                    << nodeStateName(candidate->getState())
+                    << " to " << nodeStateName(candidate->getNextState()),
+                    candidate, candidate->getState(), candidate->getNextState());
+      if (!resourceCheckRequired(candidate)) {
+        // The node is eligible to transition now
+        addStateChangeNode(candidate);
+      }
+      else {
+        // Possibility of conflict - set it aside to evaluate as a batch
+        addPendingNode(candidate);
       }
     }
 
+#ifdef PLEXIL_WITH_THREADS
+    //! \brief Check whether the condition check pool may be used.
+    //!        Lazy evaluation caches are not thread safe, and debug
+    //!        output from the workers would interleave.
+    //! \return true if so, false if conditions must be evaluated serially.
+    //! \note Tells the user the first time the pool is not used.
+    bool parallelChecksAllowed()
+    {
+      char const *reason = nullptr;
+      if (Function::getLazyEvaluation())
+        reason = "lazy evaluation is enabled";
+      else if (debugMessagesEnabled())
+        reason = "debug messages are enabled";
+      else
+        return true;
+      if (!m_reportedSerialChecks) {
+        warn("PlexilExec: evaluating conditions serially because " << reason);
+        m_reportedSerialChecks = true;
+      }
+      return false;
+    }
+
+    //! \brief Evaluate the conditions of every node on the candidate
+    //!        queue using the condition check pool, then act on the
+    //!        results in queue order.
+    //! \note No node transitions while the candidate queue is being
+    //!       drained, and getDestState() has no effect outside its
+    //!       own node, so the outcome is identical to the serial loop.
+    void evaluateCandidatesInParallel()
+    {
+      while (Node *candidate = getCandidateNode())
+        m_candidateBatch.push_back(candidate);
+      debugTraceMsg("PlexilExec:evaluateCandidatesInParallel",
+                    " evaluating " << m_candidateBatch.size() << " candidates",
+                    m_candidateBatch.size());
+      m_conditionCheckPool->evaluate(m_candidateBatch, m_candidateResults);
+      for (size_t i = 0; i < m_candidateBatch.size(); ++i)
+        if (m_candidateResults[i])
+          handleEligibleCandidate(m_candidateBatch[i]);
+      m_candidateBatch.clear();
+    }
+#endif
+
+    //! \brief Update the per-step metrics at the end of a macro step.
+    //! \param elapsed Wall time of the step, in seconds.
+    //! \param microSteps Number of quiescence loop iterations which
+    //!                   transitioned nodes.
+    //! \param transitions Number of node transitions.
+    void recordStepMetrics(double elapsed, size_t microSteps, size_t transitions)
+    {
+      ++m_metrics.steps;
+      m_metrics.lastStepTime = elapsed;
+      m_metrics.totalStepTime += elapsed;
+      if (elapsed > m_metrics.maxStepTime)
+        m_metrics.maxStepTime = elapsed;
+      m_metrics.lastMicroSteps = microSteps;
+      m_metrics.totalMicroSteps += microSteps;
+      if (microSteps > m_metrics.maxMicroSteps)
+        m_metrics.maxMicroSteps = microSteps;
+      m_metrics.lastTransitions = transitions;
+      m_metrics.totalTransitions += transitions;
+      if (transitions > m_metrics.maxTransitions)
+        m_metrics.maxTransitions = transitions;
+      m_metrics.functionEvaluations = Function::getEvaluationCount();
+      m_metrics.functionEvaluationsSaved = Function::getSavedEvaluationCount();
+    }
+
     //! \brief Execute assignments and assignment retractions.
     void performAssignments() 
     {
+      m_metrics.assignments += m_assignmentsToExecute.size();
+      m_metrics.retractions += m_assignmentsToRetract.size();
       condDebugMsg(!m_assignmentsToExecute.empty() || !m_assignmentsToRetract.empty(),
                    "PlexilExec:performAssignments", " performing "
                    << m_assignmentsToExecute.size() <<  " assignments and "
@@ -616,6 +922,8 @@ namespace PLEXIL
         // Arbitrate commands to be executed
         LinkedQueue<CommandImpl> accepted, rejected;
         m_arbiter->arbitrateCommands(m_commandsToExecute, accepted, rejected);
+        m_metrics.commands += accepted.size();
+        m_metrics.commandsRejected += rejected.size();
         // Execute the ones which can be executed
         while (CommandImpl *cmd = accepted.front()) {
           accepted.pop();
@@ -632,17 +940,20 @@ namespace PLEXIL
       }
       else {
         // Execute them all
+        m_metrics.commands += m_commandsToExecute.size();
         while (CommandImpl *cmd = m_commandsToExecute.front()) {
           m_commandsToExecute.pop();
           m_dispatcher->executeCommand(cmd);
         }
       }
       
+      m_metrics.aborts += m_commandsToAbort.size();
       while (CommandImpl *cmd = m_commandsToAbort.front()) {
         m_commandsToAbort.pop();
         m_dispatcher->invokeAbort(cmd);
       }
 
+      m_metrics.updates += m_updatesToExecute.size();
       while (Update *upd = m_updatesToExecute.front()) {
         m_updatesToExecute.pop();
         m_dispatcher->executeUpdate(upd);
@@ -690,9 +1001,10 @@ namespace PLEXIL
     {
       switch (node->getQueueStatus()) {
       case QUEUE_NONE:   // normal case
-        debugMsg("PlexilExec:step",
-                 " adding " << node->getNodeId() << ' ' << node <<
-                 " to state change queue");
+        debugTraceMsg("PlexilExec:step",
+                      " adding " << node->getNodeId() << ' ' << node <<
+                      " to state change queue",
+                      node);
         node->setQueueStatus(QUEUE_TRANSITION);
         m_stateChangeQueue.push(node);
         return;
@@ -737,11 +1049,14 @@ namespace PLEXIL
     //! \param node The node.
     void addPendingNode(Node *node)
     {
-      debugMsg("PlexilExec:step",
-               " adding " << node->getNodeId() << ' ' << node <<
-               " to pending queue");
+      debugTraceMsg("PlexilExec:step",
+                    " adding " << node->getNodeId() << ' ' << node <<
+                    " to pending queue",
+                    node);
       node->setQueueStatus(QUEUE_PENDING_TRY);
       m_pendingQueue.insert(node);
+      m_pendingSequence[node] = m_nextPendingSequence++;
+      m_pendingWakeups.push_back(node);
     }
 
     //! \brief Remove the node from the pending queue.
@@ -751,6 +1066,7 @@ namespace PLEXIL
     void removePendingNode(Node *node)
     {
       m_pendingQueue.remove(node);
+      m_pendingSequence.erase(node);
       node->setQueueStatus(QUEUE_NONE);
       node->releaseResourceReservations();
     }
@@ -779,9 +1095,10 @@ namespace PLEXIL
         // fall thru
 
       case QUEUE_NONE:
-        debugMsg("PlexilExec:step",
-                 " Marking " << node->getNodeId() << ' ' << node <<
-                 " as a finished root node");
+        debugTraceMsg("PlexilExec:step",
+                      " Marking " << node->getNodeId() << ' ' << node <<
+                      " as a finished root node",
+                      node);
         node->setQueueStatus(QUEUE_DELETE);
         m_finishedRootNodes.push(node);
         return;
@@ -37,6 +37,7 @@ namespace PLEXIL
   class CommandImpl;
   class Dispatcher;
   class ExecListenerBase; 
+  struct ExecMetrics;
   class Node;
   class ResourceArbiterInterface;
   class Update;
@@ -68,6 +69,14 @@ namespace PLEXIL
     //! \note Node's queue status must be QUEUE_NONE.
     virtual void addCandidateNode(Node *node) = 0;
 
+    //! \brief Note that a node on the pending queue must be examined
+    //!        by resource conflict resolution, because its conditions
+    //!        changed or a resource it is waiting for was released.
+    //! \param node Pointer to the node.
+    //! \note Called when the node's queue status changes from
+    //!       QUEUE_PENDING.
+    virtual void notifyPendingNode(Node *node) = 0;
+
     //! \brief Schedule this assignment for execution.
     //! \param assign Pointer to the Assignment.
     virtual void enqueueAssignment(Assignment *assign) = 0;
@@ -112,6 +121,20 @@ namespace PLEXIL
     //! \return Pointer to the arbiter instance.  May be null.
     virtual ResourceArbiterInterface *getArbiter() = 0;
 
+    //! \brief Set the number of threads used to evaluate the
+    //!        conditions of candidate nodes.
+    //! \param n The number of threads.  0 or 1 selects serial
+    //!          evaluation, which is the default.
+    //! \note Has no effect if PLEXIL was built without threads.
+    //!       Conditions are still evaluated serially while lazy
+    //!       evaluation is on or any debug messages are enabled.
+    virtual void setConditionCheckThreads(unsigned int n) = 0;
+
+    //! \brief Get the number of threads used to evaluate the
+    //!        conditions of candidate nodes.
+    //! \return The number of threads; 1 if evaluation is serial.
+    virtual unsigned int getConditionCheckThreads() const = 0;
+
     //! \brief Run a single "macro step" i.e. the entire quiescence cycle.
     //! \param startTime The time at which the step is run.  Used as the
     //!                  timestamp for node transitions in this step.
@@ -141,6 +164,14 @@ namespace PLEXIL
     //! \return Const reference to the list of root nodes.
     virtual std::list<NodePtr> const &getPlans() const = 0;
 
+    //! \brief Get the counters and high-water marks describing the
+    //!        work done by the Exec.
+    //! \return Const reference to the metrics.
+    virtual ExecMetrics const &getMetrics() const = 0;
+
+    //! \brief Reset the metrics to zero.
+    virtual void resetMetrics() = 0;
+
   };
 
   //! \brief Global pointer to the active PlexilExec instance.
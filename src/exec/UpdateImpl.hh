@@ -26,6 +26,7 @@
 #ifndef PLEXIL_UPDATE_IMPL_HH
 #define PLEXIL_UPDATE_IMPL_HH
 
+#include "PlanArena.hh"
 #include "SimpleBooleanVariable.hh"
 #include "Update.hh"
 
@@ -39,7 +40,9 @@ namespace PLEXIL
   //! \brief Implements the Update API.
   //! \see Update
   //! \see UpdateNode
-  class UpdateImpl final : public Update
+  class UpdateImpl final :
+    public Update,
+    public ArenaAllocated
   {
   public:
 
@@ -0,0 +1,284 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Measures the time, and where the platform allows, the last-level
+// cache misses, taken by the Exec to run a large plan of empty nodes
+// from start to finish.  The plan is a root list node with list node
+// children, each with the same number of empty node children.
+//
+// With the -s option, each empty node waits on its own start condition,
+// and the benchmark releases one per step, so that the children of a
+// list finish one at a time.  Run with "-l 1 -e 10000 -s" this
+// exercises the ListNode child state conditions on a wide list.
+//
+
+#include "Dispatcher.hh"
+#include "Error.hh"
+#include "ListNode.hh"
+#include "NodeFactory.hh"
+#include "PlanArena.hh"
+#include "PlexilExec.hh"
+#include "UserVariable.hh"
+#include "Value.hh"
+#include "lifecycle-utils.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace PLEXIL;
+
+using Clock = std::chrono::steady_clock;
+
+// Empty nodes need no external interface
+class NullDispatcher final : public Dispatcher
+{
+public:
+  NullDispatcher() = default;
+  virtual ~NullDispatcher() = default;
+
+  virtual void lookupNow(State const & /* state */, LookupReceiver * /* receiver */) override {}
+  virtual void setThresholds(const State & /* state */, Real /* hi */, Real /* lo */) override {}
+  virtual void setThresholds(const State & /* state */, Integer /* hi */, Integer /* lo */) override {}
+  virtual void clearThresholds(const State & /* state */) override {}
+  virtual void executeCommand(Command * /* cmd */) override {}
+  virtual void reportCommandArbitrationFailure(Command * /* cmd */) override {}
+  virtual void invokeAbort(Command * /* cmd */) override {}
+  virtual void executeUpdate(Update * /* update */) override {}
+};
+
+//
+// Hardware cache miss counter, if available
+//
+
+class CacheMissCounter final
+{
+public:
+  CacheMissCounter()
+    : m_fd(-1)
+  {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    m_fd = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+  }
+
+  ~CacheMissCounter()
+  {
+#ifdef __linux__
+    if (m_fd >= 0)
+      close(m_fd);
+#endif
+  }
+
+  bool available() const
+  {
+    return m_fd >= 0;
+  }
+
+  void start()
+  {
+#ifdef __linux__
+    if (m_fd >= 0) {
+      ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  unsigned long long stop()
+  {
+    unsigned long long count = 0;
+#ifdef __linux__
+    if (m_fd >= 0) {
+      ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(m_fd, &count, sizeof(count)) != sizeof(count))
+        count = 0;
+    }
+#endif
+    return count;
+  }
+
+private:
+  int m_fd;
+};
+
+static NodeImpl *buildPlan(size_t lists, size_t leaves,
+                           std::vector<Assignable *> *startFlags)
+{
+  PlanArena::Scope arenaScope;
+
+  ListNode *root = dynamic_cast<ListNode *>(NodeFactory::createNode("root", NodeType_NodeList));
+  root->reserveChildren(lists);
+  for (size_t i = 0; i < lists; ++i) {
+    std::string listName = "list" + std::to_string(i);
+    ListNode *list =
+      dynamic_cast<ListNode *>(NodeFactory::createNode(listName.c_str(), NodeType_NodeList, root));
+    root->addChild(list);
+    list->reserveChildren(leaves);
+    for (size_t j = 0; j < leaves; ++j) {
+      std::string leafName = listName + "_leaf" + std::to_string(j);
+      NodeImpl *leaf = NodeFactory::createNode(leafName.c_str(), NodeType_Empty, list);
+      if (startFlags) {
+        BooleanVariable *flag = new BooleanVariable(false);
+        leaf->addUserCondition("StartCondition", flag, true);
+        startFlags->push_back(flag);
+      }
+      list->addChild(leaf);
+    }
+  }
+
+  // Parents first, as the parser does
+  root->finalizeConditions();
+  for (NodeImplPtr &list : root->getChildren()) {
+    list->finalizeConditions();
+    for (NodeImplPtr &leaf : list->getChildren())
+      leaf->finalizeConditions();
+  }
+  return root;
+}
+
+static void usage()
+{
+  std::cout << "Usage: exec-step-benchmark [options]\n"
+            << " Options:\n"
+            << "  -l <number>  Number of list nodes under the root (default 250)\n"
+            << "  -e <number>  Number of empty nodes in each list (default 200)\n"
+            << "  -r <number>  Number of times to run the plan (default 5)\n"
+            << "  -s           Start the empty nodes one per step\n"
+            << "  -h           Display this message and exit\n"
+            << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t lists = 250;
+  size_t leaves = 200;
+  unsigned int repeats = 5;
+  bool sequential = false;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-h")) {
+      usage();
+      return 0;
+    }
+    else if (i + 1 < argc && !strcmp(argv[i], "-l"))
+      lists = (size_t) atol(argv[++i]);
+    else if (i + 1 < argc && !strcmp(argv[i], "-e"))
+      leaves = (size_t) atol(argv[++i]);
+    else if (i + 1 < argc && !strcmp(argv[i], "-r"))
+      repeats = (unsigned int) atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-s"))
+      sequential = true;
+    else {
+      std::cerr << "Unknown option " << argv[i] << std::endl;
+      usage();
+      return 1;
+    }
+  }
+  if (!lists || !leaves || !repeats) {
+    usage();
+    return 1;
+  }
+
+  Error::doThrowExceptions();
+  size_t const nNodes = 1 + lists + lists * leaves;
+  std::cout << "Running a plan of " << nNodes << " nodes " << repeats << " times" << std::endl;
+
+  NullDispatcher dispatcher;
+  CacheMissCounter misses;
+  double bestMs = 0;
+  unsigned long long bestMisses = 0;
+  size_t steps = 0;
+
+  for (unsigned int r = 0; r < repeats; ++r) {
+    PlexilExec *exec = makePlexilExec();
+    g_exec = exec;
+    exec->setDispatcher(&dispatcher);
+
+    std::vector<Assignable *> startFlags;
+    NodeImpl *root = buildPlan(lists, leaves, sequential ? &startFlags : nullptr);
+    exec->addPlan(root);
+
+    double time = 0;
+    size_t nextFlag = 0;
+    steps = 0;
+    misses.start();
+    Clock::time_point start = Clock::now();
+    while (!exec->allPlansFinished()) {
+      // The start conditions are only active once their nodes are WAITING
+      if (steps && nextFlag < startFlags.size())
+        startFlags[nextFlag++]->setValue(Value(true));
+      exec->step(time);
+      time += 1;
+      ++steps;
+    }
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    unsigned long long missCount = misses.stop();
+
+    if (!r || ms < bestMs) {
+      bestMs = ms;
+      bestMisses = missCount;
+    }
+
+    exec->deleteFinishedPlans();
+    g_exec = nullptr;
+    delete exec;
+  }
+
+  std::cout << std::fixed << std::setprecision(3)
+            << "Best run: " << bestMs << " ms, " << steps << " steps, "
+            << bestMs / steps << " ms/step, "
+            << bestMs * 1e6 / nNodes << " ns/node" << std::endl;
+  if (misses.available())
+    std::cout << "Cache misses: " << bestMisses << ", "
+              << std::setprecision(2) << (double) bestMisses / nNodes << " per node" << std::endl;
+  else
+    std::cout << "Cache miss counter not available" << std::endl;
+
+  plexilRunFinalizers();
+  return 0;
+}
@@ -26,6 +26,7 @@
 
 #include "Assignable.hh"
 #include "Debug.hh"
+#include "ExecMetrics.hh"
 #include "NodeImpl.hh"
 #include "NodeFactory.hh"
 #include "PlexilExec.hh"
@@ -42,6 +43,7 @@ using namespace PLEXIL;
 #define IDX_TRUE 2
 
 std::list<NodePtr> const g_dummyPlanList;
+ExecMetrics const g_dummyMetrics;
 
 class TransitionExecConnector final :
   public PlexilExec
@@ -51,6 +53,7 @@ public:
   ~TransitionExecConnector() = default;
 
   virtual void addCandidateNode(Node * /* node */) override {}
+  virtual void notifyPendingNode(Node * /* node */) override {}
   virtual void enqueueAssignment(Assignment * /* assign */) override {}
   virtual void enqueueAssignmentForRetraction(Assignment * /* assign */) override {}
   virtual void enqueueCommand(CommandImpl * /* cmd */) override {}
@@ -64,9 +67,13 @@ public:
   virtual void setExecListener(ExecListenerBase * /* l */) override {}
   virtual ExecListenerBase *getExecListener() override { return nullptr; }
   virtual ResourceArbiterInterface *getArbiter() override { return nullptr; }
+  virtual void setConditionCheckThreads(unsigned int /* n */) override {}
+  virtual unsigned int getConditionCheckThreads() const override { return 1; }
   virtual void deleteFinishedPlans() override {}
   virtual bool allPlansFinished() const override { return true; }
   virtual std::list<NodePtr> const &getPlans() const override { return g_dummyPlanList; }
+  virtual ExecMetrics const &getMetrics() const override { return g_dummyMetrics; }
+  virtual void resetMetrics() override {}
 };
 
 static bool inactiveDestTest() 
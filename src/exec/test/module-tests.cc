@@ -37,10 +37,12 @@
 
 // Declarations of tests
 extern bool stateTransitionTests();
+extern bool resourceConflictTests();
 
 void runTests()
 {
   runTestSuite(stateTransitionTests);
+  runTestSuite(resourceConflictTests);
 
   std::cout << "Finished" << std::endl;
 }
@@ -0,0 +1,151 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "Dispatcher.hh"
+#include "ExecListenerBase.hh"
+#include "ExecMetrics.hh"
+#include "Mutex.hh"
+#include "NodeFactory.hh"
+#include "NodeImpl.hh"
+#include "NodeTransition.hh"
+#include "PlexilExec.hh"
+#include "TestSupport.hh"
+
+#include <memory>
+#include <vector>
+
+using namespace PLEXIL;
+
+// Empty nodes need no external interface
+class NullDispatcher final : public Dispatcher
+{
+public:
+  NullDispatcher() = default;
+  virtual ~NullDispatcher() = default;
+
+  virtual void lookupNow(State const & /* state */, LookupReceiver * /* receiver */) override {}
+  virtual void setThresholds(const State & /* state */, Real /* hi */, Real /* lo */) override {}
+  virtual void setThresholds(const State & /* state */, Integer /* hi */, Integer /* lo */) override {}
+  virtual void clearThresholds(const State & /* state */) override {}
+  virtual void executeCommand(Command * /* cmd */) override {}
+  virtual void reportCommandArbitrationFailure(Command * /* cmd */) override {}
+  virtual void invokeAbort(Command * /* cmd */) override {}
+  virtual void executeUpdate(Update * /* update */) override {}
+};
+
+// Records the order in which nodes begin executing.
+class ExecutionOrderListener final : public ExecListenerBase
+{
+public:
+  ExecutionOrderListener() = default;
+  virtual ~ExecutionOrderListener() = default;
+
+  virtual void notifyOfTransitions(std::vector<NodeTransition> const &transitions) override
+  {
+    for (NodeTransition const &t : transitions)
+      if (t.newState == EXECUTING_STATE)
+        order.push_back(t.node);
+  }
+
+  virtual void notifyOfAssignment(Expression const * /* dest */,
+                                  std::string const & /* destName */,
+                                  Value const & /* value */) override
+  {
+  }
+
+  virtual void stepComplete(unsigned int /* cycleNum */) override
+  {
+  }
+
+  virtual void flush() override
+  {
+  }
+
+  std::vector<Node *> order;
+};
+
+// Number of nodes contending for the mutex
+#define N_CONTENDERS 32
+
+static bool mutexContentionTest()
+{
+  std::unique_ptr<PlexilExec> exec(makePlexilExec());
+  g_exec = exec.get();
+  NullDispatcher dispatcher;
+  exec->setDispatcher(&dispatcher);
+  ExecutionOrderListener listener;
+  exec->setExecListener(&listener);
+
+  Mutex m("m");
+  NodeImpl *nodes[N_CONTENDERS];
+  for (int i = 0; i < N_CONTENDERS; ++i) {
+    nodes[i] = NodeFactory::createNode("contender", NodeType_Empty);
+    // Interleave priorities so that insertion order differs from
+    // priority order; equal priorities keep insertion order
+    nodes[i]->setPriority((i * 7) % 4);
+    nodes[i]->allocateUsingMutexes(1);
+    nodes[i]->addUsingMutex(&m);
+  }
+  for (int i = 0; i < N_CONTENDERS; ++i)
+    assertTrue_1(exec->addPlan(nodes[i]));
+
+  exec->resetMetrics();
+  double time = 0;
+  while (!exec->allPlansFinished()) {
+    assertTrue_1(time < 1000);
+    exec->step(time);
+    time += 1;
+  }
+
+  // Every node executed once, in priority order, then in order of
+  // entry into the pending queue
+  assertTrue_1(listener.order.size() == N_CONTENDERS);
+  size_t k = 0;
+  for (int32_t prio = 0; prio < 4; ++prio)
+    for (int i = 0; i < N_CONTENDERS; ++i)
+      if (nodes[i]->getPriority() == prio)
+        assertTrue_1(listener.order[k++] == nodes[i]);
+
+  // Each release wakes the waiters, and each waiter is examined once
+  // per release, rather than the whole queue once per micro step.
+  ExecMetrics const &metrics = exec->getMetrics();
+  assertTrue_1(metrics.resourceAttempts >= N_CONTENDERS);
+  assertTrue_1(metrics.pendingScans <= (N_CONTENDERS * (N_CONTENDERS + 1)) / 2);
+
+  exec->setExecListener(nullptr);
+  exec->deleteFinishedPlans();
+  exec.reset();
+  g_exec = nullptr;
+  return true;
+}
+
+#undef N_CONTENDERS
+
+bool resourceConflictTests()
+{
+  runTest(mutexContentionTest);
+  return true;
+}
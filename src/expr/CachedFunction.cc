@@ -36,6 +36,8 @@ namespace PLEXIL
    * @class CachedFunction
    * @brief Variant of Function with a result cache to implement getValuePointer().
    * @note Required by functions returning anything requiring storage.
+   * @note When lazy evaluation is enabled, the cached result is reused
+   *       until a subexpression changes.
    */
 
   class CachedFunction : public Function
@@ -76,7 +78,11 @@ namespace PLEXIL
 #define DEFINE_CACHED_FUNC_DEFAULT_GET_VALUE_PTR_METHOD(_type) \
     virtual bool getValuePointer(_type const *&ptr) const               \
     {                                                                   \
-      bool result = (*m_op)(*static_cast<_type *>(m_valueCache), *this); \
+      bool result;                                                      \
+      if (!checkCache(m_op->valueType(), result)) {                     \
+        result = (*m_op)(*static_cast<_type *>(m_valueCache), *this);   \
+        markCached(m_op->valueType(), result);                          \
+      }                                                                 \
       if (result)                                                       \
         ptr = static_cast<_type const *>(m_valueCache); /* trust me */  \
       return result;                                                    \
@@ -250,7 +256,11 @@ namespace PLEXIL
 #define DEFINE_FIXED_ARG_CACHED_GET_VALUE_PTR_METHOD(_type) \
     virtual bool getValuePointer(_type const *&ptr) const   \
     {                                                                   \
-      bool result = (*m_op)(*static_cast<_type *>(m_valueCache), this); \
+      bool result;                                                      \
+      if (!checkCache(m_op->valueType(), result)) {                     \
+        result = (*m_op)(*static_cast<_type *>(m_valueCache), this);    \
+        markCached(m_op->valueType(), result);                          \
+      }                                                                 \
       if (result)                                                       \
         ptr = static_cast<_type const *>(m_valueCache); /* trust me */  \
       return result;                                                    \
@@ -329,7 +339,11 @@ namespace PLEXIL
 #define DEFINE_ONE_ARG_CACHED_GET_VALUE_PTR_METHOD(_type) \
   template <> bool FixedSizeCachedFunction<1>::getValuePointer(_type const *&ptr) const \
   {                                                                     \
-    bool result = (*m_op)(*static_cast<_type *>(m_valueCache), exprs[0]); \
+    bool result;                                                        \
+    if (!checkCache(m_op->valueType(), result)) {                       \
+      result = (*m_op)(*static_cast<_type *>(m_valueCache), exprs[0]);  \
+      markCached(m_op->valueType(), result);                            \
+    }                                                                   \
     if (result)                                                         \
       ptr = static_cast<_type const *>(m_valueCache); /* trust me */    \
     return result; \
@@ -408,7 +422,11 @@ namespace PLEXIL
 #define DEFINE_TWO_ARG_CACHED_GET_VALUE_PTR_METHOD(_type) \
   template <> bool FixedSizeCachedFunction<2>::getValuePointer(_type const *&ptr) const \
   { \
-    bool result = (*m_op)(*static_cast<_type *>(m_valueCache), exprs[0], exprs[1]); \
+    bool result; \
+    if (!checkCache(m_op->valueType(), result)) { \
+      result = (*m_op)(*static_cast<_type *>(m_valueCache), exprs[0], exprs[1]); \
+      markCached(m_op->valueType(), result); \
+    } \
     if (result) \
       ptr = static_cast<_type const *>(m_valueCache); /* trust me */ \
     return result; \
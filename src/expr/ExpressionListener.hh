@@ -29,11 +29,15 @@
 namespace PLEXIL
 {
 
+  // Forward reference
+  class Propagator;
+
   //! \class ExpressionListener
   //! \brief Pure virtual base class for listeners in the change notification graph.
 
-  //! ExpressionListener has no state. It only defines a pure virtual
-  //! member function, notifyChanged.
+  //! ExpressionListener has no state. It defines a pure virtual
+  //! member function, notifyChanged, and a query used by Notifier to
+  //! identify listeners which are Propagators.
 
   //! Instances derived from ExpressionListener can receive change
   //! notifications via notifyChanged.  The Listenable virtual base
@@ -54,6 +58,14 @@ namespace PLEXIL
     //! \brief Notify this object of a change.
     virtual void notifyChanged() = 0;
 
+    //! \brief Get this listener as a Propagator, if it is one.
+    //! \return Pointer to the Propagator; null if not a Propagator.
+    //! \note Notifier calls this once, when the listener is added.
+    virtual Propagator *asPropagator()
+    {
+      return nullptr;
+    }
+
   };
 
 }
@@ -29,14 +29,24 @@
 #include "ArrayImpl.hh"
 #include "Error.hh"
 #include "Operator.hh"
+#include "PlanArena.hh"
 #include "PlanError.hh"
 #include "Value.hh"
 
 namespace PLEXIL
 {
+  // Static initialization
+  bool Function::s_lazyEvaluation = false;
+  uint64_t Function::s_evaluations = 0;
+  uint64_t Function::s_savedEvaluations = 0;
+
   Function::Function(Operator const *oper)
     : Propagator(),
-      m_op(oper)
+      m_op(oper),
+      m_cachedReal(0),
+      m_cacheType(UNKNOWN_TYPE),
+      m_cacheKnown(false),
+      m_cacheable(!oper->isPropagationSource())
   {
   }
 
@@ -74,6 +84,61 @@ namespace PLEXIL
     return m_op->isPropagationSource();
   }
 
+  bool Function::cachesValue() const
+  {
+    return s_lazyEvaluation && m_cacheable;
+  }
+
+  //
+  // Lazy evaluation
+  //
+
+  void Function::setLazyEvaluation(bool lazy)
+  {
+    s_lazyEvaluation = lazy;
+  }
+
+  void Function::resetEvaluationCounts()
+  {
+    s_evaluations = 0;
+    s_savedEvaluations = 0;
+  }
+
+  // Local macro for boilerplate
+#define DEFINE_FUNC_CACHING_GET_VALUE_METHOD(_type, _typeTag, _member) \
+  bool Function::getValue(_type &result) const \
+  { \
+    bool known; \
+    if (checkCache(_typeTag, known)) { \
+      if (known) \
+        result = _member; \
+      return known; \
+    } \
+    known = calculate(result); \
+    if (known) \
+      _member = result; \
+    markCached(_typeTag, known); \
+    return known; \
+  }
+
+  DEFINE_FUNC_CACHING_GET_VALUE_METHOD(Boolean, BOOLEAN_TYPE, m_cachedBoolean)
+  DEFINE_FUNC_CACHING_GET_VALUE_METHOD(Integer, INTEGER_TYPE, m_cachedInteger)
+  DEFINE_FUNC_CACHING_GET_VALUE_METHOD(Real, REAL_TYPE, m_cachedReal)
+
+#undef DEFINE_FUNC_CACHING_GET_VALUE_METHOD
+
+#define DEFINE_FUNC_DEFAULT_CALCULATE_METHOD(_type) \
+  bool Function::calculate(_type &result) const \
+  { \
+    return (*m_op)(result, *this); \
+  }
+
+  DEFINE_FUNC_DEFAULT_CALCULATE_METHOD(Boolean)
+  DEFINE_FUNC_DEFAULT_CALCULATE_METHOD(Integer)
+  DEFINE_FUNC_DEFAULT_CALCULATE_METHOD(Real)
+
+#undef DEFINE_FUNC_DEFAULT_CALCULATE_METHOD
+
   // Local macro for boilerplate
 #define DEFINE_FUNC_DEFAULT_GET_VALUE_METHOD(_type) \
   bool Function::getValue(_type &result) const \
@@ -81,9 +146,6 @@ namespace PLEXIL
     return (*m_op)(result, *this); \
   }
 
-  DEFINE_FUNC_DEFAULT_GET_VALUE_METHOD(Boolean)
-  DEFINE_FUNC_DEFAULT_GET_VALUE_METHOD(Integer)
-  DEFINE_FUNC_DEFAULT_GET_VALUE_METHOD(Real)
   DEFINE_FUNC_DEFAULT_GET_VALUE_METHOD(String)
 
   DEFINE_FUNC_DEFAULT_GET_VALUE_METHOD(NodeState)
@@ -248,16 +310,25 @@ namespace PLEXIL
       }
     }
 
-    // Have to define this so specialized template functions can be defined below
+    // Have to define these so specialized template functions can be defined below
+#define DEFINE_FIXED_ARG_CALCULATE_METHOD(_type) \
+  virtual bool calculate(_type &result) const override \
+  { \
+    return (*m_op)(result, *this); \
+  }
+
+    DEFINE_FIXED_ARG_CALCULATE_METHOD(Boolean)
+    DEFINE_FIXED_ARG_CALCULATE_METHOD(Integer)
+    DEFINE_FIXED_ARG_CALCULATE_METHOD(Real)
+
+#undef DEFINE_FIXED_ARG_CALCULATE_METHOD
+
 #define DEFINE_FIXED_ARG_GET_VALUE_METHOD(_type) \
   virtual bool getValue(_type &result) const override \
   { \
     return (*m_op)(result, *this); \
   }
 
-    DEFINE_FIXED_ARG_GET_VALUE_METHOD(Boolean)
-    DEFINE_FIXED_ARG_GET_VALUE_METHOD(Integer)
-    DEFINE_FIXED_ARG_GET_VALUE_METHOD(Real)
     DEFINE_FIXED_ARG_GET_VALUE_METHOD(String)
 
     // Use base class method for now
@@ -326,20 +397,20 @@ namespace PLEXIL
   }
 
   // Local macro for boilerplate
-#define DEFINE_ONE_ARG_GET_VALUE_METHOD(_type) \
-  template <> bool FixedSizeFunction<1>::getValue(_type &result) const \
+#define DEFINE_ONE_ARG_CALCULATE_METHOD(_type) \
+  template <> bool FixedSizeFunction<1>::calculate(_type &result) const \
   { \
     return (*m_op)(result, exprs[0]); \
   }
 
-  DEFINE_ONE_ARG_GET_VALUE_METHOD(Boolean)
-  DEFINE_ONE_ARG_GET_VALUE_METHOD(Integer)
-  DEFINE_ONE_ARG_GET_VALUE_METHOD(Real)
+  DEFINE_ONE_ARG_CALCULATE_METHOD(Boolean)
+  DEFINE_ONE_ARG_CALCULATE_METHOD(Integer)
+  DEFINE_ONE_ARG_CALCULATE_METHOD(Real)
 
   // Use base class method for now
-  // DEFINE_ONE_ARG_GET_VALUE_METHOD(uint16_t)
+  // DEFINE_ONE_ARG_CALCULATE_METHOD(uint16_t)
 
-#undef DEFINE_ONE_ARG_GET_VALUE_METHOD
+#undef DEFINE_ONE_ARG_CALCULATE_METHOD
 
   // Specialized method
   template <>
@@ -397,20 +468,20 @@ namespace PLEXIL
   }
 
   // Local macro for boilerplate
-#define DEFINE_TWO_ARG_GET_VALUE_METHOD(_type) \
-  template <> bool FixedSizeFunction<2>::getValue(_type &result) const  \
+#define DEFINE_TWO_ARG_CALCULATE_METHOD(_type) \
+  template <> bool FixedSizeFunction<2>::calculate(_type &result) const  \
   { \
     return (*m_op)(result, exprs[0], exprs[1]); \
   }
 
-  DEFINE_TWO_ARG_GET_VALUE_METHOD(Boolean)
-  DEFINE_TWO_ARG_GET_VALUE_METHOD(Integer)
-  DEFINE_TWO_ARG_GET_VALUE_METHOD(Real)
+  DEFINE_TWO_ARG_CALCULATE_METHOD(Boolean)
+  DEFINE_TWO_ARG_CALCULATE_METHOD(Integer)
+  DEFINE_TWO_ARG_CALCULATE_METHOD(Real)
 
   // Use base class method for now 
-  // DEFINE_TWO_ARG_GET_VALUE_METHOD(uint16_t)
+  // DEFINE_TWO_ARG_CALCULATE_METHOD(uint16_t)
 
-#undef DEFINE_TWO_ARG_GET_VALUE_METHOD
+#undef DEFINE_TWO_ARG_CALCULATE_METHOD
 
   // Specialized method
   template <>
@@ -441,8 +512,8 @@ namespace PLEXIL
     NaryFunction(Operator const *oper, size_t n)
       : Function(oper),
         m_size(n),
-        exprs(new Expression*[n]()),
-        garbage(new bool[n]())
+        exprs(PlanArena::allocateArray<Expression *>(n)),
+        garbage(PlanArena::allocateArray<bool>(n))
     {
     }
 
@@ -454,8 +525,8 @@ namespace PLEXIL
             delete exprs[i];
         }
       }
-      delete[] garbage;
-      delete[] exprs;
+      PlanArena::deallocate(garbage);
+      PlanArena::deallocate(exprs);
     }
 
     virtual size_t size() const override
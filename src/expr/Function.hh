@@ -31,6 +31,8 @@
 #include "Value.hh"
 #include "ValueType.hh"
 
+#include <cstdint>
+
 namespace PLEXIL
 {
   // Forward reference
@@ -49,7 +51,18 @@ namespace PLEXIL
   //! Operator instances implement the desired computation via their
   //! operator() methods.
   //!
+  //! When lazy evaluation is enabled, a Function remembers its most
+  //! recent result, and returns it without recomputing until one of
+  //! its subexpressions notifies it of a change.  Subexpressions
+  //! shared among several node conditions are then computed at most
+  //! once between changes, however many times they are read.  A
+  //! change only invalidates the Functions that depend on it.
+  //!
+  //! Only a Function that is active and has listeners is notified of
+  //! changes, so only such a Function uses its cached result.
+  //!
   //! \see Operator
+  //! \see Notifier::hasChanged
   //! \ingroup Expressions
   class Function :
     public Expression,
@@ -87,10 +100,17 @@ namespace PLEXIL
     //! \brief Retrieve the value of this Expression in its native form.
     //! \param result The appropriately typed place to put the result.
     //! \return True if result known, false if unknown.
-    //! \note Derived classes may override the default methods for performance.
+    //! \note Boolean, Integer, and Real results are cached when lazy
+    //!       evaluation is enabled; derived classes should override
+    //!       calculate() rather than these methods.
     virtual bool getValue(Boolean &result) const override;
     virtual bool getValue(Integer &result) const override;
     virtual bool getValue(Real &result) const override;
+
+    //! \brief Retrieve the value of this Expression in its native form.
+    //! \param result The appropriately typed place to put the result.
+    //! \return True if result known, false if unknown.
+    //! \note Derived classes may override the default methods for performance.
     virtual bool getValue(String &result) const override;
 
     virtual bool getValue(NodeState &result) const override;
@@ -140,6 +160,11 @@ namespace PLEXIL
     //! \note Delegated to the operator.
     virtual bool isPropagationSource() const override;
 
+    //! \brief Query whether this expression caches its value.
+    //! \return True if lazy evaluation is enabled and the result can
+    //!         be cached, false otherwise.
+    virtual bool cachesValue() const override;
+
     //! \brief Apply the operator to the function's arguments,
     //!        and put the result in an Array.
     //! \param op Const pointer to an Operator.
@@ -148,22 +173,133 @@ namespace PLEXIL
     //! \note Needed by Operator::calcNative for array types
     virtual bool apply(Operator const *op, Array &result) const;
 
+    //
+    // Lazy evaluation
+    //
+
+    //! \brief Enable or disable lazy evaluation of all Functions.
+    //! \param lazy true to enable, false to disable.
+    //! \note Lazy evaluation is disabled by default.
+    //! \note Should be enabled before plans are loaded.  Functions
+    //!       join the change notification network as it is built,
+    //!       and a Function which has not joined does not cache.
+    //! \note Functions must not be evaluated by more than one thread
+    //!       at a time while lazy evaluation is enabled.
+    static void setLazyEvaluation(bool lazy);
+
+    //! \brief Query whether lazy evaluation is enabled.
+    //! \return true if enabled, false if not.
+    static bool getLazyEvaluation()
+    {
+      return s_lazyEvaluation;
+    }
+
+    //! \brief Get the number of times a Function result was computed
+    //!        while lazy evaluation was enabled.
+    //! \return The count.
+    static uint64_t getEvaluationCount()
+    {
+      return s_evaluations;
+    }
+
+    //! \brief Get the number of times a cached Function result was
+    //!        returned instead of being computed.
+    //! \return The count.
+    static uint64_t getSavedEvaluationCount()
+    {
+      return s_savedEvaluations;
+    }
+
+    //! \brief Reset the evaluation counts to zero.
+    static void resetEvaluationCounts();
+
   protected:
 
     //! \brief Protected constructor.  Only available to derived classes.
     //! \param op Const pointer to the function's operator.
     Function(Operator const *op);
 
+    //! \brief Compute the value of this Function.
+    //! \param result The appropriately typed place to put the result.
+    //! \return True if result known, false if unknown.
+    //! \note The default methods apply the operator to *this.
+    //!       Derived classes may override them for performance.
+    virtual bool calculate(Boolean &result) const;
+    virtual bool calculate(Integer &result) const;
+    virtual bool calculate(Real &result) const;
+
+    //! \brief Check whether a cached result of the given type is current.
+    //! \param typ The type of the result wanted.
+    //! \param known Reference to a variable to receive whether the
+    //!              cached result is known.
+    //! \return True if the cached result may be used, false if the
+    //!         result must be computed.
+    //! \note Always returns false if lazy evaluation is disabled.
+    bool checkCache(ValueType typ, bool &known) const
+    {
+      if (!s_lazyEvaluation || !m_cacheable)
+        return false;
+      if (!hasChanged() && m_cacheType == typ && isCurrent()) {
+        ++s_savedEvaluations;
+        known = m_cacheKnown;
+        return true;
+      }
+      ++s_evaluations;
+      return false;
+    }
+
+    //! \brief Record that a result of the given type was just computed.
+    //! \param typ The type of the result.
+    //! \param known Whether the result is known.
+    void markCached(ValueType typ, bool known) const
+    {
+      if (!s_lazyEvaluation || !m_cacheable)
+        return;
+      m_cacheType = typ;
+      m_cacheKnown = known;
+      if (isCurrent())
+        clearChanged();
+    }
+
     Operator const *m_op; //!< The operator for this Function.
 
   private:
 
+    //! \brief Query whether this Function is told of changes to its
+    //!        subexpressions, so that its changed flag can be trusted.
+    //! \return true if it is active and has listeners, false if not.
+    bool isCurrent() const
+    {
+      return isActive() && hasListeners();
+    }
+
     // Not implemented
     Function() = delete;
     Function(Function const &) = delete;
     Function(Function &&) = delete;
     Function& operator=(Function const &) = delete;
     Function& operator=(Function &&) = delete;
+
+    //! \brief The most recent Boolean, Integer, or Real result.
+    union {
+      mutable Boolean m_cachedBoolean;
+      mutable Integer m_cachedInteger;
+      mutable Real    m_cachedReal;
+    };
+
+    //! \brief The type of the cached result.
+    mutable ValueType m_cacheType;
+
+    //! \brief Whether the cached result is known.
+    mutable bool m_cacheKnown;
+
+    //! \brief False if the operator can change value independently
+    //!        of its arguments, so its result must not be cached.
+    bool m_cacheable;
+
+    static bool s_lazyEvaluation;       //!< True if lazy evaluation is enabled.
+    static uint64_t s_evaluations;      //!< Results computed while lazy.
+    static uint64_t s_savedEvaluations; //!< Cached results returned.
   };
 
   //
@@ -27,6 +27,7 @@
 #define PLEXIL_LISTENABLE_HH
 
 #include "ExpressionListener.hh"
+#include "PlanArena.hh"
 
 #include <functional>
 
@@ -58,11 +59,15 @@ namespace PLEXIL
   //! are dependent upon other expressions should derive from the
   //! Propagator class.
   //!
+  //! Listenable objects created while loading a plan are allocated
+  //! from the plan's PlanArena.
+  //!
   //! \see ExpressionListener
   //! \see Notifier
   //! \see Propagator
+  //! \see PlanArena
   //! \ingroup Expressions
-  class Listenable
+  class Listenable : public ArenaAllocated
   {
   public:
 
@@ -157,6 +162,21 @@ namespace PLEXIL
       return false;
     }
 
+    //! \brief Query whether this object caches a value computed from
+    //!        its subexpressions.
+
+    //! An object which caches its value must be told when its
+    //! subexpressions change, so it cannot be bypassed in the
+    //! notification network as other interior nodes are.
+
+    //! \return True if the object caches its value, false if not.
+    //! \note The default method returns false.
+    //! \see Function::setLazyEvaluation
+    virtual bool cachesValue() const
+    {
+      return false;
+    }
+
   };
 
 }
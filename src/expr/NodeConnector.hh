@@ -26,6 +26,7 @@
 #ifndef NODE_CONNECTOR_HH
 #define NODE_CONNECTOR_HH
 
+#include <cstdint>
 #include <string>
 
 namespace PLEXIL
@@ -57,6 +58,15 @@ namespace PLEXIL
     //! \brief Notify the node that a resource on which it is pending has become available.
     //! \note Used by Reservable as part of the resource contention resolution logic.
     virtual void notifyResourceAvailable() = 0;
+
+    //! \brief Get the node's priority.
+    //! \return The priority.  Numerically lower values take precedence.
+    //! \note Used by Reservable to order its waiting list.
+    //! \note The default method returns 0.
+    virtual int32_t getPriority() const
+    {
+      return 0;
+    }
   };
 
 } // namespace PLEXIL
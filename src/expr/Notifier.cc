@@ -27,8 +27,9 @@
 #include "Notifier.hh"
 
 #include "Error.hh"
+#include "Propagator.hh"
 
-#include <algorithm> // for std::find()
+#include <algorithm> // for std::find_if(), std::lower_bound()
 
 #ifdef LISTENER_DEBUG
 #include "Debug.hh"
@@ -39,14 +40,15 @@
 namespace PLEXIL
 {
 
-  // Static initialization
 #ifdef RECORD_EXPRESSION_STATS
   Notifier *Notifier::s_instanceList = nullptr;
 #endif
 
   Notifier::Notifier()
     : m_activeCount(0),
-      m_outgoingListeners()
+      m_changed(true),
+      m_outgoingListeners(),
+      m_listenerIndex()
   {
 #ifdef RECORD_EXPRESSION_STATS
     m_prev = nullptr;
@@ -63,10 +65,8 @@ namespace PLEXIL
     if (!m_outgoingListeners.empty()) {
       std::cerr << "*** " << (Expression *) this
                 << " HAS " << m_outgoingListeners.size() << " OUTGOING LISTENERS:";
-      for (std::vector<ExpressionListener *>::const_iterator it = m_outgoingListeners.begin();
-           it != m_outgoingListeners.end();
-           ++it)
-        std::cerr << ' ' << *it << ' ';
+      for (ListenerEntry const &entry : m_outgoingListeners)
+        std::cerr << ' ' << entry.listener << ' ';
       std::cerr << std::endl;
     }
 #endif
@@ -86,11 +86,6 @@ namespace PLEXIL
 #endif
   }
 
-  bool Notifier::isActive() const
-  {
-    return m_activeCount > 0;
-  }
-
   bool Notifier::hasListeners() const
   {
     return !m_outgoingListeners.empty();
@@ -100,8 +95,10 @@ namespace PLEXIL
   {
     bool changed = !m_activeCount;
     ++m_activeCount;
-    if (changed)
+    if (changed) {
+      invalidate();
       this->handleActivate();
+    }
     else
       // Check for counter wrap only if active at entry
       assertTrue_2(m_activeCount,
@@ -117,8 +114,10 @@ namespace PLEXIL
   {
     assertTrue_2(m_activeCount != 0,
                  "Attempted to deactivate expression too many times.");
-    if (--m_activeCount == 0)
+    if (--m_activeCount == 0) {
+      invalidate();
       this->handleDeactivate();
+    }
   }
 
   // No-op default method.
@@ -129,16 +128,36 @@ namespace PLEXIL
   void Notifier::addListener(ExpressionListener *ptr)
   {
     // Have to check for duplicates, sigh.
-    std::vector<ExpressionListener *>::const_iterator iter =
-      std::find(m_outgoingListeners.begin(), m_outgoingListeners.end(), ptr);
-    if (iter != m_outgoingListeners.end()) {
+    bool duplicate;
+    if (m_listenerIndex) {
+      std::vector<ExpressionListener *>::iterator it =
+        std::lower_bound(m_listenerIndex->begin(), m_listenerIndex->end(), ptr);
+      duplicate = (it != m_listenerIndex->end() && *it == ptr);
+      if (!duplicate)
+        m_listenerIndex->insert(it, ptr);
+    }
+    else
+      duplicate =
+        std::find_if(m_outgoingListeners.begin(), m_outgoingListeners.end(),
+                     [ptr](ListenerEntry const &entry) -> bool
+                     { return entry.listener == ptr; })
+        != m_outgoingListeners.end();
+    if (duplicate) {
 #ifdef LISTENER_DEBUG
       debugMsg("Notifier:addListener",
                ' ' << (Expression *) this << " listener " << ptr << " already present");
 #endif
       return;
     }
-    m_outgoingListeners.push_back(ptr);
+
+    m_outgoingListeners.push_back({ptr, ptr->asPropagator()});
+    if (!m_listenerIndex && m_outgoingListeners.size() > LISTENER_INDEX_THRESHOLD) {
+      m_listenerIndex.reset(new std::vector<ExpressionListener *>());
+      m_listenerIndex->reserve(m_outgoingListeners.capacity());
+      for (ListenerEntry const &entry : m_outgoingListeners)
+        m_listenerIndex->push_back(entry.listener);
+      std::sort(m_listenerIndex->begin(), m_listenerIndex->end());
+    }
 #ifdef LISTENER_DEBUG
     debugMsg("Notifier:addListener",
              ' ' << (Expression *) this << " added " << ptr);
@@ -160,30 +179,52 @@ namespace PLEXIL
              ' ' << (Expression *) this << ' ' << *this
              << " removing " << ptr << ' ' << typeid(*ptr).name());
 #endif
-    std::vector<ExpressionListener *>::iterator iter =
-      std::find(m_outgoingListeners.begin(), m_outgoingListeners.end(), ptr);
+    std::vector<ListenerEntry>::iterator iter =
+      std::find_if(m_outgoingListeners.begin(), m_outgoingListeners.end(),
+                   [ptr](ListenerEntry const &entry) -> bool
+                   { return entry.listener == ptr; });
     if (iter == m_outgoingListeners.end()) {
 #ifdef LISTENER_DEBUG
       debugMsg("Notifier:removeListener",
                ' ' << (Expression *) this << " listener " << ptr << " not found");
 #endif
+      return;
+    }
+
+    m_outgoingListeners.erase(iter);
+    if (m_listenerIndex) {
+      if (m_outgoingListeners.empty())
+        m_listenerIndex.reset();
+      else
+        m_listenerIndex->erase(std::lower_bound(m_listenerIndex->begin(),
+                                                m_listenerIndex->end(),
+                                                ptr));
     }
-    else {
-      m_outgoingListeners.erase(iter);
 #ifdef LISTENER_DEBUG
-      debugMsg("Notifier:removeListener",
-               ' ' << (Expression *) this << " removed " << ptr);
+    debugMsg("Notifier:removeListener",
+             ' ' << (Expression *) this << " removed " << ptr);
 #endif
-    }
   }
  
+  void Notifier::invalidate()
+  {
+    m_changed = true;
+    for (ListenerEntry const &entry : m_outgoingListeners)
+      if (entry.propagator)
+        static_cast<Notifier *>(entry.propagator)->invalidate();
+  }
+
   void Notifier::publishChange()
   {
+    m_changed = true;
     if (isActive())
-      for (std::vector<ExpressionListener *>::iterator it = m_outgoingListeners.begin();
-           it != m_outgoingListeners.end();
-           ++it)
-        (*it)->notifyChanged();
+      for (ListenerEntry const &entry : m_outgoingListeners) {
+        if (entry.propagator)
+          // Propagator::notifyChanged() is final, so this call is direct
+          entry.propagator->notifyChanged();
+        else
+          entry.listener->notifyChanged();
+      }
   }
 
 #ifdef RECORD_EXPRESSION_STATS
@@ -29,11 +29,15 @@
 #include "Listenable.hh"
 
 #include <cstddef> // size_t
+#include <memory>
 #include <vector>
 
 namespace PLEXIL
 {
 
+  // Forward reference
+  class Propagator;
+
   //! \class Notifier
   //! \brief Abstract base class for objects which publish changes to listeners.
 
@@ -47,6 +51,22 @@ namespace PLEXIL
   //! member function will call the notifyChanged() member function on
   //! each listener in its list.
 
+  //! Listeners are kept in a contiguous array in the order they were
+  //! added.  Whether each listener is a Propagator is determined once,
+  //! when it is added, so that publishChange() can call the
+  //! Propagator's final notifyChanged() method directly.  Once a
+  //! Notifier has many listeners, it also keeps a sorted index of
+  //! them, so that checking for duplicates in addListener() does not
+  //! require a linear search.
+
+  //! Each Notifier also records whether its value may have changed
+  //! since the value was last used.  publishChange() sets the flag.
+  //! Activation and deactivation set it too, on this object and on
+  //! every Propagator listening to it, because a value can change
+  //! then without being published.  Function clears the flag when it
+  //! caches a result, and uses it to tell whether the result is
+  //! still current.
+
   //! Each Notifier instance maintains an activation count,
   //! initialized to 0 (inactive).  When the activate() method is
   //! called, the count is incremented; if the count was 0 prior to
@@ -93,11 +113,27 @@ namespace PLEXIL
 
     //! \brief Query whether this object is active (i.e. publishing change notifications).
     //! \return true if active, false if not.
-    virtual bool isActive() const override;
+    virtual bool isActive() const override
+    {
+      return m_activeCount > 0;
+    }
 
     //! \brief If active, notify all listeners of a change.  If inactive, do nothing.
+    //! \note Always marks this object as changed.
     virtual void publishChange();
 
+    //! \brief Query whether this object may have changed value since
+    //!        its value was last marked as used.
+    //! \return true if it may have changed, false if not.
+    //! \note Changes reach an object through its change
+    //!       notifications, so this is only meaningful for an object
+    //!       with listeners, i.e. one that is in the notification graph.
+    //! \see Notifier::clearChanged
+    bool hasChanged() const
+    {
+      return m_changed;
+    }
+
 #ifdef RECORD_EXPRESSION_STATS
     //! \brief Get a linked list of all Notifier instances.
     //! \return The list.
@@ -125,6 +161,21 @@ namespace PLEXIL
     //! \return True if present, false if not.
     bool hasListeners() const;
 
+    //! \brief Record that this object's current value has been used,
+    //!        e.g. cached, so that hasChanged() returns false until
+    //!        the next change.
+    void clearChanged() const
+    {
+      m_changed = false;
+    }
+
+    //! \brief Mark this object, and every Propagator listening to it
+    //!        directly or indirectly, as changed.  Does not notify
+    //!        the listeners.
+    //! \note For changes of value which are not published,
+    //!       e.g. on activation and deactivation.
+    void invalidate();
+
     //
     // Member functions which derived classes may implement
     //
@@ -154,10 +205,32 @@ namespace PLEXIL
     //!        has been called.  Initialized to 0.
     //! \see Notifier::activate
     //! \see Notifier::deactivate
-    size_t m_activeCount;
-
-    //! \brief Listeners to this object.
-    std::vector<ExpressionListener *> m_outgoingListeners;
+    //! \note Narrower than size_t so m_changed fits in the padding.
+    unsigned int m_activeCount;
+
+    //! \brief True if this object may have changed value since
+    //!        clearChanged() was last called.  Initialized to true.
+    mutable bool m_changed;
+
+    //! \brief An entry in the listener list.
+    struct ListenerEntry
+    {
+      ExpressionListener *listener;
+      Propagator *propagator; //!< Same object as listener if it is a Propagator, else null.
+    };
+
+    //! \brief The listener count above which the sorted index is used.
+    //! \note Below this, a linear search is as fast as the index;
+    //!       above it, the search cost grows faster than the
+    //!       cost of keeping the index.
+    static constexpr size_t LISTENER_INDEX_THRESHOLD = 8;
+
+    //! \brief Listeners to this object, in the order they were added.
+    std::vector<ListenerEntry> m_outgoingListeners;
+
+    //! \brief The listeners, sorted by address.  Only allocated once
+    //!        the number of listeners exceeds LISTENER_INDEX_THRESHOLD.
+    std::unique_ptr<std::vector<ExpressionListener *> > m_listenerIndex;
 
 #ifdef RECORD_EXPRESSION_STATS
     //! \brief Pointer to a newer Notifier instance.  Initialized to nullptr.
@@ -55,6 +55,11 @@ namespace PLEXIL {
   // We only add listeners to expressions that are propagation sources,
   // whether they are leaves or interior nodes of the tree.
   //
+  // The exception is an interior node that caches its value, which must
+  // see the changes below it.  Whether a node caches can depend on
+  // settings which change after the network is built, so teardown tries
+  // every interior node.
+  //
 
   // Should only be called on expression root and internal nodes that are propagation sources.
   void Propagator::addListener(ExpressionListener *ptr)
@@ -64,7 +69,7 @@ namespace PLEXIL {
       ListenableUnaryOperator addListenerHelper =
         [this, &addListenerHelper](Listenable *exp) -> void
         {
-          if (exp->isPropagationSource())
+          if (exp->isPropagationSource() || exp->cachesValue())
             // This object can independently generate notifications,
             // so add requested listener here
             exp->addListener(this);
@@ -73,33 +78,30 @@ namespace PLEXIL {
             exp->doSubexprs(addListenerHelper);
         };
       doSubexprs(addListenerHelper);
+      // Changes were not seen while there were no listeners
+      invalidate();
     }
     Notifier::addListener(ptr);
   }
 
   void Propagator::removeListener(ExpressionListener *ptr)
   {
+    if (!hasListeners())
+      return;
     Notifier::removeListener(ptr);
     // If ptr was our last listener, remove this from subexpressions
     if (!hasListeners()) {
       ListenableUnaryOperator removeListenerHelper =
         [this, &removeListenerHelper](Listenable *exp) -> void
         {
-          if (exp->isPropagationSource())
-            exp->removeListener(this);
-          else
+          exp->removeListener(this);
+          if (!exp->isPropagationSource())
             exp->doSubexprs(removeListenerHelper);
         };
       doSubexprs(removeListenerHelper);
     }
   }
 
-  void Propagator::notifyChanged()
-  {
-    if (this->isActive())
-      this->handleChange();
-  }
-
   void Propagator::handleChange()
   {
     publishChange();
@@ -85,7 +85,28 @@ namespace PLEXIL
     virtual void removeListener(ExpressionListener *ptr);
 
     //! \brief Notify this object of a change.
-    virtual void notifyChanged();
+    //! \note Final, so that Notifier::publishChange can call it
+    //!       without virtual dispatch.
+    virtual void notifyChanged() final
+    {
+      if (Notifier::isActive())
+        this->handleChange();
+    }
+
+    //! \brief Query whether this object is active.
+    //! \return true if active, false if not.
+    //! \note Final, so that notifyChanged need not make a virtual call.
+    virtual bool isActive() const final
+    {
+      return Notifier::isActive();
+    }
+
+    //! \brief Return this object as a Propagator.
+    //! \return Pointer to this object.
+    virtual Propagator *asPropagator() final
+    {
+      return this;
+    }
 
   protected:
 
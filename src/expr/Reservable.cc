@@ -91,6 +91,7 @@ namespace PLEXIL
       debugMsg("Reservable:release",
                ' ' << this << " by node " << node->getNodeId() << ' ' << node);
       m_holder = nullptr;
+      // Wake the waiting nodes in priority order
       for (NodeConnector *n : m_waiters)
         n->notifyResourceAvailable();
     }
@@ -100,11 +101,19 @@ namespace PLEXIL
   //! @param node Pointer to the node.
   void Reservable::addWaitingNode(NodeConnector *node)
   {
-    if (std::find(m_waiters.begin(), m_waiters.end(), node) == m_waiters.end()) {
-      debugMsg("Reservable:addWaitingNode",
-               ' ' << this << " node " << node->getNodeId() << ' ' << node);
-      m_waiters.push_back(node);
+    // Find the insertion point and check for duplicates in one pass
+    int32_t priority = node->getPriority();
+    WaitQueue::iterator insertPoint = m_waiters.end();
+    for (WaitQueue::iterator it = m_waiters.begin(); it != m_waiters.end(); ++it) {
+      if (*it == node)
+        return; // already waiting
+      if (insertPoint == m_waiters.end() && (*it)->getPriority() > priority)
+        insertPoint = it;
     }
+    debugMsg("Reservable:addWaitingNode",
+             ' ' << this << " node " << node->getNodeId() << ' ' << node
+             << " priority " << priority);
+    m_waiters.insert(insertPoint, node);
   }
 
   //! Remove a node from the list of nodes waiting on the variable.
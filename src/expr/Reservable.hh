@@ -68,6 +68,8 @@ namespace PLEXIL
 
     //! Add a node to the list of nodes waiting on the variable.
     //! @param node Pointer to the node.
+    //! @note The list is kept in priority order, and in order of
+    //!       arrival within each priority.
     void addWaitingNode(NodeConnector *node);
 
     //! Remove a node from the list of nodes waiting on the variable.
@@ -85,7 +87,7 @@ namespace PLEXIL
 
     using WaitQueue = std::vector<NodeConnector *>;
 
-    //! Nodes waiting to reserve this object.
+    //! Nodes waiting to reserve this object, in priority order.
     WaitQueue m_waiters;
 
     //! The node currently holding this object.
@@ -49,7 +49,8 @@ namespace PLEXIL
       m_initializer(nullptr),
       m_name(nullptr),
       m_known(false),
-      m_savedKnown(false)
+      m_savedKnown(false),
+      m_initializerIsGarbage(false)
   {
   }
 
@@ -59,7 +60,8 @@ namespace PLEXIL
       m_initializer(nullptr),
       m_name(nullptr),
       m_known(false),
-      m_savedKnown(false)
+      m_savedKnown(false),
+      m_initializerIsGarbage(false)
   {
   }
 
@@ -70,7 +72,8 @@ namespace PLEXIL
       m_initializer(new Constant<T>(initVal)),
       m_name(nullptr),
       m_known(false),
-      m_savedKnown(false)
+      m_savedKnown(false),
+      m_initializerIsGarbage(true)
   {
   }
 
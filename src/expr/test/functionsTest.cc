@@ -71,6 +71,26 @@ Passthrough<Integer> pti;
 Passthrough<Real> ptd;
 Passthrough<String> pts;
 
+// Counts the number of times it is applied
+template <typename R>
+class CountingPassthrough : public Passthrough<R>
+{
+public:
+  CountingPassthrough()
+    : Passthrough<R>(),
+      count(0)
+  {
+  }
+
+  bool operator()(R &result, Expression const * arg) const
+  {
+    ++count;
+    return Passthrough<R>::operator()(result, arg);
+  }
+
+  mutable size_t count;
+};
+
 // TODO - test propagation of changes through variable and fn
 static bool testUnaryBasics()
 {
@@ -493,11 +513,188 @@ static bool testNaryBasics()
   return true;
 }
 
+static bool testLazyEvaluation()
+{
+  Function::setLazyEvaluation(true);
+  Function::resetEvaluationCounts();
+
+  {
+    // Nested functions; only the outer one has a listener
+    CountingPassthrough<Integer> outerOp, innerOp;
+    IntegerVariable x(1);
+    Function *inner = makeFunction(&innerOp, &x, false);
+    Function *outer = makeFunction(&outerOp, inner, true);
+    bool changed = false;
+    TrivialListener l(changed);
+    outer->addListener(&l);
+    outer->activate();
+
+    Integer temp;
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(temp == 1);
+    assertTrue_1(outerOp.count == 1);
+    assertTrue_1(innerOp.count == 1);
+
+    // Nothing changed, so nothing is recomputed
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(temp == 1);
+    assertTrue_1(inner->getValue(temp));
+    assertTrue_1(temp == 1);
+    assertTrue_1(outerOp.count == 1);
+    assertTrue_1(innerOp.count == 1);
+    assertTrue_1(Function::getEvaluationCount() == 2);
+    assertTrue_1(Function::getSavedEvaluationCount() == 2);
+
+    // Change to a leaf invalidates the whole tree
+    x.setValue((Integer) 2);
+    assertTrue_1(changed);
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(temp == 2);
+    assertTrue_1(outerOp.count == 2);
+    assertTrue_1(innerOp.count == 2);
+
+    // Unknown results are cached too
+    x.setUnknown();
+    assertTrue_1(!outer->getValue(temp));
+    assertTrue_1(!outer->getValue(temp));
+    assertTrue_1(outerOp.count == 3);
+
+    // Reactivation resets the variable to its initial value
+    x.deactivate();
+    x.activate();
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(temp == 1);
+    assertTrue_1(outerOp.count == 4);
+    assertTrue_1(innerOp.count == 4);
+
+    // A change elsewhere leaves the result alone
+    IntegerVariable y(5);
+    CountingPassthrough<Integer> otherOp;
+    Function *other = makeFunction(&otherOp, &y, false);
+    bool otherChanged = false;
+    TrivialListener ol(otherChanged);
+    other->addListener(&ol);
+    other->activate();
+    y.setValue((Integer) 6);
+    assertTrue_1(otherChanged);
+    assertTrue_1(other->getValue(temp));
+    assertTrue_1(temp == 6);
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(temp == 1);
+    assertTrue_1(outerOp.count == 4);
+    assertTrue_1(innerOp.count == 4);
+    other->deactivate();
+    other->removeListener(&ol);
+    delete other;
+
+    // Disabling lazy evaluation recomputes every time
+    Function::setLazyEvaluation(false);
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(outerOp.count == 6);
+    Function::setLazyEvaluation(true);
+
+    // Changes made while disabled are seen once it is enabled again
+    x.setValue((Integer) 3);
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(temp == 3);
+    assertTrue_1(outerOp.count == 7);
+    Function::setLazyEvaluation(false);
+    x.setValue((Integer) 4);
+    Function::setLazyEvaluation(true);
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(temp == 4);
+    assertTrue_1(outerOp.count == 8);
+
+    outer->deactivate();
+    outer->removeListener(&l);
+    delete outer;
+  }
+
+  {
+    // A Function with no listeners is not told of changes, so it
+    // does not use its cache
+    CountingPassthrough<Integer> op;
+    IntegerVariable x(1);
+    Function *fn = makeFunction(&op, &x, false);
+    fn->activate();
+    Integer temp;
+    assertTrue_1(fn->getValue(temp));
+    x.setValue((Integer) 2);
+    assertTrue_1(fn->getValue(temp));
+    assertTrue_1(temp == 2);
+    assertTrue_1(op.count == 2);
+    fn->deactivate();
+    delete fn;
+  }
+
+  {
+    // Functions built while lazy evaluation was disabled: only the
+    // root is in the notification network, so only it caches
+    Function::setLazyEvaluation(false);
+    CountingPassthrough<Integer> outerOp, innerOp;
+    IntegerVariable x(1);
+    Function *inner = makeFunction(&innerOp, &x, false);
+    Function *outer = makeFunction(&outerOp, inner, true);
+    bool changed = false;
+    TrivialListener l(changed);
+    outer->addListener(&l);
+    outer->activate();
+    Function::setLazyEvaluation(true);
+
+    Integer temp;
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(inner->getValue(temp));
+    assertTrue_1(outerOp.count == 1);
+    assertTrue_1(innerOp.count == 2);
+    x.setValue((Integer) 2);
+    assertTrue_1(outer->getValue(temp));
+    assertTrue_1(temp == 2);
+    assertTrue_1(outerOp.count == 2);
+
+    // Teardown finds the listeners whichever way they were added
+    outer->deactivate();
+    outer->removeListener(&l);
+    delete outer;
+  }
+
+  {
+    // Cached function results
+    CountingPassthrough<String> strOp;
+    StringVariable s(String("Foo"));
+    Function *str = makeCachedFunction(&strOp, &s, false);
+    bool changed = false;
+    TrivialListener l(changed);
+    str->addListener(&l);
+    str->activate();
+    String const *sptr = nullptr;
+    assertTrue_1(str->getValuePointer(sptr));
+    assertTrue_1(*sptr == "Foo");
+    assertTrue_1(str->getValuePointer(sptr));
+    assertTrue_1(strOp.count == 1);
+
+    s.setValue(String("Bar"));
+    assertTrue_1(str->getValuePointer(sptr));
+    assertTrue_1(*sptr == "Bar");
+    assertTrue_1(strOp.count == 2);
+
+    str->deactivate();
+    str->removeListener(&l);
+    delete str;
+  }
+
+  Function::setLazyEvaluation(false);
+  Function::resetEvaluationCounts();
+  return true;
+}
+
 bool functionsTest()
 {
   runTest(testUnaryBasics);
   runTest(testUnaryPropagation);
   runTest(testBinaryBasics);
   runTest(testNaryBasics);
+  runTest(testLazyEvaluation);
   return true;
 }
@@ -36,6 +36,8 @@
 #include "test/TrivialListener.hh"
 #include "Value.hh"
 
+#include <vector>
+
 using namespace PLEXIL;
 
 class PropagatingListener : public ExpressionListener
@@ -237,9 +239,104 @@ static bool testDirectPropagation()
   return true;
 }
 
+class OrderListener : public ExpressionListener
+{
+public:
+  OrderListener(std::vector<int> &log, int id)
+    : m_log(log),
+      m_id(id)
+  {
+  }
+
+protected:
+  void notifyChanged()
+  {
+    m_log.push_back(m_id);
+  }
+
+private:
+  std::vector<int> &m_log;
+  int m_id;
+};
+
+// Enough listeners of each kind to exceed Notifier's index threshold
+#define N_WIDE 40
+
+static bool testWideFanout()
+{
+  TrivialExpression source;
+  TrivialExpression dests[N_WIDE];
+  std::vector<int> log;
+  std::vector<OrderListener> listeners;
+  listeners.reserve(N_WIDE);
+  for (int i = 0; i < N_WIDE; ++i)
+    listeners.push_back(OrderListener(log, i));
+
+  // Interleave Propagators and plain listeners, adding each twice
+  for (int i = 0; i < N_WIDE; ++i) {
+    source.addListener(&dests[i]);
+    source.addListener(&listeners[i]);
+  }
+  for (int i = 0; i < N_WIDE; ++i) {
+    source.addListener(&listeners[i]);
+    source.addListener(&dests[i]);
+  }
+
+  source.activate();
+  for (int i = 0; i < N_WIDE; ++i)
+    dests[i].activate();
+
+  // Every listener notified exactly once, in the order added
+  source.publishChange();
+  assertTrue_1(log.size() == N_WIDE);
+  for (int i = 0; i < N_WIDE; ++i) {
+    assertTrue_1(log[i] == i);
+    assertTrue_1(dests[i].changed);
+    dests[i].changed = false;
+  }
+  log.clear();
+
+  // Remove the even-numbered listeners, and one twice
+  for (int i = 0; i < N_WIDE; i += 2) {
+    source.removeListener(&dests[i]);
+    source.removeListener(&listeners[i]);
+  }
+  source.removeListener(&listeners[0]);
+
+  source.publishChange();
+  assertTrue_1(log.size() == N_WIDE / 2);
+  for (int i = 0; i < N_WIDE; ++i) {
+    assertTrue_1(dests[i].changed == (i % 2 == 1));
+    dests[i].changed = false;
+  }
+  for (int i = 0; i < N_WIDE / 2; ++i)
+    assertTrue_1(log[i] == 2 * i + 1);
+  log.clear();
+
+  // Re-add a removed listener, which goes to the end
+  source.addListener(&listeners[0]);
+  source.addListener(&listeners[0]);
+  source.publishChange();
+  assertTrue_1(log.size() == N_WIDE / 2 + 1);
+  assertTrue_1(log.back() == 0);
+
+  // Clean up
+  for (int i = 0; i < N_WIDE; ++i) {
+    source.removeListener(&dests[i]);
+    source.removeListener(&listeners[i]);
+    dests[i].deactivate();
+  }
+  source.deactivate();
+
+  return true;
+}
+
+#undef N_WIDE
+
 bool listenerTest()
 {
   runTest(testListenerPropagation);
   runTest(testDirectPropagation);
+  runTest(testWideFanout);
   return true;
 }
@@ -0,0 +1,193 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Measures the cost of attaching change listeners to one expression,
+// and of publishing a change to them.  Each listener is an active
+// Propagator, as node conditions and operator expressions are, and is
+// added twice, as happens when an expression appears twice in a
+// condition.
+//
+
+#include "Error.hh"
+#include "Expression.hh"
+#include "Propagator.hh"
+#include "Value.hh"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace PLEXIL;
+
+using Clock = std::chrono::steady_clock;
+
+// A propagating expression which does nothing else
+class BenchExpression final :
+  public Expression,
+  public Propagator
+{
+public:
+  BenchExpression()
+    : Propagator(),
+      changes(0)
+  {
+  }
+
+#define DEFINE_NULL_GET_VALUE_METHOD(_rtype)  bool getValue(_rtype &) const { return false; }
+
+  DEFINE_NULL_GET_VALUE_METHOD(Boolean)
+  DEFINE_NULL_GET_VALUE_METHOD(NodeState)
+  DEFINE_NULL_GET_VALUE_METHOD(NodeOutcome)
+  DEFINE_NULL_GET_VALUE_METHOD(FailureType)
+  DEFINE_NULL_GET_VALUE_METHOD(CommandHandleValue)
+  DEFINE_NULL_GET_VALUE_METHOD(Integer)
+  DEFINE_NULL_GET_VALUE_METHOD(Real)
+  DEFINE_NULL_GET_VALUE_METHOD(String)
+
+#undef DEFINE_NULL_GET_VALUE_METHOD
+
+#define DEFINE_NULL_GET_VALUE_PTR_METHOD(_rtype)  bool getValuePointer(_rtype const *&) const { return false; }
+
+  DEFINE_NULL_GET_VALUE_PTR_METHOD(String)
+  DEFINE_NULL_GET_VALUE_PTR_METHOD(Array)
+  DEFINE_NULL_GET_VALUE_PTR_METHOD(BooleanArray)
+  DEFINE_NULL_GET_VALUE_PTR_METHOD(IntegerArray)
+  DEFINE_NULL_GET_VALUE_PTR_METHOD(RealArray)
+  DEFINE_NULL_GET_VALUE_PTR_METHOD(StringArray)
+
+#undef DEFINE_NULL_GET_VALUE_PTR_METHOD
+
+  void handleChange()
+  {
+    ++changes;
+  }
+
+  const char *exprName() const { return "bench"; }
+  ValueType valueType() const { return UNKNOWN_TYPE; }
+  void print(std::ostream & /* s */) const {}
+  void printValue(std::ostream & /* s */) const {}
+  bool isConstant() const { return false; }
+  bool isKnown() const { return false; }
+  Value toValue() const { return Value(); }
+
+  size_t changes;
+};
+
+static void usage()
+{
+  std::cout << "Usage: notifier-benchmark [options]\n"
+            << " Options:\n"
+            << "  -n <number>  Number of listeners on the source (default 1000)\n"
+            << "  -p <number>  Number of changes to publish (default 10000)\n"
+            << "  -r <number>  Number of times to run the benchmark (default 5)\n"
+            << "  -h           Display this message and exit\n"
+            << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t nListeners = 1000;
+  size_t nPublishes = 10000;
+  unsigned int repeats = 5;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-h")) {
+      usage();
+      return 0;
+    }
+    else if (i + 1 < argc && !strcmp(argv[i], "-n"))
+      nListeners = (size_t) atol(argv[++i]);
+    else if (i + 1 < argc && !strcmp(argv[i], "-p"))
+      nPublishes = (size_t) atol(argv[++i]);
+    else if (i + 1 < argc && !strcmp(argv[i], "-r"))
+      repeats = (unsigned int) atoi(argv[++i]);
+    else {
+      std::cerr << "Unknown option " << argv[i] << std::endl;
+      usage();
+      return 1;
+    }
+  }
+  if (!nListeners || !nPublishes || !repeats) {
+    usage();
+    return 1;
+  }
+
+  Error::doThrowExceptions();
+  std::cout << nListeners << " listeners, " << nPublishes << " changes, "
+            << repeats << " runs" << std::endl;
+
+  double bestAddNs = 0;
+  double bestPublishNs = 0;
+
+  for (unsigned int r = 0; r < repeats; ++r) {
+    BenchExpression source;
+    std::unique_ptr<BenchExpression[]> dests(new BenchExpression[nListeners]);
+
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < nListeners; ++i)
+      source.addListener(&dests[i]);
+    for (size_t i = 0; i < nListeners; ++i)
+      source.addListener(&dests[i]);
+    double addNs =
+      std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    source.activate();
+    for (size_t i = 0; i < nListeners; ++i)
+      dests[i].activate();
+
+    start = Clock::now();
+    for (size_t p = 0; p < nPublishes; ++p)
+      source.publishChange();
+    double publishNs =
+      std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    // Each listener must have been notified once per change
+    for (size_t i = 0; i < nListeners; ++i)
+      assertTrue_1(dests[i].changes == nPublishes);
+
+    if (!r || addNs < bestAddNs)
+      bestAddNs = addNs;
+    if (!r || publishNs < bestPublishNs)
+      bestPublishNs = publishNs;
+
+    for (size_t i = 0; i < nListeners; ++i) {
+      dests[i].deactivate();
+      source.removeListener(&dests[i]);
+    }
+    source.deactivate();
+  }
+
+  std::cout << std::fixed << std::setprecision(1)
+            << "Best add: " << bestAddNs / nListeners << " ns/listener\n"
+            << "Best publish: " << bestPublishNs / (nListeners * nPublishes)
+            << " ns/listener" << std::endl;
+  return 0;
+}
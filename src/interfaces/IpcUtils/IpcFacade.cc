@@ -47,6 +47,9 @@ namespace PLEXIL
   static void ipcMessageHandler(MSG_INSTANCE /* rawMsg */,
                                 void * unmarshalledMsg,
                                 void * this_as_void_ptr);
+  static void ipcHandlerChangeHandler(const char *msgName,
+                                      int numHandlers,
+                                      void *this_as_void_ptr);
 
   /**
    * Returns a constant character string pointer for the formatted message type,
@@ -144,6 +147,10 @@ namespace PLEXIL
       return STRING_PAIR_MSG;
       break;
 
+    case PlexilMsgType_PackedValues:
+      return PACKED_VALUES_MSG;
+      break;
+
     default:
       return nullptr;
       break;
@@ -308,6 +315,69 @@ namespace PLEXIL
     }
   }
 
+  /**
+   * @brief Utility function to delete a value message constructed by
+   *        constructPlexilValueMsg().
+   * @param m Pointer to the message.
+   */
+  static void freePlexilValueMsg(PlexilMsgBase *m)
+  {
+    switch (m->msgType) {
+    case PlexilMsgType_UnknownValue:
+      delete (PlexilUnknownValueMsg*) m;
+      break;
+
+    case PlexilMsgType_CommandHandleValue:
+      delete (PlexilCommandHandleValueMsg*) m;
+      break;
+
+    case PlexilMsgType_BooleanValue:
+      delete (PlexilBooleanValueMsg*) m;
+      break;
+
+    case PlexilMsgType_IntegerValue:
+      delete (PlexilIntegerValueMsg*) m;
+      break;
+
+    case PlexilMsgType_RealValue:
+      delete (PlexilRealValueMsg*) m;
+      break;
+
+    case PlexilMsgType_StringValue:
+      delete (PlexilStringValueMsg*) m;
+      break;
+
+      // *** DON'T FREE ARRAY DATA! IPC does this. ***
+    case PlexilMsgType_BooleanArray: {
+      PlexilBooleanArrayMsg *bam = (PlexilBooleanArrayMsg*) m;
+      delete bam;
+      break;
+    }
+
+    case PlexilMsgType_IntegerArray: {
+      PlexilIntegerArrayMsg *iam = (PlexilIntegerArrayMsg*) m;
+      delete iam;
+      break;
+    }
+
+    case PlexilMsgType_RealArray: {
+      PlexilRealArrayMsg *ram = (PlexilRealArrayMsg*) m;
+      delete ram;
+      break;
+    }
+
+    case PlexilMsgType_StringArray: {
+      PlexilStringArrayMsg *sam = (PlexilStringArrayMsg*) m;
+      delete sam;
+      break;
+    }
+
+    default:
+      delete m;
+      break;
+    }
+  }
+
   struct PlexilMsgBase* constructPlexilPairMsg(std::string const& name,
                                                Value const val)
   {
@@ -482,7 +552,8 @@ namespace PLEXIL
     m_nextSerial(1),
     m_isInitialized(false),
     m_isStarted(false),
-    m_stopDispatchThread(false)
+    m_stopDispatchThread(false),
+    m_packedEnabled(true)
   {
     debugMsg("IpcFacade", " constructor");
   }
@@ -608,6 +679,14 @@ namespace PLEXIL
     unsubscribeFromMsgs();
     m_isStarted = false;
 
+    // Stop tracking handler counts
+    {
+      std::lock_guard<std::mutex> guard(m_handlerCountsMutex);
+      for (HandlerCountMap::value_type const &pr : m_handlerCounts)
+        IPC_unsubscribeHandlerChange(pr.first.c_str(), ipcHandlerChangeHandler);
+      m_handlerCounts.clear();
+    }
+
     // Disconnect from central
     debugMsg("IpcFacade:stop", ' ' << m_myUID << " disconnecting");
     IPC_disconnect();
@@ -643,9 +722,11 @@ namespace PLEXIL
     debugMsg("IpcFacade:unsubscribe", " locking listeners mutex");
     {
       std::lock_guard<std::mutex> guard(m_listenersMutex);
-      std::remove(m_listenersToAll.begin(), m_listenersToAll.end(), listener);
-      for (ListenerMap::value_type pair : m_registeredListeners)
-        std::remove(pair.second.begin(), pair.second.end(), listener);
+      m_listenersToAll.erase(std::remove(m_listenersToAll.begin(), m_listenersToAll.end(), listener),
+                             m_listenersToAll.end());
+      for (ListenerMap::value_type &pair : m_registeredListeners)
+        pair.second.erase(std::remove(pair.second.begin(), pair.second.end(), listener),
+                          pair.second.end());
     }
     debugMsg("IpcFacade:unsubscribe", " unlocking listeners mutex");
   }
@@ -666,6 +747,7 @@ namespace PLEXIL
      INTEGER_PAIR_MSG,
      REAL_PAIR_MSG,
      STRING_PAIR_MSG,
+     PACKED_VALUES_MSG,
      nullptr};
 
   IPC_RETURN_TYPE IpcFacade::subscribeToMsgs()
@@ -733,18 +815,22 @@ namespace PLEXIL
   {
     assertTrue_2(m_isStarted, "publishCommand called before started");
     uint32_t serial = getSerialNumber();
-    struct PlexilStringValueMsg cmdPacket =
-      { { PlexilMsgType_Command,
-          (uint16_t) argsToDeliver.size(),
-          serial,
-          m_myUID.c_str() },
-        command.c_str() };
-
-    IPC_RETURN_TYPE result =
-      IPC_publishData(formatMsgName(STRING_VALUE_MSG, dest), (void *) &cmdPacket);
-
-    if (result == IPC_OK) {
-      result = sendParameters(argsToDeliver, serial);
+    IPC_RETURN_TYPE result = IPC_OK;
+    if (!sendPacked(PlexilMsgType_Command, command, argsToDeliver, serial,
+                    dest, 0, std::string(), result)) {
+      struct PlexilStringValueMsg cmdPacket =
+        { { PlexilMsgType_Command,
+            (uint16_t) argsToDeliver.size(),
+            serial,
+            m_myUID.c_str() },
+          command.c_str() };
+
+      result =
+        IPC_publishData(formatMsgName(STRING_VALUE_MSG, dest), (void *) &cmdPacket);
+
+      if (result == IPC_OK) {
+        result = sendParameters(argsToDeliver, serial);
+      }
     }
 
     setError(result);
@@ -767,22 +853,26 @@ namespace PLEXIL
                                     std::string const &dest,
                                     std::vector<Value> const &argsToDeliver)
   {
-    // Construct the messages
-    // Leader
     uint32_t serial = getSerialNumber();
-    struct PlexilStringValueMsg leader =
-      { { PlexilMsgType_LookupNow,
-          (uint16_t) argsToDeliver.size(),
-          serial,
-          m_myUID.c_str() },
-        lookup.c_str() };
-
-    IPC_RETURN_TYPE result =
-      IPC_publishData(formatMsgName(STRING_VALUE_MSG, dest), (void *) &leader);
-
-    if (result == IPC_OK && !argsToDeliver.empty())
-      // Send trailers, if any 
-      result = sendParameters(argsToDeliver, serial);
+    IPC_RETURN_TYPE result = IPC_OK;
+    if (!sendPacked(PlexilMsgType_LookupNow, lookup, argsToDeliver, serial,
+                    dest, 0, std::string(), result)) {
+      // Construct the messages
+      // Leader
+      struct PlexilStringValueMsg leader =
+        { { PlexilMsgType_LookupNow,
+            (uint16_t) argsToDeliver.size(),
+            serial,
+            m_myUID.c_str() },
+          lookup.c_str() };
+
+      result =
+        IPC_publishData(formatMsgName(STRING_VALUE_MSG, dest), (void *) &leader);
+
+      if (result == IPC_OK && !argsToDeliver.empty())
+        // Send trailers, if any 
+        result = sendParameters(argsToDeliver, serial);
+    }
 
     setError(result);
     return result == IPC_OK ? serial : ERROR_SERIAL;
@@ -794,17 +884,22 @@ namespace PLEXIL
   {
     assertTrue_2(m_isStarted, "publishReturnValues called before started");
     uint32_t serial = getSerialNumber();
-    struct PlexilReturnValuesMsg packet =
-      { { PlexilMsgType_ReturnValues,
-          1, // trailing msgs
-          serial,
-          m_myUID.c_str() },
-        request_serial,
-        request_uid.c_str() };
-    IPC_RETURN_TYPE result =
-      IPC_publishData(formatMsgName(RETURN_VALUE_MSG, request_uid), (void *) &packet);
-    if (result == IPC_OK) {
-      result = sendParameters(std::vector<Value>(1, arg), serial, request_uid);
+    std::vector<Value> const args(1, arg);
+    IPC_RETURN_TYPE result = IPC_OK;
+    if (!sendPacked(PlexilMsgType_ReturnValues, std::string(), args, serial,
+                    request_uid, request_serial, request_uid, result)) {
+      struct PlexilReturnValuesMsg packet =
+        { { PlexilMsgType_ReturnValues,
+            1, // trailing msgs
+            serial,
+            m_myUID.c_str() },
+          request_serial,
+          request_uid.c_str() };
+      result =
+        IPC_publishData(formatMsgName(RETURN_VALUE_MSG, request_uid), (void *) &packet);
+      if (result == IPC_OK) {
+        result = sendParameters(args, serial, request_uid);
+      }
     }
     setError(result);
     return result == IPC_OK ? serial : ERROR_SERIAL;
@@ -825,15 +920,19 @@ namespace PLEXIL
     debugMsg("IpcFacade:publishTelemetry",
              ' ' << m_myUID << " sending telemetry message for \"" << destName << "\"");
     uint32_t leaderSerial = getSerialNumber();
-    PlexilStringValueMsg tvMsg =
-      { { (uint16_t) PlexilMsgType_TelemetryValues,
-          (uint16_t) values.size(),
-          leaderSerial,
-          m_myUID.c_str()},
-        destName.c_str()};
-    IPC_RETURN_TYPE status = IPC_publishData(STRING_VALUE_MSG, (void *) &tvMsg);
-    if (status == IPC_OK && !values.empty()) {
-      status = sendParameters(values, leaderSerial);
+    IPC_RETURN_TYPE status = IPC_OK;
+    if (!sendPacked(PlexilMsgType_TelemetryValues, destName, values, leaderSerial,
+                    std::string(), 0, std::string(), status)) {
+      PlexilStringValueMsg tvMsg =
+        { { (uint16_t) PlexilMsgType_TelemetryValues,
+            (uint16_t) values.size(),
+            leaderSerial,
+            m_myUID.c_str()},
+          destName.c_str()};
+      status = IPC_publishData(STRING_VALUE_MSG, (void *) &tvMsg);
+      if (status == IPC_OK && !values.empty()) {
+        status = sendParameters(values, leaderSerial);
+      }
     }
     setError(status);
     return status == IPC_OK ? leaderSerial : ERROR_SERIAL;
@@ -906,62 +1005,8 @@ namespace PLEXIL
 
     // free the parameter packets
     for (size_t i = 0; i < nParams; i++) {
-      PlexilMsgBase* m = paramMsgs[i];
+      freePlexilValueMsg(paramMsgs[i]);
       paramMsgs[i] = nullptr;
-      switch (m->msgType) {
-      case PlexilMsgType_UnknownValue:
-        delete (PlexilUnknownValueMsg*) m;
-        break;
-
-      case PlexilMsgType_CommandHandleValue:
-        delete (PlexilCommandHandleValueMsg*) m;
-        break;
-
-      case PlexilMsgType_BooleanValue:
-        delete (PlexilBooleanValueMsg*) m;
-        break;
-
-      case PlexilMsgType_IntegerValue:
-        delete (PlexilIntegerValueMsg*) m;
-        break;
-
-      case PlexilMsgType_RealValue:
-        delete (PlexilRealValueMsg*) m;
-        break;
-
-      case PlexilMsgType_StringValue:
-        delete (PlexilStringValueMsg*) m;
-        break;
-
-        // *** DON'T FREE ARRAY DATA! IPC does this. ***
-      case PlexilMsgType_BooleanArray: {
-        PlexilBooleanArrayMsg *bam = (PlexilBooleanArrayMsg*) m;
-        delete bam;
-        break;
-      }
-
-      case PlexilMsgType_IntegerArray: {
-        PlexilIntegerArrayMsg *iam = (PlexilIntegerArrayMsg*) m;
-        delete iam;
-        break;
-      }
-
-      case PlexilMsgType_RealArray: {
-        PlexilRealArrayMsg *ram = (PlexilRealArrayMsg*) m;
-        delete ram;
-        break;
-      }
-
-      case PlexilMsgType_StringArray: {
-        PlexilStringArrayMsg *sam = (PlexilStringArrayMsg*) m;
-        delete sam;
-        break;
-      }
-
-      default:
-        delete m;
-        break;
-      }
     }
 
     return result;
@@ -1009,6 +1054,111 @@ namespace PLEXIL
     return result;
   }
 
+  void IpcFacade::enablePackedMessages(bool enable)
+  {
+    m_packedEnabled = enable;
+  }
+
+  bool IpcFacade::sendPacked(PlexilMsgType contentType,
+                             std::string const &name,
+                             std::vector<Value> const &args,
+                             uint32_t serial,
+                             std::string const &dest,
+                             uint32_t requestSerial,
+                             std::string const &requester,
+                             IPC_RETURN_TYPE &result)
+  {
+    if (!usePackedMessages(dest))
+      return false;
+
+    // Serialize the values into one buffer
+    size_t size = 0;
+    for (Value const &v : args) {
+      size_t s = v.serialSize();
+      if (!s) {
+        // Can't be serialized; let the caller report it
+        debugMsg("IpcFacade:sendPacked",
+                 " value of type " << valueTypeName(v.valueType())
+                 << " can't be packed, sending individually");
+        return false;
+      }
+      size += s;
+    }
+    std::vector<unsigned char> data(size);
+    char *buf = reinterpret_cast<char *>(data.data());
+    for (Value const &v : args)
+      buf = v.serialize(buf);
+
+    struct PlexilPackedValuesMsg packet =
+      { { PlexilMsgType_PackedValues,
+          (uint16_t) args.size(),
+          serial,
+          m_myUID.c_str() },
+        PACKED_VALUES_VERSION,
+        (uint16_t) contentType,
+        name.c_str(),
+        requestSerial,
+        requester.c_str(),
+        (uint32_t) size,
+        data.data() };
+    result = IPC_publishData(formatMsgName(PACKED_VALUES_MSG, dest), (void *) &packet);
+    debugMsg("IpcFacade:sendPacked",
+             ' ' << m_myUID << " sent " << args.size() << " values in "
+             << size << " bytes, serial " << serial);
+    return true;
+  }
+
+  // A broadcast may be packed only if every subscriber to the legacy
+  // leader also subscribes to packed messages. A directed message may
+  // be packed if its recipient subscribes to directed packed messages.
+  bool IpcFacade::usePackedMessages(std::string const &dest)
+  {
+    if (!m_packedEnabled)
+      return false;
+
+    if (dest.empty()) {
+      int packed = getHandlerCount(PACKED_VALUES_MSG);
+      return packed > 0 && packed >= getHandlerCount(STRING_VALUE_MSG);
+    }
+
+    char const *msgName = formatMsgName(PACKED_VALUES_MSG, dest);
+    // Define it so we are told when the recipient subscribes
+    if (!IPC_isMsgDefined(msgName)
+        && IPC_OK != IPC_defineMsg(msgName, IPC_VARIABLE_LENGTH, PACKED_VALUES_MSG_FORMAT))
+      return false;
+    return getHandlerCount(msgName) > 0;
+  }
+
+  int IpcFacade::getHandlerCount(const char *msgName)
+  {
+    {
+      std::lock_guard<std::mutex> guard(m_handlerCountsMutex);
+      HandlerCountMap::const_iterator it = m_handlerCounts.find(msgName);
+      if (it != m_handlerCounts.end())
+        return it->second;
+    }
+
+    // First request for this name; ask central, then track changes
+    int count = IPC_numHandlers(msgName);
+    if (count < 0)
+      return 0;
+    if (IPC_OK == IPC_subscribeHandlerChange(msgName, ipcHandlerChangeHandler, this)) {
+      std::lock_guard<std::mutex> guard(m_handlerCountsMutex);
+      // Don't overwrite a change notification which arrived in the meantime
+      m_handlerCounts.emplace(msgName, count);
+    }
+    debugMsg("IpcFacade:getHandlerCount", ' ' << msgName << " has " << count << " handlers");
+    return count;
+  }
+
+  void IpcFacade::handlerCountChanged(const char *msgName, int numHandlers)
+  {
+    debugMsg("IpcFacade:handlerCountChanged",
+             ' ' << msgName << " now has " << numHandlers << " handlers");
+    std::lock_guard<std::mutex> guard(m_handlerCountsMutex);
+    m_handlerCounts[msgName] = numHandlers;
+  }
+
   /**
    * @brief Get next serial number
    */
@@ -1109,6 +1259,12 @@ namespace PLEXIL
     if (status != IPC_OK)
       return false;
     status = IPC_defineMsg(formatMsgName(STRING_PAIR_MSG, uid), IPC_VARIABLE_LENGTH, STRING_PAIR_MSG_FORMAT);
+    if (status != IPC_OK)
+      return false;
+    status = IPC_defineMsg(PACKED_VALUES_MSG, IPC_VARIABLE_LENGTH, PACKED_VALUES_MSG_FORMAT);
+    if (status != IPC_OK)
+      return false;
+    status = IPC_defineMsg(formatMsgName(PACKED_VALUES_MSG, uid), IPC_VARIABLE_LENGTH, PACKED_VALUES_MSG_FORMAT);
     condDebugMsg(status == IPC_OK, "IpcFacade:definePlexilIPCMessageTypes", " succeeded");
     return status == IPC_OK;
   }
@@ -1151,6 +1307,19 @@ namespace PLEXIL
     facade->handleMessage(msgData);
   }
 
+  /**
+   * @brief Handler change function as seen by IPC.
+   * @note Called from dispatch thread.
+   */
+  void ipcHandlerChangeHandler(const char *msgName,
+                               int numHandlers,
+                               void *IpcFacade_as_void_ptr)
+  {
+    assertTrue_2(IpcFacade_as_void_ptr,
+                 "ipcHandlerChangeHandler: pointer to IpcFacade instance is null!");
+    reinterpret_cast<IpcFacade *>(IpcFacade_as_void_ptr)->handlerCountChanged(msgName, numHandlers);
+  }
+
   // Handle a message received from IPC dispatch thread
   void IpcFacade::handleMessage(PlexilMsgBase *msgData)
   {
@@ -1237,6 +1406,11 @@ namespace PLEXIL
       deliverMessages(std::vector<PlexilMsgBase *>(1, msgData));
       break;
 
+      // Leader and values in one message
+    case PlexilMsgType_PackedValues:
+      handlePackedMessage(msgData);
+      break;
+
     default:
       errorMsg("IpcFacade::handleMessage: Received unimplemented or invalid message type "
                << msgType);
@@ -1314,9 +1488,20 @@ namespace PLEXIL
   //! @param msgs (Const reference to) Vector of message pointers
   //! @note Called from dispatch thread.
   void IpcFacade::deliverMessages(const std::vector<PlexilMsgBase *>& msgs)
+  {
+    notifyListeners(msgs);
+
+    // clean up
+    for (size_t i = 0; i < msgs.size(); i++) {
+      PlexilMsgBase* msg = msgs[i];
+      IPC_freeData(IPC_msgFormatter(msgFormatForType((PlexilMsgType) msg->msgType)), (void *) msg);
+    }
+  }
+
+  void IpcFacade::notifyListeners(const std::vector<PlexilMsgBase *>& msgs)
   {
     assertTrue_2(!msgs.empty(),
-                 "IpcFacade::deliverMessages: empty message vector");
+                 "IpcFacade::notifyListeners: empty message vector");
 
     {
       debugMsg("IpcFacade:deliverMessage", " locking listeners mutex");
@@ -1335,12 +1520,87 @@ namespace PLEXIL
       }
     }
     debugMsg("IpcFacade:deliverMessage", " unlocked listeners mutex");
+  }
 
-    // clean up
-    for (size_t i = 0; i < msgs.size(); i++) {
-      PlexilMsgBase* msg = msgs[i];
-      IPC_freeData(IPC_msgFormatter(msgFormatForType((PlexilMsgType) msg->msgType)), (void *) msg);
+  // The listeners see the same leader and value messages as they
+  // would have if the sender had not packed them.
+  void IpcFacade::handlePackedMessage(PlexilMsgBase *msgData)
+  {
+    PlexilPackedValuesMsg const *packed =
+      reinterpret_cast<PlexilPackedValuesMsg const *>(msgData);
+    PlexilMsgType contentType = (PlexilMsgType) packed->contentType;
+    debugMsg("IpcFacade:handlePackedMessage",
+             ' ' << m_myUID << " received packed message type " << contentType
+             << " with " << packed->header.count << " values");
+
+    std::vector<Value> values(packed->header.count);
+    bool valid = true;
+    if (packed->version != PACKED_VALUES_VERSION) {
+      warn("IpcFacade " << m_myUID << ": ignoring packed message from "
+           << packed->header.senderUID << " with unsupported version "
+           << packed->version);
+      valid = false;
+    }
+    else if (contentType == PlexilMsgType_ReturnValues) {
+      // Only pay attention to return values directed at us
+      valid = !strcmp(packed->requesterUID, m_myUID.c_str());
+    }
+    else if (contentType != PlexilMsgType_Command
+             && contentType != PlexilMsgType_LookupNow
+             && contentType != PlexilMsgType_TelemetryValues) {
+      warn("IpcFacade " << m_myUID << ": ignoring packed message of invalid type "
+           << contentType);
+      valid = false;
     }
+
+    if (valid) {
+      char const *buf = reinterpret_cast<char const *>(packed->data);
+      char const *end = buf + packed->dataSize;
+      for (Value &v : values) {
+        if (!buf || buf >= end)
+          break;
+        buf = v.deserialize(buf);
+      }
+      if (buf != end) {
+        warn("IpcFacade " << m_myUID << ": ignoring malformed packed message from "
+             << packed->header.senderUID << ", serial " << packed->header.serial);
+        valid = false;
+      }
+    }
+
+    if (valid) {
+      // Reconstruct the leader
+      std::vector<PlexilMsgBase *> msgs;
+      msgs.reserve(values.size() + 1);
+      PlexilMsgBase const header =
+        { (uint16_t) contentType,
+          packed->header.count,
+          packed->header.serial,
+          packed->header.senderUID };
+      struct PlexilStringValueMsg stringLeader = { header, packed->name };
+      struct PlexilReturnValuesMsg returnLeader =
+        { header, packed->requestSerial, packed->requesterUID };
+      if (contentType == PlexilMsgType_ReturnValues)
+        msgs.push_back(&returnLeader.header);
+      else
+        msgs.push_back(&stringLeader.header);
+
+      // and the value messages
+      for (size_t i = 0; i < values.size(); ++i) {
+        PlexilMsgBase *paramMsg = constructPlexilValueMsg(values[i]);
+        paramMsg->count = i;
+        paramMsg->serial = packed->header.serial;
+        paramMsg->senderUID = packed->header.senderUID;
+        msgs.push_back(paramMsg);
+      }
+
+      notifyListeners(msgs);
+
+      for (size_t i = 1; i < msgs.size(); ++i)
+        freePlexilValueMsg(msgs[i]);
+    }
+
+    IPC_freeData(IPC_msgFormatter(PACKED_VALUES_MSG), (void *) msgData);
   }
 
 // UUID generation constants
@@ -199,11 +199,25 @@ namespace PLEXIL {
      */
     IPC_RETURN_TYPE getError();
 
+    //! Enable or disable sending packed messages.
+    //! @param enable If true (the default), commands, lookups,
+    //!        telemetry and return values are sent as one packed
+    //!        message to peers which accept them.  If false, always
+    //!        use one message per value.
+    //! @note Packed messages are always accepted when received.
+    void enablePackedMessages(bool enable);
+
     //! Receive the message from IPC and handle it as required.
     //! @param msg The message to be handled.
     //! @note Called from dispatch thread.
     void handleMessage(PlexilMsgBase *msg);
 
+    //! Record a change in the number of handlers for a message name.
+    //! @param msgName The message name.
+    //! @param numHandlers The current number of handlers.
+    //! @note Called from dispatch thread.
+    void handlerCountChanged(const char *msgName, int numHandlers);
+
   private:
 
     // Disallow copy, assignment, move
@@ -232,6 +246,50 @@ namespace PLEXIL {
     //! @note Called from dispatch thread.
     void deliverMessages(const std::vector<PlexilMsgBase *> &msgs);
 
+    //! Deliver the vector of messages to all listeners registered for the leader.
+    //! @param msgs (Const reference to) Vector of message pointers
+    //! @note Called from dispatch thread.
+    void notifyListeners(const std::vector<PlexilMsgBase *> &msgs);
+
+    //! Unpack a packed message into the equivalent leader and value
+    //! messages, deliver them to the listeners, and free them.
+    //! @param msgData The packed message.
+    //! @note Called from dispatch thread.
+    void handlePackedMessage(PlexilMsgBase *msgData);
+
+    //! Determine whether every recipient of a message to the given
+    //! destination accepts packed messages.
+    //! @param dest The destination ID; if empty, all recipients of broadcasts.
+    //! @return True if a packed message may be sent.
+    bool usePackedMessages(std::string const &dest);
+
+    //! Get the number of handlers subscribed to the message name,
+    //! querying central on the first request and tracking changes afterward.
+    //! @param msgName The message name.
+    //! @return The number of handlers.
+    int getHandlerCount(const char *msgName);
+
+    //! Send a leader and its values as one packed message, if the
+    //! recipients accept it.
+    //! @param contentType The message type of the equivalent leader.
+    //! @param name Command, lookup, or telemetry state name.
+    //! @param args The values to send.
+    //! @param serial The serial number for the message.
+    //! @param dest The destination ID; if empty, the message is published to all.
+    //! @param requestSerial For return values, the serial of the request.
+    //! @param requester For return values, the ID of the requester.
+    //! @param result Set to the status of the publish operation.
+    //! @return True if a packed message was published, false if the
+    //!         caller should send the values individually instead.
+    bool sendPacked(PlexilMsgType contentType,
+                    std::string const &name,
+                    std::vector<Value> const &args,
+                    IpcSerialNumber serial,
+                    std::string const &dest,
+                    IpcSerialNumber requestSerial,
+                    std::string const &requester,
+                    IPC_RETURN_TYPE &result);
+
     /**
      * @brief Helper function for sending a vector of parameters via IPC.
      * @param args The arguments to convert into messages and send
@@ -334,6 +392,9 @@ namespace PLEXIL {
     //* brief Cache of not-yet-complete message sequences
     typedef std::map<IpcMessageId, std::vector<PlexilMsgBase *> > IncompleteMessageMap;
 
+    //* brief Number of handlers subscribed to a message name
+    typedef std::map<std::string, int> HandlerCountMap;
+
     //
     // Class constants
     //
@@ -362,6 +423,13 @@ namespace PLEXIL {
     //* @brief Mutex for registered listener tables.
     std::mutex m_listenersMutex;
 
+    //* Handler counts for message names of interest, updated by IPC.
+    //* @note Shared between threads.
+    HandlerCountMap m_handlerCounts;
+
+    //* @brief Mutex for handler count map.
+    std::mutex m_handlerCountsMutex;
+
     //* @brief The message thread
     std::thread m_thread;
 
@@ -380,6 +448,9 @@ namespace PLEXIL {
 
     //* @brief True if the dispatch thread should stop.
     bool m_stopDispatchThread;
+
+    //* @brief True if packed messages may be sent.
+    bool m_packedEnabled;
   };
 
   /**
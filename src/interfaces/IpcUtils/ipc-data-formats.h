@@ -279,6 +279,31 @@ struct StringPair
 #define STRING_PAIR_MSG "PlexilStringPair"
 #define STRING_PAIR_MSG_FORMAT "{ushort, ushort, uint, string, string, string}"
 
+/*
+ * A leader and all its values in one message.
+ * contentType is the PlexilMsgType of the equivalent leader.
+ * count is the number of values serialized in data, in order.
+ * requestSerial and requesterUID are only meaningful for ReturnValues.
+ */
+
+struct PlexilPackedValuesMsg
+{
+  struct PlexilMsgBase header;
+  uint16_t version;
+  uint16_t contentType;
+  const char *name;
+  uint32_t requestSerial;
+  const char *requesterUID;
+  uint32_t dataSize;
+  unsigned char *data;
+};
+
+#define PACKED_VALUES_MSG "PlexilPackedValues"
+#define PACKED_VALUES_MSG_FORMAT "{ushort, ushort, uint, string, ushort, ushort, string, uint, string, int, <ubyte:10>}"
+
+/* Increment when the packed data representation changes */
+#define PACKED_VALUES_VERSION 1
+
 typedef enum {
   PlexilMsgType_uninited=0,
 
@@ -363,6 +388,11 @@ typedef enum {
    * Count indicates position in sequence */
   PlexilMsgType_PairString,
 
+  /* PlexilPackedValuesMsg -
+   * Stands alone, replaces a Command, LookupNow, TelemetryValues
+   * or ReturnValues leader and its value messages */
+  PlexilMsgType_PackedValues,
+
   PlexilMsgType_limit
 }
   PlexilMsgType;
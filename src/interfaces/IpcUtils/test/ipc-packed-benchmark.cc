@@ -0,0 +1,185 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+ *  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Universities Space Research Association nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+// Loopback latency and throughput of packed vs. individual value messages.
+// Requires a running central, e.g.
+//   central -u -s &
+//   ipc-packed-benchmark [central-host]
+//
+
+#include "IpcFacade.hh"
+
+#include "ArrayImpl.hh"
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <thread>
+
+using namespace PLEXIL;
+
+static constexpr size_t N_PARAMS = 20;
+static constexpr size_t LATENCY_ITERATIONS = 1000;
+static constexpr size_t THROUGHPUT_ITERATIONS = 5000;
+
+class BenchmarkListener : public IpcMessageListener
+{
+public:
+  BenchmarkListener(std::vector<Value> const &expected)
+    : m_expected(expected),
+      m_received(0),
+      m_errors(0)
+  {
+  }
+
+  virtual void ReceiveMessage(const std::vector<PlexilMsgBase*>& msgs)
+  {
+    bool ok = (msgs.size() == m_expected.size() + 1);
+    for (size_t i = 1; ok && i < msgs.size(); ++i)
+      ok = (getPlexilMsgValue(msgs[i]) == m_expected[i - 1]);
+    std::lock_guard<std::mutex> guard(m_mutex);
+    ++m_received;
+    if (!ok)
+      ++m_errors;
+    m_cv.notify_all();
+  }
+
+  // Wait until the given number of messages have been received.
+  bool waitFor(size_t n)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_cv.wait_for(lock, std::chrono::seconds(30),
+                         [this, n]() { return m_received >= n; });
+  }
+
+  size_t received()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_received;
+  }
+
+  size_t errors()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_errors;
+  }
+
+private:
+  std::vector<Value> const &m_expected;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  size_t m_received;
+  size_t m_errors;
+};
+
+static std::vector<Value> makeParameters()
+{
+  std::vector<Value> result;
+  for (size_t i = 0; i < N_PARAMS; ++i) {
+    switch (i % 5) {
+    case 0:
+      result.push_back(Value((Integer) i));
+      break;
+    case 1:
+      result.push_back(Value(i * 0.5));
+      break;
+    case 2:
+      result.push_back(Value(std::string("param") + std::to_string(i)));
+      break;
+    case 3:
+      result.push_back(Value((i & 8) != 0));
+      break;
+    default:
+      result.push_back(Value(RealArray(std::vector<Real>(8, (Real) i))));
+      break;
+    }
+  }
+  return result;
+}
+
+static bool runBenchmark(IpcFacade &facade, bool packed)
+{
+  std::vector<Value> const params = makeParameters();
+  BenchmarkListener listener(params);
+  facade.enablePackedMessages(packed);
+  facade.subscribe(&listener, PlexilMsgType_Command);
+  facade.subscribe(&listener, PlexilMsgType_TelemetryValues);
+
+  std::cout << (packed ? "Packed" : "Individual") << " messages, "
+            << N_PARAMS << " parameters" << std::endl;
+
+  // Latency: one command at a time, round trip through central
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 1; i <= LATENCY_ITERATIONS; ++i) {
+    facade.publishCommand("BenchmarkCommand", params);
+    if (!listener.waitFor(i)) {
+      std::cerr << " timed out waiting for command " << i << std::endl;
+      facade.unsubscribe(&listener);
+      return false;
+    }
+  }
+  std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+
+  // Throughput: publish telemetry as fast as possible
+  for (size_t i = 0; i < THROUGHPUT_ITERATIONS; ++i)
+    facade.publishTelemetry("BenchmarkState", params);
+  bool complete = listener.waitFor(LATENCY_ITERATIONS + THROUGHPUT_ITERATIONS);
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  facade.unsubscribe(&listener);
+
+  double latencySecs = std::chrono::duration<double>(mid - start).count();
+  double throughputSecs = std::chrono::duration<double>(end - mid).count();
+  std::cout << " round trip latency: "
+            << 1e6 * latencySecs / LATENCY_ITERATIONS << " usec\n"
+            << " telemetry throughput: "
+            << (listener.received() - LATENCY_ITERATIONS) / throughputSecs
+            << " updates/sec" << std::endl;
+  if (!complete)
+    std::cerr << " timed out, received only " << listener.received() << std::endl;
+  if (listener.errors())
+    std::cerr << " " << listener.errors() << " messages had incorrect values" << std::endl;
+  return complete && !listener.errors();
+}
+
+int main(int argc, char **argv)
+{
+  char const *server = (argc > 1) ? argv[1] : "localhost";
+  IpcFacade facade;
+  if (facade.initialize("ipc-packed-benchmark", server) != IPC_OK
+      || facade.start() != IPC_OK) {
+    std::cerr << "Unable to connect to central on " << server << std::endl;
+    return 1;
+  }
+  // Give the dispatch thread a chance to start listening
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  bool result = runBenchmark(facade, false) && runBenchmark(facade, true);
+  facade.stop();
+  return result ? 0 : 1;
+}
+
+// EOF
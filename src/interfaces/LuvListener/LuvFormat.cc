@@ -32,6 +32,7 @@
 #include "NodeTransition.hh"
 
 #include <iostream>
+#include <streambuf>
 
 #include <cstddef> // size_t
 
@@ -72,75 +73,193 @@ namespace PLEXIL {
   // Local utilities
   //
 
-  static inline void simpleStartTag(std::ostream& s, const char* val) {
-    s << '<' << val << ">";
+  /**
+   * @brief Append text to a buffer, replacing the XML markup
+   *        characters with entity references.
+   * @param buf The buffer.
+   * @param text The text.
+   * @param len The length of the text.
+   */
+  static void appendEscaped(std::string &buf, char const *text, size_t len)
+  {
+    char const *end = text + len;
+    while (text < end) {
+      // Copy the longest run which needs no escaping
+      char const *run = text;
+      while (run < end && *run != '&' && *run != '<' && *run != '>')
+        ++run;
+      buf.append(text, run - text);
+      if (run == end)
+        return;
+      switch (*run) {
+      case '&':
+        buf.append("&amp;", 5);
+        break;
+
+      case '<':
+        buf.append("&lt;", 4);
+        break;
+
+      default: // '>'
+        buf.append("&gt;", 4);
+        break;
+      }
+      text = run + 1;
+    }
+  }
+
+  //! @class XmlTextBuf
+  //! A stream buffer which appends to a string, escaping XML markup
+  //! characters.  Lets printValue() and friends write directly into
+  //! a message buffer.
+  class XmlTextBuf final : public std::streambuf
+  {
+  public:
+    XmlTextBuf(std::string &buf)
+      : std::streambuf(),
+        m_buf(buf)
+    {
+    }
+
+    virtual ~XmlTextBuf() = default;
+
+  protected:
+    virtual int_type overflow(int_type c) override
+    {
+      if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        char ch = traits_type::to_char_type(c);
+        appendEscaped(m_buf, &ch, 1);
+      }
+      return traits_type::not_eof(c);
+    }
+
+    virtual std::streamsize xsputn(char const *s, std::streamsize n) override
+    {
+      appendEscaped(m_buf, s, n);
+      return n;
+    }
+
+  private:
+    std::string &m_buf;
+  };
+
+  static inline void simpleStartTag(std::string &buf, char const *val) {
+    buf.push_back('<');
+    buf.append(val);
+    buf.push_back('>');
   }
 
-  static inline void endTag(std::ostream& s, const char* val) {
-    s << "</" << val << ">";
+  static inline void endTag(std::string &buf, char const *val) {
+    buf.append("</", 2);
+    buf.append(val);
+    buf.push_back('>');
   }
 
   /**
    * @brief Generate a simple XML element containing some text.
-   * @param s The stream to write the element to.
+   * @param buf The buffer to append the element to.
    * @param tag The tag for the element.
    * @param text The text for the element.
    */
-  void simpleTextElement(std::ostream& s,
-                         const char* tag,
-                         const char* text) {
-    simpleStartTag(s, tag);
-    s << text;
-    endTag(s, tag);
+  static void simpleTextElement(std::string &buf,
+                                char const *tag,
+                                std::string const &text) {
+    simpleStartTag(buf, tag);
+    appendEscaped(buf, text.data(), text.size());
+    endTag(buf, tag);
   }
 
   //* Internal function for formatNodePath
-  void formatNodePathInternal(std::ostream& s, 
-                              Node const *node) {
+  static void formatNodePathInternal(std::string &buf,
+                                     Node const *node) {
     // Fill in parents recursively
     if (node->getParent())
-      formatNodePathInternal(s, node->getParent());
+      formatNodePathInternal(buf, node->getParent());
     // Put ours at the end
-    simpleTextElement(s, NODE_ID_TAG, node->getNodeId().c_str());
+    simpleTextElement(buf, NODE_ID_TAG, node->getNodeId());
   }
 
   /**
    * @brief Generate the XML representation of the path to the node.
-   * @param s The stream to write the XML to.
+   * @param buf The buffer to append the XML to.
    * @param node The plan node whose path is being constructed.
    */
-  void formatNodePath(std::ostream& s, 
-                      Node const *node) {
-    simpleStartTag(s, NODE_PATH_TAG);
-    formatNodePathInternal(s, node);
-    endTag(s, NODE_PATH_TAG);
+  static void formatNodePath(std::string &buf,
+                             Node const *node) {
+    simpleStartTag(buf, NODE_PATH_TAG);
+    formatNodePathInternal(buf, node);
+    endTag(buf, NODE_PATH_TAG);
+  }
+
+  /**
+   * @brief Generate the XML representation of a node path copied earlier.
+   * @param buf The buffer to append the XML to.
+   * @param snap The snapshot holding the path.
+   */
+  static void formatNodePath(std::string &buf,
+                             NodeTransitionSnapshot const &snap) {
+    simpleStartTag(buf, NODE_PATH_TAG);
+    for (std::string const &nodeId : snap.nodePath)
+      simpleTextElement(buf, NODE_ID_TAG, nodeId);
+    endTag(buf, NODE_PATH_TAG);
   }
 
   /**
    * @brief Generate the XML representation of the current values of the node's conditions.
-   * @param s The stream to write the XML to.
+   * @param buf The buffer to append the XML to.
    * @param node The node whose conditions are being extracted.
    */
-  void formatConditions(std::ostream& s, 
-                        Node const *nptr)
+  static void formatConditions(std::string &buf,
+                               Node const *nptr)
   {
     NodeImpl const *node = dynamic_cast<NodeImpl const *>(nptr);
     assertTrueMsg(node,
                   "LuvFormat::formatConditions: not a node");
 
-    simpleStartTag(s, CONDITIONS_TAG);
+    simpleStartTag(buf, CONDITIONS_TAG);
 
+    XmlTextBuf text(buf);
+    std::ostream s(&text);
+    std::ios_base::fmtflags const flags = s.flags();
+    std::streamsize const precision = s.precision();
     for (size_t i = 0; i < NodeImpl::conditionIndexMax; ++i) {
       Expression const *cond = node->getCondition(i);
       if (cond) {
-        std::string const valueStr = cond->valueString();
-        simpleTextElement(s, 
-                          NodeImpl::ALL_CONDITIONS[i],
-                          valueStr.c_str());
+        simpleStartTag(buf, NodeImpl::ALL_CONDITIONS[i]);
+        // Each value is formatted as if to a fresh stream
+        s.flags(flags);
+        s.precision(precision);
+        cond->printValue(s);
+        endTag(buf, NodeImpl::ALL_CONDITIONS[i]);
       }
     }
 
-    endTag(s, CONDITIONS_TAG);
+    endTag(buf, CONDITIONS_TAG);
+  }
+
+  /**
+   * @brief Generate the XML representation of condition values copied earlier.
+   * @param buf The buffer to append the XML to.
+   * @param snap The snapshot holding the values.
+   */
+  static void formatConditions(std::string &buf,
+                               NodeTransitionSnapshot const &snap)
+  {
+    simpleStartTag(buf, CONDITIONS_TAG);
+
+    XmlTextBuf text(buf);
+    std::ostream s(&text);
+    std::ios_base::fmtflags const flags = s.flags();
+    std::streamsize const precision = s.precision();
+    for (std::pair<size_t, Value> const &cond : snap.conditions) {
+      simpleStartTag(buf, NodeImpl::ALL_CONDITIONS[cond.first]);
+      s.flags(flags);
+      s.precision(precision);
+      cond.second.print(s);
+      endTag(buf, NodeImpl::ALL_CONDITIONS[cond.first]);
+    }
+
+    endTag(buf, CONDITIONS_TAG);
   }
 
   /**
@@ -150,44 +269,72 @@ namespace PLEXIL {
    */
   void LuvFormat::formatPlanInfo(std::ostream& s, 
                                  bool block) {
-    simpleStartTag(s, PLAN_INFO_TAG);
-    simpleTextElement(s, 
-                      VIEWER_BLOCKS_TAG,
-                      (block ? TRUE_STR : FALSE_STR));
-    endTag(s, PLAN_INFO_TAG);
+    std::string buf;
+    formatPlanInfo(buf, block);
+    s << buf;
+  }
+
+  /**
+   * @brief Append the PlanInfo header XML to a buffer.
+   * @param buf The buffer.
+   * @param block Whether the viewer should block.
+   */
+  void LuvFormat::formatPlanInfo(std::string &buf,
+                                 bool block) {
+    simpleStartTag(buf, PLAN_INFO_TAG);
+    simpleStartTag(buf, VIEWER_BLOCKS_TAG);
+    buf.append(block ? TRUE_STR : FALSE_STR);
+    endTag(buf, VIEWER_BLOCKS_TAG);
+    endTag(buf, PLAN_INFO_TAG);
   }
 
   /**
    * @brief Construct the node state transition XML.
    * @param s The stream to write the XML to.
-   * @param prevState The state from which the node is transitioning.
-   * @param node The node.
+   * @param trans Const reference to the node state transition record.
    */
   void LuvFormat::formatTransition(std::ostream& s, 
                                    NodeTransition const &trans)
   {
-    simpleStartTag(s, NODE_STATE_UPDATE_TAG);
+    std::string buf;
+    formatTransition(buf, trans);
+    s << buf;
+  }
+
+  /**
+   * @brief Append the node state transition XML to a buffer.
+   * @param buf The buffer.
+   * @param trans Const reference to the node state transition record.
+   */
+  void LuvFormat::formatTransition(std::string &buf,
+                                   NodeTransition const &trans)
+  {
+    simpleStartTag(buf, NODE_STATE_UPDATE_TAG);
 
     // add state
-    simpleTextElement(s, NODE_STATE_TAG, nodeStateName(trans.newState).c_str());
+    simpleTextElement(buf, NODE_STATE_TAG, nodeStateName(trans.newState));
 
     // add outcome
-    if (trans.node->getOutcome() != NO_OUTCOME)
-      simpleTextElement(s, NODE_OUTCOME_TAG,
-                        outcomeName(trans.node->getOutcome()).c_str());
+    if (trans.outcome != NO_OUTCOME)
+      simpleTextElement(buf, NODE_OUTCOME_TAG, outcomeName(trans.outcome));
 
     // add failure type
-    if (trans.node->getFailureType() != NO_FAILURE)
-      simpleTextElement(s, NODE_FAILURE_TYPE_TAG,
-                        failureTypeName(trans.node->getFailureType()).c_str());
+    if (trans.failureType != NO_FAILURE)
+      simpleTextElement(buf, NODE_FAILURE_TYPE_TAG,
+                        failureTypeName(trans.failureType));
       
-    // add the condition states
-    formatConditions(s, trans.node);
-
-    // add the path
-    formatNodePath(s, trans.node);
+    // add the condition states and the path, from the snapshot if
+    // the node may have moved on
+    if (trans.snapshot) {
+      formatConditions(buf, *trans.snapshot);
+      formatNodePath(buf, *trans.snapshot);
+    }
+    else {
+      formatConditions(buf, trans.node);
+      formatNodePath(buf, trans.node);
+    }
 
-    endTag(s, NODE_STATE_UPDATE_TAG);
+    endTag(buf, NODE_STATE_UPDATE_TAG);
   }
 
   /**
@@ -198,27 +345,46 @@ namespace PLEXIL {
    * @param value The internal representation of the new value.
    */
   void LuvFormat::formatAssignment(std::ostream &s, 
+                                   Expression const *dest,
+                                   std::string const &destName,
+                                   Value const &value) {
+    std::string buf;
+    formatAssignment(buf, dest, destName, value);
+    s << buf;
+  }
+
+  /**
+   * @brief Append the assignment XML to a buffer.
+   * @param buf The buffer.
+   * @param dest The expression being assigned to.
+   * @param destName The variable name of the expression.
+   * @param value The internal representation of the new value.
+   */
+  void LuvFormat::formatAssignment(std::string &buf,
                                    Expression const * /* dest */,
                                    std::string const &destName,
                                    Value const &value) {
-    simpleStartTag(s, ASSIGNMENT_TAG);
+    simpleStartTag(buf, ASSIGNMENT_TAG);
 
     // format variable name
-    simpleStartTag(s, VARIABLE_TAG);
+    simpleStartTag(buf, VARIABLE_TAG);
 
     // TODO: get path to owning node, if any
 
     // get variable name
-    simpleTextElement(s, VARIABLE_NAME_TAG, destName.c_str());
-    endTag(s, VARIABLE_TAG);
+    simpleTextElement(buf, VARIABLE_NAME_TAG, destName);
+    endTag(buf, VARIABLE_TAG);
 
     // format variable value
-    std::string const valueStr = value.valueToString();
-    simpleTextElement(s, 
-                      VARIABLE_VALUE_TAG,
-                      valueStr.c_str());
+    simpleStartTag(buf, VARIABLE_VALUE_TAG);
+    {
+      XmlTextBuf text(buf);
+      std::ostream s(&text);
+      value.print(s);
+    }
+    endTag(buf, VARIABLE_VALUE_TAG);
     
-    endTag(s, ASSIGNMENT_TAG);
+    endTag(buf, ASSIGNMENT_TAG);
   }
 
   /**
@@ -240,9 +406,9 @@ namespace PLEXIL {
                                 pugi::xml_node const libNode)
   {
     // create a PLEXIL Library wrapper and stick the library node in it
-    simpleStartTag(s, PLEXIL_LIBRARY_TAG);
+    s << '<' << PLEXIL_LIBRARY_TAG << '>';
     libNode.print(s, "", PUGI_FORMAT_OPTIONS);
-    endTag(s, PLEXIL_LIBRARY_TAG);
+    s << "</" << PLEXIL_LIBRARY_TAG << '>';
   }
 
 }
@@ -31,6 +31,7 @@
 #include "pugixml.hpp"
 
 #include <iosfwd>
+#include <string>
 
 namespace PLEXIL {
 
@@ -76,6 +77,37 @@ namespace PLEXIL {
                                  std::string const &destName,
                                  Value const &value);
 
+    //
+    // Variants which append to a reusable buffer
+    //
+
+    /**
+     * @brief Append the PlanInfo header XML to a buffer.
+     * @param buf The buffer.
+     * @param block Whether the viewer should block.
+     */
+    static void formatPlanInfo(std::string &buf, bool block);
+
+    /**
+     * @brief Append the node state transition XML to a buffer.
+     * @param buf The buffer.
+     * @param trans Const reference to the node state transition record.
+     */
+    static void formatTransition(std::string &buf,
+                                 NodeTransition const &trans);
+
+    /**
+     * @brief Append the assignment XML to a buffer.
+     * @param buf The buffer.
+     * @param dest The expression being assigned to.
+     * @param destName The variable name of the expression.
+     * @param value The internal representation of the new value.
+     */
+    static void formatAssignment(std::string &buf,
+                                 Expression const *dest,
+                                 std::string const &destName,
+                                 Value const &value);
+
     /**
      * @brief Construct the message representing a new plan.
      * @param s The stream to write the XML to.
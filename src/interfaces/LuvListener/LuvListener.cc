@@ -28,6 +28,7 @@
 
 #include "ClientSocket.h"
 #include "Debug.hh"
+#include "Error.hh"
 #include "ExecListenerFactory.hh"
 #include "Expression.hh"
 #include "LuvFormat.hh"
@@ -38,8 +39,17 @@
 #include <sstream>
 #include <string>
 
+#ifdef PLEXIL_WITH_THREADS
+#include <mutex>
+#endif
+
+#include <cerrno>
 #include <cstdlib>
-#include <cstring>  // strdup()
+#include <cstring>  // strdup(), strerror()
+
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h> // send(), sendmsg()
+#endif
 
 namespace PLEXIL
 {
@@ -55,6 +65,24 @@ namespace PLEXIL
   static constexpr char const LUV_BLOCKING_ATTR[] = "Blocking";
 
   static constexpr char const IGNORE_CONNECT_FAILURE_ATTR[] = "IgnoreConnectFailure";
+  static constexpr char const MAX_BACKLOG_ATTR[] = "MaxBacklog";
+  static constexpr char const OVERFLOW_ATTR[] = "Overflow";
+
+  // Maximum bytes held for a slow viewer in non-blocking mode
+  static constexpr size_t LUV_DEFAULT_MAX_BACKLOG = 1024 * 1024;
+
+  //! What to do when a slow viewer lets the backlog reach its limit.
+  enum LuvOverflowPolicy : uint8_t {
+    LUV_OVERFLOW_BLOCK = 0,  //!< Wait until the viewer catches up.
+    LUV_OVERFLOW_DISCONNECT, //!< Close the connection to the viewer.
+    LUV_OVERFLOW_DROP        //!< Discard transition and assignment messages.
+  };
+
+#ifdef MSG_NOSIGNAL
+  static constexpr int LUV_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+  static constexpr int LUV_SEND_FLAGS = 0;
+#endif
 
   //! @class LuvListenerImpl
   //! Implements the LuvListener public API.
@@ -67,9 +95,17 @@ namespace PLEXIL
      */
     LuvListenerImpl(pugi::xml_node const xml)
       : LuvListener(xml), 
+#ifdef PLEXIL_WITH_THREADS
+        m_mutex(),
+#endif
+        m_buffer(),
+        m_backlog(),
         m_socket(nullptr),
         m_host(LUV_DEFAULT_HOSTNAME),
+        m_maxBacklog(LUV_DEFAULT_MAX_BACKLOG),
+        m_dropped(0),
         m_port(LUV_DEFAULT_PORT),
+        m_overflow(LUV_OVERFLOW_BLOCK),
         m_block(false),
         m_ignoreConnectFailure(true)
     {
@@ -82,13 +118,25 @@ namespace PLEXIL
       m_block = xml.attribute(LUV_BLOCKING_ATTR).as_bool(m_block);
       m_ignoreConnectFailure =
         xml.attribute(IGNORE_CONNECT_FAILURE_ATTR).as_bool(m_ignoreConnectFailure);
+      m_maxBacklog =
+        xml.attribute(MAX_BACKLOG_ATTR).as_ullong(m_maxBacklog);
+      char const *overflow = xml.attribute(OVERFLOW_ATTR).as_string("Block");
+      if (!strcmp(overflow, "Disconnect"))
+        m_overflow = LUV_OVERFLOW_DISCONNECT;
+      else if (!strcmp(overflow, "Drop"))
+        m_overflow = LUV_OVERFLOW_DROP;
+      else if (strcmp(overflow, "Block"))
+        warn("LuvListener: invalid " << OVERFLOW_ATTR << " \"" << overflow
+             << "\"; expected Block, Disconnect, or Drop.  Using Block.");
 
       // Report what we found
       debugMsg("LuvListener",
                "  host " << m_host
                << ", port " << m_port
                << ", " << (m_block ? "" : "don't ") << "block, "
-               << (m_ignoreConnectFailure ? "" : "don't ") << " ignore connection failure");
+               << (m_ignoreConnectFailure ? "" : "don't ") << " ignore connection failure"
+               << ", max backlog " << m_maxBacklog
+               << ", overflow policy " << (int) m_overflow);
     }
 
     //* Destructor.
@@ -114,13 +162,54 @@ namespace PLEXIL
       closeSocket();
     }
 
+    /**
+     * @brief Query whether this listener may be called from another thread.
+     * @return Always true; LuvFormat uses only the transition records.
+     */
+    virtual bool supportsAsynchronousPublication() const override
+    {
+      return true;
+    }
+
     //
     // Public class member functions
     //
 
+    /**
+     * @brief Notify that one or more nodes have changed state.
+     * @param transitions Const reference to the vector of transition records.
+     * @note Unless the viewer is blocking, the whole batch is sent
+     *       with a single write.
+     */
+    virtual void
+    implementNotifyNodeTransitions(std::vector<NodeTransition> const &transitions) const override
+    {
+      if (m_block) {
+        // The viewer acknowledges each message individually
+        ExecListener::implementNotifyNodeTransitions(transitions);
+        return;
+      }
+
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(m_mutex);
+#endif
+      if (!m_socket)
+        return;
+      m_buffer.clear();
+      for (NodeTransition const &trans : transitions) {
+        if (!m_filter || m_filter->reportNodeTransition(trans)) {
+          debugMsg("LuvListener:implementNotifyNodeTransition",
+                   " for " << trans.node->getNodeId());
+          LuvFormat::formatTransition(m_buffer, trans);
+          m_buffer.push_back(LUV_END_OF_MESSAGE);
+        }
+      }
+      if (!m_buffer.empty())
+        sendBuffer(true);
+    }
+
     /**
      * @brief Notify that a node has changed state.
-     * @param prevState The old state.
      * @param transition Const reference to the transition record.
      */
     virtual void
@@ -128,10 +217,14 @@ namespace PLEXIL
     {
       debugMsg("LuvListener:implementNotifyNodeTransition",
                " for " << trans.node->getNodeId());
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(m_mutex);
+#endif
       if (m_socket) {
-        std::ostringstream s;
-        LuvFormat::formatTransition(s, trans);
-        sendMessage(s.str());
+        m_buffer.clear();
+        LuvFormat::formatTransition(m_buffer, trans);
+        m_buffer.push_back(LUV_END_OF_MESSAGE);
+        sendBuffer(true);
       }
     }
 
@@ -143,11 +236,16 @@ namespace PLEXIL
     implementNotifyAddPlan(pugi::xml_node const plan) const override
     {
       debugMsg("LuvListener:implementNotifyAddPlan", " entered");
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(m_mutex);
+#endif
       if (m_socket) {
         sendPlanInfo();
         std::ostringstream s;
         LuvFormat::formatPlan(s, plan);
-        sendMessage(s.str());
+        s << LUV_END_OF_MESSAGE;
+        m_buffer = s.str();
+        sendBuffer(false);
       }
     }
 
@@ -158,11 +256,16 @@ namespace PLEXIL
     virtual void
     implementNotifyAddLibrary(pugi::xml_node const libNode) const override
     {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(m_mutex);
+#endif
       if (m_socket) {
         sendPlanInfo();
         std::ostringstream s;
         LuvFormat::formatLibrary(s, libNode);
-        sendMessage(s.str());
+        s << LUV_END_OF_MESSAGE;
+        m_buffer = s.str();
+        sendBuffer(false);
       }
     }
 
@@ -177,10 +280,14 @@ namespace PLEXIL
                               std::string const &destName,
                               Value const &value) const override
     {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(m_mutex);
+#endif
       if (m_socket) {
-        std::ostringstream s;
-        LuvFormat::formatAssignment(s, dest, destName, value);
-        sendMessage(s.str());
+        m_buffer.clear();
+        LuvFormat::formatAssignment(m_buffer, dest, destName, value);
+        m_buffer.push_back(LUV_END_OF_MESSAGE);
+        sendBuffer(true);
       }
     }
 
@@ -220,13 +327,39 @@ namespace PLEXIL
         return ignoreFailure;
       }
 
+      // Don't let a slow viewer stall the Exec
+      if (!m_block)
+        m_socket->set_non_blocking(true);
+
       // Success!
       return true; 
     }
 
     //* Close the socket.
-    void closeSocket()
+    void closeSocket() const
+    {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(m_mutex);
+#endif
+      if (m_socket && !m_backlog.empty()) {
+        // Last chance to deliver anything pending
+        m_buffer.clear();
+        sendBuffer(false);
+        if (!m_backlog.empty())
+          warn("LuvListener: discarding " << m_backlog.size()
+               << " bytes not yet sent to the viewer");
+      }
+      if (m_dropped)
+        warn("LuvListener: " << m_dropped
+             << " messages were dropped because the viewer fell behind");
+      m_dropped = 0;
+      disconnect();
+    }
+
+    //* Discard the backlog and the connection.
+    void disconnect() const
     {
+      m_backlog.clear();
       delete m_socket;
       m_socket = nullptr;
     }
@@ -234,17 +367,121 @@ namespace PLEXIL
     //* Send a plan info header to the viewer.
     void sendPlanInfo() const
     {
-      std::ostringstream s;
-      LuvFormat::formatPlanInfo(s, m_block);
-      sendMessage(s.str());
+      m_buffer.clear();
+      LuvFormat::formatPlanInfo(m_buffer, m_block);
+      m_buffer.push_back(LUV_END_OF_MESSAGE);
+      sendBuffer(false);
     }
 
-    //* Send the message to the viewer.
-    void sendMessage(const std::string& msg) const
+    //! Send the contents of m_buffer, which must consist of complete
+    //! messages, to the viewer.
+    //! @param mayDrop If true, the messages may be discarded when the
+    //!                backlog is full.
+    void sendBuffer(bool mayDrop) const
     {
-      debugMsg("LuvListener:sendMessage", " sending:\n" << msg);
-      *m_socket << msg << LUV_END_OF_MESSAGE;
-      waitForAck();
+      debugMsg("LuvListener:sendMessage", " sending:\n" << m_buffer);
+      if (m_block) {
+        *m_socket << m_buffer;
+        waitForAck();
+      }
+      else
+        writeNonBlocking(mayDrop);
+    }
+
+    //! Write the backlog, if any, and m_buffer to the socket in one
+    //! gather write.  Whatever could not be written is kept in the
+    //! backlog.  If the backlog would exceed its limit, applies the
+    //! overflow policy.
+    //! @param mayDrop If true, the messages may be discarded when the
+    //!                backlog is full and the policy is Drop.
+    void writeNonBlocking(bool mayDrop) const
+    {
+      size_t const backlogSize = m_backlog.size();
+      struct iovec iov[2];
+      size_t nIov = 0;
+      if (backlogSize) {
+        iov[nIov].iov_base = const_cast<char *>(m_backlog.data());
+        iov[nIov++].iov_len = backlogSize;
+      }
+      if (!m_buffer.empty()) {
+        iov[nIov].iov_base = const_cast<char *>(m_buffer.data());
+        iov[nIov++].iov_len = m_buffer.size();
+      }
+      if (!nIov)
+        return;
+
+      struct msghdr hdr;
+      memset(&hdr, 0, sizeof(hdr));
+      hdr.msg_iov = iov;
+      hdr.msg_iovlen = nIov;
+      ssize_t sent = sendmsg(m_socket->get_descriptor(), &hdr, LUV_SEND_FLAGS);
+      if (sent < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+          warn("LuvListener: lost connection to viewer: " << strerror(errno));
+          disconnect();
+          return;
+        }
+        sent = 0;
+      }
+
+      // Remove what was written from the backlog
+      size_t written = (size_t) sent;
+      size_t fromBacklog = written < backlogSize ? written : backlogSize;
+      m_backlog.erase(0, fromBacklog);
+      written -= fromBacklog;
+      if (written == m_buffer.size())
+        return;
+
+      if (m_backlog.size() + m_buffer.size() - written > m_maxBacklog) {
+        switch (m_overflow) {
+        case LUV_OVERFLOW_DROP:
+          // Never drop part of a message, or the viewer would lose sync
+          if (!written && mayDrop) {
+            if (!m_dropped++)
+              warn("LuvListener: viewer is more than " << m_maxBacklog
+                   << " bytes behind, dropping messages");
+            debugMsg("LuvListener:writeNonBlocking",
+                     " backlog full, dropping " << m_buffer.size() << " bytes");
+            return;
+          }
+          break;
+
+        case LUV_OVERFLOW_DISCONNECT:
+          warn("LuvListener: viewer is more than " << m_maxBacklog
+               << " bytes behind, closing the connection");
+          disconnect();
+          return;
+
+        default: // LUV_OVERFLOW_BLOCK
+          m_backlog.append(m_buffer, written, std::string::npos);
+          drainBacklog();
+          return;
+        }
+      }
+      m_backlog.append(m_buffer, written, std::string::npos);
+    }
+
+    //! Write the backlog with blocking writes until it is back within
+    //! its limit.
+    void drainBacklog() const
+    {
+      debugMsg("LuvListener:drainBacklog",
+               " waiting to send " << m_backlog.size() << " bytes");
+      m_socket->set_non_blocking(false);
+      while (m_backlog.size() > m_maxBacklog) {
+        ssize_t sent = send(m_socket->get_descriptor(),
+                            m_backlog.data(), m_backlog.size(),
+                            LUV_SEND_FLAGS);
+        if (sent < 0) {
+          if (errno == EINTR)
+            continue;
+          warn("LuvListener: lost connection to viewer: " << strerror(errno));
+          disconnect();
+          return;
+        }
+        m_backlog.erase(0, (size_t) sent);
+      }
+      m_socket->set_non_blocking(true);
     }
 
     //* Wait for acknowledgement from the viewer.
@@ -267,9 +504,27 @@ namespace PLEXIL
 	//
 	// Member variables
 	//
-    Socket* m_socket;
+
+#ifdef PLEXIL_WITH_THREADS
+    //* Serializes access to the buffers and the socket.  Plans are
+    //* reported from the thread which loads them, concurrently with
+    //* the Exec's own events.
+    mutable std::mutex m_mutex;
+#endif
+
+    //* Reusable buffer for outgoing messages.
+    mutable std::string m_buffer;
+
+    //* Bytes not yet written to the socket.  Only used when not blocking.
+    mutable std::string m_backlog;
+
+    //* Mutable because a write error in a notify method closes the connection.
+    mutable Socket* m_socket;
     std::string m_host;
+    size_t m_maxBacklog;
+    mutable size_t m_dropped;
 	uint16_t m_port;
+    LuvOverflowPolicy m_overflow;
     bool m_block;
     bool m_ignoreConnectFailure;
   };
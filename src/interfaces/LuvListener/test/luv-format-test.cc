@@ -0,0 +1,125 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Error.hh"
+#include "LuvFormat.hh"
+#include "NodeImpl.hh"
+#include "NodeTransition.hh"
+
+#include "pugixml.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <cstring> // strcmp()
+
+using namespace PLEXIL;
+
+//! \brief Parse one formatted message, which must be well-formed XML.
+static bool parseMessage(pugi::xml_document &doc, std::string const &msg)
+{
+  pugi::xml_parse_result result = doc.load_buffer(msg.data(), msg.size());
+  if (!result) {
+    std::cout << "Message is not well-formed XML: " << result.description()
+              << "\n  " << msg << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//! \brief Check that markup characters in names and values are
+//!        escaped, and that the viewer reads back the original text.
+static bool testAssignmentEscaping()
+{
+  std::cout << "Testing assignment escaping" << std::endl;
+  std::string const name = "a<b>&c";
+  std::string const text = "x < y && y > z";
+
+  std::string buf;
+  LuvFormat::formatAssignment(buf, nullptr, name, Value(text));
+  assertTrue_1(buf ==
+               "<Assignment><Variable><VariableName>a&lt;b&gt;&amp;c</VariableName></Variable>"
+               "<Value>x &lt; y &amp;&amp; y &gt; z</Value></Assignment>");
+
+  // The stream variant produces the same text
+  std::ostringstream s;
+  LuvFormat::formatAssignment(s, nullptr, name, Value(text));
+  assertTrue_1(s.str() == buf);
+
+  pugi::xml_document doc;
+  if (!parseMessage(doc, buf))
+    return false;
+  pugi::xml_node const assign = doc.child("Assignment");
+  assertTrue_1(name == assign.child("Variable").child_value("VariableName"));
+  assertTrue_1(text == assign.child_value("Value"));
+
+  // Plain text is passed through unchanged
+  buf.clear();
+  LuvFormat::formatAssignment(buf, nullptr, "count", Value((Integer) 42));
+  assertTrue_1(buf ==
+               "<Assignment><Variable><VariableName>count</VariableName></Variable>"
+               "<Value>42</Value></Assignment>");
+  return true;
+}
+
+//! \brief Check escaping of node IDs in a transition message.
+static bool testTransitionEscaping()
+{
+  std::cout << "Testing transition escaping" << std::endl;
+  NodeTransitionSnapshot snap;
+  snap.nodePath.push_back("Root");
+  snap.nodePath.push_back("Fish & <Chips>");
+  snap.conditions.emplace_back(NodeImpl::startIdx, Value(true));
+
+  NodeTransition trans(nullptr, WAITING_STATE, EXECUTING_STATE);
+  trans.snapshot = &snap;
+
+  std::string buf;
+  LuvFormat::formatTransition(buf, trans);
+  assertTrue_1(buf.find("<NodeId>Fish &amp; &lt;Chips&gt;</NodeId>") != std::string::npos);
+
+  pugi::xml_document doc;
+  if (!parseMessage(doc, buf))
+    return false;
+  pugi::xml_node const update = doc.child("NodeStateUpdate");
+  assertTrue_1(!strcmp("EXECUTING", update.child_value("NodeState")));
+  assertTrue_1(!strcmp("true",
+                       update.child("Conditions").child_value(NodeImpl::ALL_CONDITIONS[NodeImpl::startIdx])));
+  pugi::xml_node const path = update.child("NodePath");
+  pugi::xml_node id = path.first_child();
+  assertTrue_1(!strcmp("Root", id.child_value()));
+  id = id.next_sibling();
+  assertTrue_1(snap.nodePath[1] == id.child_value());
+  return true;
+}
+
+int main(int /* argc */, char ** /* argv */)
+{
+  bool success = testAssignmentEscaping();
+  success = testTransitionEscaping() && success;
+  std::cout << "LuvFormat test " << (success ? "succeeded" : "failed") << std::endl;
+  return (success ? 0 : 1);
+}
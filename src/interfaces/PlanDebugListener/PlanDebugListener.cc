@@ -29,7 +29,7 @@
 #include "Error.hh"
 #include "ExecListener.hh"
 #include "ExecListenerFactory.hh"
-#include "NodeImpl.hh"
+#include "Node.hh"
 #include "NodeTransition.hh"
 
 #include "pugixml.hpp"
@@ -58,23 +58,26 @@ namespace PLEXIL
     // structured approach including listener filters and a different user
     // interface may be in order.
 
+    // Uses only the transition record and the node ID, which never changes.
+    virtual bool supportsAsynchronousPublication() const override
+    {
+      return true;
+    }
+
     virtual void 
     implementNotifyNodeTransition(NodeTransition const &trans) const override
     {
-      NodeImpl *node = dynamic_cast<NodeImpl *>(trans.node);
-      assertTrueMsg(node,
-                    "PlanDebugListener:implementNotifyNodeTransition: not a node");
       condDebugMsg((trans.newState == FINISHED_STATE),
                    "Node:clock",
-                   " Node '" << node->getNodeId() <<
+                   " Node '" << trans.node->getNodeId() <<
                    "' finished at " << std::fixed << std::setprecision(6) <<
-                   node->getCurrentStateStartTime() << " (" <<
-                   outcomeName(node->getOutcome()) << ")");
+                   trans.time << " (" <<
+                   outcomeName(trans.outcome) << ")");
       condDebugMsg((trans.newState == EXECUTING_STATE),
                    "Node:clock",
-                   " Node '" << node->getNodeId() <<
+                   " Node '" << trans.node->getNodeId() <<
                    "' started at " << std::fixed << std::setprecision(6) <<
-                   node->getCurrentStateStartTime());
+                   trans.time);
     }
   };
 
@@ -74,6 +74,7 @@ class Socket
   void set_non_blocking ( const bool );
 
   bool is_valid() const { return m_sock != -1; }
+  int get_descriptor() const { return m_sock; }
   //bool isOpen() const;
 
  private:
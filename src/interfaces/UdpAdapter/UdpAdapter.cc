@@ -38,6 +38,7 @@
 #include "InterfaceError.hh"
 #include "MessageQueueMap.hh"
 #include "StateCacheEntry.hh"
+#include "UdpCodec.hh"
 #include "udp-utils.hh"
 #include "UdpEventLoop.hh"
 
@@ -87,14 +88,16 @@ namespace PLEXIL
                                        const char *command,
                                        int id = 0)
   {
-    std::ostringstream ss;
+    std::string result;
     if (command == RECEIVE_COMMAND_COMMAND)
-      ss << COMMAND_PREFIX;
+      result = COMMAND_PREFIX;
     else if (command == GET_PARAMETER_COMMAND)
-      ss << PARAM_PREFIX;
-    ss << name << '_' << id;
-    debugMsg("UdpAdapter:formatMessageName", " returning " << ss.str());
-    return ss.str();
+      result = PARAM_PREFIX;
+    result.append(name);
+    result.push_back('_');
+    result.append(std::to_string(id));
+    debugMsg("UdpAdapter:formatMessageName", " returning " << result);
+    return result;
   }
 
   struct Parameter final
@@ -110,6 +113,7 @@ namespace PLEXIL
     std::string name;                // the Plexil Command name
     std::string peer;                // peer to which to send
     std::vector<Parameter> parameters; // message value parameters
+    UdpCodec codec;                    // compiled from parameters
     unsigned int len;                         // the length of the message in bytes
     unsigned int local_port;                  // local port on which to receive
     unsigned int peer_port;                   // port to which to send
@@ -117,6 +121,7 @@ namespace PLEXIL
       : name(),
         peer(),
         parameters(),
+        codec(),
         len(0),
         local_port(0),
         peer_port(0)
@@ -125,6 +130,7 @@ namespace PLEXIL
       : name(nam),
         peer(),
         parameters(),
+        codec(),
         len(0),
         local_port(0),
         peer_port(0)
@@ -269,24 +275,20 @@ namespace PLEXIL
       }
       
       // Set up the outgoing UDP buffer to be sent
-      int length = msg->second.len;
-      unsigned char* udp_buffer = new unsigned char[length]; // fixed length to start with
-      memset((char*)udp_buffer, 0, length); // zero out the buffer
+      // Zero filled, so short strings are NUL padded
+      std::vector<unsigned char> udp_buffer(msg->second.len, 0);
       // Walk the parameters and encode them in the buffer to be sent out
-      if (0 > buildUdpBuffer(udp_buffer, msg->second, args, false, m_debug)) {
+      if (0 > buildUdpBuffer(udp_buffer.data(), msg->second, args, false, m_debug)) {
         warn("executeDefaultCommand: error formatting buffer");
-        delete[] udp_buffer;
         intf->handleCommandAck(cmd, COMMAND_FAILED);
         intf->notifyOfExternalEvent();
         return;
       }
       
       // Send the buffer to the given host:port
-      int status = sendUdpMessage(udp_buffer, msg->second, m_debug);
+      int status = sendUdpMessage(udp_buffer.data(), msg->second, m_debug);
       debugMsg("UdpAdapter:executeDefaultCommand",
                " sendUdpMessage returned " << status << " (bytes sent)");
-      // Clean up some (one hopes)
-      delete[] udp_buffer;
       // Do the internal Plexil Boiler Plate (as per example in IpcAdapter.cc)
       intf->handleCommandAck(cmd, COMMAND_SUCCESS);
       intf->notifyOfExternalEvent();
@@ -751,6 +753,12 @@ namespace PLEXIL
         if (param_desc)
           arg.desc = param_desc.value();
 
+        if (!msg.codec.addField(arg.type, arg.len, arg.elements)) {
+          warn("UdpAdapter: Message " << name << ": Invalid parameter type \""
+               << arg.type << '"');
+          return false;
+        }
+
         // Success!
         msg.len += arg.len * arg.elements;
         msg.parameters.push_back(arg);
@@ -833,161 +841,34 @@ namespace PLEXIL
         std::cout << "  handleUdpMessage: buffer: ";
         print_buffer(buffer, msgDef.len);
       }
+      // Decode the whole buffer before queueing anything
+      if (length < msgDef.len) {
+        warn("handleUdpMessage: " << msgDef.name << " message is " << length
+             << " bytes, expected " << msgDef.len);
+        return -1;
+      }
+      if (!msgDef.codec.decode(buffer, m_decoded)) {
+        warn("handleUdpMessage: error decoding " << msgDef.name << " message");
+        return -1;
+      }
+
       // (1) addMessage for expected message
       static int counter = 1;     // gensym counter
-      std::ostringstream unique_id;
-      unique_id << msgDef.name << ":msg_parameter:" << counter++;
-      std::string msg_label(unique_id.str());
+      std::string msg_label(msgDef.name);
+      msg_label.append(":msg_parameter:");
+      msg_label.append(std::to_string(counter++));
       debugMsg("UdpAdapter:handleUdpMessage", " adding \"" << msgDef.name << "\" to the command queue");
-      const std::string msg_name = formatMessageName(msgDef.name, RECEIVE_COMMAND_COMMAND);
-      m_messageQueues.addMessage(msg_name, msg_label);
+      m_messageQueues.addMessage(formatMessageName(msgDef.name, RECEIVE_COMMAND_COMMAND),
+                                 msg_label);
       // (2) walk the parameters, and for each, call addMessage(label, <value-or-key>), which
       //     (somehow) arranges for executeCommand(GetParameter) to be called, and which in turn
       //     calls addRecipient and updateQueue
-      int i = 0;
-      int offset = 0;
-      for (std::vector<Parameter>::const_iterator param = msgDef.parameters.begin();
-           param != msgDef.parameters.end();
-           param++, i++) {
-        const std::string param_label = formatMessageName(msg_label, GET_PARAMETER_COMMAND, i);
-        int len = param->len;   // number of bytes to read
-        int size = param->elements; // size of the array, or 1 for scalars
-        std::string type = param->type; // type to decode
-        if (m_debug) {
-          if (size == 1) {
-            std::cout << "  handleUdpMessage: decoding " << len << " byte " << type
-                      << " starting at buffer[" << offset << "]: ";
-          }
-          else {
-            size_t pos = type.find("-"); // remove the "-array" from the type
-            std::cout << "  handleUdpMessage: decoding " << size << " element array of " << len
-                      << " byte " << type.substr(0, pos) << "s starting at buffer[" << offset
-                      << "]: ";
-          }
-        }
-        if (type.compare("int") == 0) {
-          if (len != 2 && len != 4){
-            warn("handleUdpMessage: Integers must be 2 or 4 bytes, not " << len);
-            return -1;
-          }
-          int num;
-          num = (len == 2) ? decode_short_int(buffer, offset) : decode_int32_t(buffer, offset);
-          if (m_debug)
-            std::cout << num << std::endl;
-          debugMsg("UdpAdapter:handleUdpMessage", " queueing numeric (integer) parameter " << num);
-          m_messageQueues.addMessage(param_label, Value(num));
-          offset += len;
-        }
-        else if (type.compare("int-array") == 0) {
-          if (len != 2 && len != 4) {
-            warn("handleUdpMessage: Integers must be 2 or 4 bytes, not " << len);
-            return -1;
-          }
-          IntegerArray array(size);
-          for (int i = 0 ; i < size ; i++) {
-            array.setElement(i, (int32_t) ((len == 2) ? decode_short_int(buffer, offset) : decode_int32_t(buffer, offset)));
-            offset += len;
-          }
-          if (m_debug)
-            std::cout << array.toString() << std::endl;
-          debugMsg("UdpAdapter:handleUdpMessage", " queueing numeric (integer) array " << array.toString());
-          m_messageQueues.addMessage(param_label, array);
-        }
-        else if (type.compare("float") == 0) {
-          if (len != 4) {
-            warn("handleUdpMessage: Reals must be 4 bytes, not " << len);
-            return -1;
-          }
-          float num = decode_float(buffer, offset);
-          if (m_debug)
-            std::cout << num << std::endl;
-          debugMsg("UdpAdapter:handleUdpMessage", " queueing numeric (real) parameter " << num);
-          m_messageQueues.addMessage(param_label, Value((double) num));
-          offset += len;
-        }
-        else if (type.compare("float-array") == 0) {
-          if (len != 4) {
-            warn("handleUdpMessage: Reals must be 4 bytes, not " << len);
-            return -1;
-          }
-          RealArray array(size);
-          for (int i = 0 ; i < size ; i++) {
-            array.setElement(i, (double) decode_float(buffer, offset));
-            offset += len;
-          }
-          if (m_debug)
-            std::cout << array.toString() << std::endl;
-          debugMsg("UdpAdapter:handleUdpMessage", " queueing numeric (real) array " << array.toString());
-          m_messageQueues.addMessage(param_label, Value(array));
-        }
-        else if (type.compare("bool") == 0) {
-          int num;
-          switch (len) {
-          case 1:
-            num = buffer[offset];
-            break;
-
-          case 2:
-            num = decode_short_int(buffer, offset); break;
-
-          case 4:
-            num = decode_int32_t(buffer, offset); break;
-
-          default:
-            warn("handleUdpMessage: Booleans must be 1, 2 or 4 bytes, not " << len);
-            return -1;
-          }
-          if (m_debug)
-            std::cout << num << std::endl;
-          debugMsg("UdpAdapter:handleUdpMessage", " queueing numeric (boolean) parameter " << num);
-          m_messageQueues.addMessage(param_label, Value(num != 0));
-          offset += len;
-        }
-        else if (type.compare("bool-array") == 0) {
-          BooleanArray array(size);
-          for (int i = 0 ; i < size ; i++) {
-            switch (len) {
-            case 1: 
-              array.setElement(i, 0 != buffer[offset]); break;
-            case 2:
-              array.setElement(i, 0 != decode_short_int(buffer, offset)); break;
-            case 4:
-              array.setElement(i, 0 != decode_int32_t(buffer, offset)); break;
-            default:
-              warn("handleUdpMessage: Booleans must be 1, 2 or 4 bytes, not " << len);
-              return -1;
-            }
-            offset += len;
-          }
-          if (m_debug)
-            std::cout << array.toString() << std::endl;
-          debugMsg("UdpAdapter:handleUdpMessage", " queueing boolean array " << array.toString());
-          m_messageQueues.addMessage(param_label, Value(array));
-        }
-        else if (type.compare("string-array") == 0) {
-          // XXXX For unknown reasons, OnCommand(... String arg); is unable to receive this (inlike int and float arrays)
-          StringArray array(size);
-          for (int i = 0 ; i < size ; i++) {
-            array.setElement(i, decode_string(buffer, offset, len));
-            offset += len;
-          }
-          if (m_debug)
-            std::cout << array.toString() << std::endl;
-          debugMsg("UdpAdapter:handleUdpMessage", " queuing string array " << array.toString());
-          m_messageQueues.addMessage(param_label, Value(array));
-        }
-        else { // string or die
-          if (type.compare("string")) {
-            warn("handleUdpMessage: unknown parameter type " << type);
-            return -1;
-          }
-          std::string str = decode_string(buffer, offset, len);
-          if (m_debug)
-            std::cout << str << std::endl;
-          debugMsg("UdpAdapter:handleUdpMessage", " queuing string parameter \"" << str << "\"");
-          m_messageQueues.addMessage(param_label, Value(str));
-          offset += len;
-        }
+      for (size_t i = 0; i < m_decoded.size(); ++i) {
+        if (m_debug)
+          std::cout << "  handleUdpMessage: parameter " << i << ": " << m_decoded[i] << std::endl;
+        debugMsg("UdpAdapter:handleUdpMessage", " queueing parameter " << i << ": " << m_decoded[i]);
+        m_messageQueues.addMessage(formatMessageName(msg_label, GET_PARAMETER_COMMAND, i),
+                                   m_decoded[i]);
       }
       debugMsg("UdpAdapter:handleUdpMessage", " for " << msgDef.name << " complete");
       return 0;
@@ -1007,10 +888,6 @@ namespace PLEXIL
                        bool skip_arg,
                        bool debug)
     {
-      std::vector<Value>::const_iterator it;
-      std::vector<Parameter>::const_iterator param;
-      int start_index = 0; // where in the buffer to write
-
       // Do what error checking we can, since we absolutely know that planners foul this up.
       debugMsg("UdpAdapter:buildUdpBuffer",
                " args.size()==" << args.size()
@@ -1027,288 +904,15 @@ namespace PLEXIL
         return -1;
       }
 
-      // Iterate over the given args (it) and the message definition (param) in lock step to encode the outgoing buffer.
-      for (param = msg.parameters.begin(), it=args.begin(); param != msg.parameters.end(); param++, it++) {
-        if (skip_arg) { // only skip the first arg
-          it++; 
-          skip_arg = false; 
-        }
-        unsigned int len = param->len;
-        std::string type = param->type;
-        Value const &plexil_val = *it;
-        if (!plexil_val.isKnown()) {
-          warn("buildUdpBuffer: Value to be sent is unknown");
-          return -1;
-        }
-
-        ValueType valType = plexil_val.valueType();
-      
-        if (debug)
-          std::cout << "  buildUdpBuffer: encoding ";
-        if (type.compare("bool") == 0) {
-          if (valType != BOOLEAN_TYPE) {
-            warn("buildUdpBuffer: Format requires Boolean, but supplied value is not");
-            return -1;
-          }
-          bool temp;
-          plexil_val.getValue(temp);
-          if (debug)
-            std::cout << len << " byte bool starting at buffer[" << start_index << "]: " << temp;
-          switch (len) {
-          case 1: 
-            buffer[start_index] = (unsigned char) temp;
-            break;
-          case 2:
-            encode_short_int(temp, buffer, start_index);
-            break;
-          case 4:
-            encode_int32_t(temp, buffer, start_index);
-            break;
-          default:
-            warn("buildUdpBuffer: Booleans must be 1, 2 or 4 bytes, not " << len);
-            return -1;
-          }
-          start_index += len;
-        }
-        else if (type.compare("int") == 0) {
-          if (valType != INTEGER_TYPE) {
-            warn("buildUdpBuffer: Format requires Integer, but supplied value is not");
-            return -1;
-          }
-          if (len != 2 && len != 4) {
-            warn("buildUdpBuffer: Integers must be 2 or 4 bytes, not " << len);
-            return -1;
-          }
-          if (debug)
-            std::cout << len << " byte int starting at buffer[" << start_index << "]: " << plexil_val;
-          Integer temp;
-          plexil_val.getValue(temp);
-          if (len == 2) {
-            if (INT16_MIN > temp || temp > INT16_MAX) {
-              warn("buildUdpBuffer: 2 byte integers must be between "
-                   << INT16_MIN << " and " << INT16_MAX
-                   << ", " << temp << " is not");
-              return -1;
-            }
-            encode_short_int(temp, buffer, start_index);
-          }
-          else
-            encode_int32_t(temp, buffer, start_index);
-          start_index += len;
-        }
-        else if (type.compare("float") == 0) {
-          if (valType != REAL_TYPE) {
-            warn("buildUdpBuffer: Format requires Real, but supplied value is not");
-            return -1;
-          }
-          if (len != 4) {
-            warn("buildUdpBuffer: Reals must be 4 bytes, not " << len);
-            return -1;
-          }
-          double temp;
-          plexil_val.getValue(temp);
-          // Catch really big floats
-          if ((-FLT_MAX) > temp || temp > FLT_MAX) {
-            warn("buildUdpBuffer: Reals (floats) must be between "
-                 << (-FLT_MAX) << " and " << FLT_MAX <<
-                 ", not " << plexil_val);
-            return -1;
-          }
-          if (debug)
-            std::cout << len << " byte float starting at buffer[" << start_index << "]: " << temp;
-          encode_float((float) temp, buffer, start_index);
-          start_index += len;
-        }
-        else if (type.compare("string") == 0) {
-          if (valType != STRING_TYPE) {
-            warn("buildUdpBuffer: Format requires String, but supplied value is not");
-            return -1;
-          }
-          std::string const *str = nullptr;
-          plexil_val.getValuePointer(str);
-          if (str->length() > len) {
-            warn("buildUdpBuffer: declared string length (" << len <<
-                 ") and actual length (" << str->length() << ", " << *str <<
-                 ") used in the plan are not compatible");
-            return -1;
-          }
-          if (debug) 
-            std::cout << len << " byte string starting at buffer[" << start_index << "]: " << str;
-          encode_string(*str, buffer, start_index);
-          start_index += len;
-        }
-        else if (type.compare("bool-array") == 0) {
-          if (valType != BOOLEAN_ARRAY_TYPE) {
-            warn("buildUdpBuffer: Format requires BooleanArray, but supplied value is not");
-            return -1;
-          }
-          if (len != 1 && len != 2 && len != 4) {
-            warn("buildUdpBuffer: Booleans must be 1, 2 or 4 bytes, not " << len);
-            return -1;
-          }
-          unsigned int size = param->elements;
-          BooleanArray const *array = nullptr;
-          plexil_val.getValuePointer(array);
-          if (debug)
-            std::cout << size << " element array of "
-                      << len << " byte booleans starting at buffer["
-                      << start_index << "]: " << array->toString();
-          if (size != array->size()) {
-            warn("buildUdpBuffer: declared and actual (boolean) array sizes differ: "
-                 << size << " was declared, but "
-                 << array->size() << " is being used in the plan");
-            return -1;
-          }
-          for (unsigned int i = 0 ; i < size ; i++) {
-            bool temp;
-            if (!array->getElement(i, temp)) {
-              warn("buildUdpBuffer: Array element at index " << i << " is unknown");
-              return -1;
-            }
-            switch (len) {
-            case 1:
-              buffer[start_index] = (unsigned char) temp;
-              break;
-            case 2:
-              encode_short_int(temp, buffer, start_index);
-              break;
-            default:
-              encode_int32_t(temp, buffer, start_index);
-              break;
-            }
-            start_index += len;
-          }
-        }
-        else if (type.compare("int-array") == 0) {
-          if (plexil_val.valueType() != INTEGER_ARRAY_TYPE) {
-            warn("buildUdpBuffer: Format requires IntegerArray, supplied value is a "
-                 << valueTypeName(plexil_val.valueType()));
-            return -1;
-          }
-          if (len != 2 && len != 4) {
-            warn("buildUdpBuffer: Integers must be 2 or 4 bytes, not " << len);
-            return -1;
-          }
-          unsigned int size = param->elements;
-          IntegerArray const *array = nullptr;
-          plexil_val.getValuePointer(array);
-          if (debug)
-            std::cout << size << " element array of " << len << " byte ints starting at ["
-                      << start_index << "]: " << array->toString();
-          if (size != array->size()) {
-            warn("buildUdpBuffer: declared and actual array sizes differ: "
-                 << size << " was declared, but "
-                 << array->size() << " is being used in the plan");
-            return -1;
-          }
-          for (unsigned int i = 0 ; i < size ; i++) {
-            Integer temp;
-            if (!array->getElement(i, temp)) {
-              warn("buildUdpBuffer: Array element at index " << i << " is unknown");
-              return -1;
-            }
-            if (len == 2) {
-              if (INT16_MIN > temp || temp > INT16_MAX) {
-                warn("buildUdpBuffer: 2 bytes integers must be between "
-                     << INT16_MIN << " and " << INT16_MAX
-                     << ", " << temp << " is not");
-                return -1;
-              }
-              encode_short_int(temp, buffer, start_index);
-            }
-            else
-              encode_int32_t(temp, buffer, start_index);
-            start_index += len;
-          }
-        }
-        else if (type.compare("float-array") == 0) {
-          if (plexil_val.valueType() != REAL_ARRAY_TYPE) {
-            warn("buildUdpBuffer: Format requires RealArray, supplied value is a "
-                 << valueTypeName(plexil_val.valueType()));
-            return -1;
-          }
-          if (len != 4) {
-            warn("buildUdpBuffer: Reals must be 4 bytes, not " << len);
-            return -1;
-          }
-          unsigned int size = param->elements;
-          if (size < 1) {
-            warn("buildUdpBuffer: all scalars and arrays must be of at least size 1, not " << size);
-            return -1;
-          }
-          RealArray const *array = nullptr;
-          plexil_val.getValuePointer(array);
-          if (debug)
-            std::cout << size << " element array of " << len << " byte floats starting at buffer["
-                      << start_index << "]: " << array->toString();
-          if (size != array->size()) {
-            warn("buildUdpBuffer: declared and actual (float) array sizes differ: "
-                 << size << " was declared, but "
-                 << array->size() << " is being used in the plan");
-            return -1;
-          }
-          for (unsigned int i = 0 ; i < size ; i++) {
-            double temp;
-            if (!array->getElement(i, temp)) {
-              warn("buildUdpBuffer: Array element at index " << i << " is unknown");
-              return -1;
-            }
-            if ((-FLT_MAX) > temp || temp > FLT_MAX) {
-              warn("buildUdpBuffer: Reals (floats) must be between "
-                   << (-FLT_MAX) << " and " << FLT_MAX <<
-                   ", " << temp << " is not");
-              return -1;
-            }
-            encode_float((float) temp, buffer, start_index);
-            start_index += len;
-          }
-        }
-        else if (type.compare("string-array") == 0) {
-          if (plexil_val.valueType() != STRING_ARRAY_TYPE) {
-            warn("buildUdpBuffer: Format requires StringArray, supplied value is a "
-                 << valueTypeName(plexil_val.valueType()));
-            return -1;
-          }
-          unsigned int size = param->elements;
-          StringArray const *array = nullptr;
-          plexil_val.getValuePointer(array);
-          if (debug)
-            std::cout << size << " element array of " << len << " byte strings starting at buffer["
-                      << start_index << "]: " << array->toString();
-          if (size != array->size()) {
-            warn("buildUdpBuffer: declared and actual (string) array sizes differ: "
-                 << size << " was declared, but " << array->size() << " is being used in the plan");
-            return -1;
-          }
-          for (unsigned int i = 0 ; i < size ; i++) {
-            std::string const *temp = nullptr;
-            if (!array->getElementPointer(i, temp)) {
-              warn("buildUdpBuffer: Array element at index " << i << " is unknown");
-              return -1;
-            }
-            if (temp->length() > len) {
-              warn("buildUdpBuffer: declared string length (" << len <<
-                   ") and actual length (" << temp->length() <<
-                   ") used in the plan are not compatible");
-              return -1;
-            }
-            encode_string(*temp, buffer, start_index);
-            start_index += len;
-          }
-        }
-        else {
-          warn("buildUdpBuffer: unknown parameter type " << type);
-          return -1;
-        }
+      // The codec checks each value against its declared type and size
+      if (!msg.codec.encode(args, skip_arg ? 1 : 0, buffer))
+        return -1;
 
-        if (debug)
-          std::cout << std::endl;
-      }
       if (debug) {
         std::cout << "  buildUdpBuffer: buffer: ";
         print_buffer(buffer, msg.len);
       }
-      return start_index;
+      return (int) msg.codec.size();
     }
 
     void printMessageContent(const std::string& name, const std::vector<Value>& args)
@@ -1346,6 +950,7 @@ namespace PLEXIL
     std::string m_default_peer;
     MessageMap m_messages;
     MessageQueueMap m_messageQueues;
+    std::vector<Value> m_decoded; // scratch for handleUdpMessage(), event loop thread only
     unsigned int m_default_local_port;
     unsigned int m_default_peer_port;
     bool m_debug; // Show debugging output
@@ -0,0 +1,463 @@
+// Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "UdpCodec.hh"
+
+#include "ArrayImpl.hh"
+#include "Error.hh"
+
+#ifdef HAVE_ARPA_INET_H
+#include <arpa/inet.h> // htonl(), htons(), ntohl(), ntohs()
+#endif
+
+#include <cfloat>
+#include <cstring> // memchr(), memcpy()
+
+namespace PLEXIL
+{
+
+  //
+  // Byte order conversion
+  //
+  // memcpy() through a local avoids unaligned loads and stores, and
+  // compiles to a single move.  The array loops below are kept
+  // simple enough for the compiler to vectorize the byte swaps.
+  //
+
+  static inline uint16_t load16(unsigned char const *p)
+  {
+    uint16_t x;
+    memcpy(&x, p, sizeof(x));
+    return ntohs(x);
+  }
+
+  static inline uint32_t load32(unsigned char const *p)
+  {
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return ntohl(x);
+  }
+
+  static inline void store16(unsigned char *p, uint16_t x)
+  {
+    x = htons(x);
+    memcpy(p, &x, sizeof(x));
+  }
+
+  static inline void store32(unsigned char *p, uint32_t x)
+  {
+    x = htonl(x);
+    memcpy(p, &x, sizeof(x));
+  }
+
+  static void decodeIntegers(unsigned char const *p, size_t n, unsigned int len,
+                             Integer *out)
+  {
+    if (len == 2) {
+      for (size_t i = 0; i < n; ++i)
+        out[i] = (int16_t) load16(p + 2 * i);
+    }
+    else {
+      for (size_t i = 0; i < n; ++i)
+        out[i] = (int32_t) load32(p + 4 * i);
+    }
+  }
+
+  static void decodeReals(unsigned char const *p, size_t n, Real *out)
+  {
+    for (size_t i = 0; i < n; ++i) {
+      uint32_t bits = load32(p + 4 * i);
+      float f;
+      memcpy(&f, &bits, sizeof(f));
+      out[i] = f;
+    }
+  }
+
+  static inline bool decodeBoolean(unsigned char const *p, unsigned int len)
+  {
+    switch (len) {
+    case 1:
+      return p[0] != 0;
+
+    case 2:
+      return load16(p) != 0;
+
+    default:
+      return load32(p) != 0;
+    }
+  }
+
+  // Stops at the first NUL or the field length, whichever comes first.
+  static inline String decodeString(unsigned char const *p, unsigned int len)
+  {
+    void const *nul = memchr(p, 0, len);
+    size_t n = nul ? (static_cast<unsigned char const *>(nul) - p) : len;
+    return String(reinterpret_cast<char const *>(p), n);
+  }
+
+  static inline void encodeBoolean(unsigned char *p, unsigned int len, bool b)
+  {
+    switch (len) {
+    case 1:
+      p[0] = (unsigned char) b;
+      break;
+
+    case 2:
+      store16(p, b);
+      break;
+
+    default:
+      store32(p, b);
+      break;
+    }
+  }
+
+  static bool checkInteger(Integer i, unsigned int len)
+  {
+    if (len == 2 && (INT16_MIN > i || i > INT16_MAX)) {
+      warn("UdpCodec: 2 byte integers must be between "
+           << INT16_MIN << " and " << INT16_MAX
+           << ", " << i << " is not");
+      return false;
+    }
+    return true;
+  }
+
+  static bool checkReal(Real r)
+  {
+    if ((-FLT_MAX) > r || r > FLT_MAX) {
+      warn("UdpCodec: Reals (floats) must be between "
+           << (-FLT_MAX) << " and " << FLT_MAX
+           << ", " << r << " is not");
+      return false;
+    }
+    return true;
+  }
+
+  static bool checkString(String const &s, unsigned int len)
+  {
+    if (s.length() > len) {
+      warn("UdpCodec: declared string length (" << len
+           << ") and actual length (" << s.length() << ", " << s
+           << ") used in the plan are not compatible");
+      return false;
+    }
+    return true;
+  }
+
+  // Check an outgoing array's size and that all its elements are known.
+  static bool checkArray(Array const *array, unsigned int size)
+  {
+    if (size != array->size()) {
+      warn("UdpCodec: declared and actual array sizes differ: "
+           << size << " was declared, but "
+           << array->size() << " is being used in the plan");
+      return false;
+    }
+    if (!array->allElementsKnown()) {
+      for (size_t i = 0; i < size; ++i) {
+        if (!array->elementKnown(i)) {
+          warn("UdpCodec: Array element at index " << i << " is unknown");
+          break;
+        }
+      }
+      return false;
+    }
+    return true;
+  }
+
+  bool UdpCodec::addField(std::string const &type, unsigned int len, unsigned int elements)
+  {
+    Field field;
+    field.offset = m_size;
+    field.len = len;
+    field.elements = elements;
+    field.isArray = (type.find("-array") != std::string::npos);
+
+    std::string const base = type.substr(0, type.find('-'));
+    if (base == "bool")
+      field.type = BOOL_FIELD;
+    else if (base == "int")
+      field.type = INT_FIELD;
+    else if (base == "float")
+      field.type = FLOAT_FIELD;
+    else if (base == "string")
+      field.type = STRING_FIELD;
+    else
+      return false;
+    if (field.isArray && type != base + "-array")
+      return false;
+
+    m_fields.push_back(field);
+    m_size += (size_t) len * elements;
+    return true;
+  }
+
+  bool UdpCodec::decode(unsigned char const *buffer, std::vector<Value> &result) const
+  {
+    result.resize(m_fields.size());
+    for (size_t i = 0; i < m_fields.size(); ++i) {
+      Field const &field = m_fields[i];
+      unsigned char const *p = buffer + field.offset;
+      size_t const n = field.elements;
+
+      switch (field.type) {
+      case BOOL_FIELD:
+        if (field.len != 1 && field.len != 2 && field.len != 4) {
+          warn("UdpCodec: Booleans must be 1, 2 or 4 bytes, not " << field.len);
+          return false;
+        }
+        if (field.isArray) {
+          BooleanArray array(n);
+          for (size_t j = 0; j < n; ++j)
+            array.setElement(j, decodeBoolean(p + j * field.len, field.len));
+          result[i] = Value(std::move(array));
+        }
+        else
+          result[i] = Value(decodeBoolean(p, field.len));
+        break;
+
+      case INT_FIELD:
+        if (field.len != 2 && field.len != 4) {
+          warn("UdpCodec: Integers must be 2 or 4 bytes, not " << field.len);
+          return false;
+        }
+        if (field.isArray) {
+          std::vector<Integer> contents(n);
+          decodeIntegers(p, n, field.len, contents.data());
+          result[i] = Value(IntegerArray(std::move(contents)));
+        }
+        else {
+          Integer temp;
+          decodeIntegers(p, 1, field.len, &temp);
+          result[i] = Value(temp);
+        }
+        break;
+
+      case FLOAT_FIELD:
+        if (field.len != 4) {
+          warn("UdpCodec: Reals must be 4 bytes, not " << field.len);
+          return false;
+        }
+        if (field.isArray) {
+          std::vector<Real> contents(n);
+          decodeReals(p, n, contents.data());
+          result[i] = Value(RealArray(std::move(contents)));
+        }
+        else {
+          Real temp;
+          decodeReals(p, 1, &temp);
+          result[i] = Value(temp);
+        }
+        break;
+
+      case STRING_FIELD:
+        if (field.isArray) {
+          std::vector<String> contents(n);
+          for (size_t j = 0; j < n; ++j)
+            contents[j] = decodeString(p + j * field.len, field.len);
+          result[i] = Value(StringArray(std::move(contents)));
+        }
+        else
+          result[i] = Value(decodeString(p, field.len));
+        break;
+      }
+    }
+    return true;
+  }
+
+  bool UdpCodec::encode(std::vector<Value> const &args, size_t first,
+                        unsigned char *buffer) const
+  {
+    if (args.size() != first + m_fields.size()) {
+      warn("UdpCodec: expected " << m_fields.size() << " parameters, got "
+           << (args.size() > first ? args.size() - first : 0));
+      return false;
+    }
+
+    for (size_t i = 0; i < m_fields.size(); ++i) {
+      Field const &field = m_fields[i];
+      Value const &val = args[first + i];
+      unsigned char *p = buffer + field.offset;
+      size_t const n = field.elements;
+
+      if (!val.isKnown()) {
+        warn("UdpCodec: Value to be sent is unknown");
+        return false;
+      }
+
+      switch (field.type) {
+      case BOOL_FIELD:
+        if (field.len != 1 && field.len != 2 && field.len != 4) {
+          warn("UdpCodec: Booleans must be 1, 2 or 4 bytes, not " << field.len);
+          return false;
+        }
+        if (field.isArray) {
+          BooleanArray const *array = nullptr;
+          if (val.valueType() != BOOLEAN_ARRAY_TYPE || !val.getValuePointer(array)) {
+            warn("UdpCodec: Format requires BooleanArray, supplied value is a "
+                 << valueTypeName(val.valueType()));
+            return false;
+          }
+          if (!checkArray(array, n))
+            return false;
+          std::vector<Boolean> const *contents = nullptr;
+          array->getContentsVector(contents);
+          for (size_t j = 0; j < n; ++j)
+            encodeBoolean(p + j * field.len, field.len, (*contents)[j]);
+        }
+        else {
+          Boolean b;
+          if (val.valueType() != BOOLEAN_TYPE || !val.getValue(b)) {
+            warn("UdpCodec: Format requires Boolean, but supplied value is not");
+            return false;
+          }
+          encodeBoolean(p, field.len, b);
+        }
+        break;
+
+      case INT_FIELD:
+        if (field.len != 2 && field.len != 4) {
+          warn("UdpCodec: Integers must be 2 or 4 bytes, not " << field.len);
+          return false;
+        }
+        if (field.isArray) {
+          IntegerArray const *array = nullptr;
+          if (val.valueType() != INTEGER_ARRAY_TYPE || !val.getValuePointer(array)) {
+            warn("UdpCodec: Format requires IntegerArray, supplied value is a "
+                 << valueTypeName(val.valueType()));
+            return false;
+          }
+          if (!checkArray(array, n))
+            return false;
+          std::vector<Integer> const *contents = nullptr;
+          array->getContentsVector(contents);
+          Integer const *in = contents->data();
+          if (field.len == 2) {
+            for (size_t j = 0; j < n; ++j)
+              if (!checkInteger(in[j], 2))
+                return false;
+            for (size_t j = 0; j < n; ++j)
+              store16(p + 2 * j, (uint16_t) in[j]);
+          }
+          else {
+            for (size_t j = 0; j < n; ++j)
+              store32(p + 4 * j, (uint32_t) in[j]);
+          }
+        }
+        else {
+          Integer temp;
+          if (val.valueType() != INTEGER_TYPE || !val.getValue(temp)) {
+            warn("UdpCodec: Format requires Integer, but supplied value is not");
+            return false;
+          }
+          if (!checkInteger(temp, field.len))
+            return false;
+          if (field.len == 2)
+            store16(p, (uint16_t) temp);
+          else
+            store32(p, (uint32_t) temp);
+        }
+        break;
+
+      case FLOAT_FIELD:
+        if (field.len != 4) {
+          warn("UdpCodec: Reals must be 4 bytes, not " << field.len);
+          return false;
+        }
+        if (field.isArray) {
+          RealArray const *array = nullptr;
+          if (val.valueType() != REAL_ARRAY_TYPE || !val.getValuePointer(array)) {
+            warn("UdpCodec: Format requires RealArray, supplied value is a "
+                 << valueTypeName(val.valueType()));
+            return false;
+          }
+          if (!checkArray(array, n))
+            return false;
+          std::vector<Real> const *contents = nullptr;
+          array->getContentsVector(contents);
+          Real const *in = contents->data();
+          for (size_t j = 0; j < n; ++j)
+            if (!checkReal(in[j]))
+              return false;
+          for (size_t j = 0; j < n; ++j) {
+            float f = (float) in[j];
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            store32(p + 4 * j, bits);
+          }
+        }
+        else {
+          Real temp;
+          if (val.valueType() != REAL_TYPE || !val.getValue(temp)) {
+            warn("UdpCodec: Format requires Real, but supplied value is not");
+            return false;
+          }
+          if (!checkReal(temp))
+            return false;
+          float f = (float) temp;
+          uint32_t bits;
+          memcpy(&bits, &f, sizeof(bits));
+          store32(p, bits);
+        }
+        break;
+
+      case STRING_FIELD:
+        if (field.isArray) {
+          StringArray const *array = nullptr;
+          if (val.valueType() != STRING_ARRAY_TYPE || !val.getValuePointer(array)) {
+            warn("UdpCodec: Format requires StringArray, supplied value is a "
+                 << valueTypeName(val.valueType()));
+            return false;
+          }
+          if (!checkArray(array, n))
+            return false;
+          std::vector<String> const *contents = nullptr;
+          array->getContentsVector(contents);
+          for (size_t j = 0; j < n; ++j) {
+            String const &s = (*contents)[j];
+            if (!checkString(s, field.len))
+              return false;
+            // Not NUL terminated; the buffer is initially zero
+            memcpy(p + j * field.len, s.data(), s.length());
+          }
+        }
+        else {
+          String const *s = nullptr;
+          if (val.valueType() != STRING_TYPE || !val.getValuePointer(s)) {
+            warn("UdpCodec: Format requires String, but supplied value is not");
+            return false;
+          }
+          if (!checkString(*s, field.len))
+            return false;
+          memcpy(p, s->data(), s->length());
+        }
+        break;
+      }
+    }
+    return true;
+  }
+
+} // namespace PLEXIL
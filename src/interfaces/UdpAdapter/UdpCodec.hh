@@ -0,0 +1,117 @@
+// Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PLEXIL_UDP_CODEC_HH
+#define PLEXIL_UDP_CODEC_HH
+
+#include "Value.hh"
+
+#include <string>
+#include <vector>
+
+namespace PLEXIL
+{
+
+  //! @class UdpCodec
+  //! Encodes and decodes the binary representation of one UdpAdapter
+  //! message definition.  The message's parameter list is compiled
+  //! once, into fields at fixed offsets, so that encoding and
+  //! decoding are straight-line copies with byte swapping.
+  //! All multi-byte numbers are in network byte order.
+  class UdpCodec final
+  {
+  public:
+
+    //! The wire representation of one parameter.
+    enum FieldType : uint8_t
+      {
+       BOOL_FIELD = 0,
+       INT_FIELD,
+       FLOAT_FIELD,
+       STRING_FIELD
+      };
+
+    //! One compiled message parameter.
+    struct Field final
+    {
+      size_t offset;         //!< Offset of the first byte in the message.
+      unsigned int len;      //!< Bytes per element.
+      unsigned int elements; //!< Number of elements; 1 for scalars.
+      FieldType type;        //!< Element type.
+      bool isArray;          //!< True if the parameter is an array.
+    };
+
+    UdpCodec() = default;
+    UdpCodec(UdpCodec const &) = default;
+    UdpCodec(UdpCodec &&) = default;
+    UdpCodec &operator=(UdpCodec const &) = default;
+    UdpCodec &operator=(UdpCodec &&) = default;
+    ~UdpCodec() = default;
+
+    //! Append a parameter to the message layout.
+    //! @param type The parameter type name from the message
+    //!             definition, e.g. "int" or "float-array".
+    //! @param len The number of bytes for one element.
+    //! @param elements The number of elements; 1 for scalars.
+    //! @return True if the type name is valid, false otherwise.
+    //! @note Range checking of len and elements is the caller's job.
+    bool addField(std::string const &type, unsigned int len, unsigned int elements);
+
+    //! Get the total length of the message in bytes.
+    size_t size() const
+    {
+      return m_size;
+    }
+
+    //! Get the compiled fields.
+    std::vector<Field> const &fields() const
+    {
+      return m_fields;
+    }
+
+    //! Decode a message into one Value per parameter.
+    //! @param buffer The message.  Must contain at least size() bytes.
+    //! @param result Vector to receive the values.  Resized as needed.
+    //! @return True if successful, false otherwise.
+    bool decode(unsigned char const *buffer, std::vector<Value> &result) const;
+
+    //! Encode one Value per parameter into a message.
+    //! @param args The values.
+    //! @param first Index in args of the value for the first parameter.
+    //! @param buffer The buffer to receive the message.  Must contain
+    //!               at least size() bytes, initially zero.
+    //! @return True if successful, false otherwise.
+    bool encode(std::vector<Value> const &args, size_t first,
+                unsigned char *buffer) const;
+
+  private:
+
+    std::vector<Field> m_fields;
+    size_t m_size = 0;
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_UDP_CODEC_HH
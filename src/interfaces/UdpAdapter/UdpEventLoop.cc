@@ -37,6 +37,12 @@
 #include <poll.h>
 #endif
 
+// Use epoll() and recvmmsg() where available, poll() and recvfrom() otherwise
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_RECVMMSG)
+#define PLEXIL_UDP_USE_EPOLL 1
+#include <sys/epoll.h>
+#endif
+
 #ifdef HAVE_UNISTD_H
 #include <unistd.h> // pipe()
 #endif
@@ -54,6 +60,18 @@
 namespace PLEXIL
 {
 
+#ifdef PLEXIL_UDP_USE_EPOLL
+  //! Maximum number of datagrams read by one recvmmsg() call.
+  static constexpr size_t RECV_BATCH_SIZE = 16;
+
+  //! Maximum number of recvmmsg() calls per listener per wakeup,
+  //! so that one busy port can't starve the others.
+  static constexpr size_t RECV_MAX_ROUNDS = 4;
+
+  //! Maximum number of events returned by one epoll_wait() call.
+  static constexpr int EPOLL_MAX_EVENTS = 32;
+#endif
+
   //! Structure to maintain the state of one listener.
   struct Listener
   {
@@ -66,6 +84,34 @@ namespace PLEXIL
     in_port_t port;
     bool active;
 
+#ifdef PLEXIL_UDP_USE_EPOLL
+    //! Ring of receive buffers and headers for recvmmsg().
+    //! Allocated when the listener is added to the epoll set.
+    std::vector<char> batchBuffer;
+    std::vector<struct sockaddr_storage> batchAddrs;
+    std::vector<struct iovec> batchIov;
+    std::vector<struct mmsghdr> batchHdrs;
+
+    void allocateBatch()
+    {
+      if (!batchHdrs.empty())
+        return;
+      batchBuffer.resize(RECV_BATCH_SIZE * maxSize);
+      batchAddrs.resize(RECV_BATCH_SIZE);
+      batchIov.resize(RECV_BATCH_SIZE);
+      batchHdrs.resize(RECV_BATCH_SIZE);
+      for (size_t i = 0; i < RECV_BATCH_SIZE; ++i) {
+        batchIov[i].iov_base = batchBuffer.data() + i * maxSize;
+        batchIov[i].iov_len = maxSize;
+        struct msghdr &hdr = batchHdrs[i].msg_hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_name = &batchAddrs[i];
+        hdr.msg_iov = &batchIov[i];
+        hdr.msg_iovlen = 1;
+      }
+    }
+#endif
+
     Listener(int fd, in_port_t p, size_t maxLen, ListenerFunction fn)
       : func(fn),
         maxSize(maxLen),
@@ -154,6 +200,8 @@ namespace PLEXIL
     ListenerMap m_listeners;
     //! FD -> listener map
     DescriptorMap m_descriptors;
+    //! Descriptors for poll(); event loop thread only.
+    std::vector<struct pollfd> m_pollfds;
     //! Lock for port -> listener map
     std::mutex m_listenerMutex;
     //! Semaphore for background 'task complete' notification
@@ -164,6 +212,8 @@ namespace PLEXIL
     //! m_pipeFDs[0] is the event thread read port.
     //! m_pipeFDs[1] is the control write port.
     int m_pipeFDs[2];
+    //! The epoll instance, or -1 if using poll().
+    int m_epollFD;
 
   public:
     UdpEventLoopImpl()
@@ -172,7 +222,8 @@ namespace PLEXIL
         m_listenerMutex(),
         m_sem(),
         m_eventThread(),
-        m_pipeFDs()
+        m_pipeFDs(),
+        m_epollFD(-1)
     {
       m_pipeFDs[0] = 0;
       m_pipeFDs[1] = 0;
@@ -349,18 +400,99 @@ namespace PLEXIL
     {
       debugMsg("UdpEventLoop:eventLoop", "(" << pipeFD << ")");
 
+      bool stopped = false;
+#ifdef PLEXIL_UDP_USE_EPOLL
+      m_epollFD = epoll_create1(EPOLL_CLOEXEC);
+      if (m_epollFD >= 0) {
+        stopped = epollEventLoop(pipeFD);
+        if (close(m_epollFD)) {
+          warn("UdpEventLoop: closing epoll descriptor failed: " << strerror(errno));
+        }
+        m_epollFD = -1;
+      }
+      else {
+        warn("UdpEventLoop: epoll_create1() failed: " << strerror(errno)
+             << "\n falling back to poll()");
+        stopped = pollEventLoop(pipeFD);
+      }
+#else
+      stopped = pollEventLoop(pipeFD);
+#endif
+
+      if (!stopped) {
+        warn("UdpEventLoop: shutting down on error");
+      }
+
+      // Close the command pipe
+      if (close(pipeFD)) {
+        warn("UdpEventLoop: closing control pipe failed: " << strerror(errno));
+      }
+
+      // Wipe the file descriptor map.
+      // The listeners will be deleted in the foreground.
+      m_descriptors.clear();
+      m_pollfds.clear();
+      debugMsg("UdpEventLoop:eventLoop", " exited");
+    }
+
+    //! Read and act on one message from the control pipe.
+    //! @param pipeFD File descriptor of the control pipe.
+    //! @param stopped Set to true if a stop was requested.
+    //! @return False if an error occurred, true otherwise.
+    //! @note Must only be called synchronously from the event loop.
+    bool handleControlMessage(int pipeFD, bool &stopped)
+    {
+      debugMsg("UdpEventLoop:eventLoop", " control event");
+      ControlMsg request;
+      ssize_t nbytes = read(pipeFD, &request, sizeof(ControlMsg));
+      if (nbytes < 0) {
+        warn("UdpEventLoop: read() from control pipe failed: " << strerror(errno));
+        return false;
+      }
+      if (!nbytes) {
+        // EOF on pipe = stop request
+        debugMsg("UdpEventLoop:eventLoop", " stop requested");
+        stopped = true;
+        return true;
+      }
+      if (nbytes != sizeof(ControlMsg)) {
+        // OOPS
+        warn("UdpEventLoop: control message was wrong size!");
+        return false;
+      }
+
+      switch(request.op) {
+      case OP_ADD:
+        addListener(request.port);
+        break;
+
+      case OP_REMOVE:
+        removeListener(request.port);
+        break;
+
+      default:
+        warn("UdpEventLoop: invalid control message!");
+        break;
+      }
+      return true;
+    }
+
+    //! Event loop using poll().
+    //! @param pipeFD File descriptor on which to listen for commands.
+    //! @return True if stopped by request, false on error.
+    bool pollEventLoop(int pipeFD)
+    {
       // Allocate a reasonable initial vector.
-      std::vector<struct pollfd> pollfds;
-      pollfds.reserve(4);
+      m_pollfds.reserve(4);
 
       // Set up the control pipe.
       struct pollfd pfd = {pipeFD, POLLIN, 0};
-      pollfds.push_back(pfd);
+      m_pollfds.push_back(pfd);
 
       bool stopped = false;
       bool error = false;
       do {
-        int nReady = poll(pollfds.data(), pollfds.size(), -1);
+        int nReady = poll(m_pollfds.data(), m_pollfds.size(), -1);
         if (nReady < 0) {
           warn("UdpEventLoop: poll() failed: " << strerror(errno));
           break;
@@ -372,67 +504,38 @@ namespace PLEXIL
         }
 
         // At least 1 FD is ready
-        // pollfds[0] should always represent the control pipe
-        if (pollfds[0].revents) {
-          if (pollfds[0].revents & (POLLERR | POLLNVAL)) {
+        // m_pollfds[0] should always represent the control pipe
+        if (m_pollfds[0].revents) {
+          if (m_pollfds[0].revents & (POLLERR | POLLNVAL)) {
             warn("UdpEventLoop: error on control pipe");
             break;
           }
 
-          debugMsg("UdpEventLoop:eventLoop", " control event");
           // Handle control message or stop request
-          ControlMsg request;
-          ssize_t nbytes = read(pipeFD, &request, sizeof(ControlMsg));
-          if (nbytes < 0) {
-            warn("UdpEventLoop: read() from control pipe failed: " << strerror(errno));
+          if (!handleControlMessage(pipeFD, stopped)) {
             error = true;
             break;
           }
-          else if (!nbytes) {
-            // EOF on pipe = stop request
-            debugMsg("UdpEventLoop:eventLoop", " stop requested");
-            stopped = true;
+          if (stopped)
             nReady = 0;
-          }
-          else if (nbytes != sizeof(ControlMsg)) {
-            // OOPS
-            warn("UdpEventLoop: control message was wrong size!");
-            error = true;
-            break;
-          }
-          else {
-            switch(request.op) {
-            case OP_ADD:
-              addListener(request.port, pollfds);
-              break;
-
-            case OP_REMOVE:
-              removeListener(request.port, pollfds);
-              break;
-
-            default:
-              warn("UdpEventLoop: invalid control message!");
-              break;
-            }
-
+          else
             // Mark this one off and see if we have more FDs ready
             --nReady;
-          }
         }
         if (nReady) {
           // Identify FD(s) which became ready
           // and dispatch the incoming datagrams
-          for (size_t i = 1; i < pollfds.size(); ++i) {
-            if (pollfds[i].revents) {
+          for (size_t i = 1; i < m_pollfds.size(); ++i) {
+            if (m_pollfds[i].revents) {
               --nReady;
-              int fd = pollfds[i].fd;
+              int fd = m_pollfds[i].fd;
               if (!m_descriptors[fd]) {
                 warn("UdpEventLoop: internal error: no listener for FD " << fd);
                 error = true;
                 break;
               }
-              if (pollfds[i].revents & (POLLERR | POLLNVAL)) {
-                warn("UdpEventLoop: error on FD " << pollfds[i].fd
+              if (m_pollfds[i].revents & (POLLERR | POLLNVAL)) {
+                warn("UdpEventLoop: error on FD " << m_pollfds[i].fd
                      << " (port " << m_descriptors[fd]->port << ')');
                 error = true;
                 break;
@@ -450,25 +553,72 @@ namespace PLEXIL
         }
       } while (!stopped && !error);
 
-      if (!stopped) {
-        warn("UdpEventLoop: shutting down on error");
-      }
+      return stopped;
+    }
 
-      // Close the command pipe
-      if (close(pipeFD)) {
-        warn("UdpEventLoop: closing control pipe failed: " << strerror(errno));
+#ifdef PLEXIL_UDP_USE_EPOLL
+    //! Event loop using epoll() and recvmmsg().
+    //! @param pipeFD File descriptor on which to listen for commands.
+    //! @return True if stopped by request, false on error.
+    bool epollEventLoop(int pipeFD)
+    {
+      // The control pipe is the only entry with a null pointer
+      struct epoll_event ev = {};
+      ev.events = EPOLLIN;
+      ev.data.ptr = nullptr;
+      if (epoll_ctl(m_epollFD, EPOLL_CTL_ADD, pipeFD, &ev)) {
+        warn("UdpEventLoop: epoll_ctl() failed on control pipe: " << strerror(errno));
+        return false;
       }
 
-      // Wipe the file descriptor map.
-      // The listeners will be deleted in the foreground.
-      m_descriptors.clear();
-      debugMsg("UdpEventLoop:eventLoop", " exited");
+      struct epoll_event events[EPOLL_MAX_EVENTS];
+      bool stopped = false;
+      bool error = false;
+      do {
+        int nReady = epoll_wait(m_epollFD, events, EPOLL_MAX_EVENTS, -1);
+        if (nReady < 0) {
+          if (errno == EINTR)
+            continue;
+          warn("UdpEventLoop: epoll_wait() failed: " << strerror(errno));
+          break;
+        }
+
+        // Dispatch datagrams first, because a control request
+        // may remove a listener which appears later in this batch.
+        bool controlReady = false;
+        for (int i = 0; i < nReady; ++i) {
+          Listener *l = static_cast<Listener *>(events[i].data.ptr);
+          if (!l) {
+            if (events[i].events & EPOLLERR) {
+              warn("UdpEventLoop: error on control pipe");
+              error = true;
+              break;
+            }
+            controlReady = true;
+            continue;
+          }
+          if (events[i].events & EPOLLERR) {
+            warn("UdpEventLoop: error on FD " << l->socketFD
+                 << " (port " << l->port << ')');
+            error = true;
+            break;
+          }
+          handleBatchReady(l);
+        }
+
+        // Handle control message or stop request
+        if (controlReady && !error && !handleControlMessage(pipeFD, stopped))
+          error = true;
+      } while (!stopped && !error);
+
+      return stopped;
     }
+#endif
 
     //! Add the listener registered for the given port.
     //! @param port The port.
     //! @note Must only be called synchronously from the event loop.
-    void addListener(in_port_t port, std::vector<struct pollfd> &pollfds)
+    void addListener(in_port_t port)
     {
       debugMsg("UdpEventLoop:addListener", "(" << port << ")");
 
@@ -485,12 +635,30 @@ namespace PLEXIL
         return;
       }
 
-      // Map the file descriptor to the listener
       int fd = l->socketFD;
+#ifdef PLEXIL_UDP_USE_EPOLL
+      if (m_epollFD >= 0) {
+        l->allocateBatch();
+        struct epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = l;
+        if (epoll_ctl(m_epollFD, EPOLL_CTL_ADD, fd, &ev)) {
+          warn("UdpEventLoop::addListener: epoll_ctl() failed for port " << port
+               << ": " << strerror(errno));
+          m_sem.post(); // complete, though not successful
+          return;
+        }
+      }
+      else
+#endif
+        {
+          // Add it to the poll vector.
+          struct pollfd pfd = {fd, POLLIN, 0};
+          m_pollfds.push_back(pfd);
+        }
+
+      // Map the file descriptor to the listener
       m_descriptors[fd] = l;
-      // and add it to the vector.
-      struct pollfd pfd = {fd, POLLIN, 0};
-      pollfds.push_back(pfd);
       // Mark it active
       l->active = true;
       // Notify foreground
@@ -501,7 +669,7 @@ namespace PLEXIL
     //! Remove the listener on the given port.
     //! @param port The port.
     //! @note Must only be called synchronously from the event loop.
-    void removeListener(in_port_t port, std::vector<struct pollfd> &pollfds)
+    void removeListener(in_port_t port)
     {
       debugMsg("UdpEventLoop:removeListener", "(" << port << ")");
       Listener *l;
@@ -516,20 +684,33 @@ namespace PLEXIL
       }
 
       int fd = l->socketFD;
-      std::vector<struct pollfd>::iterator it =
-        std::find_if(pollfds.begin(), pollfds.end(),
-                     [fd](struct pollfd &pfd) -> bool
-                     { return pfd.fd == fd; });
-
-      // See if there is a pending error event on the FD before removing it
-      if (it->revents & (POLLERR | POLLNVAL)) {
-        warn("UdpEventLoop::removeListener: ignoring error on FD " << fd);
+#ifdef PLEXIL_UDP_USE_EPOLL
+      if (m_epollFD >= 0) {
+        if (l->active && epoll_ctl(m_epollFD, EPOLL_CTL_DEL, fd, nullptr)) {
+          warn("UdpEventLoop::removeListener: epoll_ctl() failed for FD " << fd
+               << ": " << strerror(errno));
+        }
       }
+      else
+#endif
+        {
+          std::vector<struct pollfd>::iterator it =
+            std::find_if(m_pollfds.begin(), m_pollfds.end(),
+                         [fd](struct pollfd &pfd) -> bool
+                         { return pfd.fd == fd; });
+          if (it != m_pollfds.end()) {
+            // See if there is a pending error event on the FD before removing it
+            if (it->revents & (POLLERR | POLLNVAL)) {
+              warn("UdpEventLoop::removeListener: ignoring error on FD " << fd);
+            }
+
+            // Remove the file descriptor from the pollfd vector
+            m_pollfds.erase(it);
+          }
+        }
 
-      // Remove the file descriptor from the pollfd vector
-      pollfds.erase(it);
       // Remove the listener from the descriptor map
-      m_descriptors.erase(l->socketFD);
+      m_descriptors.erase(fd);
       // Mark the listener inactive
       l->active = false;
       debugMsg("UdpEventLoop:removeListener",
@@ -547,6 +728,7 @@ namespace PLEXIL
     {
       debugMsg("UdpEventLoop:handleFDReady", " FD " << fd << ", port " << listener->port);
       assertTrue_1(listener);
+      listener->addrSizeBuf = sizeof(struct sockaddr_storage);
       ssize_t nbytes = recvfrom(fd, listener->buffer.get(), listener->maxSize,
                                 0, // flags
                                 reinterpret_cast<struct sockaddr *>(listener->addrBuf.get()),
@@ -565,6 +747,44 @@ namespace PLEXIL
       debugMsg("UdpEventLoop:handleFDReady", " FD " << fd << " complete");
     }
 
+#ifdef PLEXIL_UDP_USE_EPOLL
+    //! Drain queued datagrams from the listener's socket with
+    //! recvmmsg(), and dispatch each to the listener function.
+    //! @param listener Pointer to the Listener for this port.
+    //! @note Must only be called synchronously from the event loop.
+    void handleBatchReady(Listener *listener)
+    {
+      debugMsg("UdpEventLoop:handleBatchReady",
+               " FD " << listener->socketFD << ", port " << listener->port);
+      for (size_t round = 0; round < RECV_MAX_ROUNDS; ++round) {
+        for (struct mmsghdr &hdr : listener->batchHdrs)
+          hdr.msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+        int n = recvmmsg(listener->socketFD, listener->batchHdrs.data(),
+                         RECV_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+        if (n < 0) {
+          if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            warn("UdpEventLoop: recvmmsg() failed on port " << listener->port
+                 << ": " << strerror(errno));
+          }
+          return;
+        }
+        debugMsg("UdpEventLoop:handleBatchReady",
+                 " port " << listener->port << " received " << n << " datagrams");
+        for (int i = 0; i < n; ++i) {
+          struct mmsghdr const &hdr = listener->batchHdrs[i];
+          if (!hdr.msg_len)
+            continue; // empty datagram, nothing to deliver
+          (listener->func)(listener->port, listener->batchIov[i].iov_base,
+                           (size_t) hdr.msg_len,
+                           reinterpret_cast<const struct sockaddr *>(&listener->batchAddrs[i]),
+                           hdr.msg_hdr.msg_namelen);
+        }
+        if ((size_t) n < RECV_BATCH_SIZE)
+          return; // socket drained
+      }
+    }
+#endif
+
   }; // class UdpEventLoopImpl
 
   std::unique_ptr<UdpEventLoop> makeUdpEventLoop()
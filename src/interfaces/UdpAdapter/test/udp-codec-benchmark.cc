@@ -0,0 +1,170 @@
+// Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//
+// Round trip check and throughput benchmark for UdpCodec
+//
+
+#include "UdpCodec.hh"
+
+#include "ArrayImpl.hh"
+#include "udp-utils.hh" // decode_int32_t() etc. for the reference comparison
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+using namespace PLEXIL;
+
+// A message with a mix of scalar and array fields,
+// similar to a typical telemetry packet
+static void defineMessage(UdpCodec &codec)
+{
+  codec.addField("int", 4, 1);
+  codec.addField("int", 2, 1);
+  codec.addField("float", 4, 1);
+  codec.addField("bool", 1, 1);
+  codec.addField("string", 16, 1);
+  codec.addField("int-array", 4, 32);
+  codec.addField("float-array", 4, 64);
+  codec.addField("bool-array", 2, 8);
+}
+
+static std::vector<Value> makeArgs()
+{
+  std::vector<Value> args;
+  args.push_back(Value((Integer) -1860809244));
+  args.push_back(Value((Integer) -1234));
+  args.push_back(Value(3.5));
+  args.push_back(Value(true));
+  args.push_back(Value(String("telemetry")));
+  std::vector<Integer> ints(32);
+  for (size_t i = 0; i < ints.size(); ++i)
+    ints[i] = (Integer) (i * 100003) - 1000000;
+  args.push_back(Value(IntegerArray(std::move(ints))));
+  std::vector<Real> reals(64);
+  for (size_t i = 0; i < reals.size(); ++i)
+    reals[i] = 0.25 * i - 4;
+  args.push_back(Value(RealArray(std::move(reals))));
+  BooleanArray bools(8);
+  for (size_t i = 0; i < 8; ++i)
+    bools.setElement(i, (i % 3) == 0);
+  args.push_back(Value(std::move(bools)));
+  return args;
+}
+
+static bool testRoundTrip()
+{
+  UdpCodec codec;
+  defineMessage(codec);
+  size_t const expectedSize = 4 + 2 + 4 + 1 + 16 + 32 * 4 + 64 * 4 + 8 * 2;
+  if (codec.size() != expectedSize) {
+    std::cerr << "Codec size is " << codec.size() << ", expected " << expectedSize << std::endl;
+    return false;
+  }
+
+  std::vector<Value> args = makeArgs();
+  std::vector<unsigned char> buffer(codec.size(), 0);
+  if (!codec.encode(args, 0, buffer.data())) {
+    std::cerr << "Encoding failed" << std::endl;
+    return false;
+  }
+
+  // Compare against the original byte-at-a-time encoders
+  if (decode_int32_t(buffer.data(), 0) != -1860809244
+      || decode_short_int(buffer.data(), 4) != -1234
+      || decode_float(buffer.data(), 6) != 3.5f
+      || buffer[10] != 1
+      || decode_string(buffer.data(), 11, 16) != "telemetry") {
+    std::cerr << "Encoded scalars differ from udp-utils encoding" << std::endl;
+    return false;
+  }
+
+  std::vector<Value> result;
+  if (!codec.decode(buffer.data(), result)) {
+    std::cerr << "Decoding failed" << std::endl;
+    return false;
+  }
+  if (result != args) {
+    std::cerr << "Round trip failed" << std::endl;
+    for (size_t i = 0; i < result.size(); ++i)
+      std::cerr << " expected " << args[i] << ", got " << result[i] << std::endl;
+    return false;
+  }
+
+  // Out of range values must be rejected
+  args[1] = Value((Integer) 40000);
+  if (codec.encode(args, 0, buffer.data())) {
+    std::cerr << "Out of range short integer was not rejected" << std::endl;
+    return false;
+  }
+  args[1] = Value((Integer) -1234);
+
+  // Wrong number of arguments must be rejected
+  args.pop_back();
+  if (codec.encode(args, 0, buffer.data())) {
+    std::cerr << "Short argument list was not rejected" << std::endl;
+    return false;
+  }
+
+  std::cout << "Round trip test passed" << std::endl;
+  return true;
+}
+
+static void benchmark()
+{
+  UdpCodec codec;
+  defineMessage(codec);
+  std::vector<Value> args = makeArgs();
+  std::vector<unsigned char> buffer(codec.size(), 0);
+  std::vector<Value> result;
+
+  size_t const iterations = 200000;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i)
+    codec.encode(args, 0, buffer.data());
+  std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i)
+    codec.decode(buffer.data(), result);
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+  double encodeSecs = std::chrono::duration<double>(mid - start).count();
+  double decodeSecs = std::chrono::duration<double>(end - mid).count();
+  std::cout << codec.size() << " byte message, " << iterations << " iterations\n"
+            << " encode: " << iterations / encodeSecs << " messages/sec\n"
+            << " decode: " << iterations / decodeSecs << " messages/sec"
+            << std::endl;
+}
+
+int main()
+{
+  if (!testRoundTrip())
+    return 1;
+  benchmark();
+  return 0;
+}
+
+// EOF
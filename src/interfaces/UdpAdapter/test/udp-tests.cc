@@ -27,6 +27,7 @@
 #include "udp-utils.hh"
 #include "UdpEventLoop.hh"
 
+#include <atomic>
 #include <cinttypes>  // fixed width integer formats
 #include <cstring>
 #include <iostream>
@@ -247,6 +248,68 @@ static bool testEventLoop()
   return true;
 }
 
+// Burst of datagrams on several ports at once
+static constexpr const size_t burst_ports = 4;
+static constexpr const size_t burst_count = 200;
+static std::atomic<size_t> burst_received[burst_ports];
+
+static bool testEventLoopBurst()
+{
+  std::cout << "\nTest UdpEventLoop with bursts on " << burst_ports << " ports" << std::endl;
+  std::unique_ptr<UdpEventLoop> loop = makeUdpEventLoop();
+  if (!loop->start()) {
+    std::cout << "Loop start failed. Ending test." << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i < burst_ports; ++i) {
+    burst_received[i] = 0;
+    if (!loop->openListener(remote_port + 1 + i, BUFFER_SIZE,
+                            [i](in_port_t, const void *, size_t,
+                                const struct sockaddr *, socklen_t)
+                            { ++burst_received[i]; })) {
+      std::cout << "openListener failed. Ending test." << std::endl;
+      loop->stop();
+      return false;
+    }
+  }
+
+  // Send to all the ports from one socket, without waiting
+  int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  struct sockaddr_in dest = {};
+  dest.sin_family = AF_INET;
+  dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  for (size_t n = 0; n < burst_count; ++n) {
+    for (size_t i = 0; i < burst_ports; ++i) {
+      dest.sin_port = htons(remote_port + 1 + i);
+      sendto(sock, bytes1, BUFFER_SIZE, 0,
+             (const struct sockaddr *) &dest, sizeof(dest));
+    }
+  }
+  close(sock);
+
+  // Give the listeners time to drain their sockets
+  bool result = true;
+  for (int tries = 0; tries < 100; ++tries) {
+    result = true;
+    for (size_t i = 0; i < burst_ports; ++i)
+      if (burst_received[i] < burst_count)
+        result = false;
+    if (result)
+      break;
+    usleep(10000);
+  }
+
+  for (size_t i = 0; i < burst_ports; ++i) {
+    loop->closeListener(remote_port + 1 + i);
+    std::cout << "Port " << remote_port + 1 + i << " received "
+              << burst_received[i] << " of " << burst_count << std::endl;
+  }
+  loop->stop();
+  if (!result)
+    std::cerr << "Burst test lost datagrams" << std::endl;
+  return result;
+}
+
 int main()
 {
   testEncodeDecode();
@@ -258,6 +321,9 @@ int main()
 
   testEventLoop();
 
+  if (!testEventLoopBurst())
+    return 1;
+
   return 0;
 }
 
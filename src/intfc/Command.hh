@@ -32,6 +32,9 @@
 namespace PLEXIL
 {
 
+  // Forward reference
+  struct DispatchCache;
+
   //! \class Command
   //! \brief Abstract base class representing the Command API to
   //!        external interfaces.
@@ -62,6 +65,14 @@ namespace PLEXIL
     //! \note For the benefit of TestExec.
     virtual bool isReturnExpected() const = 0;
 
+    //! \brief Get the storage in which the Dispatcher may cache this
+    //!        command's handler.
+    //! \return Pointer to the cache.  May be null.
+    virtual DispatchCache *getDispatchCache()
+    {
+      return nullptr;
+    }
+
   };
 
   //
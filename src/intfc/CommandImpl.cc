@@ -207,6 +207,8 @@ namespace PLEXIL
       m_abortComplete("abortComplete"),
       m_command(),
       m_resourceValueList(),
+      m_resourceFootprint(),
+      m_dispatchCache(),
       m_next(nullptr),
       m_nameExpr(nullptr),
       m_dest(nullptr),
@@ -271,6 +273,11 @@ namespace PLEXIL
     return (bool) m_dest;
   }
 
+  DispatchCache *CommandImpl::getDispatchCache()
+  {
+    return &m_dispatchCache;
+  }
+
   CommandHandleValue CommandImpl:: getCommandHandle() const
   {
     return m_commandHandle;
@@ -282,6 +289,11 @@ namespace PLEXIL
     return m_resourceValueList;
   }
 
+  ResourceFootprint &CommandImpl::getResourceFootprint()
+  {
+    return m_resourceFootprint;
+  }
+
   void CommandImpl::setDestination(Expression *dest, bool isGarbage)
   {
     assertTrue_1(!m_checkedConstant);
@@ -367,6 +379,7 @@ namespace PLEXIL
     if (m_nameExpr->getValuePointer(name)) {
       m_command.setName(*name);
       m_commandNameFixed = true;
+      m_dispatchCache.generation = 0; // name may have changed
     }
     else {
       // Name is unknown - report plan error
@@ -414,6 +427,7 @@ namespace PLEXIL
         }
       }
     }
+    m_resourceFootprint.table = 0; // must be recompiled
     m_resourcesFixed = true;
   }
 
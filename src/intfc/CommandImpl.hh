@@ -29,6 +29,8 @@
 #include "Command.hh"
 #include "CommandFunction.hh"
 #include "CommandHandleVariable.hh"
+#include "Dispatcher.hh" // DispatchCache
+#include "PlanArena.hh"
 #include "SimpleBooleanVariable.hh"
 
 #include <memory> // std::unique_ptr
@@ -62,6 +64,40 @@ namespace PLEXIL
 
   using ResourceValueList = std::vector<ResourceValue>;
 
+  //! \struct ResourceUsage
+  //! \brief One resource requirement of a command, after expansion
+  //!        of the resource hierarchy.
+  struct ResourceUsage final
+  {
+    //! \brief The resource's index in the arbiter's resource table.
+    size_t index;
+
+    //! \brief The amount of the resource required.
+    double weight;
+
+    //! \brief Whether the resource is returned when the command has
+    //!        completed.
+    bool release;
+  };
+
+  //! \struct ResourceFootprint
+  //! \brief The complete resource requirements of a command, as
+  //!        compiled by the resource arbiter from the command's
+  //!        ResourceValueList.  Cached in the command until its
+  //!        resource values change.
+  struct ResourceFootprint final
+  {
+    //! \brief The resources required, sorted by index.
+    std::vector<ResourceUsage> usage;
+
+    //! \brief The priority of the command.
+    int32_t priority = 0;
+
+    //! \brief Identifies the resource table to which the indices
+    //!        refer.  Zero if the footprint has not been compiled.
+    uint32_t table = 0;
+  };
+
   //! \class ResourceSpec
   //! \brief Internal representation for a resource specification.
   //! \note Used only in CommandImpl class, but exposed to parser
@@ -157,7 +193,9 @@ namespace PLEXIL
 
   //! \class CommandImpl
   //! \brief The implementation class for PLEXIL commands.
-  class CommandImpl final : public Command
+  class CommandImpl final :
+    public Command,
+    public ArenaAllocated
   {
     friend class CommandHandleVariable;
 
@@ -193,10 +231,22 @@ namespace PLEXIL
     //! \note For the benefit of TestExec.
     virtual bool isReturnExpected() const;
 
+    //! \brief Get the storage in which the Dispatcher may cache this
+    //!        command's handler.
+    //! \return Pointer to the cache.
+    //! \note Invalidated whenever the command name is fixed.
+    virtual DispatchCache *getDispatchCache();
+
     //! \brief Get the list of fixed resource values for the command.
     //! \return Const reference to the resource list.
     ResourceValueList const &getResourceValues() const;
 
+    //! \brief Get the compiled resource footprint for the command.
+    //! \return Reference to the footprint.
+    //! \note For use by the resource arbiter only.  Invalidated
+    //!       whenever the resource values are fixed.
+    ResourceFootprint &getResourceFootprint();
+
     //! \brief Get the current value of the command handle (status)
     //!        variable.
     //! \return The value.
@@ -375,6 +425,13 @@ namespace PLEXIL
     //!        m_resourcesFixed is true.
     ResourceValueList m_resourceValueList;
 
+    //! \brief The resource requirements compiled by the resource
+    //!        arbiter from m_resourceValueList.
+    ResourceFootprint m_resourceFootprint;
+
+    //! \brief The Dispatcher's cached handler for this command.
+    DispatchCache m_dispatchCache;
+
     //! \brief Pointer to the next CommandImpl in a LinkedQueue.
     CommandImpl *m_next;
 
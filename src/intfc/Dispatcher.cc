@@ -30,4 +30,11 @@ namespace PLEXIL
 
   Dispatcher *g_dispatcher = nullptr;
 
+  void Dispatcher::setLookupThresholds(const State& state,
+                                       std::vector<Real> const & /* highs */,
+                                       Real hi, Real lo)
+  {
+    setThresholds(state, hi, lo);
+  }
+
 }
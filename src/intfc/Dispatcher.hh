@@ -32,6 +32,8 @@
 
 #include "ValueType.hh"
 
+#include <vector>
+
 namespace PLEXIL
 {
 
@@ -41,6 +43,20 @@ namespace PLEXIL
   class State;
   class Update;
 
+  //! \struct DispatchCache
+  //! \brief Storage in which a Dispatcher may remember the handler it
+  //!        resolved for a Command or a cached state.
+  //! \note The contents are private to the Dispatcher.
+  struct DispatchCache final
+  {
+    //! \brief The handler, as the Dispatcher chooses to represent it.
+    void *handler = nullptr;
+
+    //! \brief Identifies the Dispatcher's handler registrations at
+    //!        the time the handler was cached.  Zero if empty.
+    uint32_t generation = 0;
+  };
+
   //! \class Dispatcher
   //! \brief Stateless abstract base class for requests/commands from
   //!        the PLEXIL Exec to the outside world.
@@ -70,6 +86,18 @@ namespace PLEXIL
     virtual void setThresholds(const State& state, Real hi, Real lo) = 0;
     virtual void setThresholds(const State& state, Integer hi, Integer lo) = 0;
 
+    //! \brief Advise the interface of the upper threshold of each
+    //!        change lookup on this state.
+    //! \param state The state.
+    //! \param highs The upper threshold of each lookup, in no particular order.
+    //! \param hi The lowest of the upper thresholds.
+    //! \param lo The highest of the lower thresholds.
+    //! \note Lets the 'time' state schedule a wakeup for every lookup.
+    //!       The default method calls setThresholds(state, hi, lo).
+    virtual void setLookupThresholds(const State& state,
+                                     std::vector<Real> const &highs,
+                                     Real hi, Real lo);
+
     //! \brief Tell the interface that thresholds are no longer in effect
     //!        for this state.
     //! \param state The state.
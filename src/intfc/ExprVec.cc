@@ -28,6 +28,7 @@
 
 #include "Error.hh"
 #include "Expression.hh"
+#include "PlanArena.hh"
 
 namespace PLEXIL
 {
@@ -173,8 +174,8 @@ namespace PLEXIL
     GeneralExprVec(size_t n)
       : ExprVec(),
         m_size(n),
-        exprs(new Expression*[n]()),
-        garbage(new bool[n]())
+        exprs(PlanArena::allocateArray<Expression *>(n)),
+        garbage(PlanArena::allocateArray<bool>(n))
     {
     }
 
@@ -184,8 +185,8 @@ namespace PLEXIL
       for (size_t i = 0; i < m_size; ++i)
         if (exprs[i] && garbage[i])
           delete exprs[i];
-      delete[] garbage;
-      delete[] exprs;
+      PlanArena::deallocate(garbage);
+      PlanArena::deallocate(exprs);
     }
 
     //! \brief Get the size of this vector.
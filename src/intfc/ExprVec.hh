@@ -40,7 +40,7 @@ namespace PLEXIL
   //! \brief Pure virtual base class for a family of expression vector classes,
   //!        whose representations vary by size.
   //! \ingroup External-Interface
-  class ExprVec
+  class ExprVec : public ArenaAllocated
   {
   public:
 
@@ -35,7 +35,8 @@
 
 namespace PLEXIL
 {
-  // Forward reference
+  // Forward references
+  struct DispatchCache;
   class Value;
 
   //! \class LookupReceiver
@@ -79,6 +80,14 @@ namespace PLEXIL
     virtual void update(Real const ary[], size_t size) = 0;
     virtual void update(String const ary[], size_t size) = 0;
     ///@}
+
+    //! \brief Get the storage in which the Dispatcher may cache the
+    //!        lookup handler for this receiver's state.
+    //! \return Pointer to the cache.  May be null.
+    virtual DispatchCache *getDispatchCache()
+    {
+      return nullptr;
+    }
   };
 
 }
@@ -28,6 +28,8 @@
 
 #include "State.hh"
 
+#include <utility> // std::move()
+
 namespace PLEXIL
 {
 
@@ -35,6 +37,7 @@ namespace PLEXIL
     : next(nullptr),
       command(nullptr),
       value(),
+      batch(),
       type(Q_UNINITED)
   {
   }
@@ -46,6 +49,7 @@ namespace PLEXIL
       delete state;
     state = nullptr;
     value.setUnknown();
+    batch.clear();
     type = Q_UNINITED;
   }
 
@@ -65,18 +69,44 @@ namespace PLEXIL
 
   void QueueEntry::initForLookup(State &&stat, Value const &val)
   {
-    state = new State(stat); // have to copy 
+    state = new State(std::move(stat));
     value = val;
     type = Q_LOOKUP;
   }
 
   void QueueEntry::initForLookup(State &&stat, Value &&val)
   {
-    state = new State(stat); // have to copy 
+    state = new State(std::move(stat));
     value = std::move(val);
     type = Q_LOOKUP;
   }
 
+  void QueueEntry::initForLookup(StateId id, Value const &val)
+  {
+    stateId = id;
+    value = val;
+    type = Q_LOOKUP_ID;
+  }
+
+  void QueueEntry::initForLookup(StateId id, Value &&val)
+  {
+    stateId = id;
+    value = std::move(val);
+    type = Q_LOOKUP_ID;
+  }
+
+  void QueueEntry::initForLookupBatch(LookupValue const *values, size_t n)
+  {
+    batch.assign(values, values + n);
+    type = Q_LOOKUP_BATCH;
+  }
+
+  void QueueEntry::initForLookupBatch(LookupBatch &&values)
+  {
+    batch = std::move(values);
+    type = Q_LOOKUP_BATCH;
+  }
+
   void QueueEntry::initForCommandAck(Command *cmd, CommandHandleValue val)
   {
     command = cmd;
@@ -26,7 +26,9 @@
 #ifndef PLEXIL_QUEUE_ENTRY_HH
 #define PLEXIL_QUEUE_ENTRY_HH
 
-#include "Value.hh"
+#include "State.hh" // StateId
+
+#include <atomic>
 
 namespace PLEXIL
 {
@@ -34,7 +36,6 @@ namespace PLEXIL
   class Command;
   struct Message;
   class NodeImpl;
-  class State;
   class Update;
 
   //! \brief Enumeration representing the purpose of an item in the queue.
@@ -42,6 +43,8 @@ namespace PLEXIL
   enum QueueEntryType {
     Q_UNINITED = 0,         //!< Value to mark an uninitialized QueueEntryType value.
     Q_LOOKUP,               //!< A Lookup return value.
+    Q_LOOKUP_ID,            //!< A Lookup return value for a StateId.
+    Q_LOOKUP_BATCH,         //!< A batch of Lookup return values.
     Q_COMMAND_ACK,          //!< A command handle (status) value.
     Q_COMMAND_RETURN,       //!< A command return value.
     Q_COMMAND_ABORT,        //!< A command abort acknowledgement value.
@@ -62,12 +65,15 @@ namespace PLEXIL
   //! \ingroup External-Interface
   struct QueueEntry final
   {
-    QueueEntry *next;           //!< Pointer to the next item in the queue.
+    //! \brief Pointer to the next item in the queue.
+    //! \note Atomic so that lock-free InputQueue implementations may use it.
+    std::atomic<QueueEntry *> next;
     union {
       Command *command;         //!< Only valid if type is one of Q_COMMAND_ACK, Q_COMMAND_RETURN, Q_COMMAND_ABORT.
       Message *message;         //!< Only valid if type is one of Q_RECEIVE_MSG, Q_ACCEPT_MSG.
       NodeImpl *plan;           //!< Only valid if type is Q_ADD_PLAN.
       State *state;             //!< Only valid if type is Q_LOOKUP.
+      StateId stateId;          //!< Only valid if type is Q_LOOKUP_ID.
       Update *update;           //!< Only valid if type is Q_UPDATE_ACK.
       unsigned int sequence;    //!< Only valid if type is Q_MARK.
     };
@@ -75,22 +81,21 @@ namespace PLEXIL
     //! \brief The value associated with the command, update, state, or message handle.
     //!        Not valid if type is Q_ADD_PLAN, Q_MARK, or Q_MSG_QUEUE_EMPTY.
     Value value;
+
+    //! \brief The lookup returns.  Only valid if type is Q_LOOKUP_BATCH.
+    //! \note Not part of the union, so that recycled entries keep its storage.
+    LookupBatch batch;
+
     QueueEntryType type;        //!< The type of this entry.
 
     //! \brief Default constructor.
     QueueEntry();
 
-    //! \brief Copy constructor.
-    QueueEntry(QueueEntry const &) = default;
-
-    //! \brief Move constructor.
-    QueueEntry(QueueEntry &&) = default;
-
-    //! \brief Copy assignment operator.
-    QueueEntry &operator=(QueueEntry const &) = default;
-
-    //! \brief Move assignment operator.
-    QueueEntry &operator=(QueueEntry &&) = default;
+    // Entries are owned by their InputQueue, and are never copied
+    QueueEntry(QueueEntry const &) = delete;
+    QueueEntry(QueueEntry &&) = delete;
+    QueueEntry &operator=(QueueEntry const &) = delete;
+    QueueEntry &operator=(QueueEntry &&) = delete;
 
     //! \brief Destructor.
     ~QueueEntry() = default;
@@ -100,7 +105,8 @@ namespace PLEXIL
     //
 
     //! \brief Reset the entry to a blank state.
-    //!        Type is set to Q_UNINITED, value to unknown, the union to NULL.
+    //!        Type is set to Q_UNINITED, value to unknown, the union to NULL,
+    //!        the batch to empty.
     void reset();
 
     ///@{
@@ -113,6 +119,23 @@ namespace PLEXIL
     void initForLookup(State &&st, Value &&val);
     ///@}
 
+    ///@{
+    //! \brief Prepare the entry for a lookup value return.
+    //! \param id The StateId of the state whose value is being returned.
+    //! \param val The return value.
+    void initForLookup(StateId id, Value const &val);
+    void initForLookup(StateId id, Value &&val);
+    ///@}
+
+    ///@{
+    //! \brief Prepare the entry for a batch of lookup value returns.
+    //! \param values Pointer to the first of the lookup returns.
+    //! \param n The number of lookup returns.
+    void initForLookupBatch(LookupValue const *values, size_t n);
+    //! \param values The lookup returns.
+    void initForLookupBatch(LookupBatch &&values);
+    ///@}
+
     //! \brief Prepare the entry for a command handle (acknowledgement) return.
     //! \param st The Command.
     //! \param val The return value.
@@ -24,16 +24,19 @@
 * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+
 #include "ResourceArbiterInterface.hh"
 
 #include "CommandImpl.hh"
 #include "Debug.hh"
 #include "LinkedQueue.hh"
 
-#include <algorithm> // std::stable_sort()
+#include <algorithm> // std::is_sorted(), std::sort(), std::stable_sort()
+#include <atomic>
 #include <fstream>
-#include <map>
-#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <cctype>
 #include <cstdlib> // strtod()
@@ -42,169 +45,66 @@
 namespace PLEXIL
 {
 
-  //! \struct ChildResourceNode
-  //! \brief Represents both a child resource in the resource
-  //!        hierarchy, and a resource request by a command.
-  //! \see ResourceNode
-  struct ChildResourceNode final
+  //! \struct ResourceWeight
+  //! \brief A child resource in the resource hierarchy, and its weight.
+  struct ResourceWeight final
   {
-
-    //! \brief Constructor.
-    //! \param _weight The weight of this resource.
-    //! \param _name The name of this resource.
-    //! \param _release Whether this resource is released when the command using it completes.
-    ChildResourceNode(const double _weight,
-                      const std::string &_name,
-                      const bool _release = true)
-      : name(_name),
-        weight(_weight),
-        release(_release)
-    {
-    }
-
-    //
-    // The constructors and assignment operators below should only be
-    // used by container templates.
-    //
-
-    //! \brief Default constructor.
-    ChildResourceNode()
-      : name(),
-        weight(0.0),
-        release(false)
-    {
-    }
-
-    //! \brief Copy constructor.
-    ChildResourceNode(ChildResourceNode const &) = default;
-
-    //! \brief Move constructor.
-    ChildResourceNode(ChildResourceNode &&) = default;
-
-    //! \brief Copy assignment operator.
-    ChildResourceNode &operator=(ChildResourceNode const &) = default;
-
-    //! \brief Move assignment operator.
-    ChildResourceNode &operator=(ChildResourceNode &&) = default;
-
-    //! \brief Destructor.
-    ~ChildResourceNode() = default;
-
-    std::string name;  //!< The name of this resource.
-    double weight;     //!< The weight of this resource.
-    bool release;      //!< Whether the resource is released when a command completes.
+    size_t index;  //!< The index of the child resource.
+    double weight; //!< The weight of the child resource.
   };
 
-  //! \brief Compare two ChildResourceNode instances by their names.
-  //! \param x Const reference to a ChildResourceNode.
-  //! \param y Const reference to another ChildResourceNode.
-  //! \return true if x.name < y.name, false otherwise.
-  inline bool operator<(ChildResourceNode const &x, ChildResourceNode const &y)
-  {
-    return x.name < y.name;
-  }
-
-  //! \typedef ResourceSet
-  //! \brief A sorted set of ChildResourceNodes.
-  //! \see ResourceMap
-  using ResourceSet = std::set<ChildResourceNode>;
-
-  //! \typedef ResourceMap
-  //! \brief A map, keyed by command, to a set of resources required by that command.
-  //! \see ResourceSet
-  using ResourceMap = std::map<CommandImpl *, ResourceSet>;
-
-  //! \typedef ResourceMapEntry
-  //! \brief The type of an entry in a ResourceMap.
-  //! \see ResourceMap
-  using ResourceMapEntry = ResourceMap::value_type;
-
-  //! \struct ResourceNode
+  //! \struct ResourceEntry
   //! \brief Represents a resource, optionally with children.
-  //!        Its name is stored in the ResourceHierarchyMap.
-  //! \see ChildResourceNode
-  struct ResourceNode final
+  struct ResourceEntry final
   {
-    ResourceNode(const double _maxConsumableValue)
-      : children(),
-        maxConsumableValue(_maxConsumableValue)
-    {
-    }
-
-    //
-    // The constructors and assignment operators below should only be
-    // used by container templates.
-    //
-
-    //! \brief Default constructor.
-    ResourceNode()
-      : children(),
-        maxConsumableValue(0.0)
+    //! \brief Constructor.
+    //! \param _name The name of the resource.
+    ResourceEntry(std::string const &_name)
+      : name(_name),
+        children(),
+        descendants(),
+        maxConsumableValue(1.0),
+        defined(false)
     {
     }
 
     //! \brief Copy constructor.
-    ResourceNode(ResourceNode const &) = default;
+    ResourceEntry(ResourceEntry const &) = default;
 
     //! \brief Move constructor.
-    ResourceNode(ResourceNode &&) = default;
+    ResourceEntry(ResourceEntry &&) = default;
 
     //! \brief Copy assignment operator.
-    ResourceNode &operator=(ResourceNode const &) = default;
+    ResourceEntry &operator=(ResourceEntry const &) = default;
 
     //! \brief Move assignment operator.
-    ResourceNode &operator=(ResourceNode &&) = default;
+    ResourceEntry &operator=(ResourceEntry &&) = default;
 
     //! \brief Destructor.
-    ~ResourceNode() = default;
+    ~ResourceEntry() = default;
 
-    std::vector<ChildResourceNode> children; //!< The children of this resource.
+    std::string name;                        //!< The name of this resource.
+    std::vector<ResourceWeight> children;    //!< The immediate children of this resource.
+    std::vector<ResourceWeight> descendants; //!< All descendants, depth first.
     double maxConsumableValue;               //!< The available amount of this resource.
+    bool defined;                            //!< True if defined in the hierarchy file.
   };
 
-  //! \typedef ResourceHierarchyMap
-  //! \brief A map, keyed by resource name, of ResourceNode instances.
-  //! \see Resource Node
-  using ResourceHierarchyMap = std::map<std::string, ResourceNode>;
-
   //! \struct CommandPriorityEntry
   //! \brief Associates a command to be executed, its priority, and
   //!        the resources it requires.
   struct CommandPriorityEntry final
   {
-
-    //! \brief Constructor.
-    //! \param prio The command priority.
-    //! \param cmd Pointer to the actual command instance.
-    CommandPriorityEntry(int32_t prio, CommandImpl *cmd)
-      : resources(),
-        command(cmd),
-        priority(prio)
-    {
-    }
-
-    //! \brief Copy constructor.
-    CommandPriorityEntry(CommandPriorityEntry const &) = default;
-
-    //! \brief Move constructor.
-    CommandPriorityEntry(CommandPriorityEntry &&) = default;
-
-    //! \brief Copy assignment operator.
-    CommandPriorityEntry &operator=(CommandPriorityEntry const &) = default;
-
-    //! \brief Move assignment operator.
-    CommandPriorityEntry &operator=(CommandPriorityEntry &&) = default;
-
-    ResourceSet resources;  //!< The resources requested by this command.
-    CommandImpl *command;   //!< Pointer to the command instance.
-    int32_t priority;       //!< The priority of the command.
+    CommandImpl *command;               //!< Pointer to the command instance.
+    ResourceFootprint const *footprint; //!< The resources requested by this command.
+    int32_t priority;                   //!< The priority of the command.
   };
 
   //! \brief Overloaded less-than operator for CommandPriorityEntry instances.
   //! \param x Const reference to a CommandPriorityEntry instance.
   //! \param y Const reference to another CommandPriorityEntry instance.
   //! \return true if x.priority < y.priority, false otherwise.
-  bool operator<(CommandPriorityEntry const &x, CommandPriorityEntry const &y)
+  inline bool operator<(CommandPriorityEntry const &x, CommandPriorityEntry const &y)
   {
     return x.priority < y.priority;
   }
@@ -213,172 +113,60 @@ namespace PLEXIL
   //! \brief A container of CommandPriorityEntry instances.
   using CommandPriorityList = std::vector<CommandPriorityEntry>;
 
-  //! \struct ResourceEstimate
-  //! \brief Represents the renewable and consumable usage of a
-  //         resource.  Used internally by
-  //         ResourceArbiterImpl::optimalResourceAllocation().
-  struct ResourceEstimate final
+  //! \brief Order ResourceUsage instances by resource index.
+  inline bool operator<(ResourceUsage const &x, ResourceUsage const &y)
   {
-    //! \brief Constructor.
-    //! \param initial The available amount of a resource at the start
-    //!                of arbitration.
-    ResourceEstimate(double initial)
-      : renewable(initial),
-        consumable(initial)
-    {
-    }
-
-    //! \brief Default constructor.
-    ResourceEstimate()
-      : renewable(0.0),
-        consumable(0.0)
-    {
-    }
-
-    //! \brief Copy constuctor.
-    ResourceEstimate(ResourceEstimate const &) = default;
+    return x.index < y.index;
+  }
 
-    //! \brief Move constructor.
-    ResourceEstimate(ResourceEstimate &&) = default;
+  //! \brief Source of unique resource table identifiers.
+  static std::atomic<uint32_t> s_nextTableId(1);
 
-    //! \brief Copy assignment operator.
-    ResourceEstimate &operator=(ResourceEstimate const &) = default;
-
-    //! \brief Move assignment operator.
-    ResourceEstimate &operator=(ResourceEstimate &&) = default;
+  class ResourceArbiterImpl : public ResourceArbiterInterface
+  {
+  private:
 
-    //! \brief Destructor.
-    ~ResourceEstimate() = default;
-  
-    double renewable;
-    double consumable;
-  };
+    //! \brief Every resource named in the hierarchy or by a command,
+    //!        indexed by the resource's index.
+    std::vector<ResourceEntry> m_resources;
 
-  //! \typedef EstimateMap
-  //! \brief A map, keyed by resource name, of estimated resource usage.
-  using EstimateMap = std::map<std::string, ResourceEstimate>;
-
-  //! \brief Recursively collect the descendants of a resource and their weights.
-  //! \param[in] The map of all known resources.
-  //! \param[in] resName The name of a resource.
-  //! \param[in] release Whether the resource will be released upon command completion.
-  //! \param[out] flattenedRes The resulting list of the resource and its descendants.
-  static void determineChildResources(ResourceHierarchyMap const &resourceHierarchy,
-                                      std::string const &resName,
-                                      bool release,
-                                      std::vector<ChildResourceNode> &flattenedRes)
-  {
-    debugMsg("ResourceArbiter:determineChildResources", ' ' << resName);
-    ResourceHierarchyMap::const_iterator it = resourceHierarchy.find(resName);
-    if (it == resourceHierarchy.end())
-      return;
-
-    const std::vector<ChildResourceNode> &children = it->second.children;
-    if (children.empty())
-      return;
-    
-    // Recurse over children
-    for (ChildResourceNode const &child : children) {
-      flattenedRes.emplace_back(ChildResourceNode(child.weight, child.name, release));
-      determineChildResources(resourceHierarchy, child.name, release, flattenedRes);
-    }
-  }
+    //! \brief Map from resource name to index in m_resources.
+    std::unordered_map<std::string, size_t> m_resourceIndex;
 
-  //! \brief ???
-  //! \param[in] resourceHierarchy The map of all known resources.
-  //! \param[in] request Const reference to a ResourceValue
-  //!                    representing one resource requirement from a
-  //!                    command.
-  //! \param[in,out] resourcesNeeded The complete list of resources
-  //!                                needed by the command.
-  static void determineAllChildResources(ResourceHierarchyMap const &resourceHierarchy,
-                                         ResourceValue const &request,
-                                         ResourceSet &resourcesNeeded)
-  {
-    debugMsg("ResourceArbiter:determineAllChildResources", ' ' << request.name);
-    std::string const &requestName = request.name;
-    bool release = request.releaseAtTermination;
-
-    // Collect the descendants of the requested resource
-    std::vector<ChildResourceNode> flattenedRes;
-    flattenedRes.emplace_back(ChildResourceNode(request.upperBound, requestName, release));
-    determineChildResources(resourceHierarchy, requestName, release, flattenedRes);
-
-    // loop through each hierarchy element in the flattened structure
-    for (ChildResourceNode const &fres : flattenedRes) {
-      if (resourcesNeeded.find(fres) == resourcesNeeded.end())
-        resourcesNeeded.insert(fres);
-      else if (fres.name == requestName)
-        // If current is explicitly specified in 
-        // the command then the value can be overwritten. The
-        // child resource scales will not be overwritten however.
-        // In fact this check will be valid only for the first element
-        // of the flattened vector. This means that if a resource value
-        // has to be overwritten it has to be explicitly scpecified in the 
-        // plan
-        resourcesNeeded.insert(fres);
-    }
-  }
+    //! \brief The amount of each resource currently allocated,
+    //!        indexed by resource index.
+    std::vector<double> m_allocated;
 
-  //! \brief Partition a list of commands into commands with and
-  //!        without resource requirements, determine the total
-  //!        requirements of each command, and sort the commands with
-  //!        resource requirements by their priority.
-  //! \param[in] resourceHierarchy The map of all known resources.
-  //! \param[in] cmds A list of commands to be partitioned.  The list
-  //!                 is consumed by this function and left empty upon
-  //!                 return.
-  //! \param[out] acceptCmds The list of commands which do not have resource requests.
-  //! \param[out] sortedCommands Commands with resource requests, sorted by priority.
-  static void partitionCommands(ResourceHierarchyMap const &resourceHierarchy,
-                                LinkedQueue<CommandImpl> &cmds,
-                                LinkedQueue<CommandImpl> &acceptCmds,
-                                CommandPriorityList &sortedCommands)
-  {
-    while (!cmds.empty()) {
-      CommandImpl *cmd = cmds.front();
-      cmds.pop();
-      const ResourceValueList &resList = cmd->getResourceValues();
-      if (resList.empty()) {
-        debugMsg("ResourceArbiter:partitionCommands",
-                 " accepting command \"" << cmd->getName() << "\" with no resource requests");
-        acceptCmds.push(cmd);
-      }
-      else {
-        // Add the command to the list of commands in contention
-        sortedCommands.emplace_back(CommandPriorityEntry(resList.front().priority, cmd));
-
-        // Determine the total resource requirements of the command
-        ResourceSet &resources = sortedCommands.back().resources; // initially empty
-        for (ResourceValue const &request : resList)
-          determineAllChildResources(resourceHierarchy, request, resources);
-      }
-    }
+    //! \brief Renewable usage estimates during arbitration.
+    std::vector<double> m_renewable;
 
-    // Sort the list of commands with resource requirements by priority
-    if (sortedCommands.size() > 1)
-      std::stable_sort(sortedCommands.begin(),
-                       sortedCommands.end());
-  }
+    //! \brief Consumable usage estimates during arbitration.
+    std::vector<double> m_consumable;
 
+    //! \brief Used to eliminate duplicates when compiling a footprint.
+    std::vector<uint32_t> m_seen;
 
-  class ResourceArbiterImpl : public ResourceArbiterInterface
-  {
-  private:
+    //! \brief All currently executing commands with resource requirements.
+    std::unordered_set<CommandImpl *> m_activeCommands;
 
-    //! \brief The map of all known resources and their initial values.
-    ResourceHierarchyMap m_resourceHierarchy;
+    //! \brief Scratch list of commands in contention.
+    CommandPriorityList m_sortedCommands;
 
-    //! \brief The map of the resources currently allocated.
-    std::map<std::string, double> m_allocated;
+    //! \brief Identifies the current contents of the resource table.
+    //!        Footprints compiled with a different value are stale.
+    uint32_t m_tableId;
 
-    //! \brief All currently executing commands with resource requirements.
-    ResourceMap m_cmdResMap;
+    //! \brief Stamp for the current use of m_seen.
+    uint32_t m_seenStamp;
     
   public:
 
     //! \brief Default constructor.
-    ResourceArbiterImpl() = default;
+    ResourceArbiterImpl()
+      : m_tableId(s_nextTableId++),
+        m_seenStamp(0)
+    {
+    }
 
     //! \brief Virtual destructor.
     virtual ~ResourceArbiterImpl() = default;
@@ -405,11 +193,118 @@ namespace PLEXIL
     //! \brief Read the resource hierarchy from an input stream.
     //! \param[in] s The stream.
     //! \return true if successful, false if not.
+    //! \note Resource indices are stable across calls, so that
+    //!       allocations made before a reread are still valid.
     virtual bool readResourceHierarchy(std::istream &s)
+    {
+      // Clear any previous hierarchy
+      for (ResourceEntry &res : m_resources) {
+        res.children.clear();
+        res.descendants.clear();
+        res.maxConsumableValue = 1.0;
+        res.defined = false;
+      }
+      // Invalidate all compiled footprints
+      m_tableId = s_nextTableId++;
+
+      bool result = parseResourceHierarchy(s);
+      return compileResourceHierarchy() && result;
+    }
+    
+    //! \brief Partition a list of commands into accepted and rejected
+    //!        requests by resources requested and priority.
+    //! \param cmds Reference to a LinkedQueue which is consumed by the function.
+    //! \param acceptCmds Reference to a LinkedQueue provided by the caller to receive accepted commands.
+    //! \param rejectCmds Reference to a LinkedQueue provided by the caller to receive rejected commands.
+    virtual void arbitrateCommands(LinkedQueue<CommandImpl> &cmds,
+                                   LinkedQueue<CommandImpl> &acceptCmds,
+                                   LinkedQueue<CommandImpl> &rejectCmds)
+    {
+      debugMsg("ResourceArbiter:arbitrateCommands",
+               " processing " << cmds.size() << " commands");
+
+      // Do initial partitioning of commands without resource requirements,
+      // and sorting of the commands with requirements by their priority
+      partitionCommands(cmds, acceptCmds); // consumes cmds
+
+      debugStmt("ResourceArbiter:printSortedCommands",
+                printSortedCommands());
+
+      optimalResourceArbitration(acceptCmds, rejectCmds);
+      m_sortedCommands.clear();
+    
+      debugStmt("ResourceArbiter:printAcceptedCommands",
+                printAcceptedCommands(acceptCmds));
+      // Also print all the locked resources. 
+      debugStmt("ResourceArbiter:printAllocatedResources",
+                printAllocatedResources());
+    }
+
+    //! \brief Release the resources reserved by the given command, if any.
+    //! \param[in] cmd Pointer to the command.
+    virtual void releaseResourcesForCommand(CommandImpl *cmd)
+    {
+      // Review all resources used by the command and remove
+      // releaseable reservations from the allocated list.
+      // The footprint cannot have been recompiled since the command
+      // was accepted.
+      if (!m_activeCommands.erase(cmd))
+        return;
+
+      bool anyAllocated = false;
+      for (ResourceUsage const &res : cmd->getResourceFootprint().usage) {
+        if (res.release)
+          m_allocated[res.index] -= res.weight;
+      }
+      for (double alloc : m_allocated) {
+        if (alloc != 0.0) {
+          anyAllocated = true;
+          break;
+        }
+      }
+    
+      condDebugMsg(!anyAllocated,
+                   "ResourceArbiter:releaseResourcesForCommand", 
+                   " released command " << cmd->getName()
+                   << ", no resources currently allocated");
+      condDebugMsg(anyAllocated,
+                   "ResourceArbiter:releaseResourcesForCommand", 
+                   " released command " << cmd->getName()
+                   << ", remaining resource allocations:");
+      condDebugStmt(anyAllocated,
+                   "ResourceArbiter:releaseResourcesForCommand", 
+                    printAllocatedResources();
+                    );
+    }
+
+  private:
+
+    //! \brief Get the index of the named resource, adding it to the
+    //!        resource table if not already present.
+    //! \param[in] name The resource name.
+    //! \return The index.
+    size_t resourceIndex(std::string const &name)
+    {
+      std::unordered_map<std::string, size_t>::const_iterator it =
+        m_resourceIndex.find(name);
+      if (it != m_resourceIndex.end())
+        return it->second;
+
+      size_t result = m_resources.size();
+      m_resources.emplace_back(ResourceEntry(name));
+      m_resourceIndex.emplace(name, result);
+      m_allocated.push_back(0.0);
+      m_seen.push_back(0);
+      return result;
+    }
+
+    //! \brief Parse the resource hierarchy from an input stream.
+    //! \param[in] s The stream.
+    //! \return true if successful, false if not.
+    bool parseResourceHierarchy(std::istream &s)
     {
       static char const *WHITESPACE = " \t\n\r\v\f";
 
-      m_resourceHierarchy.clear();
       std::string dataStr;
       while (!s.eof()) {
         std::getline(s, dataStr); // clears dataStr
@@ -444,13 +339,14 @@ namespace PLEXIL
           return false;
         }
 
-        // We have enough information to construct the ResourceNode
-        std::pair<ResourceHierarchyMap::iterator, bool> emplaceResult =
-          m_resourceHierarchy.emplace(pName, ResourceNode(maxCons));
-        if (!emplaceResult.second) {
+        // We have enough information to define the resource
+        size_t pIndex = resourceIndex(pName);
+        if (m_resources[pIndex].defined) {
           std::cerr << "Error: resource " << pName << " defined twice" << std::endl;
           return false;
         }
+        m_resources[pIndex].defined = true;
+        m_resources[pIndex].maxConsumableValue = maxCons;
 
         debugMsg("ResourceArbiter:readResourceHierarchy",
                  " got resource name " << pName << ", value " << maxCons);
@@ -460,8 +356,6 @@ namespace PLEXIL
         len -= (endptr - data);
         data = endptr;
 
-        // Get children vector from the ResourceNode we emplaced above
-        std::vector<ChildResourceNode> &children = emplaceResult.first->second.children;
         while (len && *data) {
           // Read dependent resource weight - name pairs
           double d = strtod(data, &endptr);
@@ -488,8 +382,10 @@ namespace PLEXIL
 
           debugMsg("ResourceArbiter:readResourceHierarchy",
                    "  got dependent resource value " << d << ", name " << cName);
-          
-          children.emplace_back(ChildResourceNode(d, cName));
+
+          // Can't hold a reference to the parent across resourceIndex()
+          size_t cIndex = resourceIndex(cName);
+          m_resources[pIndex].children.push_back({cIndex, d});
 
           len -= ws;
           data += ws;
@@ -502,146 +398,209 @@ namespace PLEXIL
       }
       return true;
     }
-    
-    //! \brief Partition a list of commands into accepted and rejected
-    //!        requests by resources requested and priority.
-    //! \param cmds Reference to a LinkedQueue which is consumed by the function.
-    //! \param acceptCmds Reference to a LinkedQueue provided by the caller to receive accepted commands.
-    //! \param rejectCmds Reference to a LinkedQueue provided by the caller to receive rejected commands.
-    virtual void arbitrateCommands(LinkedQueue<CommandImpl> &cmds,
-                                   LinkedQueue<CommandImpl> &acceptCmds,
-                                   LinkedQueue<CommandImpl> &rejectCmds)
+
+    //! \brief Precompute the descendants of every resource in the
+    //!        hierarchy.
+    //! \return true if successful, false if the hierarchy contains a cycle.
+    bool compileResourceHierarchy()
     {
-      debugMsg("ResourceArbiter:arbitrateCommands",
-               " processing " << cmds.size() << " commands");
+      // 0 = not visited, 1 = in progress, 2 = done
+      std::vector<uint8_t> state(m_resources.size(), 0);
+      for (size_t i = 0; i < m_resources.size(); ++i) {
+        if (!compileDescendants(i, state)) {
+          // Leave the hierarchy usable
+          for (ResourceEntry &res : m_resources)
+            res.descendants.clear();
+          return false;
+        }
+      }
+      return true;
+    }
 
-      // Do initial partitioning of commands without resource requirements,
-      // and sorting of the commands with requirements by their priority
-      CommandPriorityList sortedCommands;
-      partitionCommands(m_resourceHierarchy, cmds, acceptCmds, sortedCommands); // consumes cmds
+    //! \brief Collect the descendants of a resource and their
+    //!        weights, depth first.
+    //! \param[in] index Index of the resource.
+    //! \param[in,out] state Visit state of each resource.
+    //! \return true if successful, false if a cycle was found.
+    bool compileDescendants(size_t index, std::vector<uint8_t> &state)
+    {
+      if (state[index] == 2)
+        return true;
+      if (state[index] == 1) {
+        std::cerr << "Error: resource " << m_resources[index].name
+                  << " is its own descendant" << std::endl;
+        return false;
+      }
+      state[index] = 1;
+      std::vector<ResourceWeight> result;
+      for (ResourceWeight const &child : m_resources[index].children) {
+        if (!compileDescendants(child.index, state))
+          return false;
+        result.push_back(child);
+        std::vector<ResourceWeight> const &grandchildren =
+          m_resources[child.index].descendants;
+        result.insert(result.end(), grandchildren.begin(), grandchildren.end());
+      }
+      m_resources[index].descendants.swap(result);
+      state[index] = 2;
+      return true;
+    }
 
-      debugStmt("ResourceArbiter:printSortedCommands",
-                printSortedCommands(sortedCommands));
+    //! \brief Add one resource requirement to a footprint, unless
+    //!        the resource is already present.
+    //! \param[in] index The resource index.
+    //! \param[in] weight The amount required.
+    //! \param[in] release Whether the resource is released upon command completion.
+    //! \param[in,out] usage The footprint being compiled.
+    void addUsage(size_t index, double weight, bool release,
+                  std::vector<ResourceUsage> &usage)
+    {
+      if (m_seen[index] == m_seenStamp)
+        return; // first requirement for a resource takes precedence
+      m_seen[index] = m_seenStamp;
+      usage.push_back({index, weight, release});
+    }
 
-      optimalResourceArbitration(sortedCommands, acceptCmds, rejectCmds);
-    
-      debugStmt("ResourceArbiter:printAcceptedCommands",
-                printAcceptedCommands(acceptCmds));
-      // Also print all the locked resources. 
-      debugStmt("ResourceArbiter:printAllocatedResources",
-                printAllocatedResources());
+    //! \brief Determine the total resource requirements of a
+    //!        command from its resource values.
+    //! \param[in] resList The command's resource values.
+    //! \param[out] footprint The compiled requirements.
+    void compileFootprint(ResourceValueList const &resList,
+                          ResourceFootprint &footprint)
+    {
+      std::vector<ResourceUsage> &usage = footprint.usage;
+      usage.clear();
+      if (!++m_seenStamp) {
+        // Stamp wrapped around
+        std::fill(m_seen.begin(), m_seen.end(), 0);
+        m_seenStamp = 1;
+      }
+
+      for (ResourceValue const &request : resList) {
+        debugMsg("ResourceArbiter:compileFootprint", ' ' << request.name);
+        size_t index = resourceIndex(request.name);
+        bool release = request.releaseAtTermination;
+        addUsage(index, request.upperBound, release, usage);
+        for (ResourceWeight const &desc : m_resources[index].descendants)
+          addUsage(desc.index, desc.weight, release, usage);
+      }
+      std::sort(usage.begin(), usage.end());
+      footprint.priority = resList.front().priority;
+      footprint.table = m_tableId;
     }
 
-    //! \brief Release the resources reserved by the given command, if any.
-    //! \param[in] cmd Pointer to the command.
-    virtual void releaseResourcesForCommand(CommandImpl *cmd)
+    //! \brief Partition a list of commands into commands with and
+    //!        without resource requirements, compile the
+    //!        requirements of each command if not already done, and
+    //!        sort the commands with resource requirements by their
+    //!        priority into m_sortedCommands.
+    //! \param[in] cmds A list of commands to be partitioned.  The list
+    //!                 is consumed by this function and left empty upon
+    //!                 return.
+    //! \param[out] acceptCmds The list of commands which do not have resource requests.
+    void partitionCommands(LinkedQueue<CommandImpl> &cmds,
+                           LinkedQueue<CommandImpl> &acceptCmds)
     {
-      // Review all resources used by the command and remove
-      // releaseable reservations from the allocated list.
-      ResourceMap::iterator resListIter = m_cmdResMap.find(cmd);
-      if (resListIter == m_cmdResMap.end())
-        return;
+      while (!cmds.empty()) {
+        CommandImpl *cmd = cmds.front();
+        cmds.pop();
+        const ResourceValueList &resList = cmd->getResourceValues();
+        if (resList.empty()) {
+          debugMsg("ResourceArbiter:partitionCommands",
+                   " accepting command \"" << cmd->getName() << "\" with no resource requests");
+          acceptCmds.push(cmd);
+        }
+        else {
+          // Determine the total resource requirements of the command
+          ResourceFootprint &footprint = cmd->getResourceFootprint();
+          if (footprint.table != m_tableId)
+            compileFootprint(resList, footprint);
 
-      for (ChildResourceNode const &res : resListIter->second) {
-        if (res.release) {
-          m_allocated[res.name] -= res.weight;
-          if (m_allocated[res.name] == 0.0)
-            m_allocated.erase(res.name);
+          // Add the command to the list of commands in contention
+          m_sortedCommands.push_back({cmd, &footprint, footprint.priority});
         }
       }
-      m_cmdResMap.erase(resListIter);
-    
-      condDebugMsg(m_allocated.empty(),
-                   "ResourceArbiter:releaseResourcesForCommand", 
-                   " released command " << cmd->getName()
-                   << ", no resources currently allocated");
-      condDebugMsg(!m_allocated.empty(),
-                   "ResourceArbiter:releaseResourcesForCommand", 
-                   " released command " << cmd->getName()
-                   << ", remaining resource allocations:");
-      condDebugStmt(!m_allocated.empty(),
-                   "ResourceArbiter:releaseResourcesForCommand", 
-                    printAllocatedResources();
-                    );
-    }
 
-  private:
+      // Sort the list of commands with resource requirements by priority
+      if (!std::is_sorted(m_sortedCommands.begin(), m_sortedCommands.end()))
+        std::stable_sort(m_sortedCommands.begin(), m_sortedCommands.end());
+    }
 
     //! \brief Evaluates resource requests and determines which
     //!        commands may be executed based on their resource
     //!        requirements and the current resource levels.
     //!        Appends to acceptCmds and rejectCmds.
-    //! \param[in] sortedCommands Commands and their resource
-    //!                            requirements, sorted by priority.
     //! \param[in,out] acceptCmds List of commands which can be
     //!                           executed.  Will be appended to by
     //!                           this function.
     //! \param[out] rejectCmds List of commands which cannot be
     //!                        executed due to resource limitations.
     //!                        Will be appended to by this function.
-    void optimalResourceArbitration(CommandPriorityList const &sortedCommands,
-                                    LinkedQueue<CommandImpl> &acceptCmds,
+    void optimalResourceArbitration(LinkedQueue<CommandImpl> &acceptCmds,
                                     LinkedQueue<CommandImpl> &rejectCmds)
     {
-      EstimateMap estimates;
-
-      // Prepare estimate map and ensure entries in allocated map based on requests
-      for (CommandPriorityEntry const &entry : sortedCommands) {
-        ResourceSet const &requests = entry.resources;
-        for (ChildResourceNode const &res : requests) {
-          std::string const &resName = res.name;
-          double value = 0.0;
-          if (m_allocated.find(resName) == m_allocated.end())
-            m_allocated[resName] = 0.0; // ensure entry in allocation map
-          else
-            value = m_allocated[resName];
-          estimates[resName] = ResourceEstimate(value);
-        }
-      }
+      if (m_sortedCommands.empty())
+        return;
 
-      for (CommandPriorityEntry const &entry : sortedCommands) {
-        EstimateMap savedEstimates = estimates;
+      // Initial estimates are the current allocations
+      m_renewable.assign(m_allocated.begin(), m_allocated.end());
+      m_consumable.assign(m_allocated.begin(), m_allocated.end());
+
+      for (CommandPriorityEntry const &entry : m_sortedCommands) {
         CommandImpl *cmd = entry.command;
-        ResourceSet const &requests = entry.resources;
+        std::vector<ResourceUsage> const &requests = entry.footprint->usage;
         bool invalid = false;
         
         debugMsg("ResourceArbiter:optimalResourceArbitration",
                  " considering \"" << cmd->getName() << '"');
 
-        for (ChildResourceNode const &res : requests) {
-          ResourceEstimate &est = estimates[res.name];
-
+        // Check first; each resource appears at most once in a footprint,
+        // so the estimates need not be backed out on rejection.
+        for (ResourceUsage const &res : requests) {
           debugMsg("ResourceArbiter:optimalResourceArbitration",
-                   "  " << cmd->getName() << " requires " << res.weight << " of " << res.name);
-
-          if (res.weight < 0.0)
-            est.renewable += res.weight;
-          else
-            est.consumable += res.weight;
+                   "  " << cmd->getName() << " requires " << res.weight
+                   << " of " << m_resources[res.index].name);
 
           // Make sure that each of the individual resource usage does not exceed
           // the permitted maximum. This handles the worst case resource usage 
           // behavior of both types of resources.
-          double resMax = maxConsumableResourceValue(res.name);
-          if (est.renewable < 0.0 || est.renewable > resMax) {
-            invalid = true;
-            debugMsg("ResourceArbiter:optimalResourceArbitration",
-                     " rejecting " << cmd->getName()
-                     << " because renewable usage of " << res.name << " exceeds limits");
-            break; // from inner loop
+          double resMax = m_resources[res.index].maxConsumableValue;
+          if (res.weight < 0.0) {
+            double renewable = m_renewable[res.index] + res.weight;
+            if (renewable < 0.0 || renewable > resMax) {
+              invalid = true;
+              debugMsg("ResourceArbiter:optimalResourceArbitration",
+                       " rejecting " << cmd->getName()
+                       << " because renewable usage of " << m_resources[res.index].name
+                       << " exceeds limits");
+              break;
+            }
+          }
+          else {
+            double consumable = m_consumable[res.index] + res.weight;
+            if (consumable < 0.0 || consumable > resMax) {
+              invalid = true;
+              debugMsg("ResourceArbiter:optimalResourceArbitration",
+                       " rejecting " << cmd->getName()
+                       << " because consumable usage of " << m_resources[res.index].name
+                       << " exceeds limits");
+              break;
+            }
           }
-          if (est.consumable < 0.0 || est.consumable > resMax) {
+          // The estimate not being changed must still be within limits
+          double other =
+            res.weight < 0.0 ? m_consumable[res.index] : m_renewable[res.index];
+          if (other < 0.0 || other > resMax) {
             invalid = true;
             debugMsg("ResourceArbiter:optimalResourceArbitration",
                      " rejecting " << cmd->getName()
-                     << " because consumable usage of " << res.name << " exceeds limits");
-            break; // from inner loop
+                     << " because usage of " << m_resources[res.index].name
+                     << " exceeds limits");
+            break;
           }
         }
         
         if (invalid) {
-          // Back out effects of rejected command
-          estimates = savedEstimates;
           rejectCmds.push(cmd);
         }
         else {
@@ -649,25 +608,23 @@ namespace PLEXIL
                    " accepting " << cmd->getName());
 
           acceptCmds.push(cmd);
-          m_cmdResMap[cmd] = requests;
-
-          // Update the allocated resource map to include the chosen command
-          for (ChildResourceNode const &res : requests)
-            m_allocated[res.name] += res.weight;
+          m_activeCommands.insert(cmd);
+
+          // Update the estimates and allocations to include the chosen command
+          for (ResourceUsage const &res : requests) {
+            if (res.weight < 0.0)
+              m_renewable[res.index] += res.weight;
+            else
+              m_consumable[res.index] += res.weight;
+            m_allocated[res.index] += res.weight;
+          }
         }
       }
     }
 
-    double maxConsumableResourceValue(const std::string& resName) const
-    {
-      if (m_resourceHierarchy.find(resName) != m_resourceHierarchy.end())
-        return m_resourceHierarchy.find(resName)->second.maxConsumableValue;
-      return 1.0;
-    }
-
-    void printSortedCommands(CommandPriorityList &sortedCommands) const
+    void printSortedCommands() const
     {
-      for (CommandPriorityEntry const &cmd : sortedCommands) {
+      for (CommandPriorityEntry const &cmd : m_sortedCommands) {
         debugMsg("ResourceArbiter:printSortedCommands", 
                  " command \"" << cmd.command->getName()
                  << "\", priority " << cmd.priority);
@@ -676,8 +633,10 @@ namespace PLEXIL
 
     void printAllocatedResources() const
     {
-      for (std::pair<const std::string, double> const &pr : m_allocated) {
-        debugMsg("ResourceArbiter:printAllocatedResources", ' ' << pr.first << " = " << pr.second);
+      for (size_t i = 0; i < m_allocated.size(); ++i) {
+        if (m_allocated[i] != 0.0)
+          debugMsg("ResourceArbiter:printAllocatedResources",
+                   ' ' << m_resources[i].name << " = " << m_allocated[i]);
       }
     }
 
@@ -686,13 +645,13 @@ namespace PLEXIL
       // Print accepted commands and the resources they consume.
       CommandImpl *cmd = acceptCmds.front();
       while (cmd) {
-        ResourceMap::const_iterator resMapIt = m_cmdResMap.find(cmd);
-        if (resMapIt != m_cmdResMap.end()) {
+        if (m_activeCommands.find(cmd) != m_activeCommands.end()) {
           debugMsg("ResourceArbiter:printAcceptedCommands",
                    " Accepted command \"" << cmd->getName()
                    << "\" uses resources:");
-          for (ChildResourceNode const &res : resMapIt->second) {
-            debugMsg("ResourceArbiter:printAcceptedCommands", "  " << res.name);
+          for (ResourceUsage const &res : cmd->getResourceFootprint().usage) {
+            debugMsg("ResourceArbiter:printAcceptedCommands",
+                     "  " << m_resources[res.index].name);
           }
         }
         else {
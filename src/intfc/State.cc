@@ -28,6 +28,7 @@
 
 #include "Error.hh" // assertTrue_2 macro
 
+#include <functional> // std::hash
 #include <ostream>
 #include <sstream>
 #include <utility> // std::move()
@@ -270,6 +271,14 @@ namespace PLEXIL
     return val.serialSize();
   }
 
+  size_t State::hash() const
+  {
+    size_t result = std::hash<std::string>()(m_name);
+    for (Value const &param : m_parameters)
+      result = result * 31 + param.hash();
+    return result;
+  }
+
   bool operator==(State const &sta, State const &stb)
   {
     return sta.name() == stb.name()
@@ -28,8 +28,20 @@
 
 #include "Value.hh"
 
+#include <cstdint>
+#include <utility> // std::move()
+
 namespace PLEXIL
 {
+  //! \brief Integer naming a State interned in the StateCache.
+  //! \see StateCache::getStateId
+  //! \ingroup External-Interface
+  using StateId = uint32_t;
+
+  //! \brief The StateId value which never names a State.
+  //! \ingroup External-Interface
+  constexpr StateId INVALID_STATE_ID = UINT32_MAX;
+
   //! \class State
   //! \brief Represents the ground values at a particular instant
   //!        of the name and arguments of a Lookup or Command. 
@@ -160,6 +172,11 @@ namespace PLEXIL
     //! \param val Const reference to the new Value.
     void setParameter(size_t i, Value const &val);
 
+    //! \brief Compute a hash code for this State.
+    //! \return The hash code.
+    //! \note States which compare equal have the same hash code.
+    size_t hash() const;
+
     //! \brief Print this State to an output stream.
     //! \param s Reference to the stream.
     void print(std::ostream &s) const;
@@ -274,6 +291,63 @@ namespace PLEXIL
   //! \ingroup External-Interface
   std::ostream &operator<<(std::ostream &, State const &);
 
+  //! \struct LookupValue
+  //! \brief A new value for a state, as reported in a batch of lookup
+  //!        returns.  The state is named by its StateId if known,
+  //!        otherwise by the State itself.
+  //! \see AdapterExecInterface::handleValueChanges
+  //! \ingroup External-Interface
+  struct LookupValue final
+  {
+    State state; //!< The state.  Only used if id is INVALID_STATE_ID.
+    Value value; //!< The new value.
+    StateId id;  //!< The ID of the state, or INVALID_STATE_ID.
+
+    //! \brief Default constructor.
+    LookupValue()
+      : state(),
+        value(),
+        id(INVALID_STATE_ID)
+    {
+    }
+
+    //! \brief Constructor from a StateId and a Value.
+    LookupValue(StateId i, Value const &val)
+      : state(),
+        value(val),
+        id(i)
+    {
+    }
+
+    //! \brief Move constructor from a StateId and a Value.
+    LookupValue(StateId i, Value &&val)
+      : state(),
+        value(std::move(val)),
+        id(i)
+    {
+    }
+
+    //! \brief Constructor from a State and a Value.
+    LookupValue(State const &st, Value const &val)
+      : state(st),
+        value(val),
+        id(INVALID_STATE_ID)
+    {
+    }
+
+    //! \brief Move constructor from a State and a Value.
+    LookupValue(State &&st, Value &&val)
+      : state(std::move(st)),
+        value(std::move(val)),
+        id(INVALID_STATE_ID)
+    {
+    }
+  };
+
+  //! \brief A batch of lookup returns, applied in order.
+  //! \ingroup External-Interface
+  using LookupBatch = std::vector<LookupValue>;
+
 } // namespace PLEXIL
 
 #endif // PLEXIL_STATE_HH
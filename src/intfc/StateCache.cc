@@ -27,13 +27,20 @@
 #include "StateCache.hh"
 
 #include "CachedValue.hh"
+#include "Debug.hh"
 #include "Dispatcher.hh"
 #include "Error.hh"
 #include "Message.hh"
 #include "State.hh"
 #include "StateCacheEntry.hh"
 
-#include <map>
+#include "plexil-config.h"
+
+#ifdef PLEXIL_WITH_THREADS
+#include <mutex>
+#endif
+
+#include <vector>
 
 namespace PLEXIL
 {
@@ -46,26 +53,83 @@ namespace PLEXIL
     return result;
   }
 
+  static StateCache::TimeSourceFn s_timeSource = nullptr;
+
   double StateCache::queryTime()
   {
     // Update the cached value
-    g_dispatcher->lookupNow(State::timeState(),
-                            instance().ensureTimeEntry()->getLookupReceiver());
+    if (s_timeSource)
+      instance().ensureTimeEntry()->getLookupReceiver()->update((Real) s_timeSource());
+    else
+      g_dispatcher->lookupNow(State::timeState(),
+                              instance().ensureTimeEntry()->getLookupReceiver());
     // and return it
     return currentTime();
   }
 
+  void StateCache::setTimeSource(TimeSourceFn fn)
+  {
+    debugMsg("StateCache:setTimeSource", (fn ? " set" : " cleared"));
+    s_timeSource = fn;
+  }
+
+  StateCache::TimeSourceFn StateCache::getTimeSource()
+  {
+    return s_timeSource;
+  }
+
   //! \class StateCacheImpl
   //! \brief Implements the StateCache API.
+  //!
+  //! Each state is interned once, in a record numbered by the low
+  //! bits of its StateId.  Records live in fixed-size segments which
+  //! are never moved, so a StateId may be used without searching.
+  //! The high bits of the StateId count how often the record has
+  //! been reused, so an ID kept after its state was deleted is
+  //! rejected rather than applied to an unrelated state.
+  //! States are found by an open-addressing (linear probing) hash
+  //! index, which stores each state's precomputed hash code so that
+  //! full State comparisons are only made on a hash match.
   class StateCacheImpl final : public StateCache
   {
     friend StateCache &StateCache::instance();
 
   private:
 
-    //! \typedef EntryMap
-    //! \brief Abbreviation for the type of the map structure.
-    using EntryMap = std::map<State, std::unique_ptr<StateCacheEntry>>;
+    //! \brief An interned state and its cache entry.
+    struct Record
+    {
+      State state;
+      size_t hash;
+      std::unique_ptr<StateCacheEntry> entry; //!< Null if the ID is not in use.
+      StateId id;                             //!< The full ID, including generation.
+    };
+
+    //! \brief A slot of the hash index.
+    struct IndexSlot
+    {
+      size_t hash;
+      StateId id;
+    };
+
+    // Record storage parameters
+    static constexpr size_t SEGMENT_BITS = 10;
+    static constexpr size_t SEGMENT_SIZE = 1 << SEGMENT_BITS;
+    static constexpr size_t MAX_SEGMENTS = 4096;
+
+    // StateId layout: record number in the low bits, generation above.
+    // The all-ones generation is never used, so neither are
+    // INVALID_STATE_ID and DELETED_SLOT.
+    static constexpr size_t RECORD_BITS = 22; // SEGMENT_BITS + log2(MAX_SEGMENTS)
+    static constexpr StateId RECORD_MASK = (StateId(1) << RECORD_BITS) - 1;
+    static constexpr StateId GENERATION_LIMIT = (INVALID_STATE_ID >> RECORD_BITS);
+    static_assert(SEGMENT_SIZE * MAX_SEGMENTS == size_t(1) << RECORD_BITS,
+                  "StateId record bits must match the record storage");
+
+    // Hash index parameters
+    static constexpr size_t MIN_INDEX_SIZE = 256; // must be a power of 2
+    static constexpr StateId EMPTY_SLOT = INVALID_STATE_ID;
+    static constexpr StateId DELETED_SLOT = INVALID_STATE_ID - 1;
 
   public:
 
@@ -105,16 +169,88 @@ namespace PLEXIL
       ensureStateCacheEntry(state)->updateValue(value, m_cycleCount);
     }
 
+    //! \brief Update the value for the state with this ID.
+    //! \param id The StateId, as returned by getStateId().
+    //! \param value The new value.
+    //! \note An ID whose state has since been deleted is ignored.
+    virtual void lookupReturn(StateId id, Value const &value)
+    {
+      StateCacheEntry *entry;
+      {
+#ifdef PLEXIL_WITH_THREADS
+        std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+        Record *rec = getLiveRecord(id);
+        if (!rec) {
+          warn("StateCache::lookupReturn: ignoring invalid or stale StateId " << id);
+          return;
+        }
+        entry = rec->entry.get();
+      }
+      // Update without the lock, as updates may call back into the cache
+      entry->updateValue(value, m_cycleCount);
+    }
+
+    //! \brief Update the values for a batch of states, in order.
+    //! \param batch The states and their new values.
+    virtual void lookupReturn(LookupBatch const &batch)
+    {
+      // Find all the entries under one lock, but update them without it,
+      // as updates may call back into the cache.
+      m_batchEntries.clear();
+      {
+#ifdef PLEXIL_WITH_THREADS
+        std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+        for (LookupValue const &lv : batch) {
+          StateId id = (lv.id == INVALID_STATE_ID) ? intern(lv.state) : lv.id;
+          Record *rec = getLiveRecord(id);
+          if (!rec)
+            warn("StateCache::lookupReturn: ignoring invalid or stale StateId " << id);
+          m_batchEntries.push_back(rec ? rec->entry.get() : nullptr);
+        }
+      }
+      for (size_t i = 0; i < batch.size(); ++i)
+        if (m_batchEntries[i])
+          m_batchEntries[i]->updateValue(batch[i].value, m_cycleCount);
+    }
+
+    //! \brief Get the stable integer ID of this state, adding the
+    //!        state to the cache if it is not already present.
+    //! \param state The state.
+    //! \return The ID.
+    virtual StateId getStateId(State const &state)
+    {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+      return intern(state);
+    }
+
+    //! \brief Get the state with the given ID.
+    //! \param id The StateId.
+    //! \return Const pointer to the State; null if the ID is invalid.
+    virtual State const *getState(StateId id) const
+    {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+      Record const *rec = getLiveRecord(id);
+      if (rec)
+        return &rec->state;
+      return nullptr;
+    }
+
     //! \brief Construct or find the cache entry for this state.
     //! \param state The state being looked up.
     //! \return Pointer to the StateCacheEntry for the state.
     //! \note Return value can be presumed to be non-null.
     virtual StateCacheEntry *ensureStateCacheEntry(State const &state)
     {
-      EntryMap::iterator iter = m_map.find(state);
-      if (iter == m_map.end())
-        iter = m_map.emplace(state, makeStateCacheEntry()).first;
-      return iter->second.get();
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+      return getRecord(intern(state))->entry.get();
     }
 
     //! \brief Get the object which should receive lookup result
@@ -176,25 +312,30 @@ namespace PLEXIL
     //! \param handle The handle being released.
     virtual void releaseMessageHandle(std::string const &handle)
     {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> guard(m_mutex);
+#endif
       // Need the parameter count to delete all the parameters
       Value handleValue(handle);
-      EntryMap::iterator iter = m_map.find(State("MessageParameterCount", handleValue));
-      if (iter == m_map.end())
+      State countState("MessageParameterCount", handleValue);
+      size_t slot = findSlot(countState, countState.hash());
+      if (slot == m_index.size())
         return; // not there, therefore already deleted or never existed
 
+      Record *rec = getRecord(m_index[slot].id);
       Integer count;
-      if (!iter->second->cachedValue()->getValue(count)) {
+      if (!rec->entry->cachedValue()->getValue(count)) {
         // warn of internal error (NYI)
         return;
       }
       
-      if (iter->second->hasRegisteredLookups()) {
+      if (rec->entry->hasRegisteredLookups()) {
         // BIG OOPS - can't delete these w/o leaving dangling pointers
         // warn (NYI)
         return;
       }
 
-      m_map.erase(iter);
+      removeSlot(slot);
       for (Integer i = 0; i < count; ++i) {
         deleteStateCacheEntry(State("MessageParameter",
                                     handleValue,
@@ -209,35 +350,179 @@ namespace PLEXIL
 
     //! \brief Default constructor.  Only accessible to StateCache::instance().
     StateCacheImpl()
-      : m_map(),
+      : m_index(MIN_INDEX_SIZE, IndexSlot {0, EMPTY_SLOT}),
+        m_freeIds(),
+        m_batchEntries(),
+#ifdef PLEXIL_WITH_THREADS
+        m_mutex(),
+#endif
         m_timeEntry(nullptr),
+        m_indexUsed(0),
+        m_liveCount(0),
+        m_nextId(0),
         m_cycleCount(1)
     {
     }
 
-    //! \brief Get or construct a state cache entry for the given state.
-    //! \param state Const reference to the state.
-    //! \return Pointer to the entry.
-    virtual StateCacheEntry *getStateCacheEntry(State const &state)
+    //
+    // Record storage
+    //
+
+    //! \brief Get the record for the given ID.
+    //! \param id The StateId.
+    //! \return Pointer to the record; null if the ID was never allocated.
+    //! \note Ignores the generation.
+    Record *getRecord(StateId id) const
+    {
+      size_t seg = (id & RECORD_MASK) >> SEGMENT_BITS;
+      if (seg >= MAX_SEGMENTS || !m_segments[seg])
+        return nullptr;
+      return &m_segments[seg][id & (SEGMENT_SIZE - 1)];
+    }
+
+    //! \brief Get the record for the given ID, if its state still exists.
+    //! \param id The StateId.
+    //! \return Pointer to the record; null if the ID is invalid or stale.
+    //! \note Caller must hold the mutex.
+    Record *getLiveRecord(StateId id) const
     {
-      EntryMap::iterator iter = m_map.find(state);
-      if (iter == m_map.end())
-        iter = m_map.emplace(state, makeStateCacheEntry()).first;
-      return iter->second.get();
+      Record *rec = getRecord(id);
+      if (rec && rec->entry && rec->id == id)
+        return rec;
+      return nullptr;
+    }
+
+    //! \brief Find or add the record for the state.
+    //! \param state The state.
+    //! \return The state's ID.
+    //! \note Caller must hold the mutex.
+    StateId intern(State const &state)
+    {
+      size_t hash = state.hash();
+      size_t slot = findSlot(state, hash);
+      if (slot != m_index.size())
+        return m_index[slot].id;
+
+      // Not found - allocate an ID
+      StateId id;
+      if (!m_freeIds.empty()) {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+      }
+      else {
+        size_t seg = m_nextId >> SEGMENT_BITS;
+        assertTrue_2(seg < MAX_SEGMENTS,
+                     "StateCache: maximum number of states exceeded");
+        if (!m_segments[seg])
+          m_segments[seg].reset(new Record[SEGMENT_SIZE]);
+        id = m_nextId++;
+      }
+      Record *rec = getRecord(id);
+      rec->state = state;
+      rec->hash = hash;
+      rec->entry = makeStateCacheEntry();
+      rec->id = id;
+      ++m_liveCount;
+      insertSlot(hash, id);
+      debugMsg("StateCache:intern", ' ' << state << " => " << id);
+      return id;
+    }
+
+    //
+    // Hash index
+    //
+
+    //! \brief Find the index slot for the state.
+    //! \param state The state.
+    //! \param hash The state's hash code.
+    //! \return Offset of the slot in the index; index size if not found.
+    size_t findSlot(State const &state, size_t hash) const
+    {
+      size_t mask = m_index.size() - 1;
+      for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        IndexSlot const &slot = m_index[i];
+        if (slot.id == EMPTY_SLOT)
+          return m_index.size();
+        if (slot.id != DELETED_SLOT
+            && slot.hash == hash
+            && getRecord(slot.id)->state == state)
+          return i;
+      }
+    }
+
+    //! \brief Add an ID to the index.
+    //! \param hash The state's hash code.
+    //! \param id The state's ID.
+    //! \note Assumes the state is not already in the index.
+    void insertSlot(size_t hash, StateId id)
+    {
+      // Keep the load factor, including deleted slots, under 3/4
+      if ((m_indexUsed + 1) * 4 > m_index.size() * 3)
+        rehash();
+      size_t mask = m_index.size() - 1;
+      size_t i = hash & mask;
+      while (m_index[i].id != EMPTY_SLOT && m_index[i].id != DELETED_SLOT)
+        i = (i + 1) & mask;
+      if (m_index[i].id == EMPTY_SLOT)
+        ++m_indexUsed;
+      m_index[i] = IndexSlot {hash, id};
+    }
+
+    //! \brief Delete the state in the given index slot, and free its ID.
+    //! \param slot Offset of the slot in the index.
+    void removeSlot(size_t slot)
+    {
+      StateId id = m_index[slot].id;
+      debugMsg("StateCache:remove", ' ' << getRecord(id)->state << " => " << id);
+      m_index[slot].id = DELETED_SLOT;
+      Record *rec = getRecord(id);
+      rec->entry.reset();
+      rec->state = State();
+      // The next state to use this record gets a new ID
+      StateId generation = (id >> RECORD_BITS) + 1;
+      if (generation == GENERATION_LIMIT)
+        generation = 0;
+      m_freeIds.push_back((generation << RECORD_BITS) | (id & RECORD_MASK));
+      --m_liveCount;
+    }
+
+    //! \brief Rebuild the index, discarding deleted slots and
+    //!        growing it if necessary.
+    void rehash()
+    {
+      size_t newSize = MIN_INDEX_SIZE;
+      while ((m_liveCount + 1) * 2 > newSize)
+        newSize *= 2;
+      std::vector<IndexSlot> oldIndex(newSize, IndexSlot {0, EMPTY_SLOT});
+      oldIndex.swap(m_index);
+      m_indexUsed = 0;
+      size_t mask = newSize - 1;
+      for (IndexSlot const &slot : oldIndex) {
+        if (slot.id == EMPTY_SLOT || slot.id == DELETED_SLOT)
+          continue;
+        size_t i = slot.hash & mask;
+        while (m_index[i].id != EMPTY_SLOT)
+          i = (i + 1) & mask;
+        m_index[i] = slot;
+        ++m_indexUsed;
+      }
+      debugMsg("StateCache:rehash",
+               ' ' << m_liveCount << " states, index size " << newSize);
     }
 
     //! \brief Delete the state cache entry for the named state.
     //! \param state Const reference to the state.
+    //! \note Caller must hold the mutex.
     void deleteStateCacheEntry(State const &state)
     {
-      EntryMap::iterator iter = m_map.find(state);
-      if (iter == m_map.end())
+      size_t slot = findSlot(state, state.hash());
+      if (slot == m_index.size())
         return; // already deleted or never there
-      if (iter->second->hasRegisteredLookups()) {
+      if (getRecord(m_index[slot].id)->entry->hasRegisteredLookups()) {
         // warn (NYI) and bail out
         return;
       }
-      m_map.erase(iter);
+      removeSlot(slot);
     }
 
     // Unimplemented
@@ -246,12 +531,36 @@ namespace PLEXIL
     StateCacheImpl &operator=(StateCacheImpl const &) = delete;
     StateCacheImpl &operator=(StateCacheImpl &&) = delete;
 
-    //! \brief The actual map.
-    EntryMap m_map;
+    //! \brief The record segments, indexed by the high bits of the StateId.
+    std::unique_ptr<Record[]> m_segments[MAX_SEGMENTS];
+
+    //! \brief The hash index.  Size is always a power of 2.
+    std::vector<IndexSlot> m_index;
+
+    //! \brief IDs for the records of deleted states, with the
+    //!        generation already advanced.
+    std::vector<StateId> m_freeIds;
+
+    //! \brief Scratch vector for lookupReturn(LookupBatch const &).
+    std::vector<StateCacheEntry *> m_batchEntries;
+
+#ifdef PLEXIL_WITH_THREADS
+    //! \brief Serializes changes to the index and records.
+    mutable std::mutex m_mutex;
+#endif
 
     //! \brief Pointer to the state cache entry for the time state.
     StateCacheEntry *m_timeEntry;
 
+    //! \brief Number of index slots which are not empty, including deleted ones.
+    size_t m_indexUsed;
+
+    //! \brief Number of states in the cache.
+    size_t m_liveCount;
+
+    //! \brief The next never-used ID.
+    StateId m_nextId;
+
     //! \brief The Exec major cycle counter.
     unsigned int m_cycleCount;
 
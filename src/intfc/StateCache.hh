@@ -56,8 +56,26 @@ namespace PLEXIL
 
     //! \brief Query the clock to get the time.
     //! \return The actual time, as a double.
+    //! \note Uses the time source if one is set, else performs a
+    //!       lookup of the time state through the Dispatcher.
     static double queryTime();
 
+    //! \typedef TimeSourceFn
+    //! \brief Type of a function returning the current time.
+    using TimeSourceFn = double (*)();
+
+    //! \brief Set a function for queryTime() to read the time from
+    //!        directly, bypassing the Dispatcher.
+    //! \param fn The function; null to restore lookups through the
+    //!           Dispatcher.
+    //! \note The function must read the same clock as the interface's
+    //!       handler for the time state.
+    static void setTimeSource(TimeSourceFn fn);
+
+    //! \brief Get the time source function.
+    //! \return The function; null if none is set.
+    static TimeSourceFn getTimeSource();
+
     //
     // API to PlexilExec
     //
@@ -83,6 +101,30 @@ namespace PLEXIL
     //! \param value The new value.
     virtual void lookupReturn(State const &state, Value const &value) = 0;
 
+    //! \brief Update the value for the state with this ID.
+    //! \param id The StateId, as returned by getStateId().
+    //! \param value The new value.
+    //! \note Skips the search for the state.
+    //! \note Ignores, with a warning, an ID whose state has since
+    //!       been deleted.
+    virtual void lookupReturn(StateId id, Value const &value) = 0;
+
+    //! \brief Update the values for a batch of states, in order.
+    //! \param batch The states and their new values.
+    virtual void lookupReturn(LookupBatch const &batch) = 0;
+
+    //! \brief Get the stable integer ID of this state, adding the
+    //!        state to the cache if it is not already present.
+    //! \param state The state.
+    //! \return The ID.
+    //! \note May be called from any thread.
+    virtual StateId getStateId(State const &state) = 0;
+
+    //! \brief Get the state with the given ID.
+    //! \param id The StateId.
+    //! \return Const pointer to the State; null if the ID is invalid.
+    virtual State const *getState(StateId id) const = 0;
+
     //
     // API to Lookup
     //
@@ -54,7 +54,8 @@ namespace PLEXIL
     StateCacheEntryImpl()
       : m_value(),
         m_lowThreshold(),
-        m_highThreshold()
+        m_highThreshold(),
+        m_dispatchCache()
     {
     }
 
@@ -312,6 +313,14 @@ namespace PLEXIL
     }
     ///@}
 
+    //! \brief Get the storage in which the Dispatcher may cache the
+    //!        lookup handler for this entry's state.
+    //! \return Pointer to the cache.
+    virtual DispatchCache *getDispatchCache()
+    {
+      return &m_dispatchCache;
+    }
+
     //
     // StateCacheEntry API
     //
@@ -479,8 +488,10 @@ namespace PLEXIL
       bool hasThresholds = false;
       Real rhi, rlo;
       Real newrhi, newrlo;
+      std::vector<Real> highs;
       for (Lookup *l : m_lookups) {
         if (l->getThresholds(newrhi, newrlo)) {
+          highs.push_back(newrhi);
           if (hasThresholds) {
             if (newrlo > rlo)
               rlo = newrlo;
@@ -504,7 +515,7 @@ namespace PLEXIL
         }
         m_lowThreshold->update(timestamp, rlo);
         m_highThreshold->update(timestamp, rhi);
-        g_dispatcher->setThresholds(state, rhi, rlo);
+        g_dispatcher->setLookupThresholds(state, highs, rhi, rlo);
       }
       else if (m_lowThreshold) {
         // Had thresholds, but they're no longer in effect
@@ -532,6 +543,9 @@ namespace PLEXIL
     //! \brief Pointer to the lowest high threshold currently in
     //!        effect.  May be null.
     CachedValuePtr m_highThreshold;
+
+    //! \brief The Dispatcher's cached lookup handler for this state.
+    DispatchCache m_dispatchCache;
   };
 
   std::unique_ptr<StateCacheEntry> makeStateCacheEntry()
@@ -36,6 +36,7 @@
 #include <cstring> // strcmp()
 
 extern bool lookupsTest();
+extern bool resourceArbiterTest();
 extern bool stateTest();
 extern bool serializeTest();
 
@@ -44,6 +45,7 @@ void runTests()
   runTestSuite(stateTest);
   runTestSuite(lookupsTest);
   runTestSuite(serializeTest);
+  runTestSuite(resourceArbiterTest);
 
   plexilRunFinalizers();
 
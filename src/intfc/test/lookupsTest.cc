@@ -26,9 +26,11 @@
 
 #include "Dispatcher.hh"
 #include "ExprVec.hh"
+#include "CachedValue.hh"
 #include "Constant.hh"
 #include "Lookup.hh"
 #include "LookupReceiver.hh"
+#include "Message.hh"
 #include "StateCacheEntry.hh"
 #include "StateCache.hh"
 #include "TestSupport.hh"
@@ -761,6 +763,93 @@ static bool testThresholdUpdate()
   return true;
 }
 
+static bool testStateIds()
+{
+  StateCache &cache = StateCache::instance();
+
+  State s1("stateIdTest", Value((Integer) 1));
+  State s2("stateIdTest", Value((Integer) 2));
+  StateId id1 = cache.getStateId(s1);
+  StateId id2 = cache.getStateId(s2);
+  assertTrue_1(id1 != INVALID_STATE_ID);
+  assertTrue_1(id2 != INVALID_STATE_ID);
+  assertTrue_1(id1 != id2);
+  assertTrue_1(cache.getStateId(s1) == id1);
+  assertTrue_1(cache.getStateId(State("stateIdTest", Value((Real) 2))) == id2);
+  assertTrue_1(*cache.getState(id1) == s1);
+  assertTrue_1(*cache.getState(id2) == s2);
+  assertTrue_1(!cache.getState(INVALID_STATE_ID));
+
+  // Update by ID is visible by state
+  cache.lookupReturn(id1, Value((Real) 5));
+  Real r = 0;
+  assertTrue_1(cache.ensureStateCacheEntry(s1)->cachedValue()->getValue(r));
+  assertTrue_1(r == 5);
+
+  // Enough states to force the index to grow
+  std::vector<StateId> ids;
+  for (Integer i = 0; i < 5000; ++i)
+    ids.push_back(cache.getStateId(State("stateIdGrowth", Value(i))));
+  for (Integer i = 0; i < 5000; ++i) {
+    assertTrue_1(cache.getStateId(State("stateIdGrowth", Value(i))) == ids[i]);
+    assertTrue_1(cache.getState(ids[i])->parameter(0) == Value(i));
+  }
+  assertTrue_1(cache.getStateId(s1) == id1);
+
+  return true;
+}
+
+static bool testStaleStateIds()
+{
+  StateCache &cache = StateCache::instance();
+
+  // Message states are deleted when the handle is released
+  Value handle(std::string("staleIdTest"));
+  cache.assignMessageHandle(new Message(State("staleIdMessage"), "tester", 1.0),
+                            "staleIdTest");
+  StateId oldId = cache.getStateId(State("MessageArrived", handle));
+  assertTrue_1(cache.getState(oldId));
+  cache.releaseMessageHandle("staleIdTest");
+  assertTrue_1(!cache.getState(oldId));
+
+  // A new state may reuse the storage, but not the ID
+  State s1("staleIdReuse");
+  StateId newId = cache.getStateId(s1);
+  assertTrue_1(newId != oldId);
+  cache.lookupReturn(newId, Value((Integer) 1));
+  cache.lookupReturn(oldId, Value((Integer) 2)); // ignored
+  Integer i = 0;
+  assertTrue_1(cache.ensureStateCacheEntry(s1)->cachedValue()->getValue(i));
+  assertTrue_1(i == 1);
+  assertTrue_1(!cache.getState(oldId));
+
+  return true;
+}
+
+static bool testLookupBatch()
+{
+  StateCache &cache = StateCache::instance();
+
+  State s1("batchTest", Value((Integer) 1));
+  State s2("batchTest", Value((Integer) 2));
+  StateId id2 = cache.getStateId(s2);
+
+  LookupBatch batch;
+  batch.emplace_back(s1, Value((Integer) 10));
+  batch.emplace_back(id2, Value((Integer) 20));
+  // Later values for the same state win
+  batch.emplace_back(s1, Value((Integer) 11));
+  cache.lookupReturn(batch);
+
+  Integer i = 0;
+  assertTrue_1(cache.ensureStateCacheEntry(s1)->cachedValue()->getValue(i));
+  assertTrue_1(i == 11);
+  assertTrue_1(cache.ensureStateCacheEntry(s2)->cachedValue()->getValue(i));
+  assertTrue_1(i == 20);
+
+  return true;
+}
+
 bool lookupsTest()
 {
   TestInterface foo;
@@ -770,6 +859,9 @@ bool lookupsTest()
   runTest(testLookupNow);
   runTest(testLookupOnChange);
   runTest(testThresholdUpdate);
+  runTest(testStateIds);
+  runTest(testStaleStateIds);
+  runTest(testLookupBatch);
   g_dispatcher = nullptr;
   return true;
 }
@@ -0,0 +1,261 @@
+/* Copyright (c) 2006-2020, Universities Space Research Association (USRA).
+ *  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Universities Space Research Association nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CommandImpl.hh"
+#include "Constant.hh"
+#include "LinkedQueue.hh"
+#include "ResourceArbiterInterface.hh"
+#include "TestSupport.hh"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+using namespace PLEXIL;
+
+struct ResourceRequest
+{
+  char const *name;
+  Real upperBound;
+  Integer priority;
+  bool release;
+};
+
+static CommandImpl *makeCommand(std::string const &name,
+                                std::vector<ResourceRequest> const &requests)
+{
+  CommandImpl *cmd = new CommandImpl(name);
+  cmd->setNameExpr(new StringConstant(name), true);
+  if (!requests.empty()) {
+    ResourceSpecList *specs = new ResourceSpecList(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+      ResourceSpec &spec = (*specs)[i];
+      spec.setNameExpression(new StringConstant(requests[i].name), true);
+      spec.setPriorityExpression(new IntegerConstant(requests[i].priority), true);
+      spec.setUpperBoundExpression(new RealConstant(requests[i].upperBound), true);
+      spec.setReleaseAtTerminationExpression(new BooleanConstant(requests[i].release), true);
+    }
+    cmd->setResourceList(specs);
+  }
+  cmd->activate();
+  cmd->fixValues();
+  return cmd;
+}
+
+static bool contains(LinkedQueue<CommandImpl> const &q, CommandImpl const *cmd)
+{
+  for (CommandImpl const *c = q.front(); c; c = c->next())
+    if (c == cmd)
+      return true;
+  return false;
+}
+
+static char const *TEST_HIERARCHY =
+  "% Test hierarchy\n"
+  "arm 1 0.5 joint1 0.5 joint2\n"
+  "joint1 1\n"
+  "joint2 1\n"
+  "\n"
+  "power 10 1 vision\n";
+
+static bool testReadHierarchy()
+{
+  std::unique_ptr<ResourceArbiterInterface> arbiter(makeResourceArbiter());
+  {
+    std::istringstream s(TEST_HIERARCHY);
+    assertTrue_1(arbiter->readResourceHierarchy(s));
+  }
+  {
+    std::istringstream s("arm 1\narm 2\n");
+    assertTrue_1(!arbiter->readResourceHierarchy(s));
+  }
+  {
+    std::istringstream s("arm 1 1\n");
+    assertTrue_1(!arbiter->readResourceHierarchy(s));
+  }
+  {
+    std::istringstream s("a 1 1 b\nb 1 1 c\nc 1 1 a\n");
+    assertTrue_1(!arbiter->readResourceHierarchy(s));
+  }
+  return true;
+}
+
+static bool testArbitration()
+{
+  std::unique_ptr<ResourceArbiterInterface> arbiter(makeResourceArbiter());
+  {
+    std::istringstream s(TEST_HIERARCHY);
+    assertTrue_1(arbiter->readResourceHierarchy(s));
+  }
+
+  // Arm uses half of each joint
+  std::unique_ptr<CommandImpl> moveArm(makeCommand("moveArm", {{"arm", 1, 1, true}}));
+  std::unique_ptr<CommandImpl> bendJoint1(makeCommand("bendJoint1", {{"joint1", 0.5, 2, true}}));
+  std::unique_ptr<CommandImpl> bendJoint2(makeCommand("bendJoint2", {{"joint2", 1, 3, true}}));
+  std::unique_ptr<CommandImpl> noResources(makeCommand("noResources", {}));
+
+  LinkedQueue<CommandImpl> cmds, accepted, rejected;
+  cmds.push(bendJoint2.get());
+  cmds.push(noResources.get());
+  cmds.push(bendJoint1.get());
+  cmds.push(moveArm.get());
+  arbiter->arbitrateCommands(cmds, accepted, rejected);
+  assertTrue_1(cmds.empty());
+  assertTrue_1(accepted.size() == 3);
+  assertTrue_1(contains(accepted, moveArm.get()));
+  assertTrue_1(contains(accepted, bendJoint1.get()));
+  assertTrue_1(contains(accepted, noResources.get()));
+  assertTrue_1(rejected.size() == 1);
+  assertTrue_1(contains(rejected, bendJoint2.get()));
+  accepted.clear();
+  rejected.clear();
+
+  // Joint 2 is available once the arm command completes
+  moveArm->deactivate(arbiter.get());
+  bendJoint2->deactivate(arbiter.get());
+  bendJoint2->activate();
+  cmds.push(bendJoint2.get());
+  arbiter->arbitrateCommands(cmds, accepted, rejected);
+  assertTrue_1(accepted.size() == 1);
+  assertTrue_1(contains(accepted, bendJoint2.get()));
+  assertTrue_1(rejected.empty());
+  accepted.clear();
+
+  // Resource not in the hierarchy has a maximum of 1
+  std::unique_ptr<CommandImpl> first(makeCommand("first", {{"camera", 1, 5, true}}));
+  std::unique_ptr<CommandImpl> second(makeCommand("second", {{"camera", 1, 4, true}}));
+  cmds.push(first.get());
+  cmds.push(second.get());
+  arbiter->arbitrateCommands(cmds, accepted, rejected);
+  assertTrue_1(accepted.size() == 1);
+  assertTrue_1(contains(accepted, second.get()));
+  assertTrue_1(rejected.size() == 1);
+  assertTrue_1(contains(rejected, first.get()));
+  accepted.clear();
+  rejected.clear();
+
+  // Resources not released at termination stay allocated
+  std::unique_ptr<CommandImpl> charge(makeCommand("charge", {{"power", 6, 1, false}}));
+  cmds.push(charge.get());
+  arbiter->arbitrateCommands(cmds, accepted, rejected);
+  assertTrue_1(accepted.size() == 1);
+  accepted.clear();
+  charge->deactivate(arbiter.get());
+  charge->activate();
+  cmds.push(charge.get());
+  arbiter->arbitrateCommands(cmds, accepted, rejected);
+  assertTrue_1(accepted.empty());
+  assertTrue_1(rejected.size() == 1);
+  rejected.clear();
+
+  // Rereading the hierarchy doesn't lose allocations
+  {
+    std::istringstream s(TEST_HIERARCHY);
+    assertTrue_1(arbiter->readResourceHierarchy(s));
+  }
+  std::unique_ptr<CommandImpl> drive(makeCommand("drive", {{"power", 5, 1, true}}));
+  cmds.push(drive.get());
+  arbiter->arbitrateCommands(cmds, accepted, rejected);
+  assertTrue_1(accepted.empty());
+  assertTrue_1(contains(rejected, drive.get()));
+  rejected.clear();
+
+  return true;
+}
+
+//
+// Times arbitration of a large batch of commands, each requesting a
+// few resources from a two-level hierarchy.
+//
+
+static bool arbitrationBenchmark()
+{
+  static size_t const N_GROUPS = 16;
+  static size_t const N_LEAVES = 4;
+  static size_t const N_COMMANDS = 512;
+  static size_t const N_ROUNDS = 200;
+
+  std::unique_ptr<ResourceArbiterInterface> arbiter(makeResourceArbiter());
+  {
+    std::ostringstream hierarchy;
+    for (size_t g = 0; g < N_GROUPS; ++g) {
+      hierarchy << "group" << g << ' ' << N_COMMANDS;
+      for (size_t l = 0; l < N_LEAVES; ++l)
+        hierarchy << " 1 leaf" << g << '_' << l;
+      hierarchy << '\n';
+      for (size_t l = 0; l < N_LEAVES; ++l)
+        hierarchy << "leaf" << g << '_' << l << ' ' << N_COMMANDS / 16 << '\n';
+    }
+    std::istringstream s(hierarchy.str());
+    assertTrue_1(arbiter->readResourceHierarchy(s));
+  }
+
+  std::vector<std::string> names;
+  for (size_t g = 0; g < N_GROUPS; ++g)
+    names.push_back("group" + std::to_string(g));
+
+  std::vector<std::unique_ptr<CommandImpl> > commands;
+  for (size_t i = 0; i < N_COMMANDS; ++i) {
+    std::vector<ResourceRequest> requests;
+    requests.push_back({names[i % N_GROUPS].c_str(), 1, (Integer) (i % 8), true});
+    requests.push_back({names[(i * 7 + 3) % N_GROUPS].c_str(), 1, (Integer) (i % 8), true});
+    commands.emplace_back(makeCommand("cmd" + std::to_string(i), requests));
+  }
+
+  LinkedQueue<CommandImpl> cmds, accepted, rejected;
+  size_t nAccepted = 0;
+  std::chrono::steady_clock::duration elapsed(0);
+  for (size_t round = 0; round < N_ROUNDS; ++round) {
+    for (std::unique_ptr<CommandImpl> const &cmd : commands)
+      cmds.push(cmd.get());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    arbiter->arbitrateCommands(cmds, accepted, rejected);
+    elapsed += std::chrono::steady_clock::now() - start;
+    nAccepted += accepted.size();
+    accepted.clear();
+    rejected.clear();
+    for (std::unique_ptr<CommandImpl> const &cmd : commands) {
+      cmd->deactivate(arbiter.get());
+      cmd->activate();
+    }
+  }
+  assertTrue_1(nAccepted > 0);
+  assertTrue_1(nAccepted < N_ROUNDS * N_COMMANDS);
+  std::cout << "  " << N_ROUNDS << " rounds of " << N_COMMANDS << " commands, "
+            << std::chrono::duration<double>(elapsed).count() * 1e9 / (N_ROUNDS * N_COMMANDS) << " ns/command"
+            << std::endl;
+  return true;
+}
+
+bool resourceArbiterTest()
+{
+  runTest(testReadHierarchy);
+  runTest(testArbitration);
+  runTest(arbitrationBenchmark);
+  return true;
+}
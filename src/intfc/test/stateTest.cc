@@ -471,6 +471,41 @@ static bool testLessThan()
   return true;
 }
 
+static bool testHash()
+{
+  State mt;
+  assertTrue_1(mt.hash() == State().hash());
+
+  std::string const foo("Foo");
+  State named(foo);
+  assertTrue_1(named.hash() == State(foo).hash());
+
+  // Equal states must hash alike, including Integer vs. Real parameters
+  State intParam(foo, Value((Integer) 3));
+  State realParam(foo, Value((Real) 3.0));
+  assertTrue_1(intParam == realParam);
+  assertTrue_1(intParam.hash() == realParam.hash());
+
+  State zero(foo, Value((Real) 0.0));
+  State minusZero(foo, Value((Real) -0.0));
+  assertTrue_1(zero == minusZero);
+  assertTrue_1(zero.hash() == minusZero.hash());
+
+  State unknownInt(foo, Value(INTEGER_TYPE));
+  State unknownReal(foo, Value(REAL_TYPE));
+  assertTrue_1(unknownInt == unknownReal);
+  assertTrue_1(unknownInt.hash() == unknownReal.hash());
+
+  State strParam(foo, Value("Bar"));
+  State strParam2(foo, Value(std::string("Bar")));
+  assertTrue_1(strParam.hash() == strParam2.hash());
+
+  // Not guaranteed in general, but should hold for these
+  assertTrue_1(named.hash() != strParam.hash());
+  assertTrue_1(intParam.hash() != strParam.hash());
+
+  return true;
+}
 
 bool stateTest()
 {
@@ -479,6 +514,7 @@ bool stateTest()
   runTest(testMoveAssignment);
   runTest(testEquality);
   runTest(testLessThan);
+  runTest(testHash);
 
   return true;
 }
@@ -120,6 +120,7 @@ CHECK_INCLUDE_FILE(poll.h HAVE_POLL_H)
 CHECK_INCLUDE_FILE(arpa/inet.h HAVE_ARPA_INET_H)
 CHECK_INCLUDE_FILE(netinet/in.h HAVE_NETINET_IN_H)
 CHECK_INCLUDE_FILE(sys/socket.h HAVE_SYS_SOCKET_H)
+CHECK_INCLUDE_FILE(sys/epoll.h HAVE_SYS_EPOLL_H) # Linux only
 
 # glibc backtrace functionality
 CHECK_INCLUDE_FILE(execinfo.h HAVE_EXECINFO_H)
@@ -218,6 +219,7 @@ unset(CMAKE_REQUIRED_LIBRARIES)
 CHECK_FUNCTION_EXISTS(gethostbyname HAVE_GETHOSTBYNAME) # UdpAdapter, IPC
 CHECK_FUNCTION_EXISTS(getpid HAVE_GETPID) # Logging, ExecApplication
 CHECK_FUNCTION_EXISTS(isatty HAVE_ISATTY) # utils/Logging.cc only
+CHECK_FUNCTION_EXISTS(recvmmsg HAVE_RECVMMSG) # UdpEventLoop, Linux only
 
 #
 # Libraries
@@ -28,9 +28,11 @@
 #include "Debug.hh"
 #include "Error.hh"
 #include "ExecApplication.hh"
+#include "Function.hh"
 #include "InterfaceManager.hh"
 #include "InterfaceSchema.hh"
 #include "lifecycle-utils.h"
+#include "planLoader.hh"
 #include "PlexilExec.hh"
 #include "ResourceArbiterInterface.hh"
 
@@ -52,6 +54,7 @@ int main_internal(int argc, char** argv)
   std::string debugConfig("Debug.cfg");
   std::string interfaceConfig("interface-config.xml");
   std::string resourceFile("resource.data");
+  std::string traceFile;
   std::vector<std::string> libraryNames;
   std::vector<std::string> libraryPath;
   std::string
@@ -61,7 +64,11 @@ int main_internal(int argc, char** argv)
                     [-L <library_directory>]*    (default .)\n\
                     [-c <interface_config_file>] (default ./interface-config.xml)\n\
                     [-d <debug_config_file>]     (default ./Debug.cfg)\n\
-                    [+d]                         (disable debug messages)\n");
+                    [+d]                         (disable debug messages)\n\
+                    [-T <trace_file>]            (record debug messages in binary trace file)\n\
+                    [-t <n>]                     (condition check threads, default 1)\n\
+                    [-P <n>]                     (plan loader threads, default 1)\n\
+                    [-e]                         (lazy expression evaluation)\n");
 
 #ifdef HAVE_LUV_LISTENER
   std::string luvHost = LUV_DEFAULT_HOSTNAME;
@@ -71,6 +78,9 @@ int main_internal(int argc, char** argv)
 #endif
 
   bool luvRequest = false;
+  unsigned int conditionCheckThreads = 1;
+  unsigned int planLoaderThreads = 1;
+  bool lazyEvaluation = false;
   bool debugConfigSupplied = false;
   bool useDebugConfig = true;
   bool resourceFileSupplied = false;
@@ -121,6 +131,14 @@ int main_internal(int argc, char** argv)
       debugConfig.clear();
       useDebugConfig = false;
     }
+    else if (strcmp(argv[i], "-T") == 0) {
+      if (argc == (++i)) {
+        std::cerr << "Error: Missing argument to the " << argv[i - 1] << " option.\n"
+                  << usage << std::endl;
+        return 2;
+      }
+      traceFile = argv[i];
+    }
     else if (strcmp(argv[i], "-l") == 0) {
 	  if (argc == (++i)) {
 		std::cerr << "Error: Missing argument to the " << argv[i - 1] << " option.\n" 
@@ -160,6 +178,26 @@ int main_internal(int argc, char** argv)
 	  }
       planName = argv[i];
 	}
+    else if (strcmp(argv[i], "-t") == 0) {
+	  if (argc == (++i)) {
+		std::cerr << "Error: Missing argument to the " << argv[i - 1] << " option.\n"
+				  << usage << std::endl;
+		return 2;
+	  }
+      std::istringstream buffer(argv[i]);
+      buffer >> conditionCheckThreads;
+    }
+    else if (strcmp(argv[i], "-P") == 0) {
+	  if (argc == (++i)) {
+		std::cerr << "Error: Missing argument to the " << argv[i - 1] << " option.\n"
+				  << usage << std::endl;
+		return 2;
+	  }
+      std::istringstream buffer(argv[i]);
+      buffer >> planLoaderThreads;
+    }
+    else if (strcmp(argv[i], "-e") == 0)
+      lazyEvaluation = true;
     else if (strcmp(argv[i], "-r") == 0) {
       if (!useResourceFile) {
         warn("Both -r and +r options specified.\n"
@@ -217,6 +255,11 @@ int main_internal(int argc, char** argv)
       readDebugConfigStream(dbgConfig);
   }
 
+  if (!traceFile.empty() && !startTraceLog(traceFile)) {
+    std::cerr << "Error: unable to start trace log " << traceFile << std::endl;
+    return 1;
+  }
+
   // get interface configuration file, if provided
   pugi::xml_document configDoc;
   if (!interfaceConfig.empty()) {
@@ -282,6 +325,9 @@ int main_internal(int argc, char** argv)
   if (useResourceFile) {
     _app->exec()->getArbiter()->readResourceHierarchyFile(resourceFile);
   }
+  _app->exec()->setConditionCheckThreads(conditionCheckThreads);
+  setPlanLoaderThreads(planLoaderThreads);
+  Function::setLazyEvaluation(lazyEvaluation);
 
   if (!_app->initialize(configElt)) {
       std::cout << "ERROR: unable to initialize application"
@@ -53,10 +53,16 @@
 
 #ifdef NO_DEBUG_MESSAGE_SUPPORT
 
+#include <string>
+
 #define debugMsg(marker, data)
 #define condDebugMsg(cond, marker, data)
 #define debugStmt(marker, stmt)
 #define condDebugStmt(cond, marker, stmt)
+#define traceMsg(...)
+#define condTraceMsg(...)
+#define debugTraceMsg(...)
+#define condDebugTraceMsg(...)
 #define SHOW(thing)
 #define MARK
 
@@ -73,11 +79,26 @@ inline bool readDebugConfigStream(std::istream & /* is */)
   return true;
 }
 
+inline bool debugMessagesEnabled()
+{
+  return false;
+}
+
+inline bool startTraceLog(std::string const & /* filename */, size_t /* bufferRecords */ = 0)
+{
+  return false;
+}
+
+inline void stopTraceLog()
+{
+}
+
 }
 
 #else
 
 #include "DebugMessage.hh"
+#include "TraceLog.hh"
 
 /**
    @brief The SHOW() macro is intended as a convenience debugging tool
@@ -106,6 +127,8 @@ inline bool readDebugConfigStream(std::istream & /* is */)
   output to the debug stream returned by DebugMessage::getStream()
   when this debug message is enabled (via, e.g. DebugMessage::enable()
   or DebugMessage::enableAll()).
+  @note While a trace log is running, the data is not formatted;
+  only the identity of the message and a timestamp are recorded.
   @see condDebugMsg
   @see debugStmt
   @see condDebugStmt
@@ -127,12 +150,112 @@ inline bool readDebugConfigStream(std::istream & /* is */)
   @see DebugMessage
 */
 #define condDebugMsg(cond, marker, data) { \
-  static PLEXIL::DebugMessage debug_msg(marker);     \
+  static PLEXIL::DebugMessage debug_msg(marker, __FILE__, __LINE__); \
   if (debug_msg.enabled && (cond)) { \
-    PLEXIL::getDebugOutputStream() << "[" << marker << "]" << data << std::endl; \
+    if (PLEXIL::traceLogActive()) \
+      PLEXIL::traceDebugMessage(debug_msg); \
+    else \
+      PLEXIL::getDebugOutputStream() << "[" << marker << "]" << data << std::endl; \
   } \
 }
 
+/**
+  @brief Create a debug message whose data are a few numeric values,
+  which are recorded without formatting while a trace log is running.
+  @param marker A string that "marks" the message to enable it by.
+  @param ... Up to TRACE_MAX_ARGS values of integer, enumeration, boolean,
+  floating point, or (non-character) pointer type.
+  @note When no trace log is running, the marker and the values are
+  printed to the debug stream, separated by spaces.
+  @see condTraceMsg
+  @see startTraceLog
+*/
+#define traceMsg(...) condTraceMsg(true, __VA_ARGS__)
+
+/**
+  @brief Create a conditional trace message, which will only be
+  recorded when the given condition is true at run time.
+  @param cond An additional condition to be checked before recording the message.
+  @param marker A string that "marks" the message to enable it by.
+  @param ... Up to TRACE_MAX_ARGS numeric values.
+  @see traceMsg
+*/
+#define condTraceMsg(cond, ...) { \
+  static PLEXIL::DebugMessage trace_msg(PLEXIL_TRACE_MARKER(__VA_ARGS__, 0), __FILE__, __LINE__); \
+  if (trace_msg.enabled && (cond)) { \
+    PLEXIL::traceMarkedMessage(trace_msg, __VA_ARGS__); \
+  } \
+}
+
+// Helper for condTraceMsg
+#define PLEXIL_TRACE_MARKER(marker, ...) marker
+
+/**
+  @brief Create a debug message which is formatted as debugMsg() would
+  when no trace log is running, and whose numeric values are recorded
+  when one is.
+  @param marker A string that "marks" the message to enable it by.
+  @param data The data to be printed when no trace log is running.
+  @param ... Up to TRACE_MAX_ARGS numeric values to be recorded in the
+  trace log; normally those in the data.
+  @note Intended for messages on the Exec's critical path, whose data
+  should not be lost in trace mode.
+  @see debugMsg
+  @see traceMsg
+*/
+#define debugTraceMsg(marker, data, ...) condDebugTraceMsg(true, marker, data, __VA_ARGS__)
+
+/**
+  @brief Create a conditional debug message which records numeric
+  values in trace mode.
+  @param cond An additional condition to be checked before printing the message.
+  @param marker A string that "marks" the message to enable it by.
+  @param data The data to be printed when no trace log is running.
+  @param ... Up to TRACE_MAX_ARGS numeric values for the trace log.
+  @see debugTraceMsg
+*/
+#define condDebugTraceMsg(cond, marker, data, ...) { \
+  static PLEXIL::DebugMessage debug_msg(marker, __FILE__, __LINE__); \
+  if (debug_msg.enabled && (cond)) { \
+    if (PLEXIL::traceLogActive()) \
+      PLEXIL::traceDebugMessage(debug_msg, __VA_ARGS__); \
+    else \
+      PLEXIL::getDebugOutputStream() << "[" << marker << "]" << data << std::endl; \
+  } \
+}
+
+namespace PLEXIL
+{
+  //! Record a debug message in the trace log, or print it if no
+  //! trace log is running.
+  template <typename... Args>
+  void traceDebugMessage(DebugMessage &msg, Args const &... args)
+  {
+    static_assert(sizeof...(Args) <= TRACE_MAX_ARGS, "Too many arguments to traceMsg");
+    if (traceLogActive()) {
+      TraceRecord *rec = beginTraceRecord(msg);
+      if (rec) {
+        rec->nArgs = sizeof...(Args);
+        setTraceArgs(*rec, 0, args...);
+        commitTraceRecord();
+      }
+    }
+    else {
+      std::ostream &os = getDebugOutputStream();
+      os << '[' << msg.marker << ']';
+      printTraceArgs(os, args...);
+      os << std::endl;
+    }
+  }
+
+  //! Helper for condTraceMsg; discards the marker.
+  template <typename... Args>
+  void traceMarkedMessage(DebugMessage &msg, char const * /* marker */, Args const &... args)
+  {
+    traceDebugMessage(msg, args...);
+  }
+}
+
 /**
   @brief Add code to be executed only if the DebugMessage is enabled.
   @param marker A string that "marks" the message to enable it by.
@@ -158,7 +281,7 @@ inline bool readDebugConfigStream(std::istream & /* is */)
   @see DebugMessage
 */
 #define condDebugStmt(cond, marker, stmt) { \
-  static PLEXIL::DebugMessage dm(marker); \
+  static PLEXIL::DebugMessage dm(marker, __FILE__, __LINE__); \
   if (dm.enabled && (cond)) { \
     stmt ; \
   } \
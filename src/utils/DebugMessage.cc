@@ -24,14 +24,21 @@
 * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include "plexil-config.h"
+
 #include "DebugMessage.hh"
 
 #include "Error.hh"
 
+#include <atomic>
 #include <cstring> // strstr()
 #include <iostream>
 #include <vector>
 
+#ifdef PLEXIL_WITH_THREADS
+#include <mutex>
+#endif
+
 namespace PLEXIL
 {
 
@@ -44,11 +51,25 @@ namespace PLEXIL
 
   static DebugMessage *allDebugMessages = nullptr;
 
-  DebugMessage::DebugMessage(char const *mrkr)
+#ifdef PLEXIL_WITH_THREADS
+  // Guards allDebugMessages and allDebugPatterns.  Messages are
+  // constructed on first use, which may be on any thread.
+  static std::mutex s_debugRegistryMutex;
+#endif
+
+  DebugMessage::DebugMessage(char const *mrkr, char const *fil, int lin)
     : marker(mrkr),
-      next(allDebugMessages),
-      enabled(matchesPatterns(marker))
+      next(nullptr),
+      enabled(false),
+      file(fil),
+      line(lin),
+      traceId(0)
   {
+#ifdef PLEXIL_WITH_THREADS
+    std::lock_guard<std::mutex> const guard(s_debugRegistryMutex);
+#endif
+    enabled = matchesPatterns(marker);
+    next = allDebugMessages;
     allDebugMessages = this;
   }
 
@@ -100,6 +121,10 @@ namespace PLEXIL
 
   static std::vector<std::string> allDebugPatterns;
 
+  // True once any pattern has been added.  Read without taking the
+  // registry mutex, so that hot paths may check it freely.
+  static std::atomic<bool> s_anyDebugPatterns(false);
+
   /**
    *  @brief Whether the given marker string matches the pattern string.
    *  Exists solely to ensure the same method is always used to check
@@ -120,6 +145,9 @@ namespace PLEXIL
 
   void enableMatchingDebugMessages(std::string &&pattern)
   {
+#ifdef PLEXIL_WITH_THREADS
+    std::lock_guard<std::mutex> const guard(s_debugRegistryMutex);
+#endif
     // Enable any existing messages that match
     for (DebugMessage *m = allDebugMessages; m != nullptr; m = m->next)
       if (!m->enabled
@@ -128,6 +156,12 @@ namespace PLEXIL
 
     // Add pattern for messages added in the future
     allDebugPatterns.push_back(std::move(pattern));
+    s_anyDebugPatterns.store(true, std::memory_order_release);
+  }
+
+  bool debugMessagesEnabled()
+  {
+    return s_anyDebugPatterns.load(std::memory_order_acquire);
   }
 
   bool readDebugConfigStream(std::istream& istr)
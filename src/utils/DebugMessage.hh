@@ -27,6 +27,9 @@
 #ifndef PLEXIL_DEBUG_MESSAGE_HH
 #define PLEXIL_DEBUG_MESSAGE_HH
 
+#include "plexil-stdint.h"
+
+#include <atomic>
 #include <iosfwd>
 #include <string>
 
@@ -42,8 +45,10 @@ namespace PLEXIL
     /**
      * @brief Construct a DebugMessage.
      * @param marker Name for the particular instance (not required to be unique within the process).
+     * @param fil Source file name of the instance, if known.
+     * @param lin Source line number of the instance, if known.
      */
-    DebugMessage(char const *mrkr);
+    DebugMessage(char const *mrkr, char const *fil = nullptr, int lin = 0);
 
     ~DebugMessage() = default;
 
@@ -66,6 +71,17 @@ namespace PLEXIL
     */
     bool enabled;
 
+    /**
+       @brief Source file and line where this instance was created.
+    */
+    char const * const file;
+    int const line;
+
+    /**
+       @brief ID of this instance in the trace log; 0 if not yet assigned.
+    */
+    std::atomic<uint32_t> traceId;
+
   private:
 
     // Not implemented
@@ -83,6 +99,15 @@ namespace PLEXIL
 
   extern bool readDebugConfigStream(std::istream &is);
 
+  /**
+   * @brief Whether any debug message pattern has been configured.
+   * @note Cheap enough to call from inner loops; does not lock.
+   * @note Output from concurrent threads is not serialized, so code
+   *       with a parallel path should take its serial path while
+   *       this is true.
+   */
+  extern bool debugMessagesEnabled();
+
 } // namespace PLEXIL
 
 #endif // PLEXIL_DEBUG_MESSAGE_HH
@@ -33,12 +33,24 @@
 namespace PLEXIL
 {
 
+  //! Forms of message to log, by constructor.
+  enum ParserExceptionForm {
+    FORM_NONE = 0,
+    FORM_MESSAGE,
+    FORM_OFFSET,
+    FORM_LINE_COLUMN
+  };
+
+  //! False while exceptions on this thread are not to be logged.
+  static thread_local bool t_logging = true;
+
   ParserException::ParserException() PLEXIL_NOEXCEPT
     : std::exception(), 
       message("Unspecified parser exception"),
       file(),
       line(0),
-      column(0)
+      column(0),
+      form(FORM_NONE)
   {
   }
 
@@ -48,13 +60,15 @@ namespace PLEXIL
       message(),
       file(),
       line(0),
-      column(0)
+      column(0),
+      form(FORM_MESSAGE)
   {
     if (msg)
       message = msg;
     else
       message = "Message not specified";
-    Logging::handle_message(Logging::LOG_ERROR, message.c_str());
+    if (t_logging)
+      report();
   }
   
   // Used to report (e.g.) pugixml errors.
@@ -63,7 +77,8 @@ namespace PLEXIL
       message(),
       file(),
       line(0),
-      column(offset)
+      column(offset),
+      form(FORM_OFFSET)
   {
     if (msg)
       message = msg;
@@ -71,7 +86,8 @@ namespace PLEXIL
       message = "Message not specified";
     if (fyle)
       file = fyle;
-    Logging::handle_message(Logging::LOG_ERROR, fyle, offset, message.c_str());
+    if (t_logging)
+      report();
   }
   
   // When we have complete information about the location.
@@ -80,7 +96,8 @@ namespace PLEXIL
       message(),
       file(),
       line(lyne),
-      column(col)
+      column(col),
+      form(FORM_LINE_COLUMN)
   {
     if (msg)
       message = msg;
@@ -88,7 +105,8 @@ namespace PLEXIL
       message = "Message not specified";
     if (fyle)
       file = fyle;
-    Logging::handle_message(Logging::LOG_ERROR, fyle, lyne, col, message.c_str());
+    if (t_logging)
+      report();
   }
 
   const char* ParserException::what() const PLEXIL_NOEXCEPT
@@ -96,4 +114,32 @@ namespace PLEXIL
     return message.c_str();
   }
 
+  void ParserException::report() const
+  {
+    char const *fyle = file.empty() ? nullptr : file.c_str();
+    switch (form) {
+    case FORM_MESSAGE:
+      Logging::handle_message(Logging::LOG_ERROR, message.c_str());
+      break;
+
+    case FORM_OFFSET:
+      Logging::handle_message(Logging::LOG_ERROR, fyle, column, message.c_str());
+      break;
+
+    case FORM_LINE_COLUMN:
+      Logging::handle_message(Logging::LOG_ERROR, fyle, line, column, message.c_str());
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  bool ParserException::setLogging(bool enable)
+  {
+    bool const result = t_logging;
+    t_logging = enable;
+    return result;
+  }
+
 }
@@ -79,10 +79,29 @@ namespace PLEXIL
 
     virtual const char *what() const PLEXIL_NOEXCEPT override;
 
+    /**
+     * @brief Log the message, as the constructor does when logging
+     *        is enabled.
+     */
+    void report() const;
+
+    /**
+     * @brief Set whether ParserExceptions constructed on the calling
+     *        thread log their messages.  The default is true.
+     * @param enable The new setting.
+     * @return The previous setting.
+     * @note Used when a check may be repeated, or its error reported
+     *       later with report().
+     */
+    static bool setLogging(bool enable);
+
     std::string message;
     std::string file; /**<The source file in which the error was detected (__FILE__). */
     int line;         /**< Line number of the error */
 	int column;       /**< The character offset of the error */
+
+  private:
+    int form;         /**< Which constructor was used, for report() */
   };
 
 }
@@ -0,0 +1,223 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "plexil-config.h"
+
+#include "PlanArena.hh"
+
+#include <new>
+
+#ifdef PLEXIL_WITH_THREADS
+#include <mutex>
+#endif
+
+namespace PLEXIL
+{
+
+  //
+  // Every block is preceded by a header naming the arena it came
+  // from, or null if it came from the heap.
+  //
+
+  struct alignas(std::max_align_t) BlockHeader
+  {
+    PlanArena *arena;
+  };
+
+  static constexpr size_t HEADER_SIZE = sizeof(BlockHeader);
+
+  static constexpr size_t roundUp(size_t size)
+  {
+    return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+  }
+
+  struct PlanArenaChunk
+  {
+    PlanArenaChunk *next;
+    size_t size;
+  };
+
+  // Chunk data starts after the (padded) header
+  static constexpr size_t CHUNK_HEADER_SIZE = roundUp(sizeof(PlanArenaChunk));
+
+  // Blocks larger than this get a chunk of their own
+  static constexpr size_t LARGE_BLOCK_SIZE = PlanArena::CHUNK_SIZE / 4;
+
+  static thread_local PlanArena *t_currentArena = nullptr;
+
+  static std::atomic<size_t> s_liveArenas(0);
+
+  //
+  // Standard-size chunks freed by one arena are kept for the next,
+  // up to a limit, so that loading a plan after deleting another
+  // doesn't have to fault in fresh pages.
+  //
+
+  static constexpr size_t MAX_SPARE_CHUNKS = 128;
+
+  static PlanArenaChunk *s_spareChunks = nullptr;
+  static size_t s_spareChunkCount = 0;
+
+#ifdef PLEXIL_WITH_THREADS
+  static std::mutex s_spareChunkMutex;
+#endif
+
+  static PlanArenaChunk *getChunk(size_t size)
+  {
+    if (size == PlanArena::CHUNK_SIZE) {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(s_spareChunkMutex);
+#endif
+      if (s_spareChunks) {
+        PlanArenaChunk *result = s_spareChunks;
+        s_spareChunks = result->next;
+        --s_spareChunkCount;
+        return result;
+      }
+    }
+    PlanArenaChunk *result = static_cast<PlanArenaChunk *>(::operator new(size));
+    result->size = size;
+    return result;
+  }
+
+  static void putChunk(PlanArenaChunk *chunk)
+  {
+    if (chunk->size == PlanArena::CHUNK_SIZE) {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(s_spareChunkMutex);
+#endif
+      if (s_spareChunkCount < MAX_SPARE_CHUNKS) {
+        chunk->next = s_spareChunks;
+        s_spareChunks = chunk;
+        ++s_spareChunkCount;
+        return;
+      }
+    }
+    ::operator delete(static_cast<void *>(chunk));
+  }
+
+  PlanArena::PlanArena()
+    : m_chunks(nullptr),
+      m_next(nullptr),
+      m_end(nullptr),
+      m_references(1)
+  {
+    s_liveArenas.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  PlanArena::~PlanArena()
+  {
+    while (m_chunks) {
+      PlanArenaChunk *temp = m_chunks;
+      m_chunks = temp->next;
+      putChunk(temp);
+    }
+    s_liveArenas.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void *PlanArena::allocateBlock(size_t size)
+  {
+    size = roundUp(size);
+    if (size > LARGE_BLOCK_SIZE) {
+      // Link it in behind the current chunk, so the current one stays in use
+      PlanArenaChunk *big = getChunk(CHUNK_HEADER_SIZE + size);
+      if (m_chunks) {
+        big->next = m_chunks->next;
+        m_chunks->next = big;
+      }
+      else {
+        big->next = nullptr;
+        m_chunks = big;
+      }
+      m_references.fetch_add(1, std::memory_order_relaxed);
+      return reinterpret_cast<char *>(big) + CHUNK_HEADER_SIZE;
+    }
+
+    if (size > static_cast<size_t>(m_end - m_next)) {
+      PlanArenaChunk *chunk = getChunk(CHUNK_SIZE);
+      chunk->next = m_chunks;
+      m_chunks = chunk;
+      m_next = reinterpret_cast<char *>(chunk) + CHUNK_HEADER_SIZE;
+      m_end = reinterpret_cast<char *>(chunk) + CHUNK_SIZE;
+    }
+    void *result = m_next;
+    m_next += size;
+    m_references.fetch_add(1, std::memory_order_relaxed);
+    return result;
+  }
+
+  void PlanArena::release() noexcept
+  {
+    if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete this;
+  }
+
+  void *PlanArena::allocate(size_t size)
+  {
+    BlockHeader *header;
+    if (t_currentArena) {
+      header = static_cast<BlockHeader *>(t_currentArena->allocateBlock(HEADER_SIZE + size));
+      header->arena = t_currentArena;
+    }
+    else {
+      header = static_cast<BlockHeader *>(::operator new(HEADER_SIZE + size));
+      header->arena = nullptr;
+    }
+    return header + 1;
+  }
+
+  void PlanArena::deallocate(void *ptr) noexcept
+  {
+    if (!ptr)
+      return;
+    BlockHeader *header = static_cast<BlockHeader *>(ptr) - 1;
+    if (header->arena)
+      header->arena->release();
+    else
+      ::operator delete(static_cast<void *>(header));
+  }
+
+  size_t PlanArena::liveArenaCount()
+  {
+    return s_liveArenas.load(std::memory_order_relaxed);
+  }
+
+  PlanArena::Scope::Scope()
+    : m_arena(nullptr)
+  {
+    if (!t_currentArena)
+      t_currentArena = m_arena = new PlanArena();
+  }
+
+  PlanArena::Scope::~Scope()
+  {
+    if (m_arena) {
+      t_currentArena = nullptr;
+      m_arena->release();
+    }
+  }
+
+} // namespace PLEXIL
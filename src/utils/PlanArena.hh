@@ -0,0 +1,157 @@
+/* Copyright (c) 2006-2020, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_PLAN_ARENA_HH
+#define PLEXIL_PLAN_ARENA_HH
+
+#include <atomic>
+#include <cstddef> // size_t, max_align_t
+#include <type_traits>
+
+namespace PLEXIL
+{
+
+  // Forward reference
+  struct PlanArenaChunk;
+
+  //! @class PlanArena
+  //! @brief A bump allocator for the objects which make up one plan.
+  //!
+  //! While a PlanArena::Scope is in effect on a thread, objects of
+  //! classes derived from ArenaAllocated which are created on that
+  //! thread are carved out of large chunks owned by the scope's arena.
+  //! Their destructors run as usual, but deleting them returns no
+  //! memory; the arena frees all its chunks at once when the scope
+  //! has ended and the last of its objects has been deleted.
+  //!
+  //! Objects created with no scope in effect come from the heap.
+  //!
+  //! @note Objects from one arena may be deleted on a different
+  //!       thread than the one which created them.
+  class PlanArena final
+  {
+  public:
+
+    //! @class Scope
+    //! @brief Directs allocations on the calling thread to a new
+    //!        arena for the lifetime of this object.
+    //! @note If a scope is already in effect on the thread, the
+    //!       new scope uses the existing arena.
+    class Scope final
+    {
+    public:
+      Scope();
+      ~Scope();
+
+    private:
+      Scope(Scope const &) = delete;
+      Scope(Scope &&) = delete;
+      Scope &operator=(Scope const &) = delete;
+      Scope &operator=(Scope &&) = delete;
+
+      PlanArena *m_arena; //!< Null if this scope is nested.
+    };
+
+    //! @brief Allocate storage from the current arena, or the heap
+    //!        if no scope is in effect.
+    //! @param size The size in bytes.
+    //! @return Pointer to the storage, aligned for any type.
+    static void *allocate(size_t size);
+
+    //! @brief Release storage returned by allocate().
+    //! @param ptr The pointer; may be null.
+    static void deallocate(void *ptr) noexcept;
+
+    //! @brief Allocate a value-initialized array as if by allocate().
+    //! @param n The number of elements.
+    //! @return Pointer to the first element.
+    //! @note Release the array with deallocate().
+    template <typename T>
+    static T *allocateArray(size_t n)
+    {
+      static_assert(std::is_trivially_destructible<T>::value,
+                    "PlanArena arrays are not destroyed");
+      T *result = static_cast<T *>(allocate(n * sizeof(T)));
+      for (size_t i = 0; i < n; ++i)
+        result[i] = T();
+      return result;
+    }
+
+    //! @brief Get the number of arenas which still hold memory.
+    //! @return The count.
+    static size_t liveArenaCount();
+
+    //! @brief Size of the chunks requested from the heap.
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+  private:
+
+    // Only Scope constructs and deletes arenas.
+    PlanArena();
+    ~PlanArena();
+
+    PlanArena(PlanArena const &) = delete;
+    PlanArena(PlanArena &&) = delete;
+    PlanArena &operator=(PlanArena const &) = delete;
+    PlanArena &operator=(PlanArena &&) = delete;
+
+    void *allocateBlock(size_t size);
+    void release() noexcept;
+
+    PlanArenaChunk *m_chunks;         //!< Most recent chunk first.
+    char *m_next;                     //!< Next free byte in the current chunk.
+    char *m_end;                      //!< End of the current chunk.
+    std::atomic<size_t> m_references; //!< Live blocks, plus one while the Scope exists.
+  };
+
+  //! @class ArenaAllocated
+  //! @brief Mixin base class for objects which are allocated from the
+  //!        current PlanArena, if any.
+  //! @see PlanArena
+  class ArenaAllocated
+  {
+  public:
+
+    static void *operator new(size_t size)
+    {
+      return PlanArena::allocate(size);
+    }
+
+    static void operator delete(void *ptr) noexcept
+    {
+      PlanArena::deallocate(ptr);
+    }
+
+  protected:
+
+    // Only usable as a base class.
+    ArenaAllocated() = default;
+    ~ArenaAllocated() = default;
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_PLAN_ARENA_HH
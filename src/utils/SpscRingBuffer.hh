@@ -0,0 +1,188 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PLEXIL_SPSC_RING_BUFFER_HH
+#define PLEXIL_SPSC_RING_BUFFER_HH
+
+#include "Error.hh"
+
+#include <atomic>
+#include <cstddef> // size_t
+#include <memory>  // std::unique_ptr
+
+namespace PLEXIL
+{
+
+  //! @class SpscRingBuffer
+  //! @brief Bounded, lock-free, single-producer/single-consumer queue.
+
+  //! SpscRingBuffer holds a fixed array of preallocated slots.  The
+  //! producer fills a slot in place, then publishes it; the consumer
+  //! reads the oldest published slot in place, then releases it.
+  //! Slot contents are never destroyed, so objects with internal
+  //! storage (e.g. vectors) can be reused without reallocation.
+  //!
+  //! Exactly one thread may call the producer member functions, and
+  //! exactly one thread may call the consumer member functions.
+  //!
+  //! @note T must be default constructible.
+  //! \ingroup Utils
+  template <typename T>
+  class SpscRingBuffer final
+  {
+  public:
+
+    //! @brief Constructor.
+    //! @param capacity Maximum number of items in the queue.
+    SpscRingBuffer(size_t capacity)
+      : m_slots(new T[capacity]),
+        m_capacity(capacity),
+        m_head(0),
+        m_tail(0)
+    {
+      assertTrue_2(capacity > 0, "SpscRingBuffer: capacity must be positive");
+    }
+
+    //! @brief Destructor.
+    ~SpscRingBuffer() = default;
+
+    //! @brief Get the maximum number of items the queue can hold.
+    //! @return The capacity.
+    size_t capacity() const
+    {
+      return m_capacity;
+    }
+
+    //! @brief Get the number of items currently in the queue.
+    //! @return The number of items.
+    //! @note Exact only when called from the producer or consumer
+    //!       thread; otherwise a snapshot.
+    size_t size() const
+    {
+      return m_head.load(std::memory_order_acquire)
+        - m_tail.load(std::memory_order_acquire);
+    }
+
+    //! @brief Query whether the queue is empty.
+    //! @return True if empty, false otherwise.
+    bool empty() const
+    {
+      return size() == 0;
+    }
+
+    //
+    // Producer API
+    //
+
+    //! @brief Get the next free slot for writing.
+    //! @return Pointer to the slot; null if the queue is full.
+    //! @note The slot is not visible to the consumer until commitWrite() is called.
+    T *writeSlot()
+    {
+      size_t head = m_head.load(std::memory_order_relaxed);
+      if (head - m_tail.load(std::memory_order_acquire) >= m_capacity)
+        return nullptr;
+      return &m_slots[head % m_capacity];
+    }
+
+    //! @brief Publish the slot most recently returned by writeSlot().
+    void commitWrite()
+    {
+      m_head.store(m_head.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+    }
+
+    //! @brief Copy an item into the queue.
+    //! @param item The item.
+    //! @return True if successful, false if the queue is full.
+    bool push(T const &item)
+    {
+      T *slot = writeSlot();
+      if (!slot)
+        return false;
+      *slot = item;
+      commitWrite();
+      return true;
+    }
+
+    //
+    // Consumer API
+    //
+
+    //! @brief Get the oldest published slot for reading.
+    //! @return Pointer to the slot; null if the queue is empty.
+    //! @note The slot is not reused until commitRead() is called.
+    T *readSlot()
+    {
+      size_t tail = m_tail.load(std::memory_order_relaxed);
+      if (tail == m_head.load(std::memory_order_acquire))
+        return nullptr;
+      return &m_slots[tail % m_capacity];
+    }
+
+    //! @brief Release the slot most recently returned by readSlot().
+    void commitRead()
+    {
+      m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+    }
+
+    //! @brief Copy the oldest item out of the queue.
+    //! @param item Reference to the place to put the item.
+    //! @return True if successful, false if the queue is empty.
+    bool pop(T &item)
+    {
+      T *slot = readSlot();
+      if (!slot)
+        return false;
+      item = *slot;
+      commitRead();
+      return true;
+    }
+
+  private:
+
+    // Not implemented
+    SpscRingBuffer() = delete;
+    SpscRingBuffer(SpscRingBuffer const &) = delete;
+    SpscRingBuffer(SpscRingBuffer &&) = delete;
+    SpscRingBuffer &operator=(SpscRingBuffer const &) = delete;
+    SpscRingBuffer &operator=(SpscRingBuffer &&) = delete;
+
+    // Typical cache line size, used to keep the producer and consumer
+    // indices from sharing a line.
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    std::unique_ptr<T[]> const m_slots; //!< The slots.
+    size_t const m_capacity;            //!< Number of slots.
+    char m_pad0[CACHE_LINE_SIZE];
+    std::atomic<size_t> m_head;         //!< Count of items written. Owned by the producer.
+    char m_pad1[CACHE_LINE_SIZE];
+    std::atomic<size_t> m_tail;         //!< Count of items read. Owned by the consumer.
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_SPSC_RING_BUFFER_HH
@@ -0,0 +1,404 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "plexil-config.h"
+
+#include "TraceLog.hh"
+
+#include "DebugMessage.hh"
+#include "Error.hh"
+#include "SpscRingBuffer.hh"
+#include "lifecycle-utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring> // memcpy()
+#include <memory>
+#include <vector>
+
+#ifdef PLEXIL_WITH_THREADS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace PLEXIL
+{
+
+  std::atomic<bool> g_traceLogActive(false);
+
+  //
+  // Per-thread ring buffers
+  //
+  // A buffer lives until the program exits, so a thread which is
+  // writing a record while the log is being stopped never writes
+  // into freed memory.  The buffer of a thread which has exited is
+  // given to the next new thread, once it has been drained.
+  //
+
+  struct TraceBuffer final
+  {
+    TraceBuffer(size_t capacity)
+      : ring(capacity),
+        dropped(0),
+        thread(0),
+        retired(false)
+    {
+    }
+
+    SpscRingBuffer<TraceRecord> ring;
+    std::atomic<uint64_t> dropped;
+    uint16_t thread;
+    std::atomic<bool> retired;
+  };
+
+  // Retires the thread's buffer when the thread exits.
+  struct ThreadTraceBuffer final
+  {
+    ~ThreadTraceBuffer()
+    {
+      if (buffer)
+        buffer->retired.store(true, std::memory_order_release);
+    }
+
+    TraceBuffer *buffer = nullptr;
+  };
+
+  static thread_local ThreadTraceBuffer t_traceBuffer;
+
+  // Guarded by s_bufferMutex
+  static std::vector<std::unique_ptr<TraceBuffer>> s_buffers;
+  static size_t s_bufferRecords = TRACE_DEFAULT_BUFFER_RECORDS;
+  static uint16_t s_nextThread = 0;
+
+  // Guarded by s_markerMutex; index is marker ID - TRACE_MARKER_FIRST
+  static std::vector<DebugMessage const *> s_markers;
+
+  // Guarded by s_flushMutex
+  static FILE *s_traceFile = nullptr;
+  static size_t s_markersWritten = 0;
+  static std::vector<TraceRecord> s_pending;
+
+  // Steady clock at log start
+  static std::atomic<int64_t> s_startTime(0);
+
+#ifdef PLEXIL_WITH_THREADS
+  static std::mutex s_bufferMutex;
+  static std::mutex s_markerMutex;
+  static std::mutex s_flushMutex;
+  static std::mutex s_controlMutex; // serializes start and stop
+
+  static std::thread s_flusher;
+  static std::condition_variable s_flusherCV;
+  static bool s_stopFlusher = false; // guarded by s_flushMutex
+
+  //! How often the background thread writes the buffers to the file.
+  static constexpr std::chrono::milliseconds TRACE_FLUSH_INTERVAL(10);
+#endif
+
+  static int64_t steadyNanoseconds()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+      (std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  static uint64_t traceTimestamp()
+  {
+    return static_cast<uint64_t>(steadyNanoseconds()
+                                 - s_startTime.load(std::memory_order_relaxed));
+  }
+
+  static uint32_t assignTraceId(DebugMessage &msg)
+  {
+#ifdef PLEXIL_WITH_THREADS
+    std::lock_guard<std::mutex> const guard(s_markerMutex);
+#endif
+    uint32_t id = msg.traceId.load(std::memory_order_relaxed);
+    if (!id) {
+      id = static_cast<uint32_t>(TRACE_MARKER_FIRST + s_markers.size());
+      s_markers.push_back(&msg);
+      msg.traceId.store(id, std::memory_order_release);
+    }
+    return id;
+  }
+
+  static TraceBuffer *acquireTraceBuffer()
+  {
+#ifdef PLEXIL_WITH_THREADS
+    std::lock_guard<std::mutex> const guard(s_bufferMutex);
+#endif
+    TraceBuffer *result = nullptr;
+    for (std::unique_ptr<TraceBuffer> const &buf : s_buffers) {
+      if (buf->retired.load(std::memory_order_acquire) && buf->ring.empty()) {
+        result = buf.get();
+        result->retired.store(false, std::memory_order_relaxed);
+        break;
+      }
+    }
+    if (!result) {
+      s_buffers.emplace_back(new TraceBuffer(s_bufferRecords));
+      result = s_buffers.back().get();
+    }
+    result->thread = s_nextThread++;
+    return result;
+  }
+
+  TraceRecord *beginTraceRecord(DebugMessage &msg)
+  {
+    if (!traceLogActive())
+      return nullptr;
+
+    uint32_t id = msg.traceId.load(std::memory_order_acquire);
+    if (!id)
+      id = assignTraceId(msg);
+
+    TraceBuffer *buf = t_traceBuffer.buffer;
+    if (!buf)
+      buf = t_traceBuffer.buffer = acquireTraceBuffer();
+
+    TraceRecord *rec = buf->ring.writeSlot();
+#ifndef PLEXIL_WITH_THREADS
+    // No background thread; make room now
+    if (!rec) {
+      flushTraceLog();
+      rec = buf->ring.writeSlot();
+    }
+#endif
+    if (!rec) {
+      buf->dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    rec->timestamp = traceTimestamp();
+    rec->marker = id;
+    rec->thread = buf->thread;
+    rec->nArgs = 0;
+    std::memset(rec->argTypes, 0, sizeof(rec->argTypes));
+    rec->reserved = 0;
+    return rec;
+  }
+
+  void commitTraceRecord()
+  {
+    t_traceBuffer.buffer->ring.commitWrite();
+  }
+
+  //
+  // Writing the file
+  //
+  // The functions below are called with s_flushMutex held.
+  //
+
+  // Write definitions of marker IDs assigned since the last call.
+  static void writeDefinitions()
+  {
+    std::vector<DebugMessage const *> markers;
+    {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(s_markerMutex);
+#endif
+      markers.assign(s_markers.begin() + s_markersWritten, s_markers.end());
+    }
+
+    std::string text;
+    for (DebugMessage const *msg : markers) {
+      text = msg->marker;
+      text.push_back('\0');
+      if (msg->file)
+        text.append(msg->file);
+
+      TraceRecord def = {};
+      def.marker = TRACE_MARKER_DEFINITION;
+      def.nArgs = 2;
+      def.argTypes[0] = TRACE_ARG_UINT;
+      def.args[0].u = TRACE_MARKER_FIRST + s_markersWritten++;
+      def.argTypes[1] = TRACE_ARG_UINT;
+      def.args[1].u = static_cast<uint64_t>(msg->line);
+      def.reserved = static_cast<uint32_t>(text.size());
+
+      // Pad the text to a whole number of records
+      text.resize((text.size() + sizeof(TraceRecord) - 1)
+                  / sizeof(TraceRecord) * sizeof(TraceRecord),
+                  '\0');
+      fwrite(&def, sizeof(def), 1, s_traceFile);
+      fwrite(text.data(), 1, text.size(), s_traceFile);
+    }
+  }
+
+  // Copy out the contents of every buffer, and write them to the file
+  // if it is open.
+  static void drainBuffers()
+  {
+    std::vector<TraceBuffer *> buffers;
+    {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(s_bufferMutex);
+#endif
+      buffers.reserve(s_buffers.size());
+      for (std::unique_ptr<TraceBuffer> const &buf : s_buffers)
+        buffers.push_back(buf.get());
+    }
+
+    s_pending.clear();
+    for (TraceBuffer *buf : buffers) {
+      // Take no more than is there now, so a busy thread can't keep us here
+      size_t n = buf->ring.size();
+      TraceRecord *rec;
+      while (n-- && (rec = buf->ring.readSlot())) {
+        s_pending.push_back(*rec);
+        buf->ring.commitRead();
+      }
+
+      uint64_t dropped = buf->dropped.exchange(0, std::memory_order_relaxed);
+      if (dropped) {
+        TraceRecord drop = {};
+        drop.timestamp = traceTimestamp();
+        drop.marker = TRACE_MARKER_DROPPED;
+        drop.thread = buf->thread;
+        drop.nArgs = 1;
+        drop.argTypes[0] = TRACE_ARG_UINT;
+        drop.args[0].u = dropped;
+        s_pending.push_back(drop);
+      }
+    }
+
+    if (!s_traceFile)
+      return;
+
+    // Every marker ID in s_pending was assigned before its record
+    // was published, so its definition goes out first.
+    writeDefinitions();
+    if (!s_pending.empty())
+      fwrite(s_pending.data(), sizeof(TraceRecord), s_pending.size(), s_traceFile);
+    fflush(s_traceFile);
+  }
+
+#ifdef PLEXIL_WITH_THREADS
+  static void runFlusher()
+  {
+    std::unique_lock<std::mutex> lock(s_flushMutex);
+    while (!s_stopFlusher) {
+      s_flusherCV.wait_for(lock, TRACE_FLUSH_INTERVAL);
+      drainBuffers();
+    }
+  }
+#endif
+
+  void flushTraceLog()
+  {
+#ifdef PLEXIL_WITH_THREADS
+    std::lock_guard<std::mutex> const guard(s_flushMutex);
+#endif
+    if (s_traceFile)
+      drainBuffers();
+  }
+
+  bool startTraceLog(std::string const &filename, size_t bufferRecords)
+  {
+    stopTraceLog();
+
+#ifdef PLEXIL_WITH_THREADS
+    std::lock_guard<std::mutex> const control(s_controlMutex);
+#endif
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f) {
+      warn("startTraceLog: unable to open trace file " << filename);
+      return false;
+    }
+
+    TraceFileHeader header = {};
+    memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_FILE_VERSION;
+    header.recordSize = sizeof(TraceRecord);
+    header.startTime = static_cast<uint64_t>
+      (std::chrono::duration_cast<std::chrono::nanoseconds>
+       (std::chrono::system_clock::now().time_since_epoch()).count());
+    if (fwrite(&header, sizeof(header), 1, f) != 1) {
+      warn("startTraceLog: unable to write trace file " << filename);
+      fclose(f);
+      return false;
+    }
+
+    {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(s_bufferMutex);
+#endif
+      s_bufferRecords = bufferRecords ? bufferRecords : TRACE_DEFAULT_BUFFER_RECORDS;
+    }
+
+    {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> const guard(s_flushMutex);
+#endif
+      // Discard anything recorded after a previous log was stopped
+      drainBuffers();
+      s_traceFile = f;
+      s_markersWritten = 0;
+#ifdef PLEXIL_WITH_THREADS
+      s_stopFlusher = false;
+#endif
+    }
+
+    s_startTime.store(steadyNanoseconds(), std::memory_order_relaxed);
+    g_traceLogActive.store(true, std::memory_order_release);
+
+#ifdef PLEXIL_WITH_THREADS
+    s_flusher = std::thread(runFlusher);
+#endif
+
+    static bool sl_finalizerAdded = false;
+    if (!sl_finalizerAdded) {
+      plexilAddFinalizer(&stopTraceLog);
+      sl_finalizerAdded = true;
+    }
+    return true;
+  }
+
+  void stopTraceLog()
+  {
+#ifdef PLEXIL_WITH_THREADS
+    std::lock_guard<std::mutex> const control(s_controlMutex);
+#endif
+    if (!g_traceLogActive.load(std::memory_order_acquire))
+      return;
+    g_traceLogActive.store(false, std::memory_order_release);
+
+#ifdef PLEXIL_WITH_THREADS
+    {
+      std::lock_guard<std::mutex> const guard(s_flushMutex);
+      s_stopFlusher = true;
+    }
+    s_flusherCV.notify_one();
+    s_flusher.join();
+
+    std::lock_guard<std::mutex> const guard(s_flushMutex);
+#endif
+    drainBuffers();
+    fclose(s_traceFile);
+    s_traceFile = nullptr;
+  }
+
+} // namespace PLEXIL
@@ -0,0 +1,243 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_TRACE_LOG_HH
+#define PLEXIL_TRACE_LOG_HH
+
+#include "plexil-stdint.h"
+
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+namespace PLEXIL
+{
+  // Forward reference
+  struct DebugMessage;
+
+  //
+  // Binary trace log
+  //
+  // While a trace log is running, enabled debug messages are written
+  // as fixed-size binary records into a ring buffer owned by the
+  // calling thread, instead of being formatted to the debug stream.
+  // A background thread copies the records to the trace file.  The
+  // decode-trace tool prints the file as text.
+  //
+  // A debugMsg() site records only its identity and a timestamp.  A
+  // traceMsg() site also records up to TRACE_MAX_ARGS numeric
+  // arguments.
+  //
+  // If a thread's ring buffer is full, its records are dropped and
+  // counted, and the count is written to the log.
+  //
+
+  //! \brief Maximum number of arguments in one trace record.
+  constexpr size_t TRACE_MAX_ARGS = 5;
+
+  //! \brief Types of trace record arguments.
+  enum TraceArgType : uint8_t
+    {
+     TRACE_ARG_NONE = 0,
+     TRACE_ARG_INT,     //!< int64_t
+     TRACE_ARG_UINT,    //!< uint64_t
+     TRACE_ARG_BOOL,    //!< uint64_t, 0 or 1
+     TRACE_ARG_REAL,    //!< double
+     TRACE_ARG_POINTER  //!< uint64_t
+    };
+
+  //! \brief Reserved marker IDs in trace records.
+  enum TraceMarkerId : uint32_t
+    {
+     //! Defines a marker ID.  args[0].u is the ID, args[1].u the
+     //! source line, and reserved the length of the text which
+     //! follows, padded to a whole number of records.  The text is
+     //! the marker string, a NUL, and the source file name.
+     TRACE_MARKER_DEFINITION = 0,
+
+     //! Reports records dropped by the thread.  args[0].u is the count.
+     TRACE_MARKER_DROPPED = 1,
+
+     //! The first ID assigned to a debug message.
+     TRACE_MARKER_FIRST = 2
+    };
+
+  //! \union TraceArg
+  //! \brief One argument of a trace record.
+  union TraceArg
+  {
+    int64_t i;
+    uint64_t u;
+    double r;
+  };
+
+  //! \struct TraceRecord
+  //! \brief The unit of the trace log.
+  struct TraceRecord final
+  {
+    uint64_t timestamp;                //!< Nanoseconds since the log was started.
+    uint32_t marker;                   //!< Marker ID.
+    uint16_t thread;                   //!< Index of the recording thread.
+    uint8_t nArgs;                     //!< Number of arguments.
+    uint8_t argTypes[TRACE_MAX_ARGS];  //!< TraceArgType of each argument.
+    uint32_t reserved;                 //!< Used by definition records.
+    TraceArg args[TRACE_MAX_ARGS];     //!< The arguments.
+  };
+
+  static_assert(sizeof(TraceRecord) == 64, "TraceRecord must be 64 bytes");
+
+  //! \struct TraceFileHeader
+  //! \brief The first record of a trace file.
+  struct TraceFileHeader final
+  {
+    char magic[8];          //!< TRACE_FILE_MAGIC
+    uint32_t version;       //!< TRACE_FILE_VERSION
+    uint32_t recordSize;    //!< sizeof(TraceRecord)
+    uint64_t startTime;     //!< System clock at start, nanoseconds since the epoch.
+    char padding[40];
+  };
+
+  static_assert(sizeof(TraceFileHeader) == sizeof(TraceRecord),
+                "TraceFileHeader must be the size of a TraceRecord");
+
+  constexpr char const TRACE_FILE_MAGIC[8] = {'P', 'L', 'E', 'X', 'T', 'R', 'C', '\0'};
+  constexpr uint32_t TRACE_FILE_VERSION = 1;
+
+  //! \brief Default capacity of each thread's ring buffer, in records.
+  constexpr size_t TRACE_DEFAULT_BUFFER_RECORDS = 8192;
+
+  //! \brief Start recording debug messages to the named file.
+  //! \param filename The file name.
+  //! \param bufferRecords The capacity of each thread's ring buffer.
+  //! \return True if the file was opened, false otherwise.
+  //! \note Stops any trace log already running.
+  bool startTraceLog(std::string const &filename,
+                     size_t bufferRecords = TRACE_DEFAULT_BUFFER_RECORDS);
+
+  //! \brief Write all buffered records, and close the trace file.
+  void stopTraceLog();
+
+  //! \brief Write all buffered records to the trace file.
+  //! \note Normally done by the background thread.
+  void flushTraceLog();
+
+  //! \brief Flag which is true while a trace log is running.
+  //! \note Use traceLogActive() to test it.
+  extern std::atomic<bool> g_traceLogActive;
+
+  //! \brief Is a trace log running?
+  //! \return True if running, false if not.
+  inline bool traceLogActive()
+  {
+    return g_traceLogActive.load(std::memory_order_relaxed);
+  }
+
+  //! \brief Get the calling thread's next free trace record, with
+  //!        the marker, thread and timestamp filled in.
+  //! \param msg The debug message being recorded.
+  //! \return Pointer to the record; null if the trace log is not
+  //!         running or the thread's buffer is full.
+  //! \note The caller must call commitTraceRecord() if the result is
+  //!       not null.
+  TraceRecord *beginTraceRecord(DebugMessage &msg);
+
+  //! \brief Publish the record returned by beginTraceRecord().
+  void commitTraceRecord();
+
+  //
+  // Argument capture
+  //
+
+  template <typename T>
+  inline typename std::enable_if<std::is_same<T, bool>::value>::type
+  setTraceArg(TraceRecord &rec, size_t n, T val)
+  {
+    rec.argTypes[n] = TRACE_ARG_BOOL;
+    rec.args[n].u = val ? 1 : 0;
+  }
+
+  template <typename T>
+  inline typename std::enable_if<(std::is_integral<T>::value && std::is_signed<T>::value)
+                                 || std::is_enum<T>::value>::type
+  setTraceArg(TraceRecord &rec, size_t n, T val)
+  {
+    rec.argTypes[n] = TRACE_ARG_INT;
+    rec.args[n].i = static_cast<int64_t>(val);
+  }
+
+  template <typename T>
+  inline typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value
+                                 && !std::is_same<T, bool>::value>::type
+  setTraceArg(TraceRecord &rec, size_t n, T val)
+  {
+    rec.argTypes[n] = TRACE_ARG_UINT;
+    rec.args[n].u = static_cast<uint64_t>(val);
+  }
+
+  template <typename T>
+  inline typename std::enable_if<std::is_floating_point<T>::value>::type
+  setTraceArg(TraceRecord &rec, size_t n, T val)
+  {
+    rec.argTypes[n] = TRACE_ARG_REAL;
+    rec.args[n].r = static_cast<double>(val);
+  }
+
+  template <typename T>
+  inline void setTraceArg(TraceRecord &rec, size_t n, T const *val)
+  {
+    static_assert(!std::is_same<typename std::remove_cv<T>::type, char>::value,
+                  "Strings can't be recorded in the trace log");
+    rec.argTypes[n] = TRACE_ARG_POINTER;
+    rec.args[n].u = reinterpret_cast<uintptr_t>(val);
+  }
+
+  inline void setTraceArgs(TraceRecord & /* rec */, size_t /* n */)
+  {
+  }
+
+  template <typename T, typename... Rest>
+  inline void setTraceArgs(TraceRecord &rec, size_t n, T const &val, Rest const &... rest)
+  {
+    setTraceArg(rec, n, val);
+    setTraceArgs(rec, n + 1, rest...);
+  }
+
+  //! \brief Print trace arguments as text, separated by spaces.
+  inline void printTraceArgs(std::ostream & /* os */)
+  {
+  }
+
+  template <typename T, typename... Rest>
+  inline void printTraceArgs(std::ostream &os, T const &val, Rest const &... rest)
+  {
+    os << ' ' << val;
+    printTraceArgs(os, rest...);
+  }
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_TRACE_LOG_HH
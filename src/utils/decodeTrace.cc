@@ -0,0 +1,195 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// decodeTrace - print a binary trace log as text
+//
+// Each line shows the time since the log was started, the index of
+// the recording thread, the marker and source location of the debug
+// message, and its arguments.
+//
+
+#include "TraceLog.hh"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>  // memcmp(), strcmp(), strlen()
+#include <map>
+#include <string>
+#include <vector>
+
+using PLEXIL::TraceFileHeader;
+using PLEXIL::TraceRecord;
+
+struct MarkerInfo
+{
+  std::string marker;
+  std::string file;
+  uint64_t line;
+};
+
+static void usage()
+{
+  std::fprintf(stderr, "Usage: decodeTrace [-h] <trace-file>\n");
+}
+
+static void printArg(TraceRecord const &rec, size_t n)
+{
+  switch (rec.argTypes[n]) {
+  case PLEXIL::TRACE_ARG_INT:
+    std::printf(" %" PRId64, rec.args[n].i);
+    break;
+
+  case PLEXIL::TRACE_ARG_UINT:
+    std::printf(" %" PRIu64, rec.args[n].u);
+    break;
+
+  case PLEXIL::TRACE_ARG_BOOL:
+    std::printf(" %s", rec.args[n].u ? "true" : "false");
+    break;
+
+  case PLEXIL::TRACE_ARG_REAL:
+    std::printf(" %.17g", rec.args[n].r);
+    break;
+
+  case PLEXIL::TRACE_ARG_POINTER:
+    std::printf(" 0x%" PRIx64, rec.args[n].u);
+    break;
+
+  default:
+    std::printf(" ?");
+    break;
+  }
+}
+
+static int decodeTrace(char const *filename)
+{
+  FILE *f = std::fopen(filename, "rb");
+  if (!f) {
+    std::fprintf(stderr, "Unable to open trace file %s\n", filename);
+    return 1;
+  }
+
+  TraceFileHeader header;
+  if (std::fread(&header, sizeof(header), 1, f) != 1
+      || std::memcmp(header.magic, PLEXIL::TRACE_FILE_MAGIC, sizeof(header.magic))) {
+    std::fprintf(stderr, "%s is not a trace file\n", filename);
+    std::fclose(f);
+    return 1;
+  }
+  if (header.version != PLEXIL::TRACE_FILE_VERSION
+      || header.recordSize != sizeof(TraceRecord)) {
+    std::fprintf(stderr, "%s: unsupported trace file version %u\n",
+                 filename, header.version);
+    std::fclose(f);
+    return 1;
+  }
+
+  std::map<uint32_t, MarkerInfo> markers;
+  std::vector<TraceRecord> records;
+  TraceRecord rec;
+  std::vector<char> text;
+  while (std::fread(&rec, sizeof(rec), 1, f) == 1) {
+    if (rec.marker != PLEXIL::TRACE_MARKER_DEFINITION) {
+      records.push_back(rec);
+      continue;
+    }
+
+    size_t padded = (rec.reserved + sizeof(TraceRecord) - 1)
+      / sizeof(TraceRecord) * sizeof(TraceRecord);
+    text.resize(padded + 1);
+    if (std::fread(text.data(), 1, padded, f) != padded) {
+      std::fprintf(stderr, "%s: truncated marker definition\n", filename);
+      break;
+    }
+    text[rec.reserved] = '\0';
+    text[padded] = '\0';
+    MarkerInfo &info = markers[static_cast<uint32_t>(rec.args[0].u)];
+    info.marker = text.data();
+    if (info.marker.size() < rec.reserved)
+      info.file = text.data() + info.marker.size() + 1;
+    info.line = rec.args[1].u;
+  }
+  std::fclose(f);
+
+  // Each thread's records are in order, but the threads are interleaved
+  std::stable_sort(records.begin(), records.end(),
+                   [](TraceRecord const &a, TraceRecord const &b)
+                   { return a.timestamp < b.timestamp; });
+
+  for (TraceRecord const &r : records) {
+    std::printf("%" PRIu64 ".%09" PRIu64 " T%u ",
+                r.timestamp / 1000000000, r.timestamp % 1000000000,
+                static_cast<unsigned>(r.thread));
+    if (r.marker == PLEXIL::TRACE_MARKER_DROPPED) {
+      std::printf("*** %" PRIu64 " records dropped ***\n", r.args[0].u);
+      continue;
+    }
+
+    std::map<uint32_t, MarkerInfo>::const_iterator it = markers.find(r.marker);
+    if (it == markers.end())
+      std::printf("[#%u]", r.marker);
+    else {
+      std::printf("[%s]", it->second.marker.c_str());
+      if (!it->second.file.empty())
+        std::printf(" %s:%" PRIu64, it->second.file.c_str(), it->second.line);
+    }
+    size_t nArgs = std::min<size_t>(r.nArgs, PLEXIL::TRACE_MAX_ARGS);
+    for (size_t i = 0; i < nArgs; ++i)
+      printArg(r, i);
+    std::printf("\n");
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  char const *traceFile = nullptr;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-h")) {
+      usage();
+      return 0;
+    }
+    else {
+      if (traceFile) {
+        std::fprintf(stderr, "Multiple trace files specified\n");
+        usage();
+        return 1;
+      }
+      traceFile = argv[i];
+    }
+  }
+
+  if (!traceFile) {
+    std::fprintf(stderr, "No trace file specified\n");
+    usage();
+    return 1;
+  }
+
+  return decodeTrace(traceFile);
+}
@@ -0,0 +1,165 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "Error.hh"
+#include "PlanArena.hh"
+#include "TestSupport.hh"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace PLEXIL;
+
+namespace
+{
+  struct ArenaTestObject : public ArenaAllocated
+  {
+    ArenaTestObject(int v)
+      : name("arena test object"),
+        value(v)
+    {
+      ++s_live;
+    }
+
+    virtual ~ArenaTestObject()
+    {
+      --s_live;
+    }
+
+    std::string name;
+    int value;
+
+    static int s_live;
+  };
+
+  int ArenaTestObject::s_live = 0;
+
+  struct BigArenaTestObject : public ArenaTestObject
+  {
+    BigArenaTestObject(int v)
+      : ArenaTestObject(v)
+    {
+      payload[0] = payload[sizeof(payload) - 1] = 'x';
+    }
+
+    char payload[PlanArena::CHUNK_SIZE];
+  };
+}
+
+static bool isAligned(void const *ptr)
+{
+  return reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t) == 0;
+}
+
+static bool testHeapAllocation()
+{
+  size_t arenas = PlanArena::liveArenaCount();
+  ArenaTestObject *obj = new ArenaTestObject(1);
+  assertTrue_1(isAligned(obj));
+  assertTrue_1(PlanArena::liveArenaCount() == arenas);
+  assertTrue_1(ArenaTestObject::s_live == 1);
+  delete obj;
+  assertTrue_1(ArenaTestObject::s_live == 0);
+  return true;
+}
+
+static bool testArenaLifetime()
+{
+  size_t arenas = PlanArena::liveArenaCount();
+  std::vector<ArenaTestObject *> objs;
+  {
+    PlanArena::Scope scope;
+    assertTrue_1(PlanArena::liveArenaCount() == arenas + 1);
+    for (int i = 0; i < 10000; ++i) {
+      objs.push_back(new ArenaTestObject(i));
+      assertTrue_1(isAligned(objs.back()));
+    }
+    {
+      // Nested scope shares the arena
+      PlanArena::Scope inner;
+      objs.push_back(new BigArenaTestObject(10000));
+      assertTrue_1(isAligned(objs.back()));
+      assertTrue_1(PlanArena::liveArenaCount() == arenas + 1);
+    }
+    objs.push_back(new ArenaTestObject(10001));
+
+    bool *flags = PlanArena::allocateArray<bool>(17);
+    for (size_t i = 0; i < 17; ++i)
+      assertTrue_1(!flags[i]);
+    PlanArena::deallocate(flags);
+  }
+
+  // Objects are intact after the scope has ended
+  assertTrue_1(PlanArena::liveArenaCount() == arenas + 1);
+  assertTrue_1(ArenaTestObject::s_live == 10002);
+  for (size_t i = 0; i < objs.size(); ++i) {
+    assertTrue_1(objs[i]->value == (int) i);
+    assertTrue_1(objs[i]->name == "arena test object");
+  }
+
+  // Objects created after the scope ended come from the heap
+  ArenaTestObject *heapObj = new ArenaTestObject(-1);
+
+  // Arena is released with its last object
+  ArenaTestObject *last = objs.back();
+  objs.pop_back();
+  for (ArenaTestObject *obj : objs)
+    delete obj;
+  assertTrue_1(PlanArena::liveArenaCount() == arenas + 1);
+  delete last;
+  assertTrue_1(PlanArena::liveArenaCount() == arenas);
+  assertTrue_1(ArenaTestObject::s_live == 1);
+
+  delete heapObj;
+  assertTrue_1(ArenaTestObject::s_live == 0);
+  return true;
+}
+
+static bool testEmptyArena()
+{
+  size_t arenas = PlanArena::liveArenaCount();
+  {
+    PlanArena::Scope scope;
+    delete new ArenaTestObject(0);
+  }
+  assertTrue_1(PlanArena::liveArenaCount() == arenas);
+  {
+    PlanArena::Scope scope;
+  }
+  assertTrue_1(PlanArena::liveArenaCount() == arenas);
+  return true;
+}
+
+bool PlanArenaTest()
+{
+  Error::doThrowExceptions();
+
+  runTest(testHeapAllocation);
+  runTest(testArenaLifetime);
+  runTest(testEmptyArena);
+  return true;
+}
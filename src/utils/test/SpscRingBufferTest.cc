@@ -0,0 +1,157 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "plexil-config.h"
+
+#include "Error.hh"
+#include "SpscRingBuffer.hh"
+#include "TestSupport.hh"
+
+#ifdef PLEXIL_WITH_THREADS
+#include <thread>
+#endif
+
+#include <vector>
+
+using namespace PLEXIL;
+
+static bool testRingBufferBasics()
+{
+  SpscRingBuffer<int> ring(4);
+  assertTrue_1(ring.capacity() == 4);
+  assertTrue_1(ring.empty());
+  assertTrue_1(ring.size() == 0);
+  assertTrue_1(ring.readSlot() == nullptr);
+
+  int item = -1;
+  assertTrue_1(!ring.pop(item));
+  assertTrue_1(item == -1);
+
+  // Fill it
+  for (int i = 0; i < 4; ++i) {
+    assertTrue_1(ring.push(i));
+    assertTrue_1(ring.size() == (size_t) i + 1);
+  }
+  assertTrue_1(!ring.push(4));
+  assertTrue_1(ring.writeSlot() == nullptr);
+  assertTrue_1(ring.size() == 4);
+
+  // Drain it in order
+  for (int i = 0; i < 4; ++i) {
+    assertTrue_1(ring.pop(item));
+    assertTrue_1(item == i);
+  }
+  assertTrue_1(ring.empty());
+  assertTrue_1(!ring.pop(item));
+
+  // Wrap around several times
+  for (int i = 0; i < 10; ++i) {
+    assertTrue_1(ring.push(i));
+    assertTrue_1(ring.push(i + 100));
+    assertTrue_1(ring.pop(item));
+    assertTrue_1(item == i);
+    assertTrue_1(ring.pop(item));
+    assertTrue_1(item == i + 100);
+  }
+  assertTrue_1(ring.empty());
+
+  return true;
+}
+
+static bool testRingBufferSlotReuse()
+{
+  SpscRingBuffer<std::vector<int> > ring(2);
+
+  std::vector<int> *slot = ring.writeSlot();
+  assertTrue_1(slot);
+  assertTrue_1(slot->empty());
+  slot->push_back(1);
+  slot->push_back(2);
+  // Not visible until committed
+  assertTrue_1(ring.readSlot() == nullptr);
+  ring.commitWrite();
+
+  std::vector<int> *rslot = ring.readSlot();
+  assertTrue_1(rslot == slot);
+  assertTrue_1(rslot->size() == 2);
+  assertTrue_1((*rslot)[0] == 1 && (*rslot)[1] == 2);
+  size_t cap = rslot->capacity();
+  rslot->clear();
+  ring.commitRead();
+
+  // Writer gets the other slot, then the first one again with its storage intact
+  slot = ring.writeSlot();
+  assertTrue_1(slot != rslot);
+  ring.commitWrite();
+  assertTrue_1(ring.readSlot() == slot);
+  ring.commitRead();
+  slot = ring.writeSlot();
+  assertTrue_1(slot == rslot);
+  assertTrue_1(slot->empty());
+  assertTrue_1(slot->capacity() == cap);
+
+  return true;
+}
+
+#ifdef PLEXIL_WITH_THREADS
+static bool testRingBufferThreads()
+{
+  size_t const N = 100000;
+  SpscRingBuffer<size_t> ring(64);
+  std::thread producer([&ring, N]() -> void
+                       {
+                         for (size_t i = 0; i < N; ++i)
+                           while (!ring.push(i))
+                             std::this_thread::yield();
+                       });
+  size_t expected = 0;
+  size_t item;
+  bool inOrder = true;
+  while (expected < N) {
+    if (ring.pop(item)) {
+      inOrder = inOrder && (item == expected);
+      ++expected;
+    }
+    else
+      std::this_thread::yield();
+  }
+  producer.join();
+  assertTrue_1(inOrder);
+  assertTrue_1(ring.empty());
+  return true;
+}
+#endif
+
+bool SpscRingBufferTest()
+{
+  Error::doThrowExceptions();
+
+  runTest(testRingBufferBasics);
+  runTest(testRingBufferSlotReuse);
+#ifdef PLEXIL_WITH_THREADS
+  runTest(testRingBufferThreads);
+#endif
+  return true;
+}
@@ -0,0 +1,235 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "plexil-config.h"
+
+#include "Debug.hh"
+#include "Error.hh"
+#include "TestSupport.hh"
+
+#ifndef NO_DEBUG_MESSAGE_SUPPORT
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef PLEXIL_WITH_THREADS
+#include <thread>
+#endif
+
+using namespace PLEXIL;
+
+static char const *TRACE_TEST_FILE = "trace-test.trc";
+
+struct TraceContents
+{
+  std::map<uint32_t, std::string> markers;
+  std::vector<TraceRecord> records;
+};
+
+static bool readTraceFile(TraceContents &contents)
+{
+  FILE *f = fopen(TRACE_TEST_FILE, "rb");
+  if (!f)
+    return false;
+  TraceFileHeader header;
+  bool result = fread(&header, sizeof(header), 1, f) == 1
+    && !memcmp(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic))
+    && header.version == TRACE_FILE_VERSION
+    && header.recordSize == sizeof(TraceRecord);
+
+  TraceRecord rec;
+  while (result && fread(&rec, sizeof(rec), 1, f) == 1) {
+    if (rec.marker != TRACE_MARKER_DEFINITION) {
+      contents.records.push_back(rec);
+      continue;
+    }
+    size_t padded = (rec.reserved + sizeof(rec) - 1) / sizeof(rec) * sizeof(rec);
+    std::vector<char> text(padded + 1, '\0');
+    result = fread(text.data(), 1, padded, f) == padded;
+    contents.markers[(uint32_t) rec.args[0].u] = text.data();
+  }
+  fclose(f);
+  return result;
+}
+
+static uint32_t findMarker(TraceContents const &contents, char const *marker)
+{
+  for (std::pair<uint32_t const, std::string> const &entry : contents.markers)
+    if (entry.second == marker)
+      return entry.first;
+  return 0;
+}
+
+static bool testTraceRoundTrip()
+{
+  std::istringstream config("TraceLogTest");
+  readDebugConfigStream(config);
+
+  int local = 0;
+  assertTrue_1(startTraceLog(TRACE_TEST_FILE));
+  assertTrue_1(traceLogActive());
+  traceMsg("TraceLogTest:args", -3, 42u, true, 2.5, &local);
+  debugMsg("TraceLogTest:plain", " not recorded " << local);
+  traceMsg("TraceLogTest:none");
+  traceMsg("NotEnabled:args", 1);
+  stopTraceLog();
+  assertTrue_1(!traceLogActive());
+
+  TraceContents contents;
+  assertTrue_1(readTraceFile(contents));
+  assertTrue_1(contents.markers.size() == 3);
+  assertTrue_1(contents.records.size() == 3);
+
+  TraceRecord const &args = contents.records[0];
+  assertTrue_1(args.marker == findMarker(contents, "TraceLogTest:args"));
+  assertTrue_1(args.nArgs == 5);
+  assertTrue_1(args.argTypes[0] == TRACE_ARG_INT && args.args[0].i == -3);
+  assertTrue_1(args.argTypes[1] == TRACE_ARG_UINT && args.args[1].u == 42);
+  assertTrue_1(args.argTypes[2] == TRACE_ARG_BOOL && args.args[2].u == 1);
+  assertTrue_1(args.argTypes[3] == TRACE_ARG_REAL && args.args[3].r == 2.5);
+  assertTrue_1(args.argTypes[4] == TRACE_ARG_POINTER
+               && args.args[4].u == reinterpret_cast<uintptr_t>(&local));
+
+  TraceRecord const &plain = contents.records[1];
+  assertTrue_1(plain.marker == findMarker(contents, "TraceLogTest:plain"));
+  assertTrue_1(plain.nArgs == 0);
+  assertTrue_1(plain.thread == args.thread);
+  assertTrue_1(plain.timestamp >= args.timestamp);
+
+  TraceRecord const &none = contents.records[2];
+  assertTrue_1(none.marker == findMarker(contents, "TraceLogTest:none"));
+  assertTrue_1(none.nArgs == 0);
+
+  // A second log defines the markers again
+  assertTrue_1(startTraceLog(TRACE_TEST_FILE));
+  traceMsg("TraceLogTest:args", 1, 2);
+  stopTraceLog();
+  TraceContents second;
+  assertTrue_1(readTraceFile(second));
+  assertTrue_1(second.records.size() == 1);
+  assertTrue_1(second.records[0].nArgs == 2);
+  assertTrue_1(second.markers.count(second.records[0].marker));
+
+  remove(TRACE_TEST_FILE);
+  return true;
+}
+
+static bool testDebugTraceMsg()
+{
+  std::istringstream config("TraceLogTest");
+  readDebugConfigStream(config);
+
+  // Formatted when no trace log is running
+  std::ostringstream text;
+  std::ostream &oldStream = getDebugOutputStream();
+  setDebugOutputStream(text);
+  for (int i = 0; i < 2; ++i) {
+    if (i)
+      assertTrue_1(startTraceLog(TRACE_TEST_FILE));
+    debugTraceMsg("TraceLogTest:both", " value " << 7 << " of " << 9, 7, 9);
+  }
+  stopTraceLog();
+  setDebugOutputStream(oldStream);
+  assertTrue_1(text.str() == "[TraceLogTest:both] value 7 of 9\n");
+
+  // Recorded with its values when one is
+  TraceContents contents;
+  assertTrue_1(readTraceFile(contents));
+  assertTrue_1(contents.records.size() == 1);
+  TraceRecord const &both = contents.records[0];
+  assertTrue_1(both.marker == findMarker(contents, "TraceLogTest:both"));
+  assertTrue_1(both.nArgs == 2);
+  assertTrue_1(both.args[0].i == 7 && both.args[1].i == 9);
+
+  remove(TRACE_TEST_FILE);
+  return true;
+}
+
+#ifdef PLEXIL_WITH_THREADS
+static bool testTraceDropped()
+{
+  size_t const N = 1000;
+
+  // The buffer size applies to threads which start recording after this
+  assertTrue_1(startTraceLog(TRACE_TEST_FILE, 4));
+  std::thread writer([N]() -> void
+                     {
+                       for (size_t i = 0; i < N; ++i)
+                         traceMsg("TraceLogTest:drop", i);
+                     });
+  writer.join();
+  stopTraceLog();
+
+  TraceContents contents;
+  assertTrue_1(readTraceFile(contents));
+  uint32_t marker = findMarker(contents, "TraceLogTest:drop");
+  assertTrue_1(marker);
+  size_t recorded = 0;
+  uint64_t dropped = 0;
+  uint64_t lastArg = 0;
+  bool inOrder = true;
+  for (TraceRecord const &rec : contents.records) {
+    if (rec.marker == TRACE_MARKER_DROPPED)
+      dropped += rec.args[0].u;
+    else if (rec.marker == marker) {
+      inOrder = inOrder && (!recorded || rec.args[0].u > lastArg);
+      lastArg = rec.args[0].u;
+      ++recorded;
+    }
+  }
+  assertTrue_1(inOrder);
+  assertTrue_1(recorded >= 4);
+  assertTrue_1(recorded + dropped == N);
+
+  remove(TRACE_TEST_FILE);
+  return true;
+}
+#endif
+
+bool TraceLogTest()
+{
+  Error::doThrowExceptions();
+
+  runTest(testTraceRoundTrip);
+  runTest(testDebugTraceMsg);
+#ifdef PLEXIL_WITH_THREADS
+  runTest(testTraceDropped);
+#endif
+  return true;
+}
+
+#else
+
+bool TraceLogTest()
+{
+  return true;
+}
+
+#endif // NO_DEBUG_MESSAGE_SUPPORT
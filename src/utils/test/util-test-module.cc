@@ -80,8 +80,11 @@
 // Tests not in this source file
 
 extern bool LinkedQueueTest();
+extern bool PlanArenaTest();
 extern bool SimpleMapTest();
 extern bool SimpleSetTest();
+extern bool SpscRingBufferTest();
+extern bool TraceLogTest();
 extern bool bitsetUtilsTest();
 
 /**
@@ -490,6 +493,9 @@ void UtilModuleTests::runTests(std::string /* path */)
   runTestSuite(SimpleMapTest);
   runTestSuite(SimpleSetTest);
   runTestSuite(LinkedQueueTest);
+  runTestSuite(PlanArenaTest);
+  runTestSuite(SpscRingBufferTest);
+  runTestSuite(TraceLogTest);
   runTestSuite(bitsetUtilsTest);
 
   // Do cleanup
@@ -29,267 +29,347 @@
 #include "ArrayImpl.hh"
 #include "PlanError.hh"
 
+#include <atomic>
+#include <functional> // std::hash
+#include <memory>     // std::unique_ptr
+
 namespace PLEXIL
 {
 
   //
-  // Constructors
+  // Shared storage
   //
 
-  Value::Value()
-    : realValue(0.0),
-      m_type(UNKNOWN_TYPE),
-      m_known(false)
-  {}
-
-  Value::Value(Value const &other)
-    : realValue(0.0),
-      m_type(other.m_type),
-      m_known(other.m_known)
+  //! \brief Reference counted holder for an immutable String or Array.
+  //!        A Value holds only a pointer to it, so scalar Values stay small.
+  struct Value::Shared
   {
-    if (!m_known)
-      return;
-    switch (m_type) {
-      // Unknown - do nothing
-    case UNKNOWN_TYPE:
-      return;
+    Shared()
+      : refCount(1)
+    {
+    }
 
-      // Immediate data - copy it
-    case BOOLEAN_TYPE:
-      booleanValue = other.booleanValue;
-      break;
+    virtual ~Shared() = default;
 
-    case INTEGER_TYPE:
-      integerValue = other.integerValue;
-      break;
+    //! \brief Add a reference.
+    void acquire()
+    {
+      refCount.fetch_add(1, std::memory_order_relaxed);
+    }
 
-    case REAL_TYPE:
-      realValue = other.realValue;
-      break;
+    //! \brief Drop a reference, deleting this object if it was the last.
+    void release()
+    {
+      if (refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+    }
 
-    case NODE_STATE_TYPE:
-      stateValue = other.stateValue;
-      break;
-      
-    case OUTCOME_TYPE:
-      outcomeValue = other.outcomeValue;
-      break;
+    std::atomic<uint32_t> refCount;
+  };
 
-    case FAILURE_TYPE:
-      failureValue = other.failureValue;
-      break;
-      
-    case COMMAND_HANDLE_TYPE:
-      commandHandleValue = other.commandHandleValue;
-      break;
+  //! \brief Shared holder for one object of type T.
+  //! \note The object must not be modified once the holder is shared.
+  template <typename T>
+  struct Value::SharedObject final : public Value::Shared
+  {
+    template <typename... Args>
+    SharedObject(Args &&... args)
+      : Shared(),
+        object(std::forward<Args>(args)...)
+    {
+    }
 
-      // Copy the actual value
-    case STRING_TYPE:
-      new (&stringValue) std::unique_ptr<String>(new String(*other.stringValue));
-      break;
+    T object;
+  };
+
+  String const *Value::stringPointer() const
+  {
+    return &static_cast<SharedObject<String> const *>(sharedValue)->object;
+  }
 
-      // Copy the entire array
+  Array const *Value::arrayPointer() const
+  {
+    switch (m_type) {
     case BOOLEAN_ARRAY_TYPE:
+      return &static_cast<SharedObject<BooleanArray> const *>(sharedValue)->object;
+
     case INTEGER_ARRAY_TYPE:
+      return &static_cast<SharedObject<IntegerArray> const *>(sharedValue)->object;
+
     case REAL_ARRAY_TYPE:
+      return &static_cast<SharedObject<RealArray> const *>(sharedValue)->object;
+
     case STRING_ARRAY_TYPE:
-      new (&arrayValue) std::unique_ptr<Array>(other.arrayValue->clone());
-      break;
+      return &static_cast<SharedObject<StringArray> const *>(sharedValue)->object;
 
     default:
-      errorMsg("Value copy constructor: unknown type");
-      return;
+      errorMsg("Value::arrayPointer: not an array");
+      return nullptr;
     }
   }
 
-  Value::Value(Value &&other)
-    : realValue(0.0),
-      m_type(other.m_type),
-      m_known(other.m_known)
+  void Value::initString(String const &val)
   {
-    if (!m_known)
-      return;
-
-    switch (m_type) {
-      // Unknown - do nothing
-    case UNKNOWN_TYPE:
-      return;
+    sharedValue = new SharedObject<String>(val);
+    m_storage = STORAGE_SHARED;
+    m_type = STRING_TYPE;
+    m_known = true;
+  }
 
-      // Immediate data - copy it
-    case BOOLEAN_TYPE:
-      booleanValue = other.booleanValue;
-      break;
+  void Value::initString(String &&val)
+  {
+    sharedValue = new SharedObject<String>(std::move(val));
+    m_storage = STORAGE_SHARED;
+    m_type = STRING_TYPE;
+    m_known = true;
+  }
 
-    case INTEGER_TYPE:
-      integerValue = other.integerValue;
-      break;
+  void Value::initArray(Shared *ary, ValueType typ)
+  {
+    sharedValue = ary;
+    m_storage = STORAGE_SHARED;
+    m_type = typ;
+    m_known = true;
+  }
 
-    case REAL_TYPE:
+  void Value::copyFrom(Value const &other)
+  {
+    if (other.m_storage == STORAGE_SHARED) {
+      // Share the immutable value
+      sharedValue = other.sharedValue;
+      sharedValue->acquire();
+    }
+    else {
+      // Immediate data - copy the largest member
       realValue = other.realValue;
-      break;
+    }
+    m_type = other.m_type;
+    m_known = other.m_known;
+    m_storage = other.m_storage;
+  }
 
-    case NODE_STATE_TYPE:
-      stateValue = other.stateValue;
-      break;
+  void Value::moveFrom(Value &&other)
+  {
+    if (other.m_storage == STORAGE_SHARED)
+      sharedValue = other.sharedValue; // take over the other's reference
+    else
+      realValue = other.realValue; // immediate data - copy the largest member
+    m_type = other.m_type;
+    m_known = other.m_known;
+    m_storage = other.m_storage;
 
-    case OUTCOME_TYPE:
-      outcomeValue = other.outcomeValue;
-      break;
+    // Leave the other a typed unknown
+    other.realValue = 0;
+    other.m_known = false;
+    other.m_storage = STORAGE_IMMEDIATE;
+  }
 
-    case FAILURE_TYPE:
-      failureValue = other.failureValue;
-      break;
-      
-    case COMMAND_HANDLE_TYPE:
-      commandHandleValue = other.commandHandleValue;
-      break;
+  //
+  // Constructors
+  //
 
-      // Pointer data - move it
-    case STRING_TYPE:
-      new (&stringValue) std::unique_ptr<String>(std::move(other.stringValue));
-      break;
+  Value::Value()
+    : realValue(0.0),
+      m_type(UNKNOWN_TYPE),
+      m_known(false),
+      m_storage(STORAGE_IMMEDIATE)
+  {}
 
-      // Copy the entire array
-    case BOOLEAN_ARRAY_TYPE:
-    case INTEGER_ARRAY_TYPE:
-    case REAL_ARRAY_TYPE:
-    case STRING_ARRAY_TYPE:
-      new (&arrayValue) std::unique_ptr<Array>(std::move(other.arrayValue));
-      break;
+  Value::Value(Value const &other)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
+  {
+    copyFrom(other);
+  }
 
-    default:
-      errorMsg("Value move constructor: unknown type");
-      break;
-    }
+  Value::Value(Value &&other)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
+  {
+    moveFrom(std::move(other));
   }
 
   Value::Value(Boolean val)
     : booleanValue(val),
       m_type(BOOLEAN_TYPE),
-      m_known(true)
+      m_known(true),
+      m_storage(STORAGE_IMMEDIATE)
   {
   }
 
   Value::Value(NodeState val)
     : stateValue(val),
       m_type(NODE_STATE_TYPE),
-      m_known(true)
+      m_known(true),
+      m_storage(STORAGE_IMMEDIATE)
   {
   }
 
   Value::Value(NodeOutcome val)
     : outcomeValue(val),
       m_type(OUTCOME_TYPE),
-      m_known(true)
+      m_known(true),
+      m_storage(STORAGE_IMMEDIATE)
   {
   }
 
   Value::Value(FailureType val)
     : failureValue(val),
       m_type(FAILURE_TYPE),
-      m_known(true)
+      m_known(true),
+      m_storage(STORAGE_IMMEDIATE)
   {
   }
 
   Value::Value(CommandHandleValue val)
     : commandHandleValue(val),
       m_type(COMMAND_HANDLE_TYPE),
-      m_known(true)
+      m_known(true),
+      m_storage(STORAGE_IMMEDIATE)
   {
   }
 
   // Typed unknown
   Value::Value(ValueType typ)
-    : m_type(typ),
-      m_known(false)
+    : realValue(0.0),
+      m_type(typ),
+      m_known(false),
+      m_storage(STORAGE_IMMEDIATE)
   {
-    switch (m_type) {
-      // Ensure proper initialization for pointer
-    case STRING_TYPE:
-      new (&stringValue) std::unique_ptr<String>();
-      break;
-
-    case BOOLEAN_ARRAY_TYPE:
-    case INTEGER_ARRAY_TYPE:
-    case REAL_ARRAY_TYPE:
-    case STRING_ARRAY_TYPE:
-      new (&arrayValue) std::unique_ptr<Array>();
-      break;
-
-    default:
-      break; // don't care
-    }
   }
       
   Value::Value(Integer val)
     : integerValue(val),
       m_type(INTEGER_TYPE),
-      m_known(true)
+      m_known(true),
+      m_storage(STORAGE_IMMEDIATE)
   {
   }
 
   Value::Value(Real val)
     : realValue(val),
       m_type(REAL_TYPE),
-      m_known(true)
+      m_known(true),
+      m_storage(STORAGE_IMMEDIATE)
   {
   }
 
   Value::Value(String const &val)
-    : stringValue(new String(val)),
-      m_type(STRING_TYPE),
-      m_known(true)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
+  {
+    initString(val);
+  }
+
+  Value::Value(String &&val)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
   {
+    initString(std::move(val));
   }
 
   Value::Value(char const *val)
-    : stringValue(new String(val)),
-      m_type(STRING_TYPE),
-      m_known(true)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
   {
+    initString(String(val));
   }
 
   Value::Value(Array const &val)
-    : arrayValue(val.clone()),
-      m_type(arrayType(val.getElementType())),
-      m_known(true)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
   {
+    switch (val.getElementType()) {
+    case BOOLEAN_TYPE:
+      initArray(new SharedObject<BooleanArray>(static_cast<BooleanArray const &>(val)),
+                BOOLEAN_ARRAY_TYPE);
+      break;
+
+    case INTEGER_TYPE:
+      initArray(new SharedObject<IntegerArray>(static_cast<IntegerArray const &>(val)),
+                INTEGER_ARRAY_TYPE);
+      break;
+
+    case REAL_TYPE:
+      initArray(new SharedObject<RealArray>(static_cast<RealArray const &>(val)),
+                REAL_ARRAY_TYPE);
+      break;
+
+    case STRING_TYPE:
+      initArray(new SharedObject<StringArray>(static_cast<StringArray const &>(val)),
+                STRING_ARRAY_TYPE);
+      break;
+
+    default:
+      errorMsg("Value constructor: Unknown or unimplemented array element type");
+      break;
+    }
   }
 
   Value::Value(BooleanArray const &val)
-    : arrayValue(val.clone()),
-      m_type(BOOLEAN_ARRAY_TYPE),
-      m_known(true)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
   {
+    initArray(new SharedObject<BooleanArray>(val), BOOLEAN_ARRAY_TYPE);
   }
 
   Value::Value(IntegerArray const &val)
-    : arrayValue(val.clone()),
-      m_type(INTEGER_ARRAY_TYPE),
-      m_known(true)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
   {
+    initArray(new SharedObject<IntegerArray>(val), INTEGER_ARRAY_TYPE);
   }
 
   Value::Value(RealArray const &val)
-    : arrayValue(val.clone()),
-      m_type(REAL_ARRAY_TYPE),
-      m_known(true)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
   {
+    initArray(new SharedObject<RealArray>(val), REAL_ARRAY_TYPE);
   }
 
   Value::Value(StringArray const &val)
-    : arrayValue(val.clone()),
-      m_type(STRING_ARRAY_TYPE),
-      m_known(true)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
   {
+    initArray(new SharedObject<StringArray>(val), STRING_ARRAY_TYPE);
+  }
+
+  Value::Value(BooleanArray &&val)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
+  {
+    initArray(new SharedObject<BooleanArray>(std::move(val)), BOOLEAN_ARRAY_TYPE);
+  }
+
+  Value::Value(IntegerArray &&val)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
+  {
+    initArray(new SharedObject<IntegerArray>(std::move(val)), INTEGER_ARRAY_TYPE);
+  }
+
+  Value::Value(RealArray &&val)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
+  {
+    initArray(new SharedObject<RealArray>(std::move(val)), REAL_ARRAY_TYPE);
+  }
+
+  Value::Value(StringArray &&val)
+    : realValue(0.0),
+      m_storage(STORAGE_IMMEDIATE)
+  {
+    initArray(new SharedObject<StringArray>(std::move(val)), STRING_ARRAY_TYPE);
   }
 
   Value::Value(std::vector<Value> const &vals)
-    : arrayValue(), // we can be sure result is an array
+    : realValue(0.0),
       m_type(UNKNOWN_TYPE),
-      m_known(true)
+      m_known(false),
+      m_storage(STORAGE_IMMEDIATE)
   {
     size_t len = vals.size();
+    bool consistent = true;
 
     // Determine element type
     ValueType eltType = UNKNOWN_TYPE;
@@ -302,7 +382,7 @@ namespace PLEXIL
         eltType = itype; // promote int to real
       else if (eltType != itype) {
         reportPlanError("Value constructor: Inconsistent value types in vector");
-        m_known = false;
+        consistent = false;
       }
       // else type is consistent
     }
@@ -315,60 +395,56 @@ namespace PLEXIL
     // Construct array value
     switch (eltType) {
     case BOOLEAN_TYPE: {
-      m_type = BOOLEAN_ARRAY_TYPE;
-      BooleanArray *ary = new BooleanArray(len);
-      arrayValue.reset(static_cast<Array *>(ary));
+      std::unique_ptr<SharedObject<BooleanArray> > ary(new SharedObject<BooleanArray>(len));
       for (size_t i = 0; i < len; ++i) {
         Boolean temp;
         if (vals[i].getValue(temp))
-          ary->setElement(i, temp);
+          ary->object.setElement(i, temp);
         else
-          ary->setElementUnknown(i);
+          ary->object.setElementUnknown(i);
       }
+      initArray(ary.release(), BOOLEAN_ARRAY_TYPE);
       break;
     }
 
     case INTEGER_TYPE: {
-      m_type = INTEGER_ARRAY_TYPE;
-      IntegerArray *ary = new IntegerArray(len);
-      arrayValue.reset(static_cast<Array *>(ary));
+      std::unique_ptr<SharedObject<IntegerArray> > ary(new SharedObject<IntegerArray>(len));
       for (size_t i = 0; i < len; ++i) {
         Integer temp;
         if (vals[i].getValue(temp))
-          ary->setElement(i, temp);
+          ary->object.setElement(i, temp);
         else
-          ary->setElementUnknown(i);
+          ary->object.setElementUnknown(i);
       }
+      initArray(ary.release(), INTEGER_ARRAY_TYPE);
       break;
     }
 
     case DATE_TYPE: // FIXME
     case DURATION_TYPE: // FIXME
     case REAL_TYPE: {
-      m_type = REAL_ARRAY_TYPE;
-      RealArray *ary = new RealArray(len);
-      arrayValue.reset(static_cast<Array *>(ary));
+      std::unique_ptr<SharedObject<RealArray> > ary(new SharedObject<RealArray>(len));
       for (size_t i = 0; i < len; ++i) {
         Real temp;
         if (vals[i].getValue(temp))
-          ary->setElement(i, temp);
+          ary->object.setElement(i, temp);
         else
-          ary->setElementUnknown(i);
+          ary->object.setElementUnknown(i);
       }
+      initArray(ary.release(), REAL_ARRAY_TYPE);
       break;
     }
 
     case STRING_TYPE: {
-      m_type = STRING_ARRAY_TYPE;
-      StringArray *ary = new StringArray(len);
-      arrayValue.reset(static_cast<Array *>(ary));
+      std::unique_ptr<SharedObject<StringArray> > ary(new SharedObject<StringArray>(len));
       for (size_t i = 0; i < len; ++i) {
         String const *temp;
         if (vals[i].getValuePointer(temp))
-          ary->setElement(i, *temp);
+          ary->object.setElement(i, *temp);
         else
-          ary->setElementUnknown(i);
+          ary->object.setElementUnknown(i);
       }
+      initArray(ary.release(), STRING_ARRAY_TYPE);
       break;
     }
 
@@ -376,6 +452,7 @@ namespace PLEXIL
       errorMsg("Value constructor: Unknown or unimplemented element type");
       break;
     }
+    m_known = consistent;
   }
 
   //
@@ -384,7 +461,7 @@ namespace PLEXIL
     
   Value::~Value()
   {
-    cleanup();
+    destroy();
   }
 
   //
@@ -397,68 +474,8 @@ namespace PLEXIL
     if (this == &other)
       return *this; // assigning to self, nothing to do
 
-    if (!other.m_known) {
-      cleanup();
-      m_type = other.m_type;
-      return *this;
-    }
-
-    switch (other.m_type) {
-      // Copy the original's value
-    case BOOLEAN_TYPE:
-      cleanup();
-      booleanValue = other.booleanValue;
-      break;
-
-    case INTEGER_TYPE:
-      cleanup();
-      integerValue = other.integerValue;
-      break;
-
-    case REAL_TYPE:
-      cleanup();
-      realValue = other.realValue;
-      break;
-
-    case NODE_STATE_TYPE:
-      cleanup();
-      stateValue = other.stateValue;
-      break;
-
-    case OUTCOME_TYPE:
-      cleanup();
-      outcomeValue = other.outcomeValue;
-      break;
-
-    case FAILURE_TYPE:
-      cleanup();
-      failureValue = other.failureValue;
-      break;
-
-    case COMMAND_HANDLE_TYPE:
-      cleanup();
-      commandHandleValue = other.commandHandleValue;
-      break;
-
-    case STRING_TYPE:
-      cleanupForString();
-      stringValue.reset(new String(*other.stringValue));
-      break;
-
-    case BOOLEAN_ARRAY_TYPE:
-    case INTEGER_ARRAY_TYPE:
-    case REAL_ARRAY_TYPE:
-    case STRING_ARRAY_TYPE:
-      cleanupForArray();
-      arrayValue.reset(other.arrayValue->clone());
-      break;
-
-    default:
-      errorMsg("Value copy assignment: invalid or unknown type");
-      break;
-    }
-    m_known = true;
-    m_type = other.m_type;
+    destroy();
+    copyFrom(other);
     return *this;
   }
 
@@ -468,71 +485,8 @@ namespace PLEXIL
     if (this == &other)
       return *this; // assigning to self, nothing to do
 
-    if (!other.m_known) {
-      cleanup();
-      m_type = other.m_type;
-      return *this;
-    }
-
-    switch (other.m_type) {
-      // Immediate data - copy it
-    case BOOLEAN_TYPE:
-      cleanup();
-      booleanValue = other.booleanValue;
-      break;
-
-    case INTEGER_TYPE:
-      cleanup();
-      integerValue = other.integerValue;
-      break;
-
-    case REAL_TYPE:
-      cleanup();
-      realValue = other.realValue;
-      break;
-
-    case NODE_STATE_TYPE:
-      cleanup();
-      stateValue = other.stateValue;
-      break;
-
-    case OUTCOME_TYPE:
-      cleanup();
-      outcomeValue = other.outcomeValue;
-      break;
-
-    case FAILURE_TYPE:
-      cleanup();
-      failureValue = other.failureValue;
-      break;
-
-    case COMMAND_HANDLE_TYPE:
-      cleanup();
-      commandHandleValue = other.commandHandleValue;
-      break;
-
-      // Pointer data - move it
-    case STRING_TYPE:
-      cleanupForString();
-      stringValue = std::move(other.stringValue);
-      break;
-
-      // Copy the entire array
-    case BOOLEAN_ARRAY_TYPE:
-    case INTEGER_ARRAY_TYPE:
-    case REAL_ARRAY_TYPE:
-    case STRING_ARRAY_TYPE:
-      cleanupForArray();
-      arrayValue = std::move(other.arrayValue);
-      break;
-
-    default:
-      errorMsg("Value move assignment: invalid or unknown type");
-      break;
-    }
-    m_known = true;
-    m_type = other.m_type;
-
+    destroy();
+    moveFrom(std::move(other));
     return *this;
   }
 
@@ -601,55 +555,54 @@ namespace PLEXIL
 
   Value &Value::operator=(String const &val)
   {
-    cleanupForString();
-    stringValue.reset(new String(val));
-    m_type = STRING_TYPE;
-    m_known = true;
+    // val may belong to our current contents, so copy it first
+    Value temp(val);
+    destroy();
+    moveFrom(std::move(temp));
     return *this;
   }
 
-  Value &Value::operator=(char const *val)
+  Value &Value::operator=(String &&val)
   {
-    cleanupForString();
-    stringValue.reset(new String(val));
-    m_type = STRING_TYPE;
-    m_known = true;
+    destroy();
+    initString(std::move(val));
     return *this;
   }
 
+  Value &Value::operator=(char const *val)
+  {
+    return *this = String(val);
+  }
+
   Value &Value::operator=(BooleanArray const &val)
   {
-    cleanupForArray();
-    arrayValue.reset(val.clone());
-    m_type = BOOLEAN_ARRAY_TYPE;
-    m_known = true;
+    Shared *ary = new SharedObject<BooleanArray>(val);
+    destroy();
+    initArray(ary, BOOLEAN_ARRAY_TYPE);
     return *this;
   }
 
   Value &Value::operator=(IntegerArray const &val)
   {
-    cleanupForArray();
-    arrayValue.reset(val.clone());
-    m_type = INTEGER_ARRAY_TYPE;
-    m_known = true;
+    Shared *ary = new SharedObject<IntegerArray>(val);
+    destroy();
+    initArray(ary, INTEGER_ARRAY_TYPE);
     return *this;
   }
 
   Value &Value::operator=(RealArray const &val)
   {
-    cleanupForArray();
-    arrayValue.reset(val.clone());
-    m_type = REAL_ARRAY_TYPE;
-    m_known = true;
+    Shared *ary = new SharedObject<RealArray>(val);
+    destroy();
+    initArray(ary, REAL_ARRAY_TYPE);
     return *this;
   }
 
   Value &Value::operator=(StringArray const &val)
   {
-    cleanupForArray();
-    arrayValue.reset(val.clone());
-    m_type = STRING_ARRAY_TYPE;
-    m_known = true;
+    Shared *ary = new SharedObject<StringArray>(val);
+    destroy();
+    initArray(ary, STRING_ARRAY_TYPE);
     return *this;
   }
 
@@ -661,67 +614,18 @@ namespace PLEXIL
   // Do whatever is necessary to delete the previous contents
   void Value::cleanup()
   {
-    switch (m_type) {
-    case STRING_TYPE:
-      stringValue.reset();
-      break;
-      
-    case BOOLEAN_ARRAY_TYPE:
-    case INTEGER_ARRAY_TYPE:
-    case REAL_ARRAY_TYPE:
-    case STRING_ARRAY_TYPE:
-      arrayValue.reset();
-      break;
-
-    default:
-      realValue = 0;
-      break;
-    }
+    destroy();
+    realValue = 0;
     m_known = false;
     m_type = UNKNOWN_TYPE;
+    m_storage = STORAGE_IMMEDIATE;
   }
 
-  void Value::cleanupForString()
-  {
-    switch (m_type) {
-    case BOOLEAN_ARRAY_TYPE:
-    case INTEGER_ARRAY_TYPE:
-    case REAL_ARRAY_TYPE:
-    case STRING_ARRAY_TYPE:
-      // Release the old value
-      arrayValue.reset();
-      // and fall through...
-
-    default:
-      // Initialize the string pointer
-      new (&stringValue) std::unique_ptr<String>();
-      break;
-
-    case STRING_TYPE:
-      // do nothing
-      break;
-    }
-  }
-
-  void Value::cleanupForArray()
+  void Value::destroy()
   {
-    switch (m_type) {
-    case STRING_TYPE:
-      // Release old value
-      stringValue.reset();
-      // and fall through...
-
-    default:
-      // Initialize the array pointer
-      new (&arrayValue) std::unique_ptr<Array>();
-      break;
-      
-    case BOOLEAN_ARRAY_TYPE:
-    case INTEGER_ARRAY_TYPE:
-    case REAL_ARRAY_TYPE:
-    case STRING_ARRAY_TYPE:
-      break;
-
+    if (m_storage == STORAGE_SHARED) {
+      sharedValue->release();
+      m_storage = STORAGE_IMMEDIATE;
     }
   }
 
@@ -832,7 +736,7 @@ namespace PLEXIL
     checkPlanError(m_type == STRING_TYPE,
                    "Attempt to get a String value from a "
                    << valueTypeName(m_type) << " Value");
-    result = *stringValue;
+    result = *stringPointer();
     return true;
   }
 
@@ -843,7 +747,7 @@ namespace PLEXIL
     checkPlanError(m_type == STRING_TYPE,
                    "Attempt to get a String value from a "
                    << valueTypeName(m_type) << " Value");
-    ptr = stringValue.get();
+    ptr = stringPointer();
     return true;
   }
 
@@ -856,7 +760,7 @@ namespace PLEXIL
     case INTEGER_ARRAY_TYPE:
     case REAL_ARRAY_TYPE:
     case STRING_ARRAY_TYPE:
-      ptr = arrayValue.get();
+      ptr = arrayPointer();
       return true;
 
     default:
@@ -873,7 +777,7 @@ namespace PLEXIL
     checkPlanError(m_type == BOOLEAN_ARRAY_TYPE,
                    "Attempt to get a BooleanArray value from a "
                    << valueTypeName(m_type) << " Value");
-    ptr = dynamic_cast<BooleanArray const *>(arrayValue.get());
+    ptr = dynamic_cast<BooleanArray const *>(arrayPointer());
     assertTrue_1(ptr);
     return true;
   }
@@ -885,7 +789,7 @@ namespace PLEXIL
     checkPlanError(m_type == INTEGER_ARRAY_TYPE,
                    "Attempt to get a IntegerArray value from a "
                    << valueTypeName(m_type) << " Value");
-    ptr = dynamic_cast<IntegerArray const *>(arrayValue.get());
+    ptr = dynamic_cast<IntegerArray const *>(arrayPointer());
     assertTrue_1(ptr);
     return true;
   }
@@ -897,7 +801,7 @@ namespace PLEXIL
     checkPlanError(m_type == REAL_ARRAY_TYPE,
                    "Attempt to get a RealArray value from a "
                    << valueTypeName(m_type) << " Value");
-    ptr = dynamic_cast<RealArray const *>(arrayValue.get());
+    ptr = dynamic_cast<RealArray const *>(arrayPointer());
     assertTrue_1(ptr);
     return true;
   }
@@ -909,7 +813,7 @@ namespace PLEXIL
     checkPlanError(m_type == STRING_ARRAY_TYPE,
                    "Attempt to get a StringArray value from a "
                    << valueTypeName(m_type) << " Value");
-    ptr = dynamic_cast<StringArray const *>(arrayValue.get());
+    ptr = dynamic_cast<StringArray const *>(arrayPointer());
     assertTrue_1(ptr);
     return true;
   }
@@ -939,23 +843,23 @@ namespace PLEXIL
       break;
 
     case STRING_TYPE:
-      PLEXIL::printValue<String>(*stringValue, s);
+      PLEXIL::printValue<String>(*stringPointer(), s);
       break;
 
     case BOOLEAN_ARRAY_TYPE:
-      PLEXIL::printValue<BooleanArray>(*dynamic_cast<BooleanArray const *>(arrayValue.get()), s);
+      PLEXIL::printValue<BooleanArray>(*dynamic_cast<BooleanArray const *>(arrayPointer()), s);
       break;
 
     case INTEGER_ARRAY_TYPE:
-      PLEXIL::printValue<IntegerArray>(*dynamic_cast<IntegerArray const *>(arrayValue.get()), s);
+      PLEXIL::printValue<IntegerArray>(*dynamic_cast<IntegerArray const *>(arrayPointer()), s);
       break;
 
     case REAL_ARRAY_TYPE:
-      PLEXIL::printValue<RealArray>(*dynamic_cast<RealArray const *>(arrayValue.get()), s);
+      PLEXIL::printValue<RealArray>(*dynamic_cast<RealArray const *>(arrayPointer()), s);
       break;
 
     case STRING_ARRAY_TYPE:
-      PLEXIL::printValue<StringArray>(*dynamic_cast<StringArray const *>(arrayValue.get()), s);
+      PLEXIL::printValue<StringArray>(*dynamic_cast<StringArray const *>(arrayPointer()), s);
       break;
 
     case NODE_STATE_TYPE:
@@ -1049,13 +953,14 @@ namespace PLEXIL
         return commandHandleValue == other.commandHandleValue;
       
       case STRING_TYPE:
-        return *stringValue == *other.stringValue;
+        return *stringPointer() == *other.stringPointer();
 
       case BOOLEAN_ARRAY_TYPE:
       case INTEGER_ARRAY_TYPE:
       case REAL_ARRAY_TYPE:
       case STRING_ARRAY_TYPE:
-        return *arrayValue == *other.arrayValue;
+        return sharedValue == other.sharedValue // shared
+          || *arrayPointer() == *other.arrayPointer();
 
       default:
         errorMsg("Value::equals: unknown value type");
@@ -1129,27 +1034,27 @@ namespace PLEXIL
         return commandHandleValue < other.commandHandleValue;
       
       case STRING_TYPE:
-        return *stringValue < *other.stringValue;
+        return *stringPointer() < *other.stringPointer();
 
       case BOOLEAN_ARRAY_TYPE:
         return 
-                              *dynamic_cast<BooleanArray const *>(arrayValue.get()) < 
-        *dynamic_cast<BooleanArray const *>(other.arrayValue.get());
+                              *dynamic_cast<BooleanArray const *>(arrayPointer()) < 
+        *dynamic_cast<BooleanArray const *>(other.arrayPointer());
 
       case INTEGER_ARRAY_TYPE:
         return 
-        *dynamic_cast<IntegerArray const *>(arrayValue.get()) < 
-        *dynamic_cast<IntegerArray const *>(other.arrayValue.get());
+        *dynamic_cast<IntegerArray const *>(arrayPointer()) < 
+        *dynamic_cast<IntegerArray const *>(other.arrayPointer());
 
       case REAL_ARRAY_TYPE:
         return 
-        *dynamic_cast<RealArray const *>(arrayValue.get()) < 
-        *dynamic_cast<RealArray const *>(other.arrayValue.get());
+        *dynamic_cast<RealArray const *>(arrayPointer()) < 
+        *dynamic_cast<RealArray const *>(other.arrayPointer());
 
       case STRING_ARRAY_TYPE:
         return 
-        *dynamic_cast<StringArray const *>(arrayValue.get()) < 
-        *dynamic_cast<StringArray const *>(other.arrayValue.get());
+        *dynamic_cast<StringArray const *>(arrayPointer()) < 
+        *dynamic_cast<StringArray const *>(other.arrayPointer());
 
       default:
         errorMsg("Value::lessThan: unknown value type");
@@ -1157,6 +1062,54 @@ namespace PLEXIL
       }
   }
 
+  size_t Value::hash() const
+  {
+    // Integers and Reals of the same numeric value are equal,
+    // as are unknowns of either type.
+    if (!m_known) {
+      if (m_type == INTEGER_TYPE)
+        return std::hash<int>()(REAL_TYPE);
+      return std::hash<int>()(m_type);
+    }
+    switch (m_type) {
+    case BOOLEAN_TYPE:
+      return std::hash<Boolean>()(booleanValue);
+
+    case INTEGER_TYPE:
+      return std::hash<Real>()((Real) integerValue);
+
+    case REAL_TYPE:
+      // -0.0 == 0.0
+      return std::hash<Real>()(realValue == 0 ? 0.0 : realValue);
+
+    case NODE_STATE_TYPE:
+      return std::hash<int>()(stateValue);
+
+    case OUTCOME_TYPE:
+      return std::hash<int>()(outcomeValue);
+
+    case FAILURE_TYPE:
+      return std::hash<int>()(failureValue);
+
+    case COMMAND_HANDLE_TYPE:
+      return std::hash<int>()(commandHandleValue);
+
+    case STRING_TYPE:
+      return std::hash<String>()(*stringPointer());
+
+    case BOOLEAN_ARRAY_TYPE:
+    case INTEGER_ARRAY_TYPE:
+    case REAL_ARRAY_TYPE:
+    case STRING_ARRAY_TYPE:
+      // Cheap and consistent with equality; arrays are rarely used as keys
+      return std::hash<size_t>()(arrayPointer()->size()) * 31 + m_type;
+
+    default:
+      errorMsg("Value::hash: unknown value type");
+      return 0;
+    }
+  }
+
   char *Value::serialize(char *buf) const
   {
     if (!m_known) {
@@ -1174,7 +1127,7 @@ namespace PLEXIL
       return PLEXIL::serialize(realValue, buf);
 
     case STRING_TYPE:
-      return PLEXIL::serialize(*stringValue, buf);
+      return PLEXIL::serialize(*stringPointer(), buf);
 
     case COMMAND_HANDLE_TYPE:
       return PLEXIL::serialize(commandHandleValue, buf);
@@ -1183,13 +1136,24 @@ namespace PLEXIL
     case INTEGER_ARRAY_TYPE:
     case REAL_ARRAY_TYPE:
     case STRING_ARRAY_TYPE:
-      return PLEXIL::serialize(*arrayValue, buf);
+      return PLEXIL::serialize(*arrayPointer(), buf);
 
     default: // invalid/unimplemented
       return nullptr;
     }
   }
   
+  template <typename T>
+  char const *Value::deserializeArray(char const *buf, ValueType typ)
+  {
+    // Contents may be shared, so deserialize into a new array
+    std::unique_ptr<SharedObject<ArrayImpl<T> > > ary(new SharedObject<ArrayImpl<T> >());
+    buf = PLEXIL::deserialize(ary->object, buf);
+    destroy();
+    initArray(ary.release(), typ);
+    return buf;
+  }
+
   char const *Value::deserialize(char const *buf)
   {
     ValueType typ = (ValueType) *buf;
@@ -1216,12 +1180,14 @@ namespace PLEXIL
       m_known = true;
       return PLEXIL::deserialize(realValue, buf);
 
-    case STRING_TYPE:
-      if (m_type != STRING_TYPE || !stringValue)
-        stringValue.reset(new String());
-      m_type = typ;
-      m_known = true;
-      return PLEXIL::deserialize(*stringValue, buf);
+    case STRING_TYPE: {
+      // Contents may be shared, so deserialize into a new string
+      String temp;
+      buf = PLEXIL::deserialize(temp, buf);
+      destroy();
+      initString(std::move(temp));
+      return buf;
+    }
 
     case COMMAND_HANDLE_TYPE:
       m_type = typ;
@@ -1229,32 +1195,16 @@ namespace PLEXIL
       return PLEXIL::deserialize(commandHandleValue, buf);
 
     case BOOLEAN_ARRAY_TYPE:
-      if (m_type != BOOLEAN_ARRAY_TYPE || !arrayValue)
-        arrayValue.reset(new BooleanArray());
-      m_type = typ;
-      m_known = true;
-      return PLEXIL::deserialize((BooleanArray &) *arrayValue, buf);
+      return deserializeArray<Boolean>(buf, BOOLEAN_ARRAY_TYPE);
 
     case INTEGER_ARRAY_TYPE:
-      if (m_type != INTEGER_ARRAY_TYPE || !arrayValue)
-        arrayValue.reset(new IntegerArray());
-      m_type = typ;
-      m_known = true;
-      return PLEXIL::deserialize((IntegerArray &) *arrayValue, buf);
+      return deserializeArray<Integer>(buf, INTEGER_ARRAY_TYPE);
 
     case REAL_ARRAY_TYPE:
-      if (m_type != REAL_ARRAY_TYPE || !arrayValue)
-        arrayValue.reset(new RealArray());
-      m_type = typ;
-      m_known = true;
-      return PLEXIL::deserialize((RealArray &) *arrayValue, buf);
+      return deserializeArray<Real>(buf, REAL_ARRAY_TYPE);
 
     case STRING_ARRAY_TYPE:
-      if (m_type != STRING_ARRAY_TYPE || !arrayValue)
-        arrayValue.reset(new StringArray());
-      m_type = typ;
-      m_known = true;
-      return PLEXIL::deserialize((StringArray &) *arrayValue, buf);
+      return deserializeArray<String>(buf, STRING_ARRAY_TYPE);
 
     default: // invalid
       return nullptr;
@@ -1277,7 +1227,7 @@ namespace PLEXIL
       return PLEXIL::serialSize(realValue);
 
     case STRING_TYPE:
-      return PLEXIL::serialSize(*stringValue);
+      return PLEXIL::serialSize(*stringPointer());
 
     case COMMAND_HANDLE_TYPE:
       return PLEXIL::serialSize(commandHandleValue);
@@ -1286,7 +1236,7 @@ namespace PLEXIL
     case INTEGER_ARRAY_TYPE:
     case REAL_ARRAY_TYPE:
     case STRING_ARRAY_TYPE:
-      return PLEXIL::serialSize(*arrayValue);
+      return PLEXIL::serialSize(*arrayPointer());
 
     default: // invalid/unimplemented
       return 0;
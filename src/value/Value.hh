@@ -29,15 +29,6 @@
 
 #include "Array.hh" // includes ValueType.hh, CommandHandle.hh, NodeConstants.hh, <vector>
 
-#include <memory> // std::unique_ptr
-
-// Explicit instantiation
-namespace std
-{
-  template class unique_ptr<PLEXIL::Array>;
-  template class unique_ptr<PLEXIL::String>;
-}
-
 namespace PLEXIL
 {
 
@@ -45,14 +36,13 @@ namespace PLEXIL
   //! \brief An encapsulation representing any possible value in the PLEXIL language.
   //! \note Implemented as a tagged (discriminated) union.
   //! \note Of use when there is no way of knowing the PLEXIL type of a value at C++ compile time.
+  //! \note Strings and arrays are immutable once stored, and are
+  //!       shared among copies through a single reference counted
+  //!       pointer, so copying a Value does not allocate and scalar
+  //!       Values stay 16 bytes.
   //! \ingroup Values
   class Value final
   {
-  private:
-    // Local typedefs
-    using ArrayPtr = std::unique_ptr<Array>;
-    using StringPtr = std::unique_ptr<String>;
-
   public:
 
     //! \brief Default constructor. Constructs a Value with type UNKNOWN_TYPE
@@ -97,6 +87,10 @@ namespace PLEXIL
     //! \param val Const reference to the String value.
     Value(String const &val);
 
+    //! \brief Constructor from a String rvalue.
+    //! \param val Rvalue reference to the String value.
+    Value(String &&val);
+
     //! \brief Constructor from a null-terminated character string.
     //! \param val Pointer to the const character string.
     Value(char const *val); // for convenience
@@ -121,6 +115,22 @@ namespace PLEXIL
     //! \param val Const reference to the StringArray.
     Value(StringArray const &val);
 
+    //! \brief Constructor from a BooleanArray rvalue.
+    //! \param val Rvalue reference to the BooleanArray.
+    Value(BooleanArray &&val);
+
+    //! \brief Constructor from an IntegerArray rvalue.
+    //! \param val Rvalue reference to the IntegerArray.
+    Value(IntegerArray &&val);
+
+    //! \brief Constructor from a RealArray rvalue.
+    //! \param val Rvalue reference to the RealArray.
+    Value(RealArray &&val);
+
+    //! \brief Constructor from a StringArray rvalue.
+    //! \param val Rvalue reference to the StringArray.
+    Value(StringArray &&val);
+
     //! \brief Constructor for typed UNKNOWN.
     //! \param typ The desired ValueType of the result.
     Value(ValueType typ);
@@ -161,6 +171,11 @@ namespace PLEXIL
     //! \return Reference to *this.
     Value &operator=(String const &val);
 
+    //! \brief Assignment operator from String rvalue.
+    //! \param val Rvalue reference to the new value.
+    //! \return Reference to *this.
+    Value &operator=(String &&val);
+
     //! \brief Assignment operator from character array.
     //! \param val Const pointer to null-terminated character string.
     //! \return Reference to *this.
@@ -244,6 +259,12 @@ namespace PLEXIL
     //! \note For use by std::map and similar templates.
     bool lessThan(Value const &) const; // for (e.g.) std::map
 
+    //! \brief Compute a hash code for this object.
+    //! \return The hash code.
+    //! \note Values which compare equal have the same hash code.
+    //! \note For use by hash tables, e.g. std::unordered_map.
+    size_t hash() const;
+
     //! \brief Write a printed representation of the object to an output stream.
     //! \param s The stream.
     void print(std::ostream &s) const;
@@ -273,18 +294,70 @@ namespace PLEXIL
     size_t serialSize() const; 
 
   private:
-    
-    //! \brief Prepare the object to be assigned a new value. 
+
+    //! \brief How the contained value is stored.
+    enum Storage : uint8_t {
+      STORAGE_IMMEDIATE = 0, //!< Scalar, or unknown; no cleanup needed
+      STORAGE_SHARED         //!< String or Array held by sharedValue
+    };
+
+    //! \brief Reference counted holder for an immutable String or Array.
+    //! \note Defined in Value.cc.
+    struct Shared;
+
+    //! \brief Shared holder for one object of type T.
+    //! \note Defined in Value.cc.
+    template <typename T>
+    struct SharedObject;
+
+    //! \brief Set the value to UNKNOWN, releasing any storage.
     void cleanup();
-    
-    //! \brief Prepare the object to be assigned a new value,
-    //!        if the previous value was a String.
-    void cleanupForString();
 
-    //! \brief Prepare the object to be assigned a new value,
-    //!        if the previous value was an Array.
-    void cleanupForArray();
-    
+    //! \brief Destroy the active union member, if it needs destruction.
+    //! \note Leaves the object in an inconsistent state; caller must
+    //!       reinitialize it.
+    void destroy();
+
+    //! \brief Copy the contents of another Value into this object.
+    //! \param other Const reference to the Value being copied.
+    //! \note This object's storage must be STORAGE_IMMEDIATE.
+    void copyFrom(Value const &other);
+
+    //! \brief Move the contents of another Value into this object.
+    //! \param other Rvalue reference to the Value being moved.
+    //! \note This object's storage must be STORAGE_IMMEDIATE.
+    void moveFrom(Value &&other);
+
+    //! \brief Initialize the object with a String value.
+    //! \param val The value.
+    //! \note This object's storage must be STORAGE_IMMEDIATE.
+    void initString(String const &val);
+    void initString(String &&val);
+
+    //! \brief Initialize the object with a shared Array value.
+    //! \param ary Pointer to the newly constructed holder of the array.
+    //! \param typ The array type.
+    //! \note This object's storage must be STORAGE_IMMEDIATE.
+    //! \note Takes ownership of the holder's initial reference.
+    void initArray(Shared *ary, ValueType typ);
+
+    //! \brief Read a serial representation of an array into this object.
+    //! \param buf Pointer to first character of the serial representation.
+    //! \param typ The array type.
+    //! \return Pointer to the character after the last character read.
+    template <typename T>
+    char const *deserializeArray(char const *buf, ValueType typ);
+
+    //! \brief Get a pointer to the contained String.
+    //! \return The pointer.
+    //! \note Caller must ensure this object holds a known String.
+    String const *stringPointer() const;
+
+    //! \brief Get a pointer to the contained Array.
+    //! \return The pointer.
+    //! \note Caller must ensure this object holds a known Array.
+    Array const *arrayPointer() const;
+
     union {
       Boolean                  booleanValue;
       NodeState                stateValue;
@@ -293,8 +366,7 @@ namespace PLEXIL
       CommandHandleValue       commandHandleValue;
       Integer                  integerValue;
       Real                     realValue;
-      StringPtr                stringValue;
-      ArrayPtr                 arrayValue;
+      Shared                  *sharedValue;
     };
 
     //! \brief The type of the contained value.
@@ -302,6 +374,9 @@ namespace PLEXIL
 
     //! \brief True if the current value is known, false otherwise.
     bool m_known;
+
+    //! \brief Which union member, if any, is active.
+    Storage m_storage;
   };
 
   //! \brief Overloaded formatted output operator for Value.
@@ -0,0 +1,219 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//
+// Counts the heap allocations and measures the time required to copy
+// Value instances of various types, by copy construction and by copy
+// assignment.  Copying a Value should not allocate; exits with a
+// nonzero status if any case allocates more than expected.
+//
+
+#include "ArrayImpl.hh"
+#include "Error.hh"
+#include "Value.hh"
+#include "lifecycle-utils.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace PLEXIL;
+
+using Clock = std::chrono::steady_clock;
+
+//
+// Allocation counting
+//
+
+static size_t s_allocations = 0;
+
+void *operator new(size_t size)
+{
+  ++s_allocations;
+  if (void *result = malloc(size ? size : 1))
+    return result;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+  free(ptr);
+}
+
+void operator delete(void *ptr, size_t /* size */) noexcept
+{
+  free(ptr);
+}
+
+//
+// Benchmark cases
+//
+
+// Keep the optimizer from discarding the copies.
+static size_t s_sink = 0;
+
+// Copy construct and destroy, n times.
+template <typename T>
+static void copyConstruct(T const &original, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    T copy(original);
+    s_sink += sizeof(copy);
+  }
+}
+
+// Copy assign alternately from two values of the same type, n times.
+template <typename T>
+static void copyAssign(T const &a, T const &b, size_t n)
+{
+  T dest(a);
+  for (size_t i = 0; i < n; ++i)
+    dest = (i & 1) ? a : b;
+  s_sink += sizeof(dest);
+}
+
+// Run one case, report the results, and return false if it allocated
+// more than maxPerCopy times per copy.
+template <typename T>
+static bool runCase(char const *what, T const &a, T const &b,
+                    size_t n, double maxPerCopy)
+{
+  size_t before = s_allocations;
+  Clock::time_point start = Clock::now();
+  copyConstruct(a, n);
+  Clock::time_point constructed = Clock::now();
+  size_t constructAllocs = s_allocations - before;
+
+  before = s_allocations;
+  copyAssign(a, b, n);
+  Clock::time_point assigned = Clock::now();
+  size_t assignAllocs = s_allocations - before;
+
+  double constructNs =
+    std::chrono::duration<double, std::nano>(constructed - start).count() / n;
+  double assignNs =
+    std::chrono::duration<double, std::nano>(assigned - constructed).count() / n;
+  // Setup of the assignment destination accounts for one copy
+  double constructPer = (double) constructAllocs / n;
+  double assignPer = (double) assignAllocs / (n + 1);
+
+  std::cout << std::left << std::setw(20) << what << std::right
+            << std::fixed << std::setprecision(2)
+            << " construct " << std::setw(5) << constructPer << " allocs, "
+            << std::setprecision(1) << std::setw(6) << constructNs << " ns;"
+            << std::setprecision(2)
+            << " assign " << std::setw(5) << assignPer << " allocs, "
+            << std::setprecision(1) << std::setw(6) << assignNs << " ns"
+            << std::endl;
+
+  if (constructPer > maxPerCopy || assignPer > maxPerCopy) {
+    std::cout << "  FAILED: expected at most " << maxPerCopy
+              << " allocations per copy" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+static void usage()
+{
+  std::cout << "Usage: value-alloc-benchmark [options]\n"
+            << " Options:\n"
+            << "  -h               Display this message and exit\n"
+            << "  -n <number>      Number of copies per case (default 1000000)\n"
+            << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t n = 1000000;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-h")) {
+      usage();
+      return 0;
+    }
+    else if (i + 1 < argc && !strcmp(argv[i], "-n")) {
+      long count = atol(argv[++i]);
+      if (count <= 0) {
+        std::cerr << "-n option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+      n = (size_t) count;
+    }
+    else {
+      std::cerr << "Unrecognized argument " << argv[i] << std::endl;
+      usage();
+      return 1;
+    }
+  }
+
+  bool success = true;
+  try {
+    Error::doThrowExceptions();
+
+    std::cout << n << " copies per case" << std::endl;
+
+    String const longA("/telemetry/vehicle/subsystem/power/bus_a/voltage");
+    String const longB("/telemetry/vehicle/subsystem/power/bus_b/voltage");
+
+    std::vector<String> strings(16, String("element"));
+    std::vector<Value> record {Value((Integer) 42), Value(3.5), Value("Telemetry"),
+                               Value(longA), Value(IntegerArray(16, 7))};
+
+    success = runCase("Integer", Value((Integer) 1), Value((Integer) 2), n, 0)
+      && success;
+    success = runCase("Real", Value(1.5), Value(2.5), n, 0)
+      && success;
+    success = runCase("unknown String", Value(STRING_TYPE), Value(STRING_TYPE), n, 0)
+      && success;
+    success = runCase("short String", Value("Telemetry"), Value("Command"), n, 0)
+      && success;
+    success = runCase("long String", Value(longA), Value(longB), n, 0)
+      && success;
+    success = runCase("IntegerArray(16)", Value(IntegerArray(16, 1)),
+                      Value(IntegerArray(16, 2)), n, 0)
+      && success;
+    success = runCase("StringArray(16)", Value(StringArray(strings)),
+                      Value(StringArray(4, String("other"))), n, 0)
+      && success;
+    // The vector's own buffer is the only allocation
+    success = runCase("vector<Value>(5)", record, record, n, 1)
+      && success;
+
+    plexilRunFinalizers();
+  }
+  catch (Error const &e) {
+    std::cerr << "Aborting benchmark due to error:\n" << e << std::endl;
+    return 1;
+  }
+
+  return success ? 0 : 1;
+}
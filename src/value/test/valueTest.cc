@@ -563,6 +563,31 @@ static bool testMoveConstructors()
     }
   }
 
+  // Move from array rvalues
+  {
+    std::vector<Integer> iv(3);
+    iv[0] = 1;
+    iv[1] = 2;
+    iv[2] = 3;
+    IntegerArray expected(iv);
+    Value movedv(IntegerArray(std::move(iv)));
+    IntegerArray const *tempiap = nullptr;
+    assertTrue_1(movedv.isKnown());
+    assertTrue_1(INTEGER_ARRAY_TYPE == movedv.valueType());
+    assertTrue_1(movedv.getValuePointer(tempiap));
+    assertTrue_1(expected == *tempiap);
+
+    std::vector<String> sv(2);
+    sv[0] = String("yo ");
+    sv[1] = String("mama");
+    StringArray expectedString(sv);
+    Value movedsv(StringArray(std::move(sv)));
+    StringArray const *tempsap = nullptr;
+    assertTrue_1(STRING_ARRAY_TYPE == movedsv.valueType());
+    assertTrue_1(movedsv.getValuePointer(tempsap));
+    assertTrue_1(expectedString == *tempsap);
+  }
+
   return true;
 }
 
@@ -2266,6 +2291,95 @@ static bool testStringArrayLessThan()
 
 // Array to String
 
+// Strings and arrays are shared among copies; make sure
+// changing one copy never affects another.
+static bool testSharedStorage()
+{
+  String const longStr("a string long enough not to fit in a std::string's own buffer");
+
+  // Scalars must not pay for string and array storage
+  assertTrue_1(sizeof(Value) <= 2 * sizeof(Real));
+
+  {
+    Value shortv("short");
+    Value shortCopy(shortv);
+    String const *p1, *p2;
+    assertTrue_1(shortv.getValuePointer(p1));
+    assertTrue_1(shortCopy.getValuePointer(p2));
+    assertTrue_1(p1 == p2); // shared
+    shortCopy = "other";
+    assertTrue_1(shortv == Value("short"));
+    assertTrue_1(shortCopy == Value("other"));
+    shortCopy = longStr;
+    assertTrue_1(shortCopy == Value(longStr));
+    shortCopy = shortv;
+    assertTrue_1(shortCopy == shortv);
+  }
+
+  {
+    Value longv(longStr);
+    Value longCopy(longv);
+    String const *p1, *p2;
+    assertTrue_1(longv.getValuePointer(p1));
+    assertTrue_1(longCopy.getValuePointer(p2));
+    assertTrue_1(p1 == p2); // shared
+    longCopy = (Integer) 3;
+    assertTrue_1(longv.getValuePointer(p1));
+    assertTrue_1(*p1 == longStr);
+
+    // Assigning a string from the value's own contents
+    longCopy = longv;
+    assertTrue_1(longCopy.getValuePointer(p2));
+    longCopy = *p2;
+    assertTrue_1(longCopy == longv);
+
+    // Deserializing into a shared value must not change the other copy
+    Value other(String("a different long string, also stored out of line"));
+    std::vector<char> buf(other.serialSize());
+    assertTrue_1(other.serialize(buf.data()));
+    assertTrue_1(longCopy.deserialize(buf.data()));
+    assertTrue_1(longCopy == other);
+    assertTrue_1(longv == Value(longStr));
+
+    // Moved-from value is left valid
+    Value moved(std::move(longCopy));
+    assertTrue_1(moved == other);
+    longCopy = longv;
+    assertTrue_1(longCopy == longv);
+  }
+
+  {
+    IntegerArray ary(4, 1);
+    Value aryv(ary);
+    Value aryCopy(aryv);
+    Array const *p1, *p2;
+    assertTrue_1(aryv.getValuePointer(p1));
+    assertTrue_1(aryCopy.getValuePointer(p2));
+    assertTrue_1(p1 == p2); // shared
+    assertTrue_1(aryv == aryCopy);
+
+    // Changing the source array doesn't change the Value
+    ary.setElement(0, (Integer) 2);
+    assertTrue_1(aryv != Value(ary));
+
+    // Deserializing into a shared value must not change the other copy
+    Value other(ary);
+    std::vector<char> buf(other.serialSize());
+    assertTrue_1(other.serialize(buf.data()));
+    assertTrue_1(aryCopy.deserialize(buf.data()));
+    assertTrue_1(aryCopy == other);
+    assertTrue_1(aryv == Value(IntegerArray(4, 1)));
+
+    // Generic Array constructor
+    Array const &generic = ary;
+    Value genericv(generic);
+    assertTrue_1(INTEGER_ARRAY_TYPE == genericv.valueType());
+    assertTrue_1(genericv == other);
+  }
+
+  return true;
+}
+
 bool valueTest()
 {
   runTest(testBasicConstructorsAndAccessors);
@@ -2285,6 +2399,7 @@ bool valueTest()
   runTest(testIntegerArrayLessThan);
   runTest(testRealArrayLessThan);
   runTest(testStringArrayLessThan);
+  runTest(testSharedStorage);
 
   return true;
 }
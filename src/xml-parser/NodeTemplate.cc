@@ -0,0 +1,137 @@
+/* Copyright (c) 2006-2020, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "NodeTemplate.hh"
+
+#include "Debug.hh"
+#include "parser-utils.hh"
+#include "PlexilSchema.hh"
+
+#include <cstdlib>  // strtoul()
+#include <cstring>  // strcmp()
+
+using pugi::xml_attribute;
+using pugi::xml_node;
+
+namespace PLEXIL
+{
+
+  static void locateDeclarations(NodeTemplate &tmpl, xml_node const varDecls)
+  {
+    for (xml_node decl : varDecls) {
+      char const *name = decl.child_value(NAME_TAG);
+      if (testTag(DECLARE_MUTEX_TAG, decl))
+        tmpl.mutexes.emplace_back(decl, name);
+      else {
+        tmpl.variables.emplace_back(decl, name);
+        if (decl.child(INITIALVAL_TAG))
+          tmpl.initializedVariables.emplace_back(decl, name);
+      }
+    }
+  }
+
+  static void locateInterface(NodeTemplate &tmpl, xml_node const iface)
+  {
+    for (xml_node elt : iface) {
+      std::vector<ElementTemplate> &decls =
+        testTag(IN_TAG, elt) ? tmpl.inVariables : tmpl.inOutVariables;
+      for (xml_node decl : elt)
+        decls.emplace_back(decl, decl.child_value(NAME_TAG));
+    }
+  }
+
+  static void locateAliases(NodeTemplate &tmpl, xml_node const callXml)
+  {
+    // First child is the called NodeId
+    xml_node aliasXml = callXml.first_child();
+    tmpl.libraryName = aliasXml.child_value();
+    while ((aliasXml = aliasXml.next_sibling())) {
+      xml_node const nameXml = aliasXml.first_child();
+      tmpl.aliases.emplace_back(nameXml.next_sibling(), nameXml.child_value());
+    }
+  }
+
+  NodeTemplate::NodeTemplate(xml_node const nodeXml)
+    : xml(nodeXml),
+      bodyXml(),
+      nodeId(""),
+      nodeType(NodeType_error),
+      hasPriority(false),
+      priority(0),
+      libraryName(nullptr)
+  {
+    xml_attribute const attr = xml.attribute(NODETYPE_ATTR);
+    nodeType = parseNodeType(attr.value());
+    checkParserExceptionWithLocation(nodeType < NodeType_error,
+                                     xml, // should really be the attribute
+                                     "Invalid " << attr.name()
+                                     << " value \"" << attr.value() << "\"");
+
+    // One pass over the top level elements
+    for (xml_node elt = xml.first_child(); elt; elt = elt.next_sibling()) {
+      char const *tag = elt.name();
+      if (!strcmp(NODEID_TAG, tag))
+        nodeId = elt.child_value();
+      else if (!strcmp(BODY_TAG, tag))
+        bodyXml = elt.first_child();
+      else if (!strcmp(VAR_DECLS_TAG, tag))
+        locateDeclarations(*this, elt);
+      else if (!strcmp(INTERFACE_TAG, tag))
+        locateInterface(*this, elt);
+      else if (!strcmp(PRIORITY_TAG, tag)) {
+        hasPriority = true;
+        priority = (int32_t) strtoul(elt.child_value(), nullptr, 10);
+      }
+      else if (!strcmp(USING_MUTEX_TAG, tag)) {
+        for (xml_node nm : elt.children(NAME_TAG))
+          usingMutexes.emplace_back(nm, nm.child_value());
+      }
+      else if (testSuffix(CONDITION_SUFFIX, tag))
+        conditions.emplace_back(elt, tag);
+    }
+    debugMsg("NodeTemplate", " node " << nodeId);
+
+    switch (nodeType) {
+    case NodeType_LibraryNodeCall:
+      locateAliases(*this, bodyXml);
+      break;
+
+    case NodeType_NodeList: {
+      size_t n = 0;
+      for (xml_node kidXml = bodyXml.first_child(); kidXml; kidXml = kidXml.next_sibling())
+        ++n;
+      children.reserve(n);
+      for (xml_node kidXml = bodyXml.first_child(); kidXml; kidXml = kidXml.next_sibling())
+        children.emplace_back(kidXml);
+      break;
+    }
+
+    default:
+      break;
+    }
+  }
+
+} // namespace PLEXIL
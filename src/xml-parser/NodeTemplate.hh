@@ -0,0 +1,119 @@
+/* Copyright (c) 2006-2020, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_NODE_TEMPLATE_HH
+#define PLEXIL_NODE_TEMPLATE_HH
+
+#include "PlexilNodeType.hh"
+
+#include "pugixml.hpp"
+
+#include <vector>
+
+#include <cstdint>
+
+//
+// A NodeTemplate records where the parts of a node's XML are, and the
+// values which can be read off the XML directly (node ID, type,
+// priority, declared names).  It is built in one walk over the XML,
+// after the XML has been checked.  Constructing a node from its
+// template needs no further searching of the node's XML; only the
+// expressions are built from the XML elements the template points to.
+//
+// Each library node's template is built once, when the library is
+// loaded, and is used for every call to that library.
+//
+
+namespace PLEXIL
+{
+
+  //! \struct ElementTemplate
+  //! \brief A named element of a node's XML.
+  struct ElementTemplate final
+  {
+    ElementTemplate(pugi::xml_node const x, char const *nm)
+      : xml(x),
+        name(nm)
+    {
+    }
+
+    pugi::xml_node xml; //!< The element.
+    char const *name;   //!< The name declared or referenced by the element.
+  };
+
+  //! \struct NodeTemplate
+  //! \brief The structure of a node's XML, located once so that the
+  //!        node can be constructed repeatedly without searching the XML.
+  struct NodeTemplate final
+  {
+    //! \brief Constructor.
+    //! \param nodeXml The Node element.
+    //! \note Presumes that checkNode() has already been called on the XML.
+    //! \note Throws ParserException if the node type is invalid.
+    explicit NodeTemplate(pugi::xml_node const nodeXml);
+
+    pugi::xml_node xml;          //!< The Node element.
+    pugi::xml_node bodyXml;      //!< The first child of the NodeBody element; empty for Empty nodes.
+    char const *nodeId;          //!< The NodeId.
+    PlexilNodeType nodeType;     //!< The node type.
+    bool hasPriority;            //!< True if the node has a Priority element.
+    int32_t priority;            //!< The priority, if supplied.
+
+    //! \brief Local variable declarations; name is the variable name.
+    std::vector<ElementTemplate> variables;
+
+    //! \brief The subset of variables with an InitialValue.
+    std::vector<ElementTemplate> initializedVariables;
+
+    //! \brief Local mutex declarations; name is the mutex name.
+    std::vector<ElementTemplate> mutexes;
+
+    //! \brief In interface declarations; name is the variable name.
+    std::vector<ElementTemplate> inVariables;
+
+    //! \brief InOut interface declarations; name is the variable name.
+    std::vector<ElementTemplate> inOutVariables;
+
+    //! \brief UsingMutex Name elements; name is the mutex name.
+    std::vector<ElementTemplate> usingMutexes;
+
+    //! \brief User condition elements, in document order; name is the tag.
+    std::vector<ElementTemplate> conditions;
+
+    //! \brief LibraryNodeCall aliases; xml is the value expression,
+    //!        name is the parameter name.
+    std::vector<ElementTemplate> aliases;
+
+    //! \brief LibraryNodeCall only: the name of the called library node.
+    char const *libraryName;
+
+    //! \brief NodeList only: the child nodes.
+    std::vector<NodeTemplate> children;
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_NODE_TEMPLATE_HH
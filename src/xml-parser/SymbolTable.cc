@@ -286,9 +286,15 @@ namespace PLEXIL
     return new SymbolTableImpl();
   }
 
-  static std::stack<SymbolTable *> s_symtabStack;
+  // Per thread, so that plan loader threads can check nodes concurrently
+  static thread_local std::stack<SymbolTable *> s_symtabStack;
 
-  static SymbolTable *s_symbolTable = nullptr;
+  static thread_local SymbolTable *s_symbolTable = nullptr;
+
+  SymbolTable *getSymbolTable()
+  {
+    return s_symbolTable;
+  }
 
   void pushSymbolTable(SymbolTable *s)
   {
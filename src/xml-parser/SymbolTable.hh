@@ -141,6 +141,9 @@ namespace PLEXIL
   // Restore the previous symbol table.
   extern void popSymbolTable();
 
+  // Get the current symbol table of the calling thread.
+  extern SymbolTable *getSymbolTable();
+
   //
   // Parser queries
   //
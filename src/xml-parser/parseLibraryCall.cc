@@ -27,6 +27,7 @@
 #include "createExpression.hh"
 #include "Debug.hh"
 #include "LibraryCallNode.hh"
+#include "NodeTemplate.hh"
 #include "parseNode.hh"
 #include "parsePlan.hh"
 #include "parser-utils.hh"
@@ -101,73 +102,60 @@ namespace PLEXIL
       checkAlias(callerId, temp);
   }
 
-  // Simply count the # of aliases in the call
-  size_t estimateAliasSpace(pugi::xml_node const callXml)
-  {
-    xml_node alias = callXml.first_child().next_sibling();
-    if (!alias)
-      return 0;
-    // checkTag(ALIAS_TAG, alias); // done in checkAlias()
-    size_t result = 1;
-    while ((alias = alias.next_sibling())) // tag checked in checkAlias()
-      result++;
-    return result;
-  }
-
-  static void allocateAliases(LibraryCallNode *node, xml_node const callXml)
-  {
-    // Preallocate, but don't populate, aliases
-    node->allocateAliasMap(estimateAliasSpace(callXml));
-  }
-
-  void constructLibraryCall(LibraryCallNode *node, xml_node const callXml)
+  void constructLibraryCall(LibraryCallNode *node, NodeTemplate const &callTemplate)
   {
     assertTrue_1(node);
     debugMsg("constructLibraryCall", " caller " << node->getNodeId());
 
-    allocateAliases(node, callXml);
+    // Preallocate, but don't populate, aliases
+    node->allocateAliasMap(callTemplate.aliases.size());
 
-    Library const *l = getLibraryNode(callXml.first_child().child_value());
+    Library const *l = getLibraryNode(callTemplate.libraryName);
     checkParserExceptionWithLocation(l,
-                                     callXml,
+                                     callTemplate.bodyXml,
                                      "Library node "
-                                     << callXml.first_child().child_value()
+                                     << callTemplate.libraryName
                                      << " not found while expanding LibraryNodeCall node "
                                      << node->getNodeId());
-    // Construct call
+
+    // Construct call from the library's template
     // Template was checked before it was added to library
-    node->addChild(constructPlan(l->doc->document_element(), l->symtab, node));
+    pushSymbolTable(l->symtab);
+    try {
+      node->addChild(constructNode(*l->nodeTemplate, node));
+    }
+    catch (...) {
+      popSymbolTable();
+      throw;
+    }
+    popSymbolTable();
   }
 
   // Second pass
-  static void finalizeAliases(LibraryCallNode *node, xml_node const callXml)
+  static void finalizeAliases(LibraryCallNode *node, NodeTemplate const &callTemplate)
   {
     debugMsg("finalizeAliases", " caller " << node->getNodeId());
-    // Skip over NodeId
-    xml_node aliasXml = callXml.first_child();
-    while ((aliasXml = aliasXml.next_sibling())) {
-      xml_node const nameXml = aliasXml.first_child();
-      debugMsg("finalizeAliases", " constructing alias " << nameXml.child_value());
+    for (ElementTemplate const &alias : callTemplate.aliases) {
+      debugMsg("finalizeAliases", " constructing alias " << alias.name);
              
       // Add the alias
       bool isGarbage = false;
-      Expression *exp = createExpression(nameXml.next_sibling(), node, isGarbage);
-      node->addAlias(nameXml.child_value(), exp, isGarbage);
+      Expression *exp = createExpression(alias.xml, node, isGarbage);
+      node->addAlias(alias.name, exp, isGarbage);
     }
   }
 
   // Second pass
-  void finalizeLibraryCall(LibraryCallNode *node, xml_node const callXml)
+  void finalizeLibraryCall(LibraryCallNode *node, NodeTemplate const &callTemplate)
   {
     assertTrue_1(node);
     debugMsg("finalizeLibraryCall", " caller " << node->getNodeId());
 
-    finalizeAliases(node, callXml);
+    finalizeAliases(node, callTemplate);
 
-    Library const *l = getLibraryNode(callXml.first_child().child_value());
+    Library const *l = getLibraryNode(callTemplate.libraryName);
     assertTrue_2(l,
                  "finalizeLibraryCall: Internal error: can't find library");
-    xml_node const calleeXml = l->doc->document_element().child(NODE_TAG);
 
     // should never happen, but...
     assertTrue_2(!node->getChildren().empty(),
@@ -175,7 +163,7 @@ namespace PLEXIL
 
     pushSymbolTable(l->symtab);
     try {
-      finalizeNode(node->getChildren().front().get(), calleeXml);
+      finalizeNode(node->getChildren().front().get(), *l->nodeTemplate);
     }
     catch (...) {
       popSymbolTable();
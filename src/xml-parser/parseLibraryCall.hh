@@ -37,16 +37,16 @@ namespace pugi
 namespace PLEXIL
 {
   class LibraryCallNode;
+  struct NodeTemplate;
 
   // Check pass
   extern void checkLibraryCall(char const *callerId, pugi::xml_node const callXml);
 
   // First pass
-  extern size_t estimateAliasSpace(pugi::xml_node const callXml);
-  extern void constructLibraryCall(LibraryCallNode *node, pugi::xml_node const callXml);
+  extern void constructLibraryCall(LibraryCallNode *node, NodeTemplate const &callTemplate);
 
   // Second pass
-  extern void finalizeLibraryCall(LibraryCallNode *node, pugi::xml_node const callXml);
+  extern void finalizeLibraryCall(LibraryCallNode *node, NodeTemplate const &callTemplate);
 
 } // namespace PLEXIL
 
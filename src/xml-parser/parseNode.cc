@@ -40,9 +40,12 @@
 #include "ListNode.hh"
 #include "Mutex.hh"
 #include "NodeFactory.hh"
+#include "NodeTemplate.hh"
 #include "parseAssignment.hh"
 #include "parseLibraryCall.hh"
 #include "parser-utils.hh"
+#include "ParserException.hh"
+#include "planLoader.hh"
 #include "PlexilSchema.hh"
 #include "UpdateNode.hh"
 #include "updateXmlParser.hh"
@@ -50,7 +53,8 @@
 
 #include "pugixml.hpp"
 
-#include <algorithm> // std::distance(), std::find_if()
+#include <algorithm> // std::find_if()
+#include <exception>
 #include <limits>
 
 #include <cstdlib>  // strtoul()
@@ -371,13 +375,38 @@ namespace PLEXIL
     }
   }
 
+  // Smallest list whose children are worth checking concurrently
+  static constexpr size_t MIN_PARALLEL_CHECK_CHILDREN = 8;
+
   static void checkChildNodes(char const *parentId, xml_node const kidsXml)
   {
+    std::vector<xml_node> kids;
+    for (xml_node kidXml = kidsXml.first_child(); kidXml; kidXml = kidXml.next_sibling())
+      kids.push_back(kidXml);
+
+    // Basic checks on children, concurrently if the list is large enough.
+    // Errors are reported below in document order, as if checked serially.
+    std::vector<std::exception_ptr> kidErrors;
+    if (kids.size() >= MIN_PARALLEL_CHECK_CHILDREN && useLoaderThreads(kids.size()))
+      runLoaderTasks(kids.size(),
+                     [&kids](size_t i) -> void { checkNode(kids[i]); },
+                     kidErrors);
+
     std::vector<char const *> nodeIds;
-    xml_node kidXml = kidsXml.first_child();
-    while (kidXml) { // empty list node is legal
-      // Basic checks on child
-      checkNode(kidXml);
+    for (size_t i = 0; i < kids.size(); ++i) { // empty list node is legal
+      xml_node const kidXml = kids[i];
+      if (kidErrors.empty())
+        checkNode(kidXml);
+      else if (kidErrors[i]) {
+        // Loader tasks don't log their errors
+        try {
+          std::rethrow_exception(kidErrors[i]);
+        }
+        catch (ParserException const &e) {
+          e.report();
+          throw;
+        }
+      }
 
       // Check that parent and child don't have same name
       char const *kidId = kidXml.child_value(NODEID_TAG);
@@ -398,7 +427,6 @@ namespace PLEXIL
       }
 
       nodeIds.push_back(kidId);
-      kidXml = kidXml.next_sibling();
     }
   }
 
@@ -744,197 +772,120 @@ namespace PLEXIL
   // LibraryNodeCall aliases can't be expanded because some of the variables they can reference
   // (e.g. child node internal vars) may not exist yet. Same with default values.
 
-  // Estimate symbol table space for interface variables
-  static size_t estimateInterfaceSpace(xml_node const iface)
-  {
-    size_t n = 0;
-    for (xml_node elt : iface)
-      n += std::distance(elt.begin(), elt.end());
-    return n;
-  }
-
   // Second pass checking of one In interface variable
-  static void parseInDecl(NodeImpl *node, xml_node const inXml, bool isCall)
+  static void parseInDecl(NodeImpl *node, ElementTemplate const &inDecl)
   {
-    char const *name = getVarDeclName(inXml);
     // Shouldn't be possible
-    checkParserExceptionWithLocation(!node->findLocalVariable(name),
-                                     inXml,
-                                     "In interface variable " << name
+    checkParserExceptionWithLocation(!node->findLocalVariable(inDecl.name),
+                                     inDecl.xml,
+                                     "In interface variable " << inDecl.name
                                      << " shadows another variable of same name in this node");
   }
 
   // Second pass checking of one InOut interface
-  static void parseInOutDecl(NodeImpl *node, xml_node const inOutXml, bool isCall)
+  static void parseInOutDecl(NodeImpl *node, ElementTemplate const &inOutDecl)
   {
-    char const *name = getVarDeclName(inOutXml);
     // Shouldn't be possible
-    checkParserExceptionWithLocation(!node->findLocalVariable(name),
-                                     inOutXml,
-                                     "InOut interface variable " << name
+    checkParserExceptionWithLocation(!node->findLocalVariable(inOutDecl.name),
+                                     inOutDecl.xml,
+                                     "InOut interface variable " << inOutDecl.name
                                      << " shadows another variable of same name in this node");
   }
 
   // Second pass
-  static void parseInterface(NodeImpl *node, xml_node const iface)
+  static void parseInterface(NodeImpl *node, NodeTemplate const &tmpl)
   {
-    // Figure out if this is a library node expansion
-    NodeImpl *parent = node->getParentNode();
-    bool isCall = (parent && parent->getType() == NodeType_LibraryNodeCall);
-    for (xml_node elt = iface.first_child(); elt; elt = elt.next_sibling()) {
-      if (testTag(IN_TAG, elt)) {
-        for (xml_node decl = elt.first_child(); decl; decl = decl.next_sibling())
-          parseInDecl(node, decl, isCall);
-      }
-      else /* if (testTag(INOUT_TAG, elt)) */ {
-        for (xml_node decl = elt.first_child(); decl; decl = decl.next_sibling())
-          parseInOutDecl(node, decl, isCall);
-      }
-    }
+    for (ElementTemplate const &decl : tmpl.inVariables)
+      parseInDecl(node, decl);
+    for (ElementTemplate const &decl : tmpl.inOutVariables)
+      parseInOutDecl(node, decl);
   }
 
-  // Second pass
-  static void parsePriority(NodeImpl *node, xml_node const nodeXml)
+  static void parseVariableDeclarations(NodeImpl *node, NodeTemplate const &tmpl)
   {
-    xml_node const prio = nodeXml.child(PRIORITY_TAG);
-    if (prio)
-      node->setPriority((int32_t) strtoul(prio.child_value(), nullptr, 10));
+    for (ElementTemplate const &decl : tmpl.mutexes)
+      node->addMutex(new Mutex(decl.name));
+    for (ElementTemplate const &decl : tmpl.variables)
+      // Variables are always created here, no need for "garbage" flag.
+      node->addLocalVariable(decl.name, createExpression(decl.xml, node));
   }
 
-  static void parseVariableDeclarations(NodeImpl *node, xml_node const decls)
+  static void initializeNodeVariables(NodeImpl *node, NodeTemplate const &tmpl)
   {
-    for (xml_node decl : decls) {
-      if (testTag(DECLARE_MUTEX_TAG, decl))
-        node->addMutex(new Mutex(decl.child_value(NAME_TAG)));
-      else
-        // Variables are always created here, no need for "garbage" flag.
-        node->addLocalVariable(getVarDeclName(decl),
-                               createExpression(decl, node));
-    }
-  }
-
-  static void initializeNodeVariables(NodeImpl *node, xml_node const xml)
-  {
-    xml_node const varDecls = xml.child(VAR_DECLS_TAG);
-    xml_node const iface = xml.child(INTERFACE_TAG);
-
-    // Now we can estimate how many entries are required and reserve space for them. 
+    // Reserve space for the entries we know about.
     // This saves us from reallocating and copying the whole table as it grows.
-    if (varDecls || iface) {
-      size_t nVariables = 0;
-      size_t nMutexes = 0;
-      if (varDecls) {
-        // Grovel over declarations and separate variables from mutexes
-        for (xml_node decl : varDecls)
-          if (testTag(DECLARE_MUTEX_TAG, decl))
-            ++nMutexes;
-          else
-            ++nVariables;
-      }
-      // FIXME: Is this in right place?
-      if (node->getType() == NodeType_LibraryNodeCall)
-        nVariables += estimateAliasSpace(xml.child(BODY_TAG).first_child());
-      if (iface)
-        nVariables += estimateInterfaceSpace(iface);
-
-      if (nVariables)
-        node->allocateVariables(nVariables);
-      if (nMutexes)
-        node->allocateMutexes(nMutexes);
-
-      // Check interface variables
-      if (iface) {
-        debugMsg("parseNode", " parsing interface declarations");
-        parseInterface(node, iface);
-      }
+    size_t nVariables = tmpl.variables.size() + tmpl.aliases.size()
+      + tmpl.inVariables.size() + tmpl.inOutVariables.size();
+    if (nVariables)
+      node->allocateVariables(nVariables);
+    if (!tmpl.mutexes.empty())
+      node->allocateMutexes(tmpl.mutexes.size());
+
+    // Check interface variables
+    if (!tmpl.inVariables.empty() || !tmpl.inOutVariables.empty()) {
+      debugMsg("parseNode", " parsing interface declarations");
+      parseInterface(node, tmpl);
+    }
 
-      // Populate local variables and mutexes
-      if (varDecls) {
-        debugMsg("parseNode", " parsing variable declarations");
-        parseVariableDeclarations(node, varDecls);
-      }
+    // Populate local variables and mutexes
+    if (!tmpl.variables.empty() || !tmpl.mutexes.empty()) {
+      debugMsg("parseNode", " parsing variable declarations");
+      parseVariableDeclarations(node, tmpl);
     }
   }
 
-  static void initializeNodeMutexes(NodeImpl *node, xml_node const xml)
+  static void initializeNodeMutexes(NodeImpl *node, NodeTemplate const &tmpl)
   {
-    // Count # of mutexes in this node
-    xml_node mtx = xml.child(USING_MUTEX_TAG);
-    if (!mtx)
+    if (tmpl.usingMutexes.empty())
       return;
 
-    size_t n = std::distance(mtx.begin(), mtx.end());
-    node->allocateUsingMutexes(n);
-    std::vector<char const *> names;
-    names.reserve(n);
-
-    // Now populate them
-    for (xml_node nm : mtx.children(NAME_TAG)) {
-      char const *name = nm.child_value();
-      Mutex *m = node->findMutex(name);
+    node->allocateUsingMutexes(tmpl.usingMutexes.size());
+    for (ElementTemplate const &nm : tmpl.usingMutexes) {
+      Mutex *m = node->findMutex(nm.name);
       // Belt-and-suspenders check
       checkParserExceptionWithLocation(m,
-                                       nm,
-                                       "Internal error: No mutex named \"" << name
+                                       nm.xml,
+                                       "Internal error: No mutex named \"" << nm.name
                                        << "\" accessible from node "
                                        << node->getNodeId());
-      names.push_back(name);
       node->addUsingMutex(m);
     };
   }
 
-  static void constructChildNodes(ListNode *node, xml_node const kidsXml)
+  static void constructChildNodes(ListNode *node, NodeTemplate const &tmpl)
   {
     assertTrue_1(node);
 
-    xml_node kidXml = kidsXml.first_child();
-    if (!kidXml)
+    if (tmpl.children.empty())
       return; // empty list
 
-    size_t n = 1;
-    while ((kidXml = kidXml.next_sibling()))
-      ++n;
-
-    node->reserveChildren(n);
-
-    // Construct the children.
-    kidXml = kidsXml.first_child();
-    do {
-      node->addChild(constructNode(kidXml, node));
-    } while ((kidXml = kidXml.next_sibling()));
+    node->reserveChildren(tmpl.children.size());
+    for (NodeTemplate const &kid : tmpl.children)
+      node->addChild(constructNode(kid, node));
   }
 
-  NodeImpl *constructNode(xml_node const xml, NodeImpl *parent)
+  NodeImpl *constructNode(NodeTemplate const &tmpl, NodeImpl *parent)
   {
-    xml_attribute attr = xml.attribute(NODETYPE_ATTR);
-    PlexilNodeType nodeType = parseNodeType(attr.value());
-    checkParserExceptionWithLocation(nodeType < NodeType_error,
-                                     xml, // should really be the attribute
-                                     "Invalid " << attr.name()
-                                     << " value \"" << attr.value() << "\"");
-
     debugMsg("parseNode", " constructing node");
-    NodeImpl *node =
-      NodeFactory::createNode(xml.child(NODEID_TAG).child_value(),
-                              nodeType,
-                              parent);
+    NodeImpl *node = NodeFactory::createNode(tmpl.nodeId, tmpl.nodeType, parent);
     debugMsg("parseNode", " Node " << node->getNodeId()  << " created");
 
     try {
-      // Get priority, if supplied.
-      parsePriority(node, xml);
+      // Set priority, if supplied.
+      if (tmpl.hasPriority)
+        node->setPriority(tmpl.priority);
 
       // Populate interface and local variables.
-      initializeNodeVariables(node, xml);
+      initializeNodeVariables(node, tmpl);
 
       // Populate mutexes
-      initializeNodeMutexes(node, xml);
+      initializeNodeMutexes(node, tmpl);
 
       // Construct body
       debugMsg("parseNode", " constructing body");
-      switch (nodeType) {
+      switch (tmpl.nodeType) {
       case NodeType_Assignment:
-        constructAssignment(dynamic_cast<AssignmentNode *>(node), xml);
+        constructAssignment(dynamic_cast<AssignmentNode *>(node), tmpl.xml);
         break;
 
       case NodeType_Command:
@@ -942,18 +893,15 @@ namespace PLEXIL
         break;
 
       case NodeType_LibraryNodeCall:
-        constructLibraryCall(dynamic_cast<LibraryCallNode *>(node),
-                             xml.child(BODY_TAG).first_child());
+        constructLibraryCall(dynamic_cast<LibraryCallNode *>(node), tmpl);
         break;
 
       case NodeType_NodeList:
-        constructChildNodes(dynamic_cast<ListNode *>(node),
-                            xml.child(BODY_TAG).first_child());
+        constructChildNodes(dynamic_cast<ListNode *>(node), tmpl);
         break;
 
       case NodeType_Update:
-        dynamic_cast<UpdateNode *>(node)->setUpdate(constructUpdate(node, 
-                                                                    xml.child(BODY_TAG).first_child()));
+        dynamic_cast<UpdateNode *>(node)->setUpdate(constructUpdate(node, tmpl.bodyXml));
         break;
 
       case NodeType_Empty:
@@ -975,6 +923,12 @@ namespace PLEXIL
     return node;
   }
 
+  NodeImpl *constructNode(xml_node const xml, NodeImpl *parent)
+  {
+    NodeTemplate const tmpl(xml);
+    return constructNode(tmpl, parent);
+  }
+
   //
   // Third pass: finalize the node
   //
@@ -1065,23 +1019,20 @@ namespace PLEXIL
   }
 
   //! Process initializers in this node's variable declarations, if any
-  static void constructVariableInitializers(NodeImpl *node, xml_node const nodeXml)
+  static void constructVariableInitializers(NodeImpl *node, NodeTemplate const &tmpl)
   {
-    if (!nodeXml.child(VAR_DECLS_TAG))
+    if (tmpl.initializedVariables.empty())
       return;
     debugMsg("finalizeNode",
              " constructing variable initializers for " << node->getNodeId());
-    for (xml_node decl : nodeXml.child(VAR_DECLS_TAG).children()) {
-      if (decl.child(INITIALVAL_TAG)) {
-        char const *varName = getVarDeclName(decl);
-        Expression *var = node->findLocalVariable(varName);
-        assertTrueMsg(var,
-                      "parseVariableInitializer: Internal error: variable " << varName
-                      << " not found in node " << node->getNodeId());
-        bool garbage = false;
-        Expression *init = parseVariableInitializer(garbage, node, decl, false);
-        var->asAssignable()->getBaseVariable()->setInitializer(init, garbage);
-      }
+    for (ElementTemplate const &decl : tmpl.initializedVariables) {
+      Expression *var = node->findLocalVariable(decl.name);
+      assertTrueMsg(var,
+                    "parseVariableInitializer: Internal error: variable " << decl.name
+                    << " not found in node " << node->getNodeId());
+      bool garbage = false;
+      Expression *init = parseVariableInitializer(garbage, node, decl.xml, false);
+      var->asAssignable()->getBaseVariable()->setInitializer(init, garbage);
     }
   }
 
@@ -1214,97 +1165,85 @@ namespace PLEXIL
     }
   }
 
-  static void linkAndInitializeInterfaceVars(NodeImpl *node, xml_node const nodeXml)
+  static void linkAndInitializeInterfaceVars(NodeImpl *node, NodeTemplate const &tmpl)
   {
-    xml_node const iface = nodeXml.child(INTERFACE_TAG);
-    if (!iface)
+    if (tmpl.inVariables.empty() && tmpl.inOutVariables.empty())
       return;
     
     debugMsg("linkAndInitializeInterface", " node " << node->getNodeId());
     NodeImpl *parent = node->getParentNode();
     bool isCall = (parent && parent->getType() == NodeType_LibraryNodeCall);
-    for (xml_node temp = iface.first_child(); temp; temp = temp.next_sibling()) {
-      if (testTag(IN_TAG, temp)) {
-        for (xml_node decl = temp.first_child(); decl; decl = decl.next_sibling())
-          linkInVar(node, decl, isCall);
-      }
-      else if (testTag(INOUT_TAG, temp)) {
-        for (xml_node decl = temp.first_child(); decl; decl = decl.next_sibling())
-          linkInOutVar(node, decl, isCall);
-      }
-    }
+    for (ElementTemplate const &decl : tmpl.inVariables)
+      linkInVar(node, decl.xml, isCall);
+    for (ElementTemplate const &decl : tmpl.inOutVariables)
+      linkInOutVar(node, decl.xml, isCall);
   }
 
-  static void createConditions(NodeImpl *node, xml_node const xml)
+  static void createConditions(NodeImpl *node, NodeTemplate const &tmpl)
   {
-    for (xml_node elt = xml.first_child(); elt; elt = elt.next_sibling()) {
-      char const *tag = elt.name();
-      if (testSuffix(CONDITION_SUFFIX, tag)) {
-        debugMsg("finalizeNode", " processing condition " << tag);
-        bool garbage;
-        Expression *cond = createExpression(elt.first_child(), node, garbage);
-        ValueType condType = cond->valueType();
-        if (condType != BOOLEAN_TYPE && condType != UNKNOWN_TYPE) {
-          if (garbage)
-            delete cond;
-          reportParserExceptionWithLocation(elt.first_child(),
-                                            "Node " << node->getNodeId() << ": "
-                                            << tag << " expression is not Boolean");
-        }
-        node->addUserCondition(tag, cond, garbage);
+    for (ElementTemplate const &elt : tmpl.conditions) {
+      debugMsg("finalizeNode", " processing condition " << elt.name);
+      xml_node const condXml = elt.xml.first_child();
+      bool garbage;
+      Expression *cond = createExpression(condXml, node, garbage);
+      ValueType condType = cond->valueType();
+      if (condType != BOOLEAN_TYPE && condType != UNKNOWN_TYPE) {
+        if (garbage)
+          delete cond;
+        reportParserExceptionWithLocation(condXml,
+                                          "Node " << node->getNodeId() << ": "
+                                          << elt.name << " expression is not Boolean");
       }
+      node->addUserCondition(elt.name, cond, garbage);
     }
 
     node->finalizeConditions();
   }
 
-  static void finalizeListNode(ListNode *node, xml_node const listXml)
+  static void finalizeListNode(ListNode *node, NodeTemplate const &tmpl)
   {
     assertTrue_1(node);
     std::vector<NodeImplPtr> &kids = node->getChildren();
     std::vector<NodeImplPtr>::iterator kid = kids.begin();
-    xml_node kidXml = listXml.first_child();
-    while (kid != kids.end() && kidXml) {
-      finalizeNode(kid->get(), kidXml);
+    std::vector<NodeTemplate>::const_iterator kidTmpl = tmpl.children.begin();
+    while (kid != kids.end() && kidTmpl != tmpl.children.end()) {
+      finalizeNode(kid->get(), *kidTmpl);
       ++kid;
-      kidXml = kidXml.next_sibling();
+      ++kidTmpl;
     }
   }
 
-  void finalizeNode(NodeImpl *node, xml_node const xml)
+  void finalizeNode(NodeImpl *node, NodeTemplate const &tmpl)
   {
     debugMsg("finalizeNode", " node " << node->getNodeId());
-    linkAndInitializeInterfaceVars(node, xml);
-    constructVariableInitializers(node, xml);
-    createConditions(node, xml);
+    linkAndInitializeInterfaceVars(node, tmpl);
+    constructVariableInitializers(node, tmpl);
+    createConditions(node, tmpl);
 
     // Process body
     switch (node->getType()) {
     case NodeType_Assignment:
-      finalizeAssignment(dynamic_cast<AssignmentNode *>(node),
-                         xml.child(BODY_TAG).first_child());
+      finalizeAssignment(dynamic_cast<AssignmentNode *>(node), tmpl.bodyXml);
       break;
       
     case NodeType_Command:
       finalizeCommand(dynamic_cast<CommandNode *>(node)->getCommand(),
                       node,
-                      xml.child(BODY_TAG).first_child());
+                      tmpl.bodyXml);
       break;
 
     case NodeType_LibraryNodeCall:
-      finalizeLibraryCall(dynamic_cast<LibraryCallNode *>(node),
-                          xml.child(BODY_TAG).first_child());
+      finalizeLibraryCall(dynamic_cast<LibraryCallNode *>(node), tmpl);
       break;
 
     case NodeType_NodeList:
-      finalizeListNode(dynamic_cast<ListNode *>(node),
-                       xml.child(BODY_TAG).first_child());
+      finalizeListNode(dynamic_cast<ListNode *>(node), tmpl);
       break;
 
     case NodeType_Update:
       finalizeUpdate(dynamic_cast<UpdateNode *>(node)->getUpdate(),
                      node,
-                     xml.child(BODY_TAG).first_child());
+                     tmpl.bodyXml);
       break;
 
       // No-op for empty.
@@ -1314,4 +1253,10 @@ namespace PLEXIL
     }
   }
 
+  void finalizeNode(NodeImpl *node, xml_node const xml)
+  {
+    NodeTemplate const tmpl(xml);
+    finalizeNode(node, tmpl);
+  }
+
 } // namespace PLEXIL
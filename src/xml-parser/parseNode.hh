@@ -35,6 +35,7 @@ namespace pugi
 namespace PLEXIL
 {
   class NodeImpl;
+  struct NodeTemplate;
 
   /**
    * @brief Check the node's XML before taking any action
@@ -52,6 +53,15 @@ namespace PLEXIL
    */
   extern NodeImpl *constructNode(pugi::xml_node const xml, NodeImpl *parent);
 
+  /**
+   * @brief Construct the node and all its children from the given template.
+   * @param tmpl The template of the node's XML.
+   * @param parent The node which is the parent of the returned value.
+   * @return The node represented by the template, with all its children and variables populated.
+   * @note Presumes that checkNode() has already been called on the template's XML.
+   */
+  extern NodeImpl *constructNode(NodeTemplate const &tmpl, NodeImpl *parent);
+
   /**
    * @brief Construct all the expressions for the node and its children from the given XML DOM.
    * @param node The node to finalize.
@@ -59,6 +69,13 @@ namespace PLEXIL
    */
   extern void finalizeNode(NodeImpl *node, pugi::xml_node const xml);
 
+  /**
+   * @brief Construct all the expressions for the node and its children from the given template.
+   * @param node The node to finalize.
+   * @param tmpl The template from which the node was constructed.
+   */
+  extern void finalizeNode(NodeImpl *node, NodeTemplate const &tmpl);
+
 } // namespace PLEXIL
 
 #endif // PLEXIL_PARSE_NODE_HH
@@ -26,10 +26,14 @@
 
 #include "Debug.hh"
 #include "NodeImpl.hh"
+#include "NodeTemplate.hh"
 #include "parseGlobalDeclarations.hh"
 #include "parseNode.hh"
 #include "parser-utils.hh"
 #include "ParserException.hh"
+#include "PlanArena.hh"
+#include "planLibrary.hh"
+#include "planLoader.hh"
 #include "PlexilSchema.hh"
 #include "SymbolTable.hh"
 
@@ -99,16 +103,17 @@ namespace PLEXIL
     return result;
   }
 
-  NodeImpl *constructPlan(xml_node const xml, SymbolTable *symtab, NodeImpl *parent)
+  static NodeImpl *constructPlan(NodeTemplate const &rootTemplate,
+                                  SymbolTable *symtab,
+                                  NodeImpl *parent)
   {
-    xml_node const root = xml.child(NODE_TAG);
-    debugMsg("constructPlan", ' ' << root.child_value(NODEID_TAG));
+    debugMsg("constructPlan", ' ' << rootTemplate.nodeId);
     pushSymbolTable(symtab);
     NodeImpl *result = nullptr;
     try {
       // Construct the plan
       try {
-        result = constructNode(root, parent);
+        result = constructNode(rootTemplate, parent);
       }
       catch (...) {
         delete result;
@@ -127,16 +132,33 @@ namespace PLEXIL
     return result;
   }
 
+  NodeImpl *constructPlan(xml_node const xml, SymbolTable *symtab, NodeImpl *parent)
+  {
+    NodeTemplate const rootTemplate(xml.child(NODE_TAG));
+    return constructPlan(rootTemplate, symtab, parent);
+  }
+
   NodeImpl *parsePlan(xml_node const xml)
   {
     debugMsg("parsePlan", "entered");
     // Perform surface checks & log global symbols
     SymbolTable *symtab = checkPlan(xml);
+
+    // Read the called libraries ahead of time, if that can be done in parallel
+    if (getPlanLoaderThreads() > 1)
+      preloadLibraries(xml);
+
+    // Nodes and expressions of the plan come from one arena, which
+    // is freed when the last of them is deleted
+    PlanArena::Scope arenaScope;
+
+    // Locate the node structure once, for both passes
+    NodeTemplate const rootTemplate(xml.child(NODE_TAG));
     NodeImpl *result = nullptr;
-    result = constructPlan(xml, symtab, nullptr); // can throw ParserException
+    result = constructPlan(rootTemplate, symtab, nullptr); // can throw ParserException
     pushSymbolTable(symtab);
     try {
-      finalizeNode(result, xml.child(NODE_TAG));
+      finalizeNode(result, rootTemplate);
     }
     catch (...) {
       popSymbolTable();
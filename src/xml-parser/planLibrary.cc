@@ -26,16 +26,23 @@
 
 #include "planLibrary.hh"
 
+#include "Debug.hh"
 #include "lifecycle-utils.h"
 #include "map-utils.hh"
+#include "NodeTemplate.hh"
 #include "parsePlan.hh"
+#include "parser-utils.hh"
 #include "ParserException.hh"
+#include "planLoader.hh"
 #include "PlexilSchema.hh"
 #include "SimpleMap.hh"
 #include "SymbolTable.hh"
 
 #include "pugixml.hpp"
 
+#include <algorithm>
+#include <exception>
+
 using pugi::xml_document;
 using pugi::xml_node;
 using std::string;
@@ -79,6 +86,8 @@ namespace PLEXIL
   {
     for (LibraryMap::iterator it = s_libraryMap.begin(); it != s_libraryMap.end(); ++it) {
       Library &l = it->second;
+      delete l.nodeTemplate;
+      l.nodeTemplate = nullptr;
       delete l.doc;
       l.doc = nullptr;
       delete l.symtab;
@@ -108,10 +117,10 @@ namespace PLEXIL
   }
 
   // name could be node name, file name w/ or w/o directory, w/ w/o .plx
-  Library const *loadLibraryNode(char const *name)
+  static void parseLibraryName(char const *name, string &nodeName, string &fname)
   {
-    string nodeName = name;
-    string fname = name;
+    nodeName = name;
+    fname = name;
     size_t pos = fname.rfind(".plx");
     if (pos == string::npos)
       fname += ".plx";
@@ -120,6 +129,12 @@ namespace PLEXIL
     pos = nodeName.find_last_of("/\\");
     if (pos != string::npos)
       nodeName = nodeName.substr(++pos);
+  }
+
+  Library const *loadLibraryNode(char const *name)
+  {
+    string nodeName, fname;
+    parseLibraryName(name, nodeName, fname);
 
     xml_document *doc = loadLibraryFile(fname);
     if (!doc)
@@ -147,7 +162,10 @@ namespace PLEXIL
       return nullptr;
   }
 
-  Library const *loadLibraryDocument(xml_document *doc)
+  // Internal fn
+  // If reportErrors is false, a library which fails its checks is
+  // discarded without comment.
+  static Library *installLibraryDocument(xml_document *doc, bool reportErrors)
   {
     // Check if already loaded
     xml_node const plan = doc->document_element();
@@ -161,16 +179,22 @@ namespace PLEXIL
     }
 
     SymbolTable *symtab = nullptr;
+    NodeTemplate *tmpl = nullptr;
     try {
       symtab = checkPlan(plan);
+      // Locate the node structure once, for use by every call
+      tmpl = new NodeTemplate(plan.child(NODE_TAG));
     }
     catch (ParserException const &exc) {
+      delete symtab;
+      if (reportErrors)
+        warn("Unable to load library node \"" << nodeId << "\": "
+             << exc.what());
       delete doc;
-      warn("Unable to load library node \"" << nodeId << "\": "
-           << exc.what());
       return nullptr;
     }
     catch (...) {
+      delete symtab;
       delete doc;
       throw;
     }
@@ -178,10 +202,12 @@ namespace PLEXIL
     // Success!
     if (l) {
       // Replace previous version
+      delete l->nodeTemplate;
       delete l->doc;
       delete l->symtab;
       l->doc = doc;
       l->symtab = symtab;
+      l->nodeTemplate = tmpl;
       return l;
     }
     else {
@@ -193,11 +219,98 @@ namespace PLEXIL
       }
       
       std::string nodeStr = nodeId;
-      s_libraryMap[nodeStr] = Library(doc, symtab);
+      s_libraryMap[nodeStr] = Library(doc, symtab, tmpl);
       return &s_libraryMap[nodeStr];
     }
   }
 
+  Library const *loadLibraryDocument(xml_document *doc)
+  {
+    return installLibraryDocument(doc, true);
+  }
+
+  // Internal fn
+  static void collectLibraryCalls(xml_node const xml, vector<string> &names)
+  {
+    for (xml_node elt = xml.first_child(); elt; elt = elt.next_sibling()) {
+      if (elt.type() != pugi::node_element)
+        continue;
+      if (testTag(LIBRARYNODECALL_TAG, elt))
+        names.push_back(elt.child_value(NODEID_TAG));
+      else
+        collectLibraryCalls(elt, names);
+    }
+  }
+
+  // Internal fn
+  static void preloadCalledLibraries(xml_node const plan)
+  {
+    vector<string> names;
+    collectLibraryCalls(plan, names);
+
+    while (!names.empty()) {
+      // Load each library once, in a consistent order
+      std::sort(names.begin(), names.end());
+      names.erase(std::unique(names.begin(), names.end()), names.end());
+      names.erase(std::remove_if(names.begin(), names.end(),
+                                 [](string const &name) -> bool
+                                 { return isLibraryLoaded(name.c_str()); }),
+                  names.end());
+      if (names.empty())
+        return;
+      debugMsg("preloadLibraries", ' ' << names.size() << " libraries");
+
+      // Locate and parse the files concurrently
+      size_t const n = names.size();
+      vector<string> nodeNames(n);
+      vector<xml_document *> docs(n, nullptr);
+      vector<std::exception_ptr> errors;
+      runLoaderTasks(n,
+                     [&names, &nodeNames, &docs](size_t i) -> void
+                     {
+                       string fname;
+                       parseLibraryName(names[i].c_str(), nodeNames[i], fname);
+                       docs[i] = loadLibraryFile(fname);
+                     },
+                     errors);
+
+      // Check and install them in name order.  Checking registers
+      // global declarations, and so cannot be done concurrently.
+      // Failures are left for the plan's own load to report.
+      vector<string> calls;
+      for (size_t i = 0; i < n; ++i) {
+        xml_document *doc = docs[i];
+        if (!doc)
+          continue;
+        xml_node const libPlan = doc->document_element();
+        if (nodeNames[i] != libPlan.child(NODE_TAG).child_value(NODEID_TAG)
+            || isLibraryLoaded(nodeNames[i].c_str())) {
+          delete doc;
+          continue;
+        }
+        try {
+          if (installLibraryDocument(doc, false))
+            collectLibraryCalls(libPlan, calls);
+        }
+        catch (...) {
+          // Free the rest, and leave the error to the serial load
+          for (size_t j = i + 1; j < n; ++j)
+            delete docs[j];
+          return;
+        }
+      }
+      names.swap(calls);
+    }
+  }
+
+  void preloadLibraries(xml_node const plan)
+  {
+    // Errors are left for the plan's own load to report
+    bool const wasLogging = ParserException::setLogging(false);
+    preloadCalledLibraries(plan);
+    ParserException::setLogging(wasLogging);
+  }
+
   bool isLibraryLoaded(char const *name)
   {
     LibraryMap::iterator it = s_libraryMap.find<char const *, CStringComparator>(name);
@@ -33,23 +33,27 @@
 namespace pugi
 {
   class xml_document;
+  class xml_node;
 }
 
 namespace PLEXIL
 {
   class SymbolTable;
+  struct NodeTemplate;
 
-  // A Library consists of a pre-checked XML document
-  // and the symbol table generated by the check.
+  // A Library consists of a pre-checked XML document,
+  // the symbol table generated by the check,
+  // and the template from which calls to the library are constructed.
   struct Library {
     pugi::xml_document *doc;
     SymbolTable *symtab;
+    NodeTemplate *nodeTemplate;
 
     Library()
-      : doc(nullptr), symtab(nullptr)
+      : doc(nullptr), symtab(nullptr), nodeTemplate(nullptr)
     {}
-    Library(pugi::xml_document *d, SymbolTable *s)
-      : doc(d), symtab(s)
+    Library(pugi::xml_document *d, SymbolTable *s, NodeTemplate *t)
+      : doc(d), symtab(s), nodeTemplate(t)
     {}
   };
 
@@ -109,6 +113,17 @@ namespace PLEXIL
    */
   extern Library const *loadLibraryDocument(pugi::xml_document *doc);
 
+  /**
+   * @brief Load every library called by the plan, and by the libraries
+   *        it calls, which is not already loaded.
+   * @param plan The top level element of the plan's XML.
+   * @note The library files are located and parsed on the plan loader
+   *       threads; see planLoader.hh.
+   * @note Libraries which cannot be loaded are silently skipped, to be
+   *       reported when the plan itself is constructed.
+   */
+  extern void preloadLibraries(pugi::xml_node const plan);
+
 } // namespace PLEXIL
 
 #endif // PLEXIL_PLAN_LIBRARY_HH
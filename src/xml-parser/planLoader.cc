@@ -0,0 +1,126 @@
+/* Copyright (c) 2006-2020, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "planLoader.hh"
+
+#include "plexil-config.h"
+
+#include "Debug.hh"
+#include "ParserException.hh"
+#include "SymbolTable.hh"
+
+#ifdef PLEXIL_WITH_THREADS
+#include <atomic>
+#include <thread>
+#endif
+
+namespace PLEXIL
+{
+
+  static unsigned int s_loaderThreads = 1;
+
+  //! True while the current thread is running a loader task.
+  static thread_local bool t_inLoaderTask = false;
+
+  void setPlanLoaderThreads(unsigned int n)
+  {
+#ifdef PLEXIL_WITH_THREADS
+    s_loaderThreads = n ? n : 1;
+#else
+    s_loaderThreads = 1;
+#endif
+    debugMsg("setPlanLoaderThreads", ' ' << s_loaderThreads);
+  }
+
+  unsigned int getPlanLoaderThreads()
+  {
+    return s_loaderThreads;
+  }
+
+  // Debug output from loader threads would interleave, so load
+  // serially while any debug messages are enabled
+  bool useLoaderThreads(size_t n)
+  {
+    return s_loaderThreads > 1 && !t_inLoaderTask && n > 1
+      && !debugMessagesEnabled();
+  }
+
+  static void runTask(size_t i,
+                      std::function<void(size_t)> const &fn,
+                      std::vector<std::exception_ptr> &errors)
+  {
+    try {
+      fn(i);
+    }
+    catch (...) {
+      errors[i] = std::current_exception();
+    }
+  }
+
+  void runLoaderTasks(size_t n,
+                      std::function<void(size_t)> const &fn,
+                      std::vector<std::exception_ptr> &errors)
+  {
+    errors.assign(n, nullptr);
+
+#ifdef PLEXIL_WITH_THREADS
+    if (useLoaderThreads(n)) {
+      SymbolTable *symtab = getSymbolTable();
+      std::atomic<size_t> nextTask(0);
+      auto work =
+        [n, &fn, &errors, &nextTask, symtab]() -> void
+        {
+          bool const wasInTask = t_inLoaderTask;
+          t_inLoaderTask = true;
+          // The caller reports the errors it rethrows
+          bool const wasLogging = ParserException::setLogging(false);
+          pushSymbolTable(symtab);
+          size_t i;
+          while ((i = nextTask.fetch_add(1)) < n)
+            runTask(i, fn, errors);
+          popSymbolTable();
+          ParserException::setLogging(wasLogging);
+          t_inLoaderTask = wasInTask;
+        };
+
+      size_t const nWorkers = std::min((size_t) s_loaderThreads, n) - 1;
+      debugMsg("runLoaderTasks", ' ' << n << " tasks on " << nWorkers + 1 << " threads");
+      std::vector<std::thread> workers;
+      workers.reserve(nWorkers);
+      for (size_t w = 0; w < nWorkers; ++w)
+        workers.emplace_back(work);
+      work(); // the calling thread does its share
+      for (std::thread &t : workers)
+        t.join();
+      return;
+    }
+#endif
+
+    for (size_t i = 0; i < n; ++i)
+      runTask(i, fn, errors);
+  }
+
+} // namespace PLEXIL
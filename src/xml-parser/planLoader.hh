@@ -0,0 +1,90 @@
+/* Copyright (c) 2006-2020, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_PLAN_LOADER_HH
+#define PLEXIL_PLAN_LOADER_HH
+
+#include <exception>
+#include <functional>
+#include <vector>
+
+#include <cstddef>
+
+//
+// Parallel plan loading.
+//
+// When more than one loader thread is requested, the parser checks
+// the children of large NodeList nodes concurrently, and locates and
+// parses the library files called by a plan concurrently.  The plan's
+// nodes are still constructed on the calling thread.
+//
+// Work is always divided so that its results, and any error reported,
+// are the same as for serial loading.
+//
+
+namespace PLEXIL
+{
+
+  /**
+   * @brief Set the number of threads used to load a plan, including
+   *        the calling thread.
+   * @param n The number of threads. 0 and 1 mean serial loading.
+   * @note Ignored in builds without thread support.
+   * @note Plans are still loaded serially while any debug messages
+   *       are enabled.
+   */
+  extern void setPlanLoaderThreads(unsigned int n);
+
+  /**
+   * @brief Get the number of threads used to load a plan.
+   * @return The number of threads, including the calling thread.
+   */
+  extern unsigned int getPlanLoaderThreads();
+
+  /**
+   * @brief Query whether a batch of loader tasks of the given size
+   *        would be run on more than one thread.
+   * @param n The number of tasks.
+   * @return true if so, false if the tasks would be run serially.
+   */
+  extern bool useLoaderThreads(size_t n);
+
+  /**
+   * @brief Call fn(i) for every i from 0 to n - 1, on the loader threads.
+   * @param n The number of tasks.
+   * @param fn The task function.
+   * @param errors Vector to receive, for each task, the exception it
+   *               threw, or nullptr.
+   * @note Each task runs with the calling thread's symbol table current.
+   * @note Tasks run serially if called from within a loader task.
+   */
+  extern void runLoaderTasks(size_t n,
+                             std::function<void(size_t)> const &fn,
+                             std::vector<std::exception_ptr> &errors);
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_PLAN_LOADER_HH
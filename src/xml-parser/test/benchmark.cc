@@ -34,14 +34,20 @@
 #include "planLibrary.hh"
 #include "pugixml.hpp"
 
+#include <deque>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include <cstdlib>
 #include <cstring>
 
+#ifdef __linux__
+#include <unistd.h> // sysconf()
+#endif
+
 #if defined(HAVE_GETTIMEOFDAY) && !defined(__VXWORKS__)
 #include <sys/time.h> // for gettimeofday, itimerval
 #include "timeval-utils.hh"
@@ -61,6 +67,135 @@
 #define REPORT_TIME(start, finish) do {} while (0)
 #endif
 
+//
+// Generated plan: a list node of library calls, all to the same library
+// node.  The library node declares an In variable and a local variable,
+// and contains an Assignment node and one or more conditioned Empty nodes.
+//
+
+static char const *LIBRARY_NODE_NAME = "BenchmarkLibrary";
+
+static void makePcdataElement(pugi::xml_node parent, char const *name, char const *value)
+{
+  parent.append_child(name).append_child(pugi::node_pcdata).set_value(value);
+}
+
+static pugi::xml_node makeNode(pugi::xml_node parent,
+                               char const *nodeId,
+                               char const *nodeType)
+{
+  pugi::xml_node result = parent.append_child("Node");
+  result.append_attribute("NodeType").set_value(nodeType);
+  makePcdataElement(result, "NodeId", nodeId);
+  return result;
+}
+
+static void makeDeclareVariable(pugi::xml_node parent,
+                                char const *varName,
+                                char const *varType)
+{
+  pugi::xml_node decl = parent.append_child("DeclareVariable");
+  makePcdataElement(decl, "Name", varName);
+  makePcdataElement(decl, "Type", varType);
+}
+
+static pugi::xml_document *makeLibraryDocument(unsigned int nChecks)
+{
+  pugi::xml_document *doc = new pugi::xml_document;
+  pugi::xml_node lib = makeNode(doc->append_child("PlexilPlan"), LIBRARY_NODE_NAME, "NodeList");
+  makeDeclareVariable(lib.append_child("Interface").append_child("In"), "count", "Integer");
+  makeDeclareVariable(lib.append_child("VariableDeclarations"), "total", "Integer");
+  pugi::xml_node kids = lib.append_child("NodeBody").append_child("NodeList");
+
+  pugi::xml_node assn = makeNode(kids, "Add", "Assignment");
+  pugi::xml_node assnBody = assn.append_child("NodeBody").append_child("Assignment");
+  makePcdataElement(assnBody, "IntegerVariable", "total");
+  pugi::xml_node add = assnBody.append_child("NumericRHS").append_child("ADD");
+  makePcdataElement(add, "IntegerVariable", "count");
+  makePcdataElement(add, "IntegerValue", "1");
+
+  for (unsigned int i = 0; i < nChecks; ++i) {
+    std::string const checkId = "Check" + std::to_string(i);
+    pugi::xml_node check = makeNode(kids, checkId.c_str(), "Empty");
+    pugi::xml_node gt = check.append_child("StartCondition").append_child("GT");
+    makePcdataElement(gt, "IntegerVariable", "total");
+    makePcdataElement(gt, "IntegerValue", "0");
+  }
+  return doc;
+}
+
+static pugi::xml_document *makeCallingPlan(unsigned int nCalls)
+{
+  pugi::xml_document *doc = new pugi::xml_document;
+  pugi::xml_node root = makeNode(doc->append_child("PlexilPlan"), "LibraryCalls", "NodeList");
+  pugi::xml_node kids = root.append_child("NodeBody").append_child("NodeList");
+  for (unsigned int i = 0; i < nCalls; ++i) {
+    std::string const callId = "Call" + std::to_string(i);
+    std::string const count = std::to_string(i);
+    pugi::xml_node call = makeNode(kids, callId.c_str(), "LibraryNodeCall");
+    pugi::xml_node callBody = call.append_child("NodeBody").append_child("LibraryNodeCall");
+    makePcdataElement(callBody, "NodeId", LIBRARY_NODE_NAME);
+    pugi::xml_node alias = callBody.append_child("Alias");
+    makePcdataElement(alias, "NodeParameter", "count");
+    makePcdataElement(alias, "IntegerValue", count.c_str());
+  }
+  return doc;
+}
+
+// Resident set size in KiB, or 0 if it can't be determined.
+static size_t residentKiB()
+{
+#ifdef __linux__
+  std::ifstream statm("/proc/self/statm");
+  size_t pages = 0, resident = 0;
+  if (statm >> pages >> resident)
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+  return 0;
+}
+
+//
+// Soak test: parse plans of varying size, keeping up to window plans
+// alive at once as a long-running Exec would, and report the resident
+// set size at intervals.  Plan i has nCalls >> (i % 4) library calls.
+//
+
+static void soakBenchmark(unsigned int n,
+                          unsigned int nCalls,
+                          unsigned int window,
+                          unsigned int reportInterval)
+{
+  std::vector<pugi::xml_document *> docs;
+  for (unsigned int i = 0; i < 4; ++i)
+    docs.push_back(makeCallingPlan(nCalls >> i ? nCalls >> i : 1));
+
+  std::deque<PLEXIL::NodeImpl *> live;
+  std::cout << "Initial RSS " << residentKiB() << " KiB" << std::endl;
+  for (unsigned int i = 0; i < n; ++i) {
+    PLEXIL::NodeImpl *root = PLEXIL::parsePlan(docs[i % 4]->document_element());
+    checkParserException(root, "parsePlan returned null");
+    live.push_back(root);
+    if (live.size() > window) {
+      delete live.front();
+      live.pop_front();
+    }
+    if (reportInterval && !((i + 1) % reportInterval))
+      std::cout << "After " << i + 1 << " plans RSS " << residentKiB() << " KiB" << std::endl;
+  }
+  for (PLEXIL::NodeImpl *root : live)
+    delete root;
+  std::cout << "Final RSS " << residentKiB() << " KiB" << std::endl;
+  for (pugi::xml_document *doc : docs)
+    delete doc;
+}
+
+void parsePlanBenchmark(pugi::xml_document const *doc)
+{
+  PLEXIL::NodeImpl *root = PLEXIL::parsePlan(doc->document_element());
+  checkParserException(root, "parsePlan returned null");
+  delete root;
+}
+
 void loadPlanBenchmark(std::string const &planFile)
 {
   // Load the XML
@@ -77,11 +212,19 @@ void loadPlanBenchmark(std::string const &planFile)
 void usage()
 {
   std::cout << "Usage: benchmark [options] <plan file>\n"
+            << "       benchmark [options] -c <number>\n"
             << " Options:\n"
             << "  -L <dir>         Add <dir> to library path\n"
             << "  -h               Display this message and exit\n"
             << "  -d <debug file>  Use debug-file as debug message config (default Debug.cfg)\n"
             << "  -n <number>      Number of times to load the plan (default 1)\n"
+            << "  -c <number>      Instead of a plan file, generate a plan with <number>\n"
+            << "                   calls to one library node\n"
+            << "  -k <number>      With -c, the library node has <number> Empty children\n"
+            << "                   (default 1)\n"
+            << "  -w <number>      With -c, soak test: vary the plan size and keep up to\n"
+            << "                   <number> plans loaded at once\n"
+            << "  -r <number>      With -w, report the resident set size every <number> plans\n"
             << std::endl;
 }
 
@@ -90,6 +233,10 @@ int main(int argc, char *argv[])
   std::string debugConfig("Debug.cfg");
   std::string planFile;
   unsigned int n = 1;
+  unsigned int nCalls = 0;
+  unsigned int nChecks = 1;
+  unsigned int window = 0;
+  unsigned int reportInterval = 0;
 
   for (int i = 1; i < argc; ++i) {
     if (!strcmp(argv[i], "-d"))
@@ -110,6 +257,42 @@ int main(int argc, char *argv[])
       }
       n = (unsigned int) nspec;
     }
+    else if (!strcmp(argv[i], "-c")) {
+      int cspec = atoi(argv[++i]);
+      if (cspec <= 0) {
+        std::cerr << "-c option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+      nCalls = (unsigned int) cspec;
+    }
+    else if (!strcmp(argv[i], "-k")) {
+      int kspec = atoi(argv[++i]);
+      if (kspec <= 0) {
+        std::cerr << "-k option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+      nChecks = (unsigned int) kspec;
+    }
+    else if (!strcmp(argv[i], "-w")) {
+      int wspec = atoi(argv[++i]);
+      if (wspec <= 0) {
+        std::cerr << "-w option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+      window = (unsigned int) wspec;
+    }
+    else if (!strcmp(argv[i], "-r")) {
+      int rspec = atoi(argv[++i]);
+      if (rspec <= 0) {
+        std::cerr << "-r option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+      reportInterval = (unsigned int) rspec;
+    }
     else {
       if (!planFile.empty()) {
         std::cerr << "Multiple plan files specified" << std::endl;
@@ -120,7 +303,7 @@ int main(int argc, char *argv[])
     }
   }
 
-  if (planFile.empty()) {
+  if (planFile.empty() && !nCalls) {
     std::cerr << "No plan file specified" << std::endl;
     usage();
     return 1;
@@ -134,7 +317,14 @@ int main(int argc, char *argv[])
   else
      std::cerr << "Unable to read configuration file " << debugConfig << " - continuing\n";
   
-  std::cout << "Loading plan file " << planFile << ' ' << n << " times..." << std::endl;
+  if (nCalls && window)
+    std::cout << "Soak test: parsing " << n << " plans of up to " << nCalls
+              << " library calls, " << window << " loaded at once..." << std::endl;
+  else if (nCalls)
+    std::cout << "Parsing a plan of " << nCalls << " library calls "
+              << n << " times..." << std::endl;
+  else
+    std::cout << "Loading plan file " << planFile << ' ' << n << " times..." << std::endl;
 
   TIME_STRUCT start, finish;
 
@@ -142,10 +332,29 @@ int main(int argc, char *argv[])
     // Initialize infrastructure
     PLEXIL::Error::doThrowExceptions();
 
-    GET_WALL_TIME(&start);
-    for (unsigned int i = 0; i < n; ++i)
-      loadPlanBenchmark(planFile);
-    GET_WALL_TIME(&finish);
+    if (nCalls && window) {
+      checkParserException(PLEXIL::loadLibraryDocument(makeLibraryDocument(nChecks)),
+                           "Unable to load generated library node");
+      GET_WALL_TIME(&start);
+      soakBenchmark(n, nCalls, window, reportInterval);
+      GET_WALL_TIME(&finish);
+    }
+    else if (nCalls) {
+      checkParserException(PLEXIL::loadLibraryDocument(makeLibraryDocument(nChecks)),
+                           "Unable to load generated library node");
+      pugi::xml_document *doc = makeCallingPlan(nCalls);
+      GET_WALL_TIME(&start);
+      for (unsigned int i = 0; i < n; ++i)
+        parsePlanBenchmark(doc);
+      GET_WALL_TIME(&finish);
+      delete doc;
+    }
+    else {
+      GET_WALL_TIME(&start);
+      for (unsigned int i = 0; i < n; ++i)
+        loadPlanBenchmark(planFile);
+      GET_WALL_TIME(&finish);
+    }
 
     plexilRunFinalizers();
 
@@ -34,6 +34,7 @@
 #include "parseNode.hh"
 #include "ParserException.hh"
 #include "planLibrary.hh"
+#include "planLoader.hh"
 #include "TestSupport.hh"
 #include "UpdateImpl.hh"
 #include "UpdateNode.hh"
@@ -1850,6 +1851,122 @@ static bool libraryCallNodeXmlParserTest()
     delete nonDefInOutCall;
   }
 
+  // Several calls to the same library share its template
+  // but must not share any of its variables
+  {
+    xml_node multiCallXml = makeNode(*doc, "multiCall", "NodeList");
+    xml_node multiCallList = multiCallXml.append_child("NodeBody").append_child("NodeList");
+    char const *callIds[3] = {"call0", "call1", "call2"};
+    char const *callValues[3] = {"7", "8", "9"};
+    for (size_t i = 0; i < 3; ++i) {
+      xml_node callXml = makeNode(multiCallList, callIds[i], "LibraryNodeCall");
+      xml_node libCall = callXml.append_child("NodeBody").append_child("LibraryNodeCall");
+      makePcdataElement(libCall, "NodeId", "withInVar");
+      xml_node alias0 = libCall.append_child("Alias");
+      makePcdataElement(alias0, "NodeParameter", "inInt");
+      makePcdataElement(alias0, "IntegerValue", callValues[i]);
+    }
+    NodeImpl *multiCall = nullptr;
+
+    try {
+      checkNode(multiCallXml);
+      multiCall = constructNode(multiCallXml, nullptr);
+    }
+    catch (ParserException const &exc) {
+      assertTrueMsg(ALWAYS_FAIL, "Unexpected parser exception " << exc.what());
+    }
+    assertTrue_1(multiCall);
+    assertTrue_1(multiCall->getChildren().size() == 3);
+
+    finalizeNode(multiCall, multiCallXml);
+    Expression *previous = nullptr;
+    for (size_t i = 0; i < 3; ++i) {
+      NodeImplPtr const &call = multiCall->getChildren()[i];
+      assertTrue_1(call->getNodeId() == callIds[i]);
+      assertTrue_1(call->getChildren().size() == 1);
+      NodeImplPtr const &callee = call->getChildren().front();
+      assertTrue_1(callee->getNodeId() == "withInVar");
+      Expression *ivar = callee->findVariable("inInt");
+      assertTrue_1(ivar);
+      assertTrue_1(ivar != previous);
+      ivar->activate();
+      int32_t ival = 0;
+      assertTrue_1(ivar->getValue(ival));
+      assertTrue_1(ival == 7 + (int32_t) i);
+      previous = ivar;
+    }
+
+    delete multiCall;
+  }
+
+  return true;
+}
+
+static bool loaderThreadsNodeXmlParserTest()
+{
+  assertTrue_1(doc);
+  xml_node wideListXml = makeNode(*doc, "wideList", "NodeList");
+  xml_node wideList = wideListXml.append_child("NodeBody").append_child("NodeList");
+  assertTrue_1(wideList);
+  for (size_t i = 0; i < 16; ++i) {
+    std::string const kidId = "wideKid" + std::to_string(i);
+    makeNode(wideList, kidId.c_str(), "Empty");
+  }
+
+  // A wide list checks and constructs the same with loader threads
+  setPlanLoaderThreads(4);
+  {
+    NodeImpl *wide = nullptr;
+    try {
+      checkNode(wideListXml);
+      wide = constructNode(wideListXml, nullptr);
+    }
+    catch (ParserException const &exc) {
+      assertTrueMsg(ALWAYS_FAIL, "Unexpected parser exception " << exc.what());
+    }
+    assertTrue_1(wide);
+    assertTrue_1(wide->getChildren().size() == 16);
+    for (size_t i = 0; i < 16; ++i)
+      assertTrue_1(wide->getChildren()[i]->getNodeId() == "wideKid" + std::to_string(i));
+    finalizeNode(wide, wideListXml);
+    delete wide;
+  }
+
+  // With several bad children, the error reported is the one
+  // a serial check reports
+  xml_node badListXml = doc->append_copy(wideListXml);
+  assertTrue_1(badListXml);
+  assertTrue_1(badListXml.child("NodeId").first_child().set_value("badList"));
+  size_t i = 0;
+  for (xml_node kid : badListXml.child("NodeBody").child("NodeList").children()) {
+    if (i == 5 || i == 11)
+      assertTrue_1(kid.attribute("NodeType").set_value("Bogus"));
+    ++i;
+  }
+
+  std::string serialError, threadedError;
+  setPlanLoaderThreads(1);
+  try {
+    checkNode(badListXml);
+    assertTrueMsg(ALWAYS_FAIL, "Failed to detect bad child node type");
+  }
+  catch (ParserException const &exc) {
+    serialError = exc.what();
+  }
+  setPlanLoaderThreads(4);
+  try {
+    checkNode(badListXml);
+    assertTrueMsg(ALWAYS_FAIL, "Failed to detect bad child node type with loader threads");
+  }
+  catch (ParserException const &exc) {
+    threadedError = exc.what();
+  }
+  setPlanLoaderThreads(1);
+  assertTrue_1(!serialError.empty());
+  assertTrueMsg(threadedError == serialError,
+                "Loader threads reported \"" << threadedError
+                << "\", expected \"" << serialError << '"');
+
   return true;
 }
 
@@ -1863,6 +1980,7 @@ bool nodeXmlParserTest()
   runTest(commandNodeXmlParserTest);
   runTest(updateNodeXmlParserTest);
   runTest(libraryCallNodeXmlParserTest);
+  runTest(loaderThreadsNodeXmlParserTest);
 
   delete doc;
   doc = nullptr;